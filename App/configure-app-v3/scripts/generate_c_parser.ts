@@ -3,7 +3,7 @@ import fs from 'fs';
 import path from 'path';
 import { fileURLToPath } from 'url';
 
-import { modeSchema } from '../src/app/models/mode';
+import { keyframeEasings, modeSchema, modeTransitionEvents } from '../src/app/models/mode';
 
 const __filename = fileURLToPath(import.meta.url);
 const __dirname = path.dirname(__filename);
@@ -20,8 +20,9 @@ const __dirname = path.dirname(__filename);
  *    - `fields`: Object mapping field names to definitions.
  *    - `refine`: C expression string for validation logic (e.g. "out->has_front || out->has_case_comp").
  * 3. Field definitions:
- *    - `type`: 'string' | 'uint32' | 'boolean' | 'array' | [StructName]
+ *    - `type`: 'string' | 'uint32' | 'boolean' | 'enum' | 'array' | [StructName]
  *    - `min`, `max`: Validation constraints.
+ *    - `enumName`, `values`: C enum and the JSON strings it is parsed from, for 'enum' fields.
  *    - `optional`: boolean.
  * 4. Run `pnpm generate:c_parser` to regenerate mode_parser.h and mode_parser.c.
  */
@@ -63,6 +64,24 @@ const examplesData = [
       },
     },
   },
+  {
+    name: 'Keyframe Pattern',
+    data: {
+      name: 'Breathe',
+      front: {
+        pattern: {
+          type: 'keyframe',
+          name: 'Blue Breathe',
+          duration: 3000,
+          easing: 'ease',
+          changeAt: [
+            { ms: 0, output: '#000000' },
+            { ms: 1500, output: '#0000FF' },
+          ],
+        },
+      },
+    },
+  },
   {
     name: 'Accel Trigger',
     data: {
@@ -92,6 +111,63 @@ const examplesData = [
       },
     },
   },
+  {
+    name: 'Mode Script',
+    data: {
+      name: 'Shake Glow',
+      front: {
+        pattern: {
+          type: 'simple',
+          name: 'Steady Off',
+          duration: 1000,
+          changeAt: [{ ms: 0, output: '#000000' }],
+        },
+      },
+      accel: {
+        triggers: [
+          {
+            threshold: 50,
+            front: {
+              pattern: {
+                type: 'simple',
+                name: 'Glow',
+                duration: 1000,
+                changeAt: [{ ms: 0, output: '#FF8000' }],
+              },
+            },
+          },
+        ],
+      },
+      script: {
+        transitions: [
+          { from: 0, to: 1, on: 'accel', threshold: 50 },
+          { from: 1, to: 0, on: 'still', threshold: 20, ms: 5000 },
+        ],
+      },
+    },
+  },
+  {
+    name: 'Script States',
+    data: {
+      name: 'Tap Toggle',
+      front: {
+        pattern: {
+          type: 'simple',
+          name: 'Glow',
+          duration: 1000,
+          changeAt: [{ ms: 0, output: '#FF8000' }],
+        },
+      },
+      script: {
+        states: [{ front: 0 }, {}],
+        transitions: [
+          { from: 0, to: 1, on: 'button' },
+          { from: 0, to: 1, on: 'charge' },
+          { from: 1, to: 0, on: 'button' },
+        ],
+      },
+    },
+  },
 ];
 
 // Validate examples
@@ -127,13 +203,18 @@ type FieldType =
   | 'uint8'
   | 'uint32'
   | 'boolean'
+  | 'enum'
   | 'array'
   | 'ModeComponent'
   | 'ModePattern'
   | 'ModeAccel'
   | 'ModeAccelTrigger'
+  | 'ModeScript'
+  | 'ModeScriptState'
+  | 'ModeTransition'
   | 'SimplePattern'
   | 'EquationPattern'
+  | 'KeyframePattern'
   | 'PatternChange'
   | 'EquationSection'
   | 'ChannelConfig'
@@ -165,6 +246,12 @@ interface BooleanFieldDef extends BaseFieldDef {
   type: 'boolean';
 }
 
+interface EnumFieldDef extends BaseFieldDef {
+  type: 'enum';
+  enumName: string;
+  values: readonly string[];
+}
+
 interface ArrayFieldDef extends BaseFieldDef {
   type: 'array';
   item: string;
@@ -179,8 +266,12 @@ interface StructFieldDef extends BaseFieldDef {
     | 'ModePattern'
     | 'ModeAccel'
     | 'ModeAccelTrigger'
+    | 'ModeScript'
+    | 'ModeScriptState'
+    | 'ModeTransition'
     | 'SimplePattern'
     | 'EquationPattern'
+    | 'KeyframePattern'
     | 'PatternChange'
     | 'EquationSection'
     | 'ChannelConfig'
@@ -192,6 +283,7 @@ type FieldDef =
   | Uint8FieldDef
   | Uint32FieldDef
   | BooleanFieldDef
+  | EnumFieldDef
   | ArrayFieldDef
   | StructFieldDef;
 
@@ -274,12 +366,28 @@ const schema: Record<string, SchemaDef> = {
       field: 'red',
     },
   },
+  KeyframePattern: {
+    type: 'struct',
+    fields: {
+      name: { type: 'string', min: 1, max: 31, maxDefine: 'MODE_NAME_MAX_LEN' },
+      duration: { type: 'uint32', min: 1 },
+      easing: { type: 'enum', enumName: 'KeyframeEasing', values: keyframeEasings },
+      changeAt: {
+        type: 'array',
+        item: 'PatternChange',
+        min: 1,
+        max: 32,
+        maxDefine: 'SIMPLE_PATTERN_CHANGES_MAX',
+      },
+    },
+  },
   ModePattern: {
     type: 'discriminatedUnion',
     discriminator: 'type',
     variants: {
       simple: 'SimplePattern',
       equation: 'EquationPattern',
+      keyframe: 'KeyframePattern',
     },
   },
   ModeComponent: {
@@ -292,6 +400,7 @@ const schema: Record<string, SchemaDef> = {
     type: 'struct',
     fields: {
       threshold: { type: 'uint8', min: 0 },
+      holdMs: { type: 'uint32', min: 0, optional: true },
       front: { type: 'ModeComponent', optional: true },
       case: { type: 'ModeComponent', optional: true },
     },
@@ -309,6 +418,43 @@ const schema: Record<string, SchemaDef> = {
       },
     },
   },
+  ModeTransition: {
+    type: 'struct',
+    fields: {
+      from: { type: 'uint8', min: 0 },
+      to: { type: 'uint8', min: 0 },
+      on: { type: 'enum', enumName: 'ModeTransitionEvent', values: modeTransitionEvents },
+      threshold: { type: 'uint8', min: 0, optional: true },
+      ms: { type: 'uint32', min: 0, optional: true },
+    },
+  },
+  ModeScriptState: {
+    type: 'struct',
+    fields: {
+      front: { type: 'uint8', min: 0, optional: true },
+      case: { type: 'uint8', min: 0, optional: true },
+    },
+  },
+  ModeScript: {
+    type: 'struct',
+    fields: {
+      states: {
+        type: 'array',
+        item: 'ModeScriptState',
+        min: 1,
+        max: 8,
+        maxDefine: 'MODE_SCRIPT_STATES_MAX',
+        optional: true,
+      },
+      transitions: {
+        type: 'array',
+        item: 'ModeTransition',
+        min: 1,
+        max: 8,
+        maxDefine: 'MODE_SCRIPT_TRANSITIONS_MAX',
+      },
+    },
+  },
   Mode: {
     type: 'struct',
     fields: {
@@ -316,23 +462,35 @@ const schema: Record<string, SchemaDef> = {
       front: { type: 'ModeComponent', optional: true },
       case: { type: 'ModeComponent', optional: true },
       accel: { type: 'ModeAccel', optional: true },
+      script: { type: 'ModeScript', optional: true },
     },
     refine: { expr: 'out->hasFront || out->hasCaseComp', field: 'front' },
   },
 };
 
+// KeyframeEasing + 'linear' -> KEYFRAME_EASING_LINEAR
+function enumConstant(enumName: string, value: string) {
+  const prefix = enumName.replace(/([a-z0-9])([A-Z])/g, '$1_$2').toUpperCase();
+  return `${prefix}_${value.toUpperCase()}`;
+}
+
 function generateModelHeader() {
+  const patternTypes = Object.values(schema)
+    .filter((def): def is DiscriminatedUnionDef => def.type === 'discriminatedUnion')
+    .flatMap(def => Object.keys(def.variants))
+    .map(key => `PATTERN_TYPE_${key.toUpperCase()}`);
+
   let out = `/* Generated by scripts/generate_c_parser.ts */
 /*
 ${examplesComment}
  */
-#ifndef MODE_MODEL_H
-#define MODE_MODEL_H
+#ifndef INC_MODEL_MODE_H_
+#define INC_MODEL_MODE_H_
 
 #include <stdbool.h>
 #include <stdint.h>
 
-typedef enum { PATTERN_TYPE_SIMPLE, PATTERN_TYPE_EQUATION } PatternType;
+typedef enum { ${patternTypes.join(', ')} } PatternType;
 
 `;
 
@@ -358,7 +516,26 @@ typedef enum { PATTERN_TYPE_SIMPLE, PATTERN_TYPE_EQUATION } PatternType;
 
 typedef enum BulbSimpleOutput { low, high } BulbSimpleOutput;
 
-typedef struct RGBSimpleOutput RGBSimpleOutput;
+`;
+
+  // Enums used by struct fields
+  const enums = new Map<string, readonly string[]>();
+  for (const def of Object.values(schema)) {
+    if (def.type === 'struct') {
+      for (const field of Object.values(def.fields)) {
+        if (field.type === 'enum') {
+          enums.set(field.enumName, field.values);
+        }
+      }
+    }
+  }
+
+  for (const [enumName, values] of enums) {
+    const constants = values.map(value => enumConstant(enumName, value)).join(', ');
+    out += `typedef enum ${enumName} { ${constants} } ${enumName};\n\n`;
+  }
+
+  out += `typedef struct RGBSimpleOutput RGBSimpleOutput;
 typedef struct SimpleOutput SimpleOutput;
 
 `;
@@ -399,6 +576,8 @@ struct SimpleOutput {
           out += `    uint32_t ${cName};\n`;
         } else if (fieldDef.type === 'boolean') {
           out += `    bool ${cName};\n`;
+        } else if (fieldDef.type === 'enum') {
+          out += `    ${fieldDef.enumName} ${cName};\n`;
         } else if (fieldDef.type === 'array') {
           const lenStr = fieldDef.maxDefine ?? String(fieldDef.max);
           out += `    ${fieldDef.item} ${cName}[${lenStr}];\n`;
@@ -426,14 +605,14 @@ struct SimpleOutput {
     out += `};\n\n`;
   }
 
-  out += `#endif  // MODE_MODEL_H\n`;
+  out += `#endif /* INC_MODEL_MODE_H_ */\n`;
   return out;
 }
 
 function generateParserHeader() {
   return `/* Generated by scripts/generate_c_parser.ts */
-#ifndef MODE_PARSER_H
-#define MODE_PARSER_H
+#ifndef INC_JSON_MODE_PARSER_H_
+#define INC_JSON_MODE_PARSER_H_
 
 #include "lwjson/lwjson.h"
 #include "microlight/json/parser.h"
@@ -441,7 +620,7 @@ function generateParserHeader() {
 
 bool parseMode(lwjson_t *lwjson, lwjson_token_t *token, Mode *out, ParserErrorContext *ctx);
 
-#endif  // MODE_PARSER_H
+#endif /* INC_JSON_MODE_PARSER_H_ */
 `;
 }
 
@@ -652,6 +831,21 @@ static bool parseBooleanField(const lwjson_token_t *token, bool *out) {
           out += `        }\n`;
         } else if (fieldDef.type === 'boolean') {
           out += `        parseBooleanField(tokenField, &out->${cName});\n`;
+        } else if (fieldDef.type === 'enum') {
+          out += `        char enumStr[32];\n`;
+          out += `        if (!parseStringField(tokenField, enumStr, 1, 31, ctx, "${fieldName}")) {\n`;
+          out += `            return false;\n`;
+          out += `        }\n`;
+          fieldDef.values.forEach((value, i) => {
+            out += i === 0 ? `        if ` : `        } else if `;
+            out += `(strcmp(enumStr, "${value}") == 0) {\n`;
+            out += `            out->${cName} = ${enumConstant(fieldDef.enumName, value)};\n`;
+          });
+          out += `        } else {\n`;
+          out += `            ctx->error = PARSER_ERR_INVALID_VARIANT;\n`;
+          out += `            strcpy(ctx->path, "${fieldName}");\n`;
+          out += `            return false;\n`;
+          out += `        }\n`;
         } else if (fieldDef.type === 'array') {
           const maxStr = fieldDef.maxDefine ?? String(fieldDef.max);
           out += `        const lwjson_token_t *child = lwjson_get_first_child(tokenField);\n`;
@@ -4,6 +4,7 @@ import {
   hexColorSchema,
   isBinaryPattern,
   isColorPattern,
+  keyframePatternSchema,
   modeDocumentSchema,
   parseModeDocument,
   simplePatternSchema,
@@ -44,6 +45,42 @@ describe('simplePatternSchema', () => {
   });
 });
 
+describe('keyframePatternSchema', () => {
+  it('validates a looping color fade', () => {
+    const result = keyframePatternSchema.safeParse({
+      type: 'keyframe',
+      name: 'Breathe',
+      duration: 3000,
+      easing: 'ease',
+      changeAt: [
+        { ms: 0, output: '#000000' },
+        { ms: 1500, output: '#0000ff' },
+      ],
+    });
+    expect(result.success).toBe(true);
+  });
+
+  it('rejects binary outputs and unknown easing', () => {
+    const binary = keyframePatternSchema.safeParse({
+      type: 'keyframe',
+      name: 'Bulb Fade',
+      duration: 1000,
+      easing: 'linear',
+      changeAt: [{ ms: 0, output: 'high' }],
+    });
+    expect(binary.success).toBe(false);
+
+    const easing = keyframePatternSchema.safeParse({
+      type: 'keyframe',
+      name: 'Bounce',
+      duration: 1000,
+      easing: 'bounce',
+      changeAt: [{ ms: 0, output: '#ffffff' }],
+    });
+    expect(easing.success).toBe(false);
+  });
+});
+
 describe('modeDocumentSchema', () => {
   it('parses a mode with accelerometer triggers and binary outputs', () => {
     const result = parseModeDocument({
@@ -253,6 +290,115 @@ describe('modeDocumentSchema', () => {
     }
   });
 
+  describe('script', () => {
+    const scriptedMode = (transitions: unknown[], states?: unknown[]) => ({
+      mode: {
+        name: 'scripted',
+        front: {
+          pattern: {
+            type: 'simple',
+            name: 'front pattern',
+            duration: 1,
+            changeAt: [{ ms: 0, output: 'low' }],
+          },
+        },
+        accel: {
+          triggers: [
+            {
+              threshold: 50,
+              front: {
+                pattern: {
+                  type: 'simple',
+                  name: 'trigger pattern',
+                  duration: 1,
+                  changeAt: [{ ms: 0, output: 'high' }],
+                },
+              },
+            },
+          ],
+        },
+        script: { states, transitions },
+      },
+    });
+
+    it('parses transitions between the mode and its triggers', () => {
+      const result = parseModeDocument(
+        scriptedMode([
+          { from: 0, to: 1, on: 'accel', threshold: 50 },
+          { from: 1, to: 0, on: 'timer', ms: 2000 },
+        ]),
+      );
+
+      expect(result.mode.script?.transitions).toHaveLength(2);
+      expect(result.mode.script?.transitions[1].on).toBe('timer');
+    });
+
+    it('rejects transitions to a state without a trigger', () => {
+      const result = modeDocumentSchema.safeParse(
+        scriptedMode([{ from: 0, to: 2, on: 'accel', threshold: 50 }]),
+      );
+
+      expect(result.success).toBe(false);
+      if (!result.success) {
+        expect(
+          result.error.issues.some(issue => issue.message === 'validation.script.stateMissing'),
+        ).toBe(true);
+      }
+    });
+
+    it('parses script states moved by the button and the charger', () => {
+      const result = parseModeDocument(
+        scriptedMode(
+          [
+            { from: 0, to: 2, on: 'button' },
+            { from: 2, to: 1, on: 'charge' },
+          ],
+          [{ front: 0 }, { front: 1 }, {}],
+        ),
+      );
+
+      expect(result.mode.script?.states).toHaveLength(3);
+      expect(result.mode.script?.transitions[0].on).toBe('button');
+    });
+
+    it('rejects transitions to a state the script does not list', () => {
+      const result = modeDocumentSchema.safeParse(
+        scriptedMode([{ from: 0, to: 1, on: 'button' }], [{ front: 0 }]),
+      );
+
+      expect(result.success).toBe(false);
+      if (!result.success) {
+        expect(
+          result.error.issues.some(issue => issue.message === 'validation.script.stateMissing'),
+        ).toBe(true);
+      }
+    });
+
+    it('rejects states showing a trigger the mode does not have', () => {
+      const result = modeDocumentSchema.safeParse(
+        scriptedMode([{ from: 0, to: 1, on: 'button' }], [{ front: 0 }, { front: 2 }]),
+      );
+
+      expect(result.success).toBe(false);
+      if (!result.success) {
+        expect(
+          result.error.issues.some(issue => issue.message === 'validation.script.slotMissing'),
+        ).toBe(true);
+      }
+    });
+
+    it('requires a time on timer transitions', () => {
+      const result = modeDocumentSchema.safeParse(scriptedMode([{ from: 1, to: 0, on: 'timer' }]));
+
+      expect(result.success).toBe(false);
+      if (!result.success) {
+        expect(
+          result.error.issues.some(issue => issue.message === 'validation.script.msRequired'),
+        ).toBe(true);
+      }
+    });
+  });
+
   it('parses a mode with equation patterns', () => {
     const result = parseModeDocument({
       mode: {
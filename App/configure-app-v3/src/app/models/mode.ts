@@ -89,6 +89,45 @@ export const createDefaultEquationPattern = (): EquationPattern => ({
   blue: { sections: [], loopAfterDuration: true },
 });
 
+const uniqueTimestamps = (changes: PatternChange[], ctx: z.RefinementCtx) => {
+  const timestamps = new Set<number>();
+  for (const change of changes) {
+    if (timestamps.has(change.ms)) {
+      ctx.addIssue({
+        code: 'custom',
+        message: 'validation.pattern.simple.timestamp.unique',
+      });
+      break;
+    }
+    timestamps.add(change.ms);
+  }
+};
+
+// A step's duration is the difference between its start time and the next step's start time (or
+// total duration)
+const nonZeroStepDurations = (
+  pattern: { duration: number; changeAt: PatternChange[] },
+  ctx: z.RefinementCtx,
+) => {
+  const sortedChanges = [...pattern.changeAt].sort((a, b) => a.ms - b.ms);
+
+  for (let i = 0; i < sortedChanges.length; i++) {
+    const current = sortedChanges[i];
+    const nextMs = i === sortedChanges.length - 1 ? pattern.duration : sortedChanges[i + 1].ms;
+    const duration = nextMs - current.ms;
+
+    if (duration <= 0) {
+      ctx.addIssue({
+        code: 'custom',
+        message: createLocalizedError('validation.pattern.simple.stepDurationZero', {
+          step: i + 1,
+        }),
+        path: ['changeAt', i],
+      });
+    }
+  }
+};
+
 export const simplePatternSchema = z
   .object({
     type: z.literal('simple'),
@@ -100,48 +139,46 @@ export const simplePatternSchema = z
     changeAt: z
       .array(patternChangeSchema)
       .min(1, 'validation.pattern.simple.changeEventRequired')
-      .superRefine((changes, ctx) => {
-        const timestamps = new Set<number>();
-        for (const change of changes) {
-          if (timestamps.has(change.ms)) {
-            ctx.addIssue({
-              code: 'custom',
-              message: 'validation.pattern.simple.timestamp.unique',
-            });
-            break;
-          }
-          timestamps.add(change.ms);
-        }
-      }),
+      .superRefine(uniqueTimestamps),
   })
   .describe('A pattern defining how an LED output changes over time.')
-  .superRefine((pattern, ctx) => {
-    // Check for zero-duration steps
-    // A step's duration is the difference between its start time and the next step's start time (or total duration)
-    const sortedChanges = [...pattern.changeAt].sort((a, b) => a.ms - b.ms);
+  .superRefine(nonZeroStepDurations);
 
-    for (let i = 0; i < sortedChanges.length; i++) {
-      const current = sortedChanges[i];
-      const nextMs = i === sortedChanges.length - 1 ? pattern.duration : sortedChanges[i + 1].ms;
-      const duration = nextMs - current.ms;
+export type SimplePattern = z.infer<typeof simplePatternSchema>;
 
-      if (duration <= 0) {
-        ctx.addIssue({
-          code: 'custom',
-          message: createLocalizedError('validation.pattern.simple.stepDurationZero', {
-            step: i + 1,
-          }),
-          path: ['changeAt', i],
-        });
-      }
-    }
-  });
+export const keyframeEasings = ['linear', 'ease'] as const;
 
-export type SimplePattern = z.infer<typeof simplePatternSchema>;
+export const keyframeEasingSchema = z
+  .enum(keyframeEasings)
+  .describe('How colors move between keyframes, ease slows down into and out of each one.');
+
+export type KeyframeEasing = z.infer<typeof keyframeEasingSchema>;
+
+export const keyframePatternSchema = z
+  .object({
+    type: z.literal('keyframe'),
+    name: z.string().min(1, 'validation.pattern.name.required'),
+    duration: z
+      .number()
+      .int('validation.pattern.duration.integer')
+      .positive('validation.pattern.duration.min'),
+    easing: keyframeEasingSchema,
+    changeAt: z
+      .array(patternChangeColorSchema)
+      .min(1, 'validation.pattern.simple.changeEventRequired')
+      .superRefine(uniqueTimestamps),
+  })
+  .describe(
+    'A pattern that fades between colors at each keyframe, looping from the last back to the first.',
+  )
+  .superRefine(nonZeroStepDurations);
+
+export type KeyframePattern = z.infer<typeof keyframePatternSchema>;
 
 export const modePatternSchema = z.discriminatedUnion('type', [
   simplePatternSchema,
   equationPatternSchema,
+  keyframePatternSchema,
 ]);
 
 export type ModePattern = z.infer<typeof modePatternSchema>;
@@ -157,6 +194,7 @@ export type ModeComponent = z.infer<typeof modeComponentSchema>;
 export const modeAccelTriggerSchema = z
   .object({
     threshold: z.number().nonnegative('validation.accel.thresholdNegative'),
+    holdMs: z.number().int().nonnegative('validation.accel.holdNegative').optional(),
     front: modeComponentSchema.optional(),
     case: modeComponentSchema.optional(),
   })
@@ -174,17 +212,104 @@ export const modeAccelSchema = z
 
 export type ModeAccel = z.infer<typeof modeAccelSchema>;
 
+export const modeTransitionEvents = ['accel', 'still', 'timer', 'button', 'charge'] as const;
+
+export const modeTransitionEventSchema = z
+  .enum(modeTransitionEvents)
+  .describe(
+    'accel fires over the threshold, still once the threshold has not been passed for ms, timer ms after entering the state, button on a click (which then no longer changes the mode) and charge once the charger is plugged in or unplugged after entering the state.',
+  );
+
+export type ModeTransitionEvent = z.infer<typeof modeTransitionEventSchema>;
+
+export const modeTransitionSchema = z
+  .object({
+    from: z.number().int().nonnegative('validation.script.stateNegative'),
+    to: z.number().int().nonnegative('validation.script.stateNegative'),
+    on: modeTransitionEventSchema,
+    threshold: z.number().nonnegative('validation.accel.thresholdNegative').optional(),
+    ms: z.number().int().nonnegative('validation.script.msNegative').optional(),
+  })
+  .refine(
+    transition =>
+      (transition.on !== 'accel' && transition.on !== 'still') ||
+      transition.threshold !== undefined,
+    {
+      message: 'validation.script.thresholdRequired',
+      path: ['threshold'],
+    },
+  )
+  .refine(transition => transition.on !== 'timer' || transition.ms !== undefined, {
+    message: 'validation.script.msRequired',
+    path: ['ms'],
+  })
+  .describe('Moves the mode from one state to another when its event fires.');
+
+export type ModeTransition = z.infer<typeof modeTransitionSchema>;
+
+export const modeScriptStateSchema = z
+  .object({
+    front: z.number().int().nonnegative('validation.script.slotNegative').optional(),
+    case: z.number().int().nonnegative('validation.script.slotNegative').optional(),
+  })
+  .describe(
+    'Components shown in a state, 0 for those of the mode and n for those of accel trigger n. Without one the LED is off.',
+  );
+
+export type ModeScriptState = z.infer<typeof modeScriptStateSchema>;
+
+export const modeScriptSchema = z
+  .object({
+    states: z
+      .array(modeScriptStateSchema)
+      .min(1, 'validation.script.stateRequired')
+      .max(8, 'validation.script.stateLimit')
+      .optional(),
+    transitions: z
+      .array(modeTransitionSchema)
+      .min(1, 'validation.script.transitionRequired')
+      .max(8, 'validation.script.transitionLimit'),
+  })
+  .describe(
+    'State machine replacing the trigger thresholds. Without states, state 0 shows the mode components and state n those of accel trigger n.',
+  );
+
+export type ModeScript = z.infer<typeof modeScriptSchema>;
+
 export const modeSchema = z
   .object({
     name: z.string().min(1, 'validation.mode.nameEmpty'),
     front: modeComponentSchema.optional(),
     case: modeComponentSchema.optional(),
     accel: modeAccelSchema.optional(),
+    script: modeScriptSchema.optional(),
   })
   .refine(data => data.front ?? data.case, {
     message: 'validation.mode.patternRequired',
     path: ['front', 'case'],
   })
+  .superRefine((data, ctx) => {
+    const triggerCount = data.accel?.triggers.length ?? 0;
+    const stateCount = data.script?.states?.length ?? triggerCount + 1;
+    data.script?.states?.forEach((state, index) => {
+      if ((state.front ?? 0) > triggerCount || (state.case ?? 0) > triggerCount) {
+        ctx.addIssue({
+          code: z.ZodIssueCode.custom,
+          message: 'validation.script.slotMissing',
+          path: ['script', 'states', index],
+        });
+      }
+    });
+    data.script?.transitions.forEach((transition, index) => {
+      if (transition.from >= stateCount || transition.to >= stateCount) {
+        ctx.addIssue({
+          code: z.ZodIssueCode.custom,
+          message: 'validation.script.stateMissing',
+          path: ['script', 'transitions', index],
+        });
+      }
+    });
+  })
   .describe('Complete mode description including optional accelerometer triggers.');
 
 export type Mode = z.infer<typeof modeSchema>;
@@ -60,7 +60,9 @@ export const AccelTriggerEditor = ({ triggers, onChange, patterns }: Props) => {
     onChange(next);
   };
 
-  const colorPatterns = patterns.filter(p => isColorPattern(p) || p.type === 'equation');
+  const colorPatterns = patterns.filter(
+    p => isColorPattern(p) || p.type === 'equation' || p.type === 'keyframe',
+  );
 
   return (
     <Section
@@ -103,6 +105,23 @@ export const AccelTriggerEditor = ({ triggers, onChange, patterns }: Props) => {
                 />
                 <p className="theme-muted text-xs mt-1">{t('modeEditor.thresholdHelper')}</p>
               </div>
+              <div className="w-full sm:w-1/3">
+                <label className="text-sm font-medium">{t('modeEditor.holdLabel')}</label>
+                <input
+                  type="number"
+                  step="10"
+                  min="0"
+                  className="theme-input w-full rounded-md border px-3 py-2 min-h-[44px]"
+                  value={trigger.holdMs ?? 0}
+                  onChange={e => {
+                    const val = parseInt(e.target.value, 10);
+                    updateTrigger(index, {
+                      holdMs: Number.isNaN(val) || val <= 0 ? undefined : val,
+                    });
+                  }}
+                />
+                <p className="theme-muted text-xs mt-1">{t('modeEditor.holdHelper')}</p>
+              </div>
               <button
                 onClick={() => {
                   removeTrigger(index);
@@ -103,6 +103,19 @@ describe('ModeEditor', () => {
     }
   });
 
+  it('calls onChange when the script changes', () => {
+    const onChange = vi.fn();
+    renderWithProviders(
+      <ModeEditor mode={defaultMode} onChange={onChange} patterns={mockPatterns} />,
+    );
+
+    fireEvent.click(screen.getByText('modeEditor.script.addTransition'));
+
+    const [newMode, action] = onChange.mock.calls[0] as [Mode, ModeAction];
+    expect(newMode.script?.transitions).toEqual([{ from: 0, to: 0, on: 'button' }]);
+    expect(action.type).toBe('update-script');
+  });
+
   it('filters patterns for Case LED selector to only allow RGB patterns', () => {
     renderWithProviders(
       <ModeEditor mode={defaultMode} onChange={vi.fn()} patterns={mockPatterns} />,
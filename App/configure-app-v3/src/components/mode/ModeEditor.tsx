@@ -2,11 +2,13 @@ import { useTranslation } from 'react-i18next';
 
 import { AccelTriggerEditor } from './AccelTriggerEditor';
 import { PatternSelector } from './PatternSelector';
+import { ScriptEditor } from './ScriptEditor';
 import {
   isColorPattern,
   type Mode,
   type ModeAccelTrigger,
   type ModePattern,
+  type ModeScript,
 } from '../../app/models/mode';
 import { NameEditor } from '../common/NameEditor';
 import { PanelContainer } from '../common/PanelContainer';
@@ -16,7 +18,8 @@ export type ModeAction =
   | { type: 'update-name'; name: string }
   | { type: 'update-front-pattern'; pattern: ModePattern | undefined }
   | { type: 'update-case-pattern'; pattern: ModePattern | undefined }
-  | { type: 'update-triggers'; triggers: ModeAccelTrigger[] };
+  | { type: 'update-triggers'; triggers: ModeAccelTrigger[] }
+  | { type: 'update-script'; script: ModeScript | undefined };
 
 interface Props {
   mode: Mode;
@@ -63,7 +66,13 @@ export const ModeEditor = ({ mode, onChange, patterns }: Props) => {
     );
   };
 
-  const colorPatterns = patterns.filter(p => isColorPattern(p) || p.type === 'equation');
+  const handleScriptChange = (script: ModeScript | undefined) => {
+    onChange({ ...mode, script }, { type: 'update-script', script });
+  };
+
+  const colorPatterns = patterns.filter(
+    p => isColorPattern(p) || p.type === 'equation' || p.type === 'keyframe',
+  );
 
   return (
     <PanelContainer>
@@ -97,6 +106,12 @@ export const ModeEditor = ({ mode, onChange, patterns }: Props) => {
         onChange={handleTriggersChange}
         patterns={patterns}
       />
+
+      <ScriptEditor
+        script={mode.script}
+        triggerCount={mode.accel?.triggers.length ?? 0}
+        onChange={handleScriptChange}
+      />
     </PanelContainer>
   );
 };
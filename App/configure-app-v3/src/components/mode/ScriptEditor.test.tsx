@@ -0,0 +1,82 @@
+import { fireEvent, screen } from '@testing-library/react';
+import { describe, expect, it, vi } from 'vitest';
+
+import { ScriptEditor } from './ScriptEditor';
+import type { ModeScript } from '../../app/models/mode';
+import { renderWithProviders } from '../../test-utils/render-with-providers';
+
+describe('ScriptEditor', () => {
+  it('renders empty state', () => {
+    renderWithProviders(<ScriptEditor script={undefined} triggerCount={0} onChange={vi.fn()} />);
+    expect(screen.getByText('modeEditor.script.noScript')).toBeInTheDocument();
+  });
+
+  it('adds a button transition between the trigger states', () => {
+    const onChange = vi.fn();
+    renderWithProviders(<ScriptEditor script={undefined} triggerCount={1} onChange={onChange} />);
+
+    fireEvent.click(screen.getByText('modeEditor.script.addTransition'));
+    expect(onChange).toHaveBeenCalledWith({
+      states: undefined,
+      transitions: [{ from: 0, to: 1, on: 'button' }],
+    });
+  });
+
+  it('starts its own states from the trigger states', () => {
+    const onChange = vi.fn();
+    renderWithProviders(<ScriptEditor script={undefined} triggerCount={1} onChange={onChange} />);
+
+    fireEvent.click(screen.getByText('modeEditor.script.addState'));
+    expect(onChange).toHaveBeenCalledWith({
+      states: [{ front: 0, case: 0 }, { front: 1, case: 1 }, {}],
+      transitions: [],
+    });
+  });
+
+  it('turns a state component off', () => {
+    const onChange = vi.fn();
+    const script: ModeScript = {
+      states: [{ front: 0, case: 0 }],
+      transitions: [{ from: 0, to: 0, on: 'charge' }],
+    };
+    renderWithProviders(<ScriptEditor script={script} triggerCount={0} onChange={onChange} />);
+
+    // front and case of the state, then from, to and on of the transition
+    const selects = screen.getAllByRole('combobox');
+    fireEvent.change(selects[0], { target: { value: '' } });
+
+    const next = onChange.mock.calls[0][0] as ModeScript;
+    expect(next.states?.[0]).toEqual({ front: undefined, case: 0 });
+  });
+
+  it('asks for a time when the event becomes a timer', () => {
+    const onChange = vi.fn();
+    const script: ModeScript = {
+      transitions: [{ from: 0, to: 1, on: 'accel', threshold: 50 }],
+    };
+    renderWithProviders(<ScriptEditor script={script} triggerCount={1} onChange={onChange} />);
+
+    const selects = screen.getAllByRole('combobox');
+    fireEvent.change(selects[2], { target: { value: 'timer' } });
+
+    const next = onChange.mock.calls[0][0] as ModeScript;
+    expect(next.transitions[0]).toEqual({
+      from: 0,
+      to: 1,
+      on: 'timer',
+      threshold: undefined,
+      ms: 1000,
+    });
+  });
+
+  it('removes the script with its last transition', () => {
+    const onChange = vi.fn();
+    const script: ModeScript = {
+      transitions: [{ from: 0, to: 1, on: 'button' }],
+    };
+    renderWithProviders(<ScriptEditor script={script} triggerCount={1} onChange={onChange} />);
+
+    fireEvent.click(screen.getByText('modeEditor.script.deleteTransition'));
+    expect(onChange).toHaveBeenCalledWith(undefined);
+  });
+});
@@ -0,0 +1,270 @@
+import { useTranslation } from 'react-i18next';
+
+import {
+  modeTransitionEvents,
+  type ModeScript,
+  type ModeScriptState,
+  type ModeTransition,
+  type ModeTransitionEvent,
+} from '../../app/models/mode';
+import { Section } from '../common/Section';
+
+interface Props {
+  script: ModeScript | undefined;
+  triggerCount: number;
+  onChange: (script: ModeScript | undefined) => void;
+}
+
+const inputClassName = 'theme-input w-full rounded-md border px-3 py-2 min-h-[44px]';
+
+export const ScriptEditor = ({ script, triggerCount, onChange }: Props) => {
+  const { t } = useTranslation();
+
+  const states = script?.states;
+  const transitions = script?.transitions ?? [];
+  // without states of its own the script runs on the mode and one state per trigger
+  const stateCount = states?.length ?? triggerCount + 1;
+
+  const update = (nextStates: ModeScriptState[] | undefined, nextTransitions: ModeTransition[]) => {
+    if (!nextStates?.length && nextTransitions.length === 0) {
+      onChange(undefined);
+      return;
+    }
+    onChange({
+      states: nextStates?.length ? nextStates : undefined,
+      transitions: nextTransitions,
+    });
+  };
+
+  const addState = () => {
+    // the first state of its own starts from the ones the script ran on so far
+    const current =
+      states ??
+      Array.from({ length: triggerCount + 1 }, (_, slot) => ({ front: slot, case: slot }));
+    update([...current, {}], transitions);
+  };
+
+  const removeState = (index: number) => {
+    const next = [...(states ?? [])];
+    next.splice(index, 1);
+    update(next, transitions);
+  };
+
+  const updateState = (index: number, component: 'front' | 'case', value: string) => {
+    const next = [...(states ?? [])];
+    next[index] = { ...next[index], [component]: value === '' ? undefined : Number(value) };
+    update(next, transitions);
+  };
+
+  const addTransition = () => {
+    update(states, [...transitions, { from: 0, to: stateCount > 1 ? 1 : 0, on: 'button' }]);
+  };
+
+  const removeTransition = (index: number) => {
+    const next = [...transitions];
+    next.splice(index, 1);
+    update(states, next);
+  };
+
+  const updateTransition = (index: number, change: Partial<ModeTransition>) => {
+    const next = [...transitions];
+    next[index] = { ...next[index], ...change };
+    update(states, next);
+  };
+
+  const usesThreshold = (on: ModeTransitionEvent) => on === 'accel' || on === 'still';
+  const usesMs = (on: ModeTransitionEvent) => on === 'still' || on === 'timer';
+
+  const changeEvent = (index: number, on: ModeTransitionEvent) => {
+    const current = transitions[index];
+    updateTransition(index, {
+      on,
+      threshold: usesThreshold(on) ? (current.threshold ?? 150) : undefined,
+      ms: usesMs(on) ? (current.ms ?? 1000) : undefined,
+    });
+  };
+
+  const slotLabel = (slot: number) =>
+    slot === 0
+      ? t('modeEditor.script.modeComponents')
+      : t('modeEditor.script.triggerComponents', { index: slot });
+
+  const stateOptions = Array.from({ length: stateCount }, (_, index) => (
+    <option key={index} value={index}>
+      {t('modeEditor.script.stateLabel', { index })}
+    </option>
+  ));
+
+  const slotOptions = [
+    <option key="none" value="">
+      {t('modeEditor.script.noComponent')}
+    </option>,
+    ...Array.from({ length: triggerCount + 1 }, (_, slot) => (
+      <option key={slot} value={slot}>
+        {slotLabel(slot)}
+      </option>
+    )),
+  ];
+
+  return (
+    <Section
+      title={t('modeEditor.script.title')}
+      actions={
+        <>
+          <button
+            onClick={addState}
+            className="theme-button px-3 py-2 text-sm min-h-[44px]"
+            disabled={stateCount >= 8}
+          >
+            {t('modeEditor.script.addState')}
+          </button>
+          <button
+            onClick={addTransition}
+            className="theme-button theme-button-primary px-3 py-2 text-sm min-h-[44px]"
+            disabled={transitions.length >= 8}
+          >
+            {t('modeEditor.script.addTransition')}
+          </button>
+        </>
+      }
+    >
+      {!script && <p className="theme-muted text-sm italic">{t('modeEditor.script.noScript')}</p>}
+
+      <div className="space-y-4">
+        {states?.map((state, index) => (
+          <div
+            key={index}
+            className="bg-[rgb(var(--surface-raised)/0.5)] theme-border rounded-lg border p-3 sm:p-4 flex flex-col gap-3 sm:flex-row sm:items-end"
+          >
+            <span className="text-sm font-medium sm:w-1/6">
+              {t('modeEditor.script.stateLabel', { index })}
+            </span>
+            <div className="w-full sm:w-1/3">
+              <label className="text-sm font-medium">{t('modeEditor.frontLabel')}</label>
+              <select
+                className={inputClassName}
+                value={state.front ?? ''}
+                onChange={e => {
+                  updateState(index, 'front', e.target.value);
+                }}
+              >
+                {slotOptions}
+              </select>
+            </div>
+            <div className="w-full sm:w-1/3">
+              <label className="text-sm font-medium">{t('modeEditor.caseLabel')}</label>
+              <select
+                className={inputClassName}
+                value={state.case ?? ''}
+                onChange={e => {
+                  updateState(index, 'case', e.target.value);
+                }}
+              >
+                {slotOptions}
+              </select>
+            </div>
+            <button
+              onClick={() => {
+                removeState(index);
+              }}
+              className="text-red-500 hover:text-red-700 text-sm min-h-[44px] min-w-[44px] flex items-center justify-center rounded-lg hover:bg-red-500/10 transition-colors"
+            >
+              {t('modeEditor.script.deleteState')}
+            </button>
+          </div>
+        ))}
+
+        {transitions.map((transition, index) => (
+          <div
+            key={index}
+            className="bg-[rgb(var(--surface-raised)/0.5)] theme-border rounded-lg border p-3 sm:p-4 grid grid-cols-2 gap-3 md:grid-cols-6 md:items-end"
+          >
+            <div>
+              <label className="text-sm font-medium">{t('modeEditor.script.fromLabel')}</label>
+              <select
+                className={inputClassName}
+                value={transition.from}
+                onChange={e => {
+                  updateTransition(index, { from: Number(e.target.value) });
+                }}
+              >
+                {stateOptions}
+              </select>
+            </div>
+            <div>
+              <label className="text-sm font-medium">{t('modeEditor.script.toLabel')}</label>
+              <select
+                className={inputClassName}
+                value={transition.to}
+                onChange={e => {
+                  updateTransition(index, { to: Number(e.target.value) });
+                }}
+              >
+                {stateOptions}
+              </select>
+            </div>
+            <div>
+              <label className="text-sm font-medium">{t('modeEditor.script.onLabel')}</label>
+              <select
+                className={inputClassName}
+                value={transition.on}
+                onChange={e => {
+                  changeEvent(index, e.target.value as ModeTransitionEvent);
+                }}
+              >
+                {modeTransitionEvents.map(event => (
+                  <option key={event} value={event}>
+                    {t(`modeEditor.script.events.${event}`)}
+                  </option>
+                ))}
+              </select>
+            </div>
+            {usesThreshold(transition.on) && (
+              <div>
+                <label className="text-sm font-medium">{t('modeEditor.thresholdLabel')}</label>
+                <input
+                  type="number"
+                  step="1"
+                  min="0"
+                  max="255"
+                  className={inputClassName}
+                  value={transition.threshold ?? 0}
+                  onChange={e => {
+                    const val = parseInt(e.target.value, 10);
+                    updateTransition(index, {
+                      threshold: Number.isNaN(val) ? 0 : Math.min(255, Math.max(0, val)),
+                    });
+                  }}
+                />
+              </div>
+            )}
+            {usesMs(transition.on) && (
+              <div>
+                <label className="text-sm font-medium">{t('modeEditor.script.msLabel')}</label>
+                <input
+                  type="number"
+                  step="10"
+                  min="0"
+                  className={inputClassName}
+                  value={transition.ms ?? 0}
+                  onChange={e => {
+                    const val = parseInt(e.target.value, 10);
+                    updateTransition(index, { ms: Number.isNaN(val) ? 0 : Math.max(0, val) });
+                  }}
+                />
+              </div>
+            )}
+            <button
+              onClick={() => {
+                removeTransition(index);
+              }}
+              className="text-red-500 hover:text-red-700 text-sm min-h-[44px] min-w-[44px] flex items-center justify-center rounded-lg hover:bg-red-500/10 transition-colors"
+            >
+              {t('modeEditor.script.deleteTransition')}
+            </button>
+          </div>
+        ))}
+      </div>
+    </Section>
+  );
+};
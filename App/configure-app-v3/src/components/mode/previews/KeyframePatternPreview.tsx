@@ -0,0 +1,40 @@
+import { useMemo } from 'react';
+
+import { type KeyframePattern } from '../../../app/models/mode';
+
+interface Props {
+  pattern: KeyframePattern;
+  className?: string;
+}
+
+const mixHex = (from: string, to: string, amount: number) => {
+  const channel = (hex: string, offset: number) => parseInt(hex.slice(offset, offset + 2), 16);
+  const mixed = [1, 3, 5].map(offset =>
+    Math.round(channel(from, offset) + (channel(to, offset) - channel(from, offset)) * amount),
+  );
+  return `rgb(${mixed.join(', ')})`;
+};
+
+export const KeyframePatternPreview = ({ pattern, className = '' }: Props) => {
+  const background = useMemo(() => {
+    const sortedChanges = [...pattern.changeAt].sort((a, b) => a.ms - b.ms);
+    const stops = sortedChanges.map(
+      change => `${change.output} ${String((change.ms / pattern.duration) * 100)}%`,
+    );
+
+    // the pattern fades from the last keyframe back into the first one as it loops
+    const first = sortedChanges[0];
+    const last = sortedChanges[sortedChanges.length - 1];
+    const wrapSpan = pattern.duration - last.ms + first.ms;
+    const startColor = mixHex(last.output, first.output, (pattern.duration - last.ms) / wrapSpan);
+    return `linear-gradient(to right, ${startColor} 0%, ${stops.join(', ')}, ${startColor} 100%)`;
+  }, [pattern]);
+
+  return (
+    <div
+      data-testid="keyframe-preview"
+      className={`h-6 sm:h-4 w-full rounded overflow-hidden border theme-border ${className}`}
+      style={{ background }}
+    />
+  );
+};
@@ -1,4 +1,5 @@
 import { EquationPatternPreview } from './EquationPatternPreview';
+import { KeyframePatternPreview } from './KeyframePatternPreview';
 import { SimplePatternPreview } from './SimplePatternPreview';
 import { type ModePattern } from '../../../app/models/mode';
 
@@ -10,11 +11,9 @@ interface Props {
 export const PatternPreview = ({ pattern, className = '' }: Props) => {
   return (
     <div className={className}>
-      {pattern.type === 'simple' ? (
-        <SimplePatternPreview pattern={pattern} />
-      ) : (
-        <EquationPatternPreview pattern={pattern} />
-      )}
+      {pattern.type === 'simple' && <SimplePatternPreview pattern={pattern} />}
+      {pattern.type === 'equation' && <EquationPatternPreview pattern={pattern} />}
+      {pattern.type === 'keyframe' && <KeyframePatternPreview pattern={pattern} />}
     </div>
   );
 };
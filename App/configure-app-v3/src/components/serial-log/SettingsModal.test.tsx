@@ -17,6 +17,8 @@ vi.mock('react-i18next', () => ({
           'Auto off without auto lock',
         'serialLog.configureSettings.options.shutdownPolicy.autoOffAndAutoLock':
           'Auto off and auto lock',
+        'serialLog.configureSettings.labels.modeCrossfadeMs': 'Mode Change Fade (ms)',
+        'serialLog.configureSettings.hints.modeCrossfadeMs': 'Fades from the colors shown.',
       };
 
       if (key in translations) {
@@ -235,4 +237,25 @@ describe('SettingsModal', () => {
     expect(screen.getByLabelText('Enable Charger Serial')).not.toBeChecked();
     expect(screen.getByLabelText('Enable I2c Failure Reporting')).not.toBeChecked();
   });
+
+  it('labels a setting from its translation key and shows its hint', async () => {
+    render(<SettingsModal isOpen={true} onClose={mockOnClose} />);
+
+    act(() => {
+      dataCallback('', {
+        settings: null,
+        defaults: {
+          modeCount: 0,
+          modeCrossfadeMs: 0,
+        },
+      });
+    });
+
+    await waitFor(() => {
+      expect(screen.getByText('Mode Count')).toBeInTheDocument();
+    });
+
+    expect(screen.getByLabelText('Mode Change Fade (ms)')).toHaveValue(0);
+    expect(screen.getByText('Fades from the colors shown.')).toBeInTheDocument();
+  });
 });
@@ -36,6 +36,14 @@ export const SettingsModal = ({ isOpen, onClose }: SettingsModalProps) => {
   const [defaults, setDefaults] = useState<Settings | null>(null);
   const [metadata, setMetadata] = useState<SettingsMetadata>({});
 
+  const getSettingLabel = (settingKey: string) =>
+    t(`serialLog.configureSettings.labels.${settingKey}`, {
+      defaultValue: humanizeCamelCase(settingKey),
+    });
+
+  const getSettingHint = (settingKey: string) =>
+    t(`serialLog.configureSettings.hints.${settingKey}`, { defaultValue: '' });
+
   const getEnumOptionLabel = (settingKey: string, optionKey: string) => {
     const translationKey = `serialLog.configureSettings.options.${settingKey}.${optionKey}`;
     return t(translationKey, { defaultValue: humanizeCamelCase(optionKey) });
@@ -171,15 +179,16 @@ export const SettingsModal = ({ isOpen, onClose }: SettingsModalProps) => {
               const isEnum = !!fieldMetadata;
               const enumOptions = getEnumOptions(key);
               const value = settings[key];
+              const hint = getSettingHint(key);
 
               return (
                 <div key={key}>
-                  {/* TODO: Localize non-enum setting labels and boolean state text once translation keys exist for the rest of the settings schema. */}
+                  {/* TODO: Localize boolean state text once translation keys exist for the rest of the settings schema. */}
                   <label
                     htmlFor={`setting-${key}`}
                     className="block text-sm font-medium theme-muted"
                   >
-                    {humanizeCamelCase(key)}
+                    {getSettingLabel(key)}
                   </label>
                   {isBoolean ? (
                     <div className="mt-1 flex items-center">
@@ -231,6 +240,7 @@ export const SettingsModal = ({ isOpen, onClose }: SettingsModalProps) => {
                       }}
                     />
                   )}
+                  {hint && <p className="mt-1 text-xs theme-muted">{hint}</p>}
                   <p className="mt-1 text-xs theme-muted">
                     Default: {getDisplayValue(key, defaults[key])}
                   </p>
@@ -10,4 +10,10 @@
 void writeStringToFlash(uint32_t page, const char str[], size_t length);
 void readStringFromFlash(uint32_t page, char buffer[], size_t length);
 
+// Raw access for logs that append into erased flash. offset counts from the start of page and
+// may run into the following pages, writes must be whole 8 byte double words.
+void eraseFlashPage(uint32_t page);
+void writeBytesToFlash(uint32_t page, uint32_t offset, const uint8_t data[], size_t length);
+void readBytesFromFlash(uint32_t page, uint32_t offset, uint8_t buffer[], size_t length);
+
 #endif /* INC_FLASH_STRING_H_ */
@@ -19,24 +19,35 @@ void readSettingsFromFlash(char buffer[], size_t length);
 void writeModeToFlash(uint8_t mode, const char str[], size_t length);
 void readModeFromFlash(uint8_t mode, char buffer[], size_t length);
 
-bool i2cWriteRegister(uint8_t devAddress, uint8_t reg, uint8_t value);
-bool i2cReadRegisters(uint8_t devAddress, uint8_t startReg, uint8_t *buf, size_t len);
+void eraseTelemetryPage(uint8_t page);
+void writeTelemetryToFlash(uint32_t offset, const uint8_t data[], size_t length);
+void readTelemetryFromFlash(uint32_t offset, uint8_t buffer[], size_t length);
+
+bool i2cStartWrite(uint8_t devAddress, uint8_t startReg, const uint8_t *data, size_t len);
+bool i2cStartRead(uint8_t devAddress, uint8_t startReg, uint8_t *buf, size_t len);
+void i2cAbort(void);
+uint32_t i2cMilliseconds(void);
 
 uint8_t readButtonPin(void);
 void writeRgbPwmCaseLed(uint16_t redDuty, uint16_t greenDuty, uint16_t blueDuty);
 void writeRgbPwmFrontLed(uint16_t redDuty, uint16_t greenDuty, uint16_t blueDuty);
+void enableCaseLedDither(bool enable);
+void enableFrontLedDither(bool enable);
 void writeBulbLed(uint8_t state);
 
 void enableChipTickTimer(bool enable);
 void enableCaseLedTimer(bool enable);
 void enableFrontLedTimer(bool enable);
 void enableUsbClock(bool enable);
+void enableLowPowerClock(bool enable);
 void enableAutoOffTimer(bool enable);
 uint32_t convertTicksToMilliseconds(uint32_t ticks);
 
 void enterStandbyMode(void);
 void enterStopModeWithRtcAlarm(uint16_t wakeIntervalSeconds);
 bool waitForButtonWakeOrAutoLock(uint16_t lockThresholdMinutes);
+uint32_t enterStopModeForMilliseconds(uint32_t milliseconds);
+uint32_t rtcMilliseconds(void);
 
 __attribute__((noreturn)) void blinkCaseLedWhiteForever(void);
 
@@ -13,11 +13,13 @@
 
 #include "microlight/device/bq25180.h"
 #include "microlight/device/button.h"
+#include "microlight/device/i2c_queue.h"
 #include "microlight/device/mc3479.h"
 #include "microlight/device/rgb_led.h"
 #include "microlight/json/command_parser.h"
 #include "microlight/mode_manager.h"
 #include "microlight/model/log.h"
+#include "microlight/model/telemetry.h"
 #include "microlight/settings_manager.h"
 
 typedef struct {
@@ -30,6 +32,10 @@ typedef struct {
     RGBLed *frontLed;
     BQ25180 *chargerIC;
     MC3479 *accel;
+    // shared by the charger and accelerometer, flushed before the MCU powers down
+    I2CQueue *i2c;
+    // charge, fault, mode and power events, flushed before the MCU powers down
+    Telemetry *telemetry;
 
     // Callbacks
     void (*enableChipTickTimer)(bool enable);
@@ -37,6 +43,9 @@ typedef struct {
     void (*enableFrontLedTimer)(bool enable);
     void (*enableAutoOffTimer)(bool enable);
     void (*enableUsbClock)(bool enable);
+    // Drops SYSCLK below 12 MHz. Only requested while no PWM timer runs, since the PWM frequency
+    // cannot be held there. USB takes precedence while enabled.
+    void (*enableLowPowerClock)(bool enable);
     void (*enterStandbyMode)(void);
     bool (*waitForButtonWakeOrAutoLock)(uint16_t lockThresholdMinutes);
     void (*systemReset)(void);
@@ -48,12 +57,16 @@ typedef struct {
 
     // State
     uint32_t ticksSinceLastUserActivity;  // auto off timer ticks at 0.1 hz
+    uint32_t lastTaskMs;
+    // last state recorded to telemetry
+    enum ChargeState lastChargeState;
 
     // Cached timer states to avoid redundant HAL calls
     bool lastChipTickEnabled;
     bool lastCasePwmEnabled;
     bool lastFrontPwmEnabled;
     bool lastUsbClockEnabled;
+    bool lastLowPowerClockEnabled;
 } ChipState;
 
 bool configureChipState(ChipState *state, ChipDependencies deps);
@@ -66,4 +79,18 @@ typedef struct StateTaskFlags {
 
 void stateTask(ChipState *state, uint32_t milliseconds, StateTaskFlags flags);
 
+// Stop mode halts every timer, only worth entering for idle stretches longer than the wake up and
+// clock restore cost. Plug and charge changes wake the chip through the charger interrupt, the
+// charger's own periodic read bounds the budget below STOP_IDLE_MAX_MS.
+#define STOP_IDLE_MIN_MS 10
+#define STOP_IDLE_MAX_MS 30000
+
+/**
+ * Returns how long the chip may sit in Stop mode after stateTask, 0 when it must keep ticking.
+ * Stop mode is only allowed while no PWM timer or USB clock is needed, no button indicator is
+ * shown, and neither the current mode, the charger nor a held button has work due within
+ * STOP_IDLE_MIN_MS. With the chip tick off a held button is the only deadline.
+ */
+uint32_t stateIdleBudgetMs(ChipState *state);
+
 #endif /* INC_CHIP_STATE_H_ */
@@ -10,7 +10,7 @@
 
 #include <stdbool.h>
 #include <stdint.h>
-#include "microlight/device/i2c.h"
+#include "microlight/device/i2c_queue.h"
 #include "microlight/device/rgb_led.h"
 #include "microlight/model/log.h"
 
@@ -50,18 +50,50 @@
 #define BQ25180_WATCHDOG_160S_HW_RESET 0b00000001
 #define BQ25180_WATCHDOG_DISABLED 0b00000011
 
+#define BQ25180_REGISTER_COUNT 13
+// well inside the 160 s host watchdog
+#define BQ25180_REFRESH_MS 30000
+#define BQ25180_STATE_RETRY_MS 1000
+// STAT0, STAT1 and FLAG0, read together so fault flags are caught on every status read
+#define BQ25180_STATUS_READ_LENGTH 3
+
 enum ChargeState { notConnected, notCharging, constantCurrent, constantVoltage, done };
 
+typedef struct ChargerTaskFlags {
+    bool interruptTriggered;
+    bool unplugLockEnabled;
+    bool chargeLedEnabled;
+    bool serialEnabled;
+} ChargerTaskFlags;
+
 typedef struct BQ25180 {
-    I2CReadRegisters readRegisters;
-    I2CWriteRegister writeRegister;
+    I2CQueue *i2c;
     Log log;
     uint8_t devAddress;
     RGBLed *caseLed;
 
     enum ChargeState chargingState;
-    uint32_t chargeStateCachedAtMs;
     uint32_t registersReadAtMs;
+
+    // Last known register contents, one bit per register in `shadowKnown`. Configuration writes
+    // that match the shadow are skipped and the rest are staged in `shadowDirty` until they go out
+    // as bursts. Status registers are only trusted until the next charger interrupt.
+    uint8_t shadow[BQ25180_REGISTER_COUNT];
+    uint16_t shadowKnown;
+    uint16_t shadowDirty;
+
+    // Reads go through the shared I2CQueue and complete on a later main loop pass
+    uint8_t stateReadsPending;
+    uint32_t stateRequestedAtMs;
+    // an interrupt is handled once the STAT0 read it queued completes
+    bool interruptPending;
+    uint32_t interruptAtMs;
+    enum ChargeState stateBeforeInterrupt;
+    ChargerTaskFlags interruptFlags;
+    // FLAG0 clears on read, every flag seen is kept here until bq25180TakeFaults
+    uint8_t faultFlags;
+    uint8_t registerDump[BQ25180_REGISTER_COUNT];
+    bool registerDumpPending;
 } BQ25180;
 
 typedef struct BQ25180Registers {
@@ -80,27 +112,22 @@ typedef struct BQ25180Registers {
     uint8_t mask_id;
 } BQ25180Registers;
 
-typedef struct ChargerTaskFlags {
-    bool interruptTriggered;
-    bool unplugLockEnabled;
-    bool chargeLedEnabled;
-    bool serialEnabled;
-} ChargerTaskFlags;
-
-bool bq25180Init(
-    BQ25180 *chargerIC,
-    I2CReadRegisters readRegisters,
-    I2CWriteRegister writeRegister,
-    uint8_t devAddress,
-    Log log,
-    RGBLed *caseLed);
+// Reads every register into the shadow, configures the charger and waits for both, the only time
+// the driver blocks outside of lock.
+bool bq25180Init(BQ25180 *chargerIC, I2CQueue *i2c, uint8_t devAddress, Log log, RGBLed *caseLed);
 
 void chargerTask(BQ25180 *chargerIC, uint32_t milliseconds, ChargerTaskFlags flags);
+// Queued like every other write, flush the I2C queue before sleeping. Interrupts go unhandled
+// while asleep, so the status shadow is dropped too.
 void disableWatchdog(BQ25180 *chargerIC);
+// Ship mode when unplugged, hardware reset otherwise. Waits for the bus, power goes away next.
 void lock(BQ25180 *chargerIC);
-enum ChargeState getChargingState(BQ25180 *chargerIC, uint32_t milliseconds);
-
-// TODO: Handle interrupts from bq25180 and check status/fault registers
-//       - send errors over usb to app
+// Returns the cached state, never touches the bus. chargerTask refreshes it after every charger
+// interrupt and on the periodic watchdog read, a failed refresh is retried once a second.
+enum ChargeState getChargingState(const BQ25180 *chargerIC);
+// How long chargerTask can go without running before it has a read to start, UINT32_MAX if none.
+uint32_t bq25180MsUntilNextRead(const BQ25180 *chargerIC, uint32_t milliseconds);
+// Returns the FLAG0 bits latched since the last call and clears them.
+uint8_t bq25180TakeFaults(BQ25180 *chargerIC);
 
 #endif /* INC_DEVICE_BQ25180_H_ */
@@ -11,13 +11,29 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+// Edges the interrupt can capture before buttonInputTask drains them, contact bounce included.
+#define BUTTON_EDGE_QUEUE_LENGTH 8
+
+typedef struct ButtonEdge {
+    uint32_t milliseconds;
+    bool pressed;
+} ButtonEdge;
+
 typedef struct Button {
     uint8_t (*readButtonPin)();
+    // Timestamps the edges, has to keep counting while the MCU is in Stop mode.
+    uint32_t (*milliseconds)(void);
+
+    // Written by buttonEdgeInterrupt, drained by buttonInputTask.
+    ButtonEdge edges[BUTTON_EDGE_QUEUE_LENGTH];
+    volatile uint8_t edgeHead;
+    volatile uint8_t edgeTail;
 
-    uint32_t evalStartMs;
+    bool evaluating;
+    uint32_t pressMs;
 } Button;
 
-bool buttonInit(Button *button, uint8_t (*readButtonPin)());
+bool buttonInit(Button *button, uint8_t (*readButtonPin)(), uint32_t (*milliseconds)(void));
 
 enum ButtonResult {
     ignore,
@@ -29,7 +45,11 @@ enum ButtonResult {
                           // plugged in.
 };
 
-enum ButtonResult buttonInputTask(Button *button, uint32_t milliseconds, bool interruptTriggered);
+// Call from the button EXTI interrupt on both edges, timestamps the edge and the pin level.
+void buttonEdgeInterrupt(Button *button);
+enum ButtonResult buttonInputTask(Button *button);
 bool isEvaluatingButtonPress(Button *button);
+// Time until a held press crosses the next hold threshold, UINT32_MAX when there is none.
+uint32_t buttonMsUntilNextResult(Button *button);
 
 #endif /* INC_DEVICE_BUTTON_H_ */
@@ -12,14 +12,16 @@
 #include <stddef.h>
 #include <stdint.h>
 
-// write to single register.
-typedef void (*I2CWriteRegister)(uint8_t devAddress, uint8_t reg, uint8_t value);
+// Start reading multiple consecutive registers without waiting for the bus. `buffer` must stay
+// valid until the transfer completes. Returns false if the transfer could not be started.
+typedef bool (*I2CStartRead)(uint8_t devAddress, uint8_t startReg, uint8_t *buffer, size_t length);
 
-// write to single register. Returns true on success.
-typedef bool (*I2CWriteRegisterChecked)(uint8_t devAddress, uint8_t reg, uint8_t value);
+// Start writing consecutive registers without waiting for the bus. `data` must stay valid until
+// the transfer completes. Returns false if the transfer could not be started.
+typedef bool (*I2CStartWrite)(
+    uint8_t devAddress, uint8_t startReg, const uint8_t *data, size_t length);
 
-// Read multiple consecutive registers. Returns true on success.
-typedef bool (*I2CReadRegisters)(
-    uint8_t devAddress, uint8_t startReg, uint8_t *buffer, size_t length);
+// Result of a queued transaction, called from the main loop, never from the interrupt.
+typedef void (*I2CCompletion)(void *context, bool ok);
 
 #endif /* INC_DEVICE_I2C_H_ */
@@ -0,0 +1,116 @@
+/*
+ * i2c_queue.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#ifndef INC_DEVICE_I2C_QUEUE_H_
+#define INC_DEVICE_I2C_QUEUE_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "microlight/device/i2c.h"
+
+#define I2C_QUEUE_LENGTH 8
+// a full accelerometer FIFO burst is ~18 ms at 100 kHz, anything much longer is a stuck bus
+#define I2C_QUEUE_TIMEOUT_MS 50
+
+typedef struct {
+    uint8_t devAddress;
+    uint8_t reg;
+    bool isRead;
+    // a single written byte lives in the queue, so callers can write and forget
+    uint8_t value;
+    // burst writes send from here instead of `value`
+    const uint8_t *data;
+    uint8_t *buffer;
+    size_t length;
+    I2CCompletion onComplete;
+    void *context;
+} I2CTransaction;
+
+/**
+ * Runs one I2C transaction at a time in the background, in submission order. Transfers are started
+ * by the I2CStart* dependencies, which return immediately. Their completion interrupt reports back
+ * through i2cQueueComplete and i2cQueueTask delivers the result to the submitter from the main
+ * loop, so no driver code runs in interrupt context and nothing waits on the bus.
+ */
+typedef struct I2CQueue {
+    I2CStartRead startRead;
+    I2CStartWrite startWrite;
+    // resets the peripheral after a transfer timed out
+    void (*abort)(void);
+    // free running, keeps counting while the chip tick is off
+    uint32_t (*milliseconds)(void);
+    // optional, told about every failed transaction
+    void (*onFailure)(const I2CTransaction *transaction);
+
+    I2CTransaction transactions[I2C_QUEUE_LENGTH];
+    uint8_t head;
+    uint8_t count;
+    bool inFlight;
+    uint32_t startedAtMs;
+    // written from the completion interrupt
+    volatile bool completed;
+    volatile bool completedOk;
+} I2CQueue;
+
+bool i2cQueueInit(
+    I2CQueue *queue,
+    I2CStartRead startRead,
+    I2CStartWrite startWrite,
+    void (*abort)(void),
+    uint32_t (*milliseconds)(void),
+    void (*onFailure)(const I2CTransaction *transaction));
+
+/**
+ * Queues a read of `length` consecutive registers into `buffer`, which must stay valid until
+ * `onComplete` (optional) runs. If the queue is full this waits for a slot, which only happens
+ * when more is submitted in one pass than I2C_QUEUE_LENGTH, e.g. while configuring at boot.
+ */
+bool i2cQueueRead(
+    I2CQueue *queue,
+    uint8_t devAddress,
+    uint8_t startReg,
+    uint8_t *buffer,
+    size_t length,
+    I2CCompletion onComplete,
+    void *context);
+
+// Queues a single register write, `onComplete` is optional. Waits for a slot like i2cQueueRead.
+bool i2cQueueWrite(
+    I2CQueue *queue,
+    uint8_t devAddress,
+    uint8_t reg,
+    uint8_t value,
+    I2CCompletion onComplete,
+    void *context);
+
+/**
+ * Queues a write of `length` consecutive registers from `data`, which must stay valid until
+ * `onComplete` (optional) runs. Waits for a slot like i2cQueueRead.
+ */
+bool i2cQueueWriteBurst(
+    I2CQueue *queue,
+    uint8_t devAddress,
+    uint8_t startReg,
+    const uint8_t *data,
+    size_t length,
+    I2CCompletion onComplete,
+    void *context);
+
+// Called from the transfer complete or error interrupt.
+void i2cQueueComplete(I2CQueue *queue, bool ok);
+
+// Delivers finished transactions and starts the next one, call every main loop pass.
+void i2cQueueTask(I2CQueue *queue);
+
+bool i2cQueueIdle(const I2CQueue *queue);
+
+// Blocks until everything queued has completed or timed out. Only for the moments before the MCU
+// or the charger powers down, when queued writes must reach the bus.
+void i2cQueueFlush(I2CQueue *queue);
+
+#endif /* INC_DEVICE_I2C_QUEUE_H_ */
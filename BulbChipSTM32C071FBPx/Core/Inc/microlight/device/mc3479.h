@@ -3,8 +3,11 @@
  *
  * Abstraction for the MC3479 I2C accelerometer.
  *
- * Provides a simple interface to enable/disable periodic sampling
- * and to read the most recent absolute acceleration magnitude in units of g.
+ * Provides a simple interface to enable/disable sampling and to check the
+ * jerk seen since the last read against a threshold. The sensor samples into
+ * its FIFO on its own, the driver drains the whole FIFO in one burst read.
+ * All bus traffic goes through the shared I2CQueue, a drain spans a few
+ * main loop passes and never waits on the bus.
  */
 
 #ifndef INC_DEVICE_MC3479_H_
@@ -13,7 +16,8 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
-#include "microlight/device/i2c.h"
+#include "microlight/device/i2c_queue.h"
+#include "microlight/model/jerk_filter.h"
 #include "microlight/model/log.h"
 
 #define MC3479_I2CADDR_DEFAULT 0x99  // 8-bit address
@@ -21,8 +25,30 @@
 // Register map used by this driver (defaults - consult datasheet)
 #define MC3479_REG_STATUS 0x05
 #define MC3479_REG_CTRL1 0x07
-#define MC3479_REG_CTRL2 0x08
+#define MC3479_REG_CTRL2 0x08  // sample rate
+#define MC3479_REG_FIFO_RD_P 0x0B
+#define MC3479_REG_FIFO_WR_P 0x0C
 #define MC3479_REG_RANGE 0x20
+#define MC3479_REG_FIFO_CTRL 0x2D
+#define MC3479_REG_FIFO_CTRL2 0x30
+
+#define MC3479_FIFO_CTRL_ENABLE 0x40
+#define MC3479_FIFO_CTRL_WATERMARK_MODE 0x20
+#define MC3479_FIFO_CTRL_THRESHOLD_MASK 0x1F
+#define MC3479_FIFO_CTRL2_RESET 0x40
+// XOUT_L..ZOUT_H reads wrap around and pop the next FIFO sample
+#define MC3479_FIFO_CTRL2_BURST 0x20
+// read and write pointers carry a wrap bit above the 5 bit index
+#define MC3479_FIFO_POINTER_MASK 0x3F
+
+#define MC3479_FIFO_DEPTH 32
+#define MC3479_SAMPLE_RATE_100HZ 0x11
+#define MC3479_SAMPLE_PERIOD_MS 10
+// No INT line is routed to the MCU, so the FIFO is drained on a timer once this many samples are
+// expected. 10 ms samples are seen through one I2C burst every 80 ms, instead of one sample per
+// 50 ms poll.
+#define MC3479_FIFO_WATERMARK 8
+#define MC3479_FIFO_DRAIN_MS (MC3479_FIFO_WATERMARK * MC3479_SAMPLE_PERIOD_MS)
 
 // Axis output registers
 #define MC3479_REG_XOUT_L 0x0D
@@ -35,44 +61,51 @@
 typedef struct MC3479 MC3479;  // forward declaration
 
 struct MC3479 {
-    I2CReadRegisters readRegisters;
-    I2CWriteRegister writeRegister;
+    I2CQueue *i2c;
 
     uint8_t devAddress;
 
-    // Current calculated jerk magnitude (absolute) squared
+    // Largest filtered jerk magnitude squared seen during the last drain, in raw units per sample
+    // period, and that period
     uint64_t currentJerkSquaredSum;
     uint32_t lastDtMs;
 
     bool enabled;
+    // when the last drain was started
     uint32_t lastSampleMs;
 
-    // Cached last acceleration values (raw)
-    int16_t lastRawX;
-    int16_t lastRawY;
-    int16_t lastRawZ;
+    // A drain is two queued reads, the FIFO pointers and then the samples
+    bool drainPending;
+    // enable or disable happened mid drain, its samples belong to the old session
+    bool discardDrain;
+    uint8_t fifoPointers[2];
+
+    // Runs across drains, so jerk is continuous from one burst to the next
+    JerkFilter jerkFilter;
 };
 
-bool mc3479Init(
-    MC3479 *dev,
-    I2CReadRegisters readRegisters,
-    I2CWriteRegister writeRegister,
-    uint8_t devAddress);
+bool mc3479Init(MC3479 *dev, I2CQueue *i2c, uint8_t devAddress);
 
 void mc3479Enable(MC3479 *dev);
 void mc3479Disable(MC3479 *dev);
 
-// Polling task: call periodically from the main loop. When enabled and the
-// loop interval has elapsed this will read the three axis values, compute
-// magnitude and update `currentMagnitudeG`.
+// Polling task: call periodically from the main loop. When enabled and
+// MC3479_FIFO_DRAIN_MS has elapsed this starts a drain, see mc3479StartDrain.
 void mc3479Task(MC3479 *dev, uint32_t milliseconds);
 
-// Force an immediate sample and magnitude calculation. Returns true on success,
-// false if a sample couldn't be taken (e.g. missing read callback).
-// The caller must provide the current ms value (same units as used by
-// mc3479Task). Jerk is computed as change-in-acceleration divided by
-// delta-ms, and therefore its units are g per ms (g/ms).
-bool mc3479SampleNow(MC3479 *dev, uint32_t milliseconds);
+// Queue a read of every sample buffered in the FIFO in one burst. Once it
+// completes each sample runs through the jerk filter and the largest output
+// is kept, so short impacts between drains are not missed. A failed drain
+// leaves the previous value in place. Returns false if disabled or a drain
+// is already in flight.
+// Samples are MC3479_SAMPLE_PERIOD_MS apart, jerk is change-in-acceleration
+// divided by that period.
+bool mc3479StartDrain(MC3479 *dev, uint32_t milliseconds);
+
+// Milliseconds until mc3479Task drains again, 0 when due and UINT32_MAX while
+// disabled. The FIFO fills while the MCU sleeps, so sleeping this long loses
+// no samples.
+uint32_t mc3479MsUntilNextDrain(const MC3479 *dev, uint32_t milliseconds);
 
 bool isOverThreshold(MC3479 *dev, uint8_t threshold);
 
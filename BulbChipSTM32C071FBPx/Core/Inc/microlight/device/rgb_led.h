@@ -12,6 +12,8 @@
 #include <stdint.h>
 
 typedef void (*RGBWritePwm)(uint16_t redDuty, uint16_t greenDuty, uint16_t blueDuty);
+// Turns the PWM timer's update interrupt on or off, the interrupt calls rgbDitherUpdate.
+typedef void (*RGBEnableDither)(bool enable);
 
 typedef struct RGBWhiteBalance {
     uint8_t red;
@@ -19,23 +21,80 @@ typedef struct RGBWhiteBalance {
     uint8_t blue;
 } RGBWhiteBalance;
 
+#define RGB_CHANNEL_COUNT 3
+// Duty is kept to 1/16 of a PWM step, dithering spreads it over 16 timer periods.
+#define RGB_DITHER_BITS 4
+// Dither only below this many whole duty steps, one step above it is too small a change to see.
+#define RGB_DITHER_MAX_DUTY 64
+
+// Sources that want the LED, the lowest active layer is the one shown. Each layer keeps its own
+// color so a source can update underneath another without the two fighting over the PWM.
+typedef enum RGBLayer {
+    // shutdown and lock indicators while the button is held past a threshold
+    RGB_LAYER_INDICATOR,
+    // click and charging feedback, drops back out after RGB_STATUS_MS
+    RGB_LAYER_STATUS,
+    // the current mode, shown whenever nothing above it is
+    RGB_LAYER_USER,
+    RGB_LAYER_COUNT,
+} RGBLayer;
+
+#define RGB_STATUS_MS 300
+
+typedef struct RGBLayerColor {
+    bool active;
+    // unbalanced colors skip white balance, the lock indicator has to show on bulb chips too
+    bool balanced;
+    uint8_t red;
+    uint8_t green;
+    uint8_t blue;
+} RGBLayerColor;
+
 typedef struct RGBLed {
     RGBWritePwm writePwm;
     uint16_t period;  // TODO: set period from config?
     RGBWhiteBalance whiteBalance;
+    // linear 0-255 channel value to timer duty with gamma and white balance folded in, rebuilt
+    // whenever the white balance changes. Fixed point with fractionBits below one PWM step.
+    uint16_t dutyTable[RGB_CHANNEL_COUNT][256];
+    uint8_t fractionBits;
+    // duty last handed to writePwm, unchanged colors skip the write
+    uint16_t lastDuty[RGB_CHANNEL_COUNT];
+    bool dutyWritten;
+
+    // optional, without it fractional duties round to the nearest step
+    RGBEnableDither enableDither;
+    volatile bool dithering;
+    volatile uint16_t ditherTarget[RGB_CHANNEL_COUNT];
+    uint16_t ditherError[RGB_CHANNEL_COUNT];
 
     uint32_t ms;
-    uint32_t msOfColorChange;
-    bool showingTransientStatus;
-    uint8_t userRed;
-    uint8_t userGreen;
-    uint8_t userBlue;
+    uint32_t msOfStatusChange;
+    RGBLayerColor layers[RGB_LAYER_COUNT];
+    // what rgbCompose last drove, a frame that resolves to the same color skips the duty lookup
+    RGBLayerColor shown;
 } RGBLed;
 
+// period is the timer ARR, full scale drives a duty of period + 1 so it must stay below 0xFFFF.
 bool rgbInit(RGBLed *device, RGBWritePwm writePwm, uint16_t period);
 void rgbSetWhiteBalance(RGBLed *device, RGBWhiteBalance whiteBalance);
+void rgbSetDitherControl(RGBLed *device, RGBEnableDither enableDither);
+// Called from the PWM timer update interrupt while dim colors are being dithered.
+void rgbDitherUpdate(RGBLed *device);
+// Linear 0-255 channel to the gamma corrected, white balanced 0-255 value that PWM duty follows.
+uint8_t gammaAndWhiteBalancedColor(uint8_t value, uint8_t whiteBalance);
 
-void rgbTransientTask(RGBLed *device, uint32_t milliseconds);
+/**
+ * Drops an expired status and drives the highest active layer, once per tick after every source
+ * has had its say. The layer setters below only record colors, nothing reaches the PWM before
+ * this runs.
+ */
+void rgbCompose(RGBLed *device, uint32_t milliseconds);
+void rgbClearLayer(RGBLed *device, RGBLayer layer);
+bool rgbLayerActive(const RGBLed *device, RGBLayer layer);
+// Whether a layer above `layer` is what the rgbCompose at `milliseconds` will show, a status that
+// has run out by then does not count.
+bool rgbLayerCovered(const RGBLed *device, RGBLayer layer, uint32_t milliseconds);
 void rgbShowUserColor(RGBLed *device, uint8_t red, uint8_t green, uint8_t blue);
 void rgbShowSuccess(RGBLed *device);
 void rgbShowLocked(RGBLed *device);
@@ -9,40 +9,16 @@
 #define INC_I2C_LOG_DECORATE_H_
 
 #include <stdbool.h>
-#include "microlight/device/i2c.h"
+#include "microlight/device/i2c_queue.h"
 #include "microlight/model/log.h"
 
 /**
- * @brief Stateless helper that executes a write transaction checking for errors and logging them.
+ * @brief Stateless helper that logs a failed queued transaction, see I2CQueue.onFailure.
  *
- * @param devAddress I2C device address
- * @param reg Register to write to
- * @param value Value to write
- * @param rawFunc The underlying I2C function to call
+ * @param transaction The transaction that failed or timed out
  * @param enableFlag Pointer to the boolean flag determining if logging is active
  * @param log The logging function to use (e.g. Log)
  */
-void i2cDecoratedWrite(
-    uint8_t devAddress,
-    uint8_t reg,
-    uint8_t value,
-    I2CWriteRegisterChecked rawFunc,
-    const bool *enableFlag,
-    Log log);
-
-/**
- * @brief Stateless helper that executes a multi-byte read transaction checking for errors and
- * logging them.
- *
- * @return true if successful, false otherwise
- */
-bool i2cDecoratedReadRegisters(
-    uint8_t devAddress,
-    uint8_t startReg,
-    uint8_t *buf,
-    size_t len,
-    I2CReadRegisters rawFunc,
-    const bool *enableFlag,
-    Log log);
+void i2cLogFailure(const I2CTransaction *transaction, const bool *enableFlag, Log log);
 
 #endif /* INC_I2C_LOG_DECORATE_H_ */
@@ -40,6 +40,10 @@
  *   "caseWhiteBalanceRed": 195,
  *   "caseWhiteBalanceGreen": 255,
  *   "caseWhiteBalanceBlue": 255,
+ *   "frontRedCurrentMa": 20,
+ *   "caseRedCurrentMa": 5,
+ *   "bulbCurrentMa": 20,
+ *   "modeCrossfadeMs": 200,
  *   "shutdownPolicy": 2
  * }
  *
@@ -52,6 +56,26 @@
  * {
  *   "command": "dfu"
  * }
+ *
+ * Estimate Power:
+ * {
+ *   "command": "estimatePower",
+ *   "index": 0
+ * }
+ * Response, also appended to readMode responses:
+ * {"powerEstimate":{"averageMicroamps":9080,"frontMicroamps":7000,"caseMicroamps":1500,
+ *   "mcuMicroamps":580,"awakePermille":350,"awakeMeasured":true,"exact":true}}
+ * awakeMeasured is false unless index is the running mode, the MCU is then assumed always awake.
+ *
+ * Read Telemetry:
+ * {
+ *   "command": "readTelemetry",
+ *   "first": 0 // optional, index of the oldest record wanted
+ * }
+ * Response, up to USB_TELEMETRY_JSON_RECORDS records per line, ask again from first + records
+ * until first reaches total:
+ * {"telemetry":{"total":510,"first":0,"records":"0402000010270000..."}}
+ * records holds the stored records as hex, see telemetry.h for the layout.
  */
 
 #include <stddef.h>
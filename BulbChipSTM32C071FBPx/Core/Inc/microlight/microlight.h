@@ -7,33 +7,48 @@
 #include "microlight/chip_state.h"
 #include "microlight/device/bq25180.h"
 #include "microlight/device/button.h"
-#include "microlight/device/i2c.h"
+#include "microlight/device/i2c_queue.h"
 #include "microlight/device/mc3479.h"
 #include "microlight/device/rgb_led.h"
 #include "microlight/mode_manager.h"
+#include "microlight/model/monotonic_clock.h"
 #include "microlight/model/storage.h"
+#include "microlight/model/telemetry.h"
 #include "microlight/model/usb.h"
 #include "microlight/settings_manager.h"
 #include "microlight/usb_manager.h"
 
 typedef struct {
     // Hardware I/O
-    I2CWriteRegisterChecked i2cWriteRegister;
-    I2CReadRegisters i2cReadRegisters;
+    I2CStartRead i2cStartRead;
+    I2CStartWrite i2cStartWrite;
+    // resets the I2C peripheral after a transfer timed out
+    void (*i2cAbort)(void);
+    // free running millisecond clock for I2C timeouts, keeps counting while the chip tick is off
+    uint32_t (*i2cMilliseconds)(void);
     RGBWritePwm writeRgbPwmCaseLed;
     RGBWritePwm writeRgbPwmFrontLed;
+    // optional, update interrupts of the LED timers for dithering dim colors
+    RGBEnableDither enableCaseLedDither;
+    RGBEnableDither enableFrontLedDither;
     void (*writeBulbLed)(uint8_t state);
     uint8_t (*readButtonPin)(void);
+    // timestamps button edges from the interrupt, keeps counting in Stop mode
+    uint32_t (*buttonMilliseconds)(void);
 
     // USB
     UsbReadTask usbReadTask;
     UsbWrite usbWrite;
+    UsbTxFree usbTxFree;
 
     // Storage
     ReadSavedSettings readSavedSettings;
     SaveSettings saveSettings;
     ReadSavedMode readSavedMode;
     SaveMode saveMode;
+    EraseTelemetryPage eraseTelemetryPage;
+    WriteTelemetry writeTelemetry;
+    ReadTelemetry readTelemetry;
 
     // System
     void (*enableChipTickTimer)(bool enable);
@@ -41,11 +56,16 @@ typedef struct {
     void (*enableFrontLedTimer)(bool enable);
     void (*enableAutoOffTimer)(bool enable);
     void (*enableUsbClock)(bool enable);
+    void (*enableLowPowerClock)(bool enable);
     void (*enterStandbyMode)(void);
     bool (*waitForButtonWakeOrAutoLock)(uint16_t lockThresholdMinutes);
+    // Stop mode until the deadline or an interrupt, returns the milliseconds actually slept
+    uint32_t (*enterStopModeForMilliseconds)(uint32_t milliseconds);
     void (*systemReset)(void);
     void (*enterDFU)(void);
     uint32_t (*convertTicksToMilliseconds)(uint32_t ticks);
+    // keeps counting in Stop mode and while the chip tick is off, the time base of every task
+    uint32_t (*rtcMilliseconds)(void);
     uint32_t rgbTimerPeriod;
 
     // Memory
@@ -57,7 +77,11 @@ enum MicroLightInterrupt {
     ButtonInterrupt,
     ChargerInterrupt,
     ChipTickInterrupt,
-    AutoOffTimerInterrupt
+    AutoOffTimerInterrupt,
+    I2CCompleteInterrupt,
+    I2CErrorInterrupt,
+    CaseLedPwmUpdateInterrupt,
+    FrontLedPwmUpdateInterrupt
 };
 
 bool configureMicroLight(MicroLightDependencies *deps);
@@ -13,12 +13,34 @@
 #include "device/mc3479.h"
 #include "device/rgb_led.h"
 #include "model/cli_model.h"
+#include "model/live_stream.h"
 #include "model/log.h"
 #include "model/mode_state.h"
 #include "model/storage.h"
 
 #define FAKE_OFF_MODE_INDEX 255
 
+/**
+ * Fade from a snapshot, not a crossfade of two running modes. The colors shown when the mode
+ * switched are frozen and blended into the live output of the new mode, the outgoing mode stops
+ * animating at the switch. Keeping both ModeStates running would double the mode RAM and the
+ * tinyexpr work. Bulb outputs switch at once.
+ */
+typedef struct ModeCrossfade {
+    bool active;
+    uint32_t startMs;
+    uint32_t elapsedMs;
+    uint16_t durationMs;
+    RGBSimpleOutput front;
+    RGBSimpleOutput caseColor;
+} ModeCrossfade;
+
+typedef struct ModeOutputs {
+    bool frontValid;
+    bool caseValid;
+    SimpleOutputType frontType;
+} ModeOutputs;
+
 // TODO: split deps into separate struct like chipState?
 typedef struct ModeManager {
     Mode currentMode;  // if running out of memory, consider using a pointer here that shares
@@ -32,14 +54,23 @@ typedef struct ModeManager {
     Log log;
     ModeState modeState;
     bool shouldResetState;
+    LiveStream liveStream;
+    // since the current mode (re)started, for its measured awake fraction
+    uint32_t modeStartedMs;
+    uint32_t modeSleptMs;
+    // length of the fade from the shown colors started by the next mode switch, 0 switches at once
+    uint16_t crossfadeMs;
+    ModeCrossfade crossfade;
+    // last colors written to the LEDs, where a crossfade starts from
+    RGBSimpleOutput shownFront;
+    RGBSimpleOutput shownCase;
+    // what the LEDs last reported, repeated while another layer covers the mode's colors
+    ModeOutputs lastOutputs;
+    // button and charger events of the mode script, fed in by the caller like the accel readings
+    bool buttonTapped;
+    bool charging;
 } ModeManager;
 
-typedef struct ModeOutputs {
-    bool frontValid;
-    bool caseValid;
-    SimpleOutputType frontType;
-} ModeOutputs;
-
 bool modeManagerInit(
     ModeManager *manager,
     MC3479 *accel,
@@ -53,11 +84,34 @@ void loadMode(ModeManager *manager, uint8_t index);
 
 void fakeOffMode(ModeManager *manager);
 bool isFakeOff(ModeManager *manager);
-ModeOutputs modeTask(
-    ModeManager *manager,
-    uint32_t milliseconds,
-    bool canUpdateFrontLed,
-    bool canUpdateCaseLed,
-    uint8_t equationEvalIntervalMs);
+
+// While a live stream is active, modeTask plays the host's frames instead of the current mode.
+void startLiveStream(
+    ModeManager *manager, uint8_t frameIntervalMs, uint8_t prefillFrames, uint32_t milliseconds);
+void stopLiveStream(ModeManager *manager);
+
+// Milliseconds until the LED outputs of the current mode can next change, 0 when they are changing
+// continuously (equations, live streams, crossfades) or the mode has not been evaluated yet. Accel
+// modes are bounded by the next accelerometer FIFO drain, timers and quiet periods leaving the
+// current state by when they run out. Button and charge transitions do not bound it, both events
+// wake the MCU on their own.
+uint32_t modeIdleBudgetMs(ModeManager *manager);
+// Equations are evaluated in software floating point and too slow for the low power clock.
+bool modeNeedsFullSpeedClock(ModeManager *manager);
+// The caller owns Stop mode and reports the time slept there, see modeAwakePermille.
+void modeNoteStopModeSleep(ModeManager *manager, uint32_t sleptMs);
+// Hands a button tap to the next modeTask when a button transition leaves the current state.
+// Returns false when none does, the caller then handles the tap as usual.
+bool modeTakeButtonTap(ModeManager *manager);
+// Whether the charger has power, charge transitions fire when this changes.
+void modeNoteCharging(ModeManager *manager, bool charging);
+// Share of time since the current mode started that the MCU was awake, 1000 until time passes.
+uint16_t modeAwakePermille(ModeManager *manager, uint32_t milliseconds);
+/**
+ * Advances the current mode and hands its colors to the user layer of each LED. An LED covered by
+ * an indicator or status is skipped, its component is not evaluated and catches up on the mode
+ * timeline once it shows again.
+ */
+ModeOutputs modeTask(ModeManager *manager, uint32_t milliseconds, uint8_t equationEvalIntervalMs);
 
 #endif /* INC_MODE_MANAGER_H_ */
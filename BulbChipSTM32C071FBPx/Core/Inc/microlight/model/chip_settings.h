@@ -9,6 +9,7 @@
 #define INC_MODEL_CHIP_SETTINGS_H_
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <stdint.h>
 
 #define SHUTDOWN_POLICY_MAP(X)                            \
@@ -26,6 +27,10 @@ enum ShutdownPolicy {
 #define DEFAULT_MINUTES_UNTIL_AUTO_OFF 90
 #define DEFAULT_MINUTES_UNTIL_LOCK_AFTER_AUTO_OFF 10
 #define DEFAULT_EQUATION_EVAL_INTERVAL_MS 20
+// Fades from the colors frozen at a mode switch into the new mode, the old mode stops animating,
+// see ModeCrossfade. 0 switches modes instantly
+#define DEFAULT_MODE_CROSSFADE_MS 0
+#define MAX_MODE_CROSSFADE_MS 5000
 #define DEFAULT_SHUTDOWN_POLICY autoOffAndAutoLock
 #define DEFAULT_ENABLE_CHARGER_SERIAL false
 #define DEFAULT_ENABLE_I2C_FAILURE_REPORTING \
@@ -36,6 +41,14 @@ enum ShutdownPolicy {
 #define DEFAULT_CASE_WHITE_BALANCE_RED 140
 #define DEFAULT_CASE_WHITE_BALANCE_GREEN 210
 #define DEFAULT_CASE_WHITE_BALANCE_BLUE 255
+// LED current in mA at 100% duty, used only to estimate power draw
+#define DEFAULT_FRONT_RED_CURRENT_MA 20
+#define DEFAULT_FRONT_GREEN_CURRENT_MA 20
+#define DEFAULT_FRONT_BLUE_CURRENT_MA 20
+#define DEFAULT_CASE_RED_CURRENT_MA 5
+#define DEFAULT_CASE_GREEN_CURRENT_MA 5
+#define DEFAULT_CASE_BLUE_CURRENT_MA 5
+#define DEFAULT_BULB_CURRENT_MA 20
 
 #ifdef MICROLIGHT_LEGACY_PCB_BUTTON_PA7
 _Static_assert(
@@ -57,7 +70,15 @@ _Static_assert(
     X(uint8_t, frontWhiteBalanceBlue, DEFAULT_FRONT_WHITE_BALANCE_BLUE)                 \
     X(uint8_t, caseWhiteBalanceRed, DEFAULT_CASE_WHITE_BALANCE_RED)                     \
     X(uint8_t, caseWhiteBalanceGreen, DEFAULT_CASE_WHITE_BALANCE_GREEN)                 \
-    X(uint8_t, caseWhiteBalanceBlue, DEFAULT_CASE_WHITE_BALANCE_BLUE)
+    X(uint8_t, caseWhiteBalanceBlue, DEFAULT_CASE_WHITE_BALANCE_BLUE)                   \
+    X(uint8_t, frontRedCurrentMa, DEFAULT_FRONT_RED_CURRENT_MA)                         \
+    X(uint8_t, frontGreenCurrentMa, DEFAULT_FRONT_GREEN_CURRENT_MA)                     \
+    X(uint8_t, frontBlueCurrentMa, DEFAULT_FRONT_BLUE_CURRENT_MA)                       \
+    X(uint8_t, caseRedCurrentMa, DEFAULT_CASE_RED_CURRENT_MA)                           \
+    X(uint8_t, caseGreenCurrentMa, DEFAULT_CASE_GREEN_CURRENT_MA)                       \
+    X(uint8_t, caseBlueCurrentMa, DEFAULT_CASE_BLUE_CURRENT_MA)                         \
+    X(uint8_t, bulbCurrentMa, DEFAULT_BULB_CURRENT_MA)                                  \
+    X(uint16_t, modeCrossfadeMs, DEFAULT_MODE_CROSSFADE_MS)
 
 typedef struct {
 #define X_FIELDS(type, name, def) type name;
@@ -65,10 +86,60 @@ typedef struct {
 #undef X_FIELDS
 } ChipSettings;
 
+enum {
+#define X_INDEX(type, name, def) CHIP_SETTING_INDEX_##name,
+    CHIP_SETTINGS_MAP(X_INDEX)
+#undef X_INDEX
+    CHIP_SETTINGS_COUNT
+};
+
 static inline void chipSettingsInitDefaults(ChipSettings *settings) {
 #define X_DEFAULTS(type, name, def) settings->name = def;
     CHIP_SETTINGS_MAP(X_DEFAULTS)
 #undef X_DEFAULTS
 }
 
+// Binary form used by the framed protocol, each setting little endian in CHIP_SETTINGS_MAP order.
+typedef struct {
+#define X_PACKED(type, name, def) uint8_t name[sizeof(type)];
+    CHIP_SETTINGS_MAP(X_PACKED)
+#undef X_PACKED
+} ChipSettingsPacked;
+
+#define CHIP_SETTINGS_PACKED_SIZE sizeof(ChipSettingsPacked)
+#define CHIP_SETTING_OFFSET(name) offsetof(ChipSettingsPacked, name)
+
+static inline void chipSettingsPack(
+    const ChipSettings *settings, uint8_t out[CHIP_SETTINGS_PACKED_SIZE]) {
+#define X_PACK(type, name, def)                                                 \
+    for (size_t i = 0; i < sizeof(type); i++) {                                 \
+        uint32_t value = (uint32_t)settings->name;                              \
+        out[CHIP_SETTING_OFFSET(name) + i] = (uint8_t)(value >> (8U * i));      \
+    }
+    CHIP_SETTINGS_MAP(X_PACK)
+#undef X_PACK
+}
+
+#define UNPACK_SETTING_uint8_t(value) ((uint8_t)(value))
+#define UNPACK_SETTING_uint16_t(value) ((uint16_t)(value))
+#define UNPACK_SETTING_bool(value) ((value) != 0)
+
+static inline void chipSettingsUnpack(
+    const uint8_t in[CHIP_SETTINGS_PACKED_SIZE], ChipSettings *settings) {
+#define X_UNPACK(type, name, def)                                              \
+    {                                                                          \
+        uint32_t value = 0;                                                    \
+        for (size_t i = 0; i < sizeof(type); i++) {                            \
+            value |= (uint32_t)in[CHIP_SETTING_OFFSET(name) + i] << (8U * i); \
+        }                                                                      \
+        settings->name = UNPACK_SETTING_##type(value);                         \
+    }
+    CHIP_SETTINGS_MAP(X_UNPACK)
+#undef X_UNPACK
+}
+
+#undef UNPACK_SETTING_bool
+#undef UNPACK_SETTING_uint16_t
+#undef UNPACK_SETTING_uint8_t
+
 #endif /* INC_MODEL_CHIP_SETTINGS_H_ */
@@ -19,7 +19,9 @@ enum ParseResult {
     parseReadMode,
     parseWriteSettings,
     parseReadSettings,
-    parseDfu
+    parseDfu,
+    parseEstimatePower,
+    parseReadTelemetry
 };
 
 typedef struct CliInput {
@@ -29,6 +31,8 @@ typedef struct CliInput {
 
     // metadata
     uint8_t modeIndex;
+    // readTelemetry, index of the oldest record wanted
+    uint16_t telemetryFirst;
 
     ParserErrorContext errorContext;
 
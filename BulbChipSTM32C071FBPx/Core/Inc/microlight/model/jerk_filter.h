@@ -0,0 +1,43 @@
+/*
+ * jerk_filter.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#ifndef INC_MODEL_JERK_FILTER_H_
+#define INC_MODEL_JERK_FILTER_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Samples in the mean square window, a power of two
+#define JERK_FILTER_WINDOW 4
+// DC blocker pole at 1 - 1/2^n, removes gravity and slow orientation changes
+#define JERK_FILTER_HIGH_PASS_SHIFT 3
+// held peak loses 1/2^n per sample
+#define JERK_FILTER_PEAK_DECAY_SHIFT 3
+
+/**
+ * Integer only jerk detector for a stream of evenly spaced accelerometer samples. Each axis is high
+ * passed, jerk is the difference of consecutive filtered samples, its square is averaged over the
+ * last JERK_FILTER_WINDOW samples and the result is peak held with decay. A lone noisy sample is
+ * spread over the window while an impact lasting a few samples keeps most of its energy.
+ */
+typedef struct {
+    bool primed;
+    int16_t lastRaw[3];
+    int32_t highPass[3];
+    uint32_t window[JERK_FILTER_WINDOW];
+    uint8_t windowIndex;
+    uint64_t windowSum;
+    // mean square jerk in raw LSB per sample period, squared
+    uint32_t peak;
+} JerkFilter;
+
+void jerkFilterReset(JerkFilter *filter);
+
+// Feeds one sample and returns the held peak after it.
+uint32_t jerkFilterPush(JerkFilter *filter, int16_t x, int16_t y, int16_t z);
+
+#endif /* INC_MODEL_JERK_FILTER_H_ */
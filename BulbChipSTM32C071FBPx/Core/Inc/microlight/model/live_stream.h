@@ -0,0 +1,84 @@
+/*
+ * live_stream.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#ifndef INC_MODEL_LIVE_STREAM_H_
+#define INC_MODEL_LIVE_STREAM_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// front r, g, b then case r, g, b
+#define LIVE_STREAM_FRAME_SIZE 6
+#define LIVE_STREAM_BUFFER_FRAMES 8
+#define LIVE_STREAM_DEFAULT_PREFILL 2
+// stream ends and the mode resumes once the buffer is empty and nothing arrived for this long
+#define LIVE_STREAM_TIMEOUT_MS 1000
+// received, played, dropped, underruns, elapsed ms (u32 LE), last/max latency (u16 LE), buffered
+#define LIVE_STREAM_STATS_SIZE 25
+
+typedef struct {
+    uint8_t frontRed;
+    uint8_t frontGreen;
+    uint8_t frontBlue;
+    uint8_t caseRed;
+    uint8_t caseGreen;
+    uint8_t caseBlue;
+} LiveStreamFrame;
+
+typedef struct {
+    uint32_t framesReceived;
+    uint32_t framesPlayed;
+    // overwritten because the buffer was full, or skipped because playout fell behind
+    uint32_t framesDropped;
+    uint32_t underruns;
+    uint32_t startedAtMs;
+    // arrival to shown
+    uint16_t lastLatencyMs;
+    uint16_t maxLatencyMs;
+} LiveStreamStats;
+
+typedef struct {
+    LiveStreamFrame frames[LIVE_STREAM_BUFFER_FRAMES];
+    uint32_t arrivalMs[LIVE_STREAM_BUFFER_FRAMES];
+    uint8_t head;
+    uint8_t count;
+    LiveStreamFrame current;
+    uint8_t frameIntervalMs;
+    uint8_t prefillFrames;
+    bool active;
+    bool playing;
+    uint32_t nextFrameMs;
+    uint32_t lastReceivedMs;
+    LiveStreamStats stats;
+} LiveStream;
+
+/**
+ * Starts a stream that plays one frame every `frameIntervalMs`. Playout waits until
+ * `prefillFrames` frames are buffered, and again after every underrun, so host jitter up to
+ * prefillFrames * frameIntervalMs is absorbed. Clears the buffer and the stats.
+ */
+void liveStreamStart(
+    LiveStream *stream, uint8_t frameIntervalMs, uint8_t prefillFrames, uint32_t milliseconds);
+void liveStreamStop(LiveStream *stream);
+
+/**
+ * Queues one LIVE_STREAM_FRAME_SIZE byte frame. When the buffer is full the oldest frame is
+ * dropped, a preview wants the newest colors. Returns false if the stream is not active.
+ */
+bool liveStreamPush(LiveStream *stream, const uint8_t data[], uint32_t milliseconds);
+
+/**
+ * Advances playout to `milliseconds` and writes the frame to show into `frame`, the last frame is
+ * held while prefilling or on underrun. Returns false once the stream is inactive, including when
+ * it times out here.
+ */
+bool liveStreamTask(LiveStream *stream, uint32_t milliseconds, LiveStreamFrame *frame);
+
+void liveStreamPackStats(const LiveStream *stream, uint32_t milliseconds, uint8_t out[]);
+
+#endif /* INC_MODEL_LIVE_STREAM_H_ */
@@ -54,7 +54,30 @@
  *   }
  * }
  *
- * 3. Accel Trigger:
+ * 3. Keyframe Pattern:
+ * {
+ *   "name": "Breathe",
+ *   "front": {
+ *     "pattern": {
+ *       "type": "keyframe",
+ *       "name": "Blue Breathe",
+ *       "duration": 3000,
+ *       "easing": "ease",
+ *       "changeAt": [
+ *         {
+ *           "ms": 0,
+ *           "output": "#000000"
+ *         },
+ *         {
+ *           "ms": 1500,
+ *           "output": "#0000FF"
+ *         }
+ *       ]
+ *     }
+ *   }
+ * }
+ *
+ * 4. Accel Trigger:
  * {
  *   "name": "Impact",
  *   "front": {
@@ -91,6 +114,104 @@
  *     ]
  *   }
  * }
+ *
+ * 5. Mode Script:
+ * {
+ *   "name": "Shake Glow",
+ *   "front": {
+ *     "pattern": {
+ *       "type": "simple",
+ *       "name": "Steady Off",
+ *       "duration": 1000,
+ *       "changeAt": [
+ *         {
+ *           "ms": 0,
+ *           "output": "#000000"
+ *         }
+ *       ]
+ *     }
+ *   },
+ *   "accel": {
+ *     "triggers": [
+ *       {
+ *         "threshold": 50,
+ *         "front": {
+ *           "pattern": {
+ *             "type": "simple",
+ *             "name": "Glow",
+ *             "duration": 1000,
+ *             "changeAt": [
+ *               {
+ *                 "ms": 0,
+ *                 "output": "#FF8000"
+ *               }
+ *             ]
+ *           }
+ *         }
+ *       }
+ *     ]
+ *   },
+ *   "script": {
+ *     "transitions": [
+ *       {
+ *         "from": 0,
+ *         "to": 1,
+ *         "on": "accel",
+ *         "threshold": 50
+ *       },
+ *       {
+ *         "from": 1,
+ *         "to": 0,
+ *         "on": "still",
+ *         "threshold": 20,
+ *         "ms": 5000
+ *       }
+ *     ]
+ *   }
+ * }
+ *
+ * 6. Script States:
+ * {
+ *   "name": "Tap Toggle",
+ *   "front": {
+ *     "pattern": {
+ *       "type": "simple",
+ *       "name": "Glow",
+ *       "duration": 1000,
+ *       "changeAt": [
+ *         {
+ *           "ms": 0,
+ *           "output": "#FF8000"
+ *         }
+ *       ]
+ *     }
+ *   },
+ *   "script": {
+ *     "states": [
+ *       {
+ *         "front": 0
+ *       },
+ *       {}
+ *     ],
+ *     "transitions": [
+ *       {
+ *         "from": 0,
+ *         "to": 1,
+ *         "on": "button"
+ *       },
+ *       {
+ *         "from": 0,
+ *         "to": 1,
+ *         "on": "charge"
+ *       },
+ *       {
+ *         "from": 1,
+ *         "to": 0,
+ *         "on": "button"
+ *       }
+ *     ]
+ *   }
+ * }
 
  */
 #ifndef INC_MODEL_MODE_H_
@@ -99,18 +220,30 @@
 #include <stdbool.h>
 #include <stdint.h>
 
-typedef enum { PATTERN_TYPE_SIMPLE, PATTERN_TYPE_EQUATION } PatternType;
+typedef enum { PATTERN_TYPE_SIMPLE, PATTERN_TYPE_EQUATION, PATTERN_TYPE_KEYFRAME } PatternType;
 
 #define MODE_NAME_MAX_LEN 32
 #define SIMPLE_PATTERN_CHANGES_MAX 32
 #define EQUATION_SECTION_EQUATION_MAX_LEN 64
 #define CHANNEL_CONFIG_SECTIONS_MAX 3
 #define MODE_ACCEL_TRIGGERS_MAX 2
+#define MODE_SCRIPT_STATES_MAX 8
+#define MODE_SCRIPT_TRANSITIONS_MAX 8
 
 typedef enum SimpleOutputType { BULB, RGB } SimpleOutputType;
 
 typedef enum BulbSimpleOutput { low, high } BulbSimpleOutput;
 
+typedef enum KeyframeEasing { KEYFRAME_EASING_LINEAR, KEYFRAME_EASING_EASE } KeyframeEasing;
+
+typedef enum ModeTransitionEvent {
+    MODE_TRANSITION_EVENT_ACCEL,
+    MODE_TRANSITION_EVENT_STILL,
+    MODE_TRANSITION_EVENT_TIMER,
+    MODE_TRANSITION_EVENT_BUTTON,
+    MODE_TRANSITION_EVENT_CHARGE
+} ModeTransitionEvent;
+
 typedef struct RGBSimpleOutput RGBSimpleOutput;
 typedef struct SimpleOutput SimpleOutput;
 
@@ -119,10 +252,14 @@ typedef struct SimplePattern SimplePattern;
 typedef struct EquationSection EquationSection;
 typedef struct ChannelConfig ChannelConfig;
 typedef struct EquationPattern EquationPattern;
+typedef struct KeyframePattern KeyframePattern;
 typedef struct ModePattern ModePattern;
 typedef struct ModeComponent ModeComponent;
 typedef struct ModeAccelTrigger ModeAccelTrigger;
 typedef struct ModeAccel ModeAccel;
+typedef struct ModeTransition ModeTransition;
+typedef struct ModeScriptState ModeScriptState;
+typedef struct ModeScript ModeScript;
 typedef struct Mode Mode;
 
 struct RGBSimpleOutput {
@@ -170,11 +307,20 @@ struct EquationPattern {
     ChannelConfig blue;
 };
 
+struct KeyframePattern {
+    char name[MODE_NAME_MAX_LEN];
+    uint32_t duration;
+    KeyframeEasing easing;
+    PatternChange changeAt[SIMPLE_PATTERN_CHANGES_MAX];
+    uint8_t changeAtCount;
+};
+
 struct ModePattern {
     PatternType type;
     union {
         SimplePattern simple;
         EquationPattern equation;
+        KeyframePattern keyframe;
     } data;
 };
 
@@ -184,6 +330,8 @@ struct ModeComponent {
 
 struct ModeAccelTrigger {
     uint8_t threshold;
+    uint32_t holdMs;
+    bool hasHoldMs;
     ModeComponent front;
     bool hasFront;
     ModeComponent caseComp;
@@ -195,6 +343,31 @@ struct ModeAccel {
     uint8_t triggersCount;
 };
 
+struct ModeTransition {
+    uint8_t from;
+    uint8_t to;
+    ModeTransitionEvent on;
+    uint8_t threshold;
+    bool hasThreshold;
+    uint32_t ms;
+    bool hasMs;
+};
+
+struct ModeScriptState {
+    uint8_t front;
+    bool hasFront;
+    uint8_t caseComp;
+    bool hasCaseComp;
+};
+
+struct ModeScript {
+    ModeScriptState states[MODE_SCRIPT_STATES_MAX];
+    uint8_t statesCount;
+    bool hasStates;
+    ModeTransition transitions[MODE_SCRIPT_TRANSITIONS_MAX];
+    uint8_t transitionsCount;
+};
+
 struct Mode {
     char name[MODE_NAME_MAX_LEN];
     ModeComponent front;
@@ -203,6 +376,8 @@ struct Mode {
     bool hasCaseComp;
     ModeAccel accel;
     bool hasAccel;
+    ModeScript script;
+    bool hasScript;
 };
 
 #endif /* INC_MODEL_MODE_H_ */
@@ -29,8 +29,12 @@ typedef struct {
 } EquationPatternState;
 
 typedef struct {
+    // also walks the keyframes of a keyframe pattern
     SimplePatternState simple;
     EquationPatternState equation;
+    // the mode timeline this component follows and how far along it the component has been moved
+    const uint32_t *timelineMs;
+    uint32_t syncedMs;
 } ModeComponentState;
 
 typedef struct {
@@ -38,11 +42,41 @@ typedef struct {
     ModeComponentState case_comp;
 } ModeAccelTriggerState;
 
+// Sized for a script listing its own states. Without them state 0 shows the mode's own
+// components and state n those of accel trigger n - 1.
+#define MODE_MACHINE_STATES_MAX MODE_SCRIPT_STATES_MAX
+// a state shows nothing on that LED
+#define MODE_MACHINE_NO_COMPONENT 0xFF
+
+/**
+ * The accel triggers or script of a mode compiled into a transition table. Only the transitions
+ * leaving the current state are looked at each tick, the first one whose event has happened is
+ * taken.
+ */
+typedef struct {
+    // grouped by the state they leave, those of state s are [first[s], first[s + 1])
+    ModeTransition transitions[MODE_SCRIPT_TRANSITIONS_MAX];
+    uint8_t first[MODE_MACHINE_STATES_MAX + 1];
+    uint8_t stateCount;
+    // last time the jerk went over the threshold of each still transition
+    uint32_t lastOverMs[MODE_SCRIPT_TRANSITIONS_MAX];
+    // component slot shown in each state, 0 for the mode's own, n for accel trigger n - 1
+    uint8_t frontSlot[MODE_MACHINE_STATES_MAX];
+    uint8_t caseSlot[MODE_MACHINE_STATES_MAX];
+    uint8_t state;
+    uint32_t enteredMs;
+    // whether the charger had power when the state was entered, charge transitions fire on a change
+    bool enteredCharging;
+} ModeMachine;
+
 typedef struct {
     ModeComponentState front;
     ModeComponentState case_comp;
     ModeAccelTriggerState accel[MODE_ACCEL_TRIGGERS_MAX];
+    ModeMachine machine;
     uint32_t lastPatternUpdateMs;
+    // ms the mode has run, every component catches up to it when it is next shown
+    uint32_t timelineMs;
 } ModeState;
 
 typedef struct {
@@ -55,11 +89,18 @@ typedef struct {
 /**
  * Initializes a `ModeState` instance so it can evaluate the provided `Mode`.
  * Frees any previously compiled expressions, zeroes the runtime state, seeds
- * `lastPatternUpdateMs` with `initialMs`, and compiles all required equations.
+ * `lastPatternUpdateMs` with `initialMs`, compiles all required equations and
+ * the transition table of the mode's machine.
  * Returns false and populates `error` when an equation fails to compile.
  */
 bool modeStateInitialize(
     ModeState *state, const Mode *mode, uint32_t initialMs, ModeEquationError *error);
+
+/**
+ * Moves the mode timeline shared by all components. Components are only advanced when their
+ * output is read, so the accel trigger components that are not shown cost nothing per tick and
+ * pick up where the timeline is once they are.
+ */
 void modeStateAdvance(ModeState *state, const Mode *mode, uint32_t milliseconds);
 bool modeStateGetSimpleOutput(
     ModeComponentState *componentState,
@@ -67,6 +108,14 @@ bool modeStateGetSimpleOutput(
     SimpleOutput *output,
     uint8_t equationEvalIntervalMs);
 
+/**
+ * Returns how long until the output of `component` can next change, UINT32_MAX when it never
+ * does. Equation patterns change continuously and always return 0, keyframe patterns only count
+ * down while holding between two keyframes of the same color.
+ */
+uint32_t modeStateMsUntilNextChange(
+    ModeComponentState *componentState, const ModeComponent *component);
+
 #ifdef UNIT_TEST
 void modeStateTest_resetEquationFreeCounter(void);
 uint32_t modeStateTest_getEquationFreeCounter(void);
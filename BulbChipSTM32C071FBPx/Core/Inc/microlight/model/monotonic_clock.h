@@ -0,0 +1,61 @@
+/*
+ * monotonic_clock.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#ifndef INC_MODEL_MONOTONIC_CLOCK_H_
+#define INC_MODEL_MONOTONIC_CLOCK_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+ * Millisecond clock built on a coarse source that never stops, like the RTC which keeps counting
+ * in Stop mode and across clock changes, trimmed against a finer reference that only runs part
+ * of the time, like the chip tick.
+ *
+ * Source milliseconds are scaled by a Q16 rate and the remainder below a millisecond is carried
+ * from one read to the next, so a trimmed rate never loses time to rounding. The rate starts at
+ * one and is re-measured over every window of MONOTONIC_CLOCK_CALIBRATION_MS reference time.
+ */
+
+#define MONOTONIC_CLOCK_RATE_ONE 65536U
+// The 4 ms RTC steps at either end of a window keep a trim within ~300 ppm
+#define MONOTONIC_CLOCK_CALIBRATION_MS 30000U
+// The LSI is good to a few percent, a window further off than this saw the reference stall
+#define MONOTONIC_CLOCK_MAX_TRIM (MONOTONIC_CLOCK_RATE_ONE / 10U)
+
+typedef struct {
+    bool started;
+    uint32_t lastSourceMs;
+    uint32_t milliseconds;
+    // Q16 reference milliseconds per source millisecond, and the Q16 remainder not yet counted
+    uint32_t rate;
+    uint32_t fraction;
+
+    // source time seen since the window opened at windowStartReferenceMs
+    bool calibrating;
+    uint32_t windowSourceMs;
+    uint32_t windowStartReferenceMs;
+} MonotonicClock;
+
+void monotonicClockInit(MonotonicClock *clock);
+
+/**
+ * Moves the clock on by the source time since the last update and returns the milliseconds since
+ * the first one. The source may wrap, updates only have to be less than ~49 days apart.
+ */
+uint32_t monotonicClockUpdate(MonotonicClock *clock, uint32_t sourceMs);
+
+/**
+ * Call right after monotonicClockUpdate with the reference read at the same moment. Opens a window
+ * on the first call and trims the rate once the window covers MONOTONIC_CLOCK_CALIBRATION_MS.
+ */
+void monotonicClockCalibrate(MonotonicClock *clock, uint32_t referenceMs);
+
+// The reference stopped or jumped, drop the open window and keep the current rate.
+void monotonicClockRestartCalibration(MonotonicClock *clock);
+
+#endif /* INC_MODEL_MONOTONIC_CLOCK_H_ */
@@ -0,0 +1,42 @@
+/*
+ * power_estimate.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#ifndef INC_MODEL_POWER_ESTIMATE_H_
+#define INC_MODEL_POWER_ESTIMATE_H_
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "microlight/model/chip_settings.h"
+#include "microlight/model/mode.h"
+
+// STM32C071 supply current running from flash at the normal 12 MHz clock, and in Stop mode.
+#define POWER_MCU_RUN_MICROAMPS 1500U
+#define POWER_MCU_STOP_MICROAMPS 80U
+
+typedef struct {
+    // time weighted average over one pattern loop, per the *CurrentMa settings
+    uint32_t frontMicroamps;
+    uint32_t caseMicroamps;
+    uint32_t mcuMicroamps;
+    uint16_t awakePermille;
+    // false when equation patterns were counted at full scale or accel triggers were ignored
+    bool exact;
+} PowerEstimate;
+
+/**
+ * Estimates the average current drawn while `mode` plays. Simple patterns are integrated exactly
+ * after gamma and white balance. Equation patterns would need a second set of compiled
+ * expressions, more than the heap has, so they are counted at full scale as an upper bound.
+ * Accel triggers are not counted. `awakePermille` is the fraction of time the MCU runs rather
+ * than sits in Stop mode.
+ */
+PowerEstimate powerEstimateMode(
+    const Mode *mode, const ChipSettings *settings, uint16_t awakePermille);
+
+uint32_t powerEstimateTotalMicroamps(const PowerEstimate *estimate);
+
+#endif /* INC_MODEL_POWER_ESTIMATE_H_ */
@@ -17,4 +17,10 @@ typedef void (*ReadSavedSettings)(char *buffer, size_t length);
 typedef void (*SaveMode)(uint8_t modeIndex, const char *buffer, size_t length);
 typedef void (*ReadSavedMode)(uint8_t modeIndex, char *buffer, size_t length);
 
+// Telemetry region, offsets count from its start. Writes are whole 8 byte double words into erased
+// flash, erases are whole pages.
+typedef void (*EraseTelemetryPage)(uint8_t page);
+typedef void (*WriteTelemetry)(uint32_t offset, const uint8_t *data, size_t length);
+typedef void (*ReadTelemetry)(uint32_t offset, uint8_t *buffer, size_t length);
+
 #endif /* INC_MODEL_STORAGE_H_ */
@@ -0,0 +1,111 @@
+/*
+ * telemetry.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#ifndef INC_MODEL_TELEMETRY_H_
+#define INC_MODEL_TELEMETRY_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "microlight/model/storage.h"
+
+/*
+ * Event log kept in a ring of flash pages so field units keep their history across power cycles.
+ *
+ * Every slot is one 8 byte flash double word:
+ *   event, arg, value (u16 LE), milliseconds since boot (u32 LE)
+ * The first slot of each page is its header instead:
+ *   TELEMETRY_PAGE_MAGIC (u32 LE), page sequence (u32 LE)
+ *
+ * Records are only ever appended into erased slots. A page is erased when the ring wraps onto it,
+ * once per TELEMETRY_RECORDS_PER_PAGE records, and the oldest page of history goes with it.
+ */
+
+#define TELEMETRY_RECORD_SIZE 8
+#define TELEMETRY_PAGE_SIZE 2048
+#define TELEMETRY_PAGE_COUNT 2
+#define TELEMETRY_RECORDS_PER_PAGE (TELEMETRY_PAGE_SIZE / TELEMETRY_RECORD_SIZE - 1)
+#define TELEMETRY_CAPACITY (TELEMETRY_RECORDS_PER_PAGE * TELEMETRY_PAGE_COUNT)
+#define TELEMETRY_PAGE_MAGIC 0x314D4C54U  // "TLM1"
+// events wait in RAM until telemetryFlush, anything past this is counted as dropped
+#define TELEMETRY_PENDING_RECORDS 8
+
+enum TelemetryEvent {
+    TELEMETRY_EVENT_BOOT = 0x01,
+    // arg: new ChargeState
+    TELEMETRY_EVENT_CHARGE_STATE = 0x02,
+    // value: BQ25180 FLAG0 bits
+    TELEMETRY_EVENT_CHARGER_FAULT = 0x03,
+    // arg: mode index
+    TELEMETRY_EVENT_MODE_CHANGED = 0x04,
+    TELEMETRY_EVENT_AUTO_OFF = 0x05,
+    TELEMETRY_EVENT_SHUTDOWN = 0x06,
+    TELEMETRY_EVENT_LOCK = 0x07,
+    // arg: device address, value: register, 0x100 set for reads
+    TELEMETRY_EVENT_I2C_FAILURE = 0x08,
+    // value: events lost because the RAM queue was full
+    TELEMETRY_EVENT_DROPPED = 0x09,
+    // never written, an erased slot reads back as this
+    TELEMETRY_EVENT_NONE = 0xFF,
+};
+
+typedef struct {
+    uint8_t event;
+    uint8_t arg;
+    uint16_t value;
+    uint32_t milliseconds;
+} TelemetryRecord;
+
+typedef struct {
+    EraseTelemetryPage erasePage;
+    WriteTelemetry write;
+    ReadTelemetry read;
+
+    // page being appended to and its next free slot, TELEMETRY_RECORDS_PER_PAGE + 1 when full
+    uint8_t page;
+    uint16_t slot;
+    uint32_t sequence;
+    // full pages of history behind the current one
+    uint8_t olderPages;
+
+    TelemetryRecord pending[TELEMETRY_PENDING_RECORDS];
+    uint8_t pendingCount;
+    uint16_t dropped;
+} Telemetry;
+
+/**
+ * Finds the newest page and its first free slot. Flash that holds no valid page is taken as a
+ * fresh log and its first page is erased.
+ */
+bool telemetryInit(
+    Telemetry *telemetry, EraseTelemetryPage erasePage, WriteTelemetry write, ReadTelemetry read);
+
+/**
+ * Queues a record in RAM, cheap enough to call from any task. Nothing reaches flash until
+ * telemetryFlush.
+ */
+void telemetryRecord(
+    Telemetry *telemetry, uint8_t event, uint8_t arg, uint16_t value, uint32_t milliseconds);
+
+bool telemetryHasPending(const Telemetry *telemetry);
+
+// Appends the queued records to flash, erasing the next page whenever the current one fills.
+void telemetryFlush(Telemetry *telemetry);
+
+// Records stored in flash, queued records are not counted until flushed.
+uint16_t telemetryCount(const Telemetry *telemetry);
+
+/**
+ * Copies up to maxRecords stored records, oldest first, starting at index `first` into out as
+ * TELEMETRY_RECORD_SIZE byte records in the flash layout. Returns the number of records copied.
+ */
+uint16_t telemetryRead(
+    const Telemetry *telemetry, uint16_t first, uint8_t out[], uint16_t maxRecords);
+
+void telemetryUnpack(const uint8_t data[], TelemetryRecord *record);
+
+#endif /* INC_MODEL_TELEMETRY_H_ */
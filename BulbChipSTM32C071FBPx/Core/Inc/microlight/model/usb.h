@@ -16,4 +16,9 @@ typedef int32_t (*UsbReadTask)(char *buffer, size_t length);
 
 typedef void (*UsbWrite)(const char *buffer, size_t length);
 
+// Bytes UsbWrite can still queue without dropping a message
+typedef size_t (*UsbTxFree)(void);
+
+typedef uint32_t (*CurrentMilliseconds)(void);
+
 #endif /* INC_MODEL_USB_H_ */
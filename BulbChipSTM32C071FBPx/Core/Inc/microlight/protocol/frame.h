@@ -0,0 +1,114 @@
+/*
+ * frame.h
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#ifndef INC_PROTOCOL_FRAME_H_
+#define INC_PROTOCOL_FRAME_H_
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Binary frames share the USB line transport with the JSON commands.
+ *
+ * On the wire:
+ *   FRAME_START_BYTE, encoded..., '\n'
+ *
+ * encoded is the COBS encoding of
+ *   opcode, seq, payload..., crcHigh, crcLow
+ * with every byte XORed with '\n'. COBS output never contains 0x00, so after the XOR it never
+ * contains '\n' and the existing line reader delimits frames the same way it delimits JSON.
+ * The CRC is CRC-16/CCITT-FALSE over opcode, seq and payload.
+ *
+ * JSON lines always start with '{', so a line starting with FRAME_START_BYTE is a frame. Responses
+ * echo the request seq with FRAME_RESPONSE_FLAG set on the opcode, which lets the host keep several
+ * requests in flight. Unsolicited events stay JSON lines.
+ *
+ * Requests:
+ *   FRAME_OP_HELLO          payload: host protocol version
+ *                           response: FRAME_PROTOCOL_VERSION, max payload (u16 LE), settings size
+ *   FRAME_OP_WRITE_MODE     payload: writeMode JSON command, stored to flash as is
+ *   FRAME_OP_READ_MODE      payload: mode index. response: stored writeMode JSON command
+ *   FRAME_OP_WRITE_SETTINGS payload: settings in CHIP_SETTINGS_MAP order, see chipSettingsPack
+ *   FRAME_OP_READ_SETTINGS  response: settings packed the same way as FRAME_OP_WRITE_SETTINGS
+ *   FRAME_OP_DFU            no response
+ *   FRAME_OP_STREAM_START   payload: frame interval ms, optional prefill frames
+ *                           response: LIVE_STREAM_BUFFER_FRAMES
+ *   FRAME_OP_STREAM_FRAMES  payload: one or more LIVE_STREAM_FRAME_SIZE byte frames, no response
+ *                           so the host can push at the frame rate without waiting on acks
+ *   FRAME_OP_STREAM_STOP    response: live stream stats, see LIVE_STREAM_STATS_SIZE
+ *   FRAME_OP_STREAM_STATS   response: live stream stats, stream keeps playing
+ *   FRAME_OP_READ_TELEMETRY payload: optional index of the oldest record wanted (u16 LE)
+ *                           response: total records (u16 LE), first (u16 LE), then up to
+ *                           USB_TELEMETRY_FRAME_RECORDS records, see telemetry.h
+ *
+ * Failures are answered with FRAME_OP_ERROR, payload: FrameError, then optional ascii detail.
+ */
+
+#define FRAME_START_BYTE ((char)0xF0)
+#define FRAME_PROTOCOL_VERSION 1
+#define FRAME_RESPONSE_FLAG 0x80
+
+// opcode + seq
+#define FRAME_HEADER_SIZE 2
+#define FRAME_CRC_SIZE 2
+// total + first ahead of the records in a FRAME_OP_READ_TELEMETRY response
+#define TELEMETRY_FRAME_HEADER_SIZE 4
+
+// Space frameEncode needs in front of a payload to encode it in place, enough for payloads up to
+// 3 KB. Start byte, header, and one COBS code byte per 254 bytes all run ahead of the payload.
+#define FRAME_HEADROOM 16
+
+enum FrameOpcode {
+    FRAME_OP_HELLO = 0x01,
+    FRAME_OP_WRITE_MODE = 0x02,
+    FRAME_OP_READ_MODE = 0x03,
+    FRAME_OP_WRITE_SETTINGS = 0x04,
+    FRAME_OP_READ_SETTINGS = 0x05,
+    FRAME_OP_DFU = 0x06,
+    FRAME_OP_STREAM_START = 0x07,
+    FRAME_OP_STREAM_FRAMES = 0x08,
+    FRAME_OP_STREAM_STOP = 0x09,
+    FRAME_OP_STREAM_STATS = 0x0A,
+    FRAME_OP_READ_TELEMETRY = 0x0B,
+    FRAME_OP_ERROR = 0x7F,
+};
+
+typedef enum {
+    FRAME_OK = 0,
+    FRAME_ERR_CRC = 1,
+    FRAME_ERR_MALFORMED = 2,
+    FRAME_ERR_UNKNOWN_OPCODE = 3,
+    FRAME_ERR_INVALID_PAYLOAD = 4,
+} FrameError;
+
+typedef struct {
+    uint8_t opcode;
+    uint8_t seq;
+    char *payload;
+    size_t payloadLength;
+} Frame;
+
+// Decodes a line read from USB in place, the payload is written to the start of line followed by
+// the two CRC bytes. opcode and seq are filled whenever enough of the frame decoded to read them,
+// so a CRC failure can still be answered.
+FrameError frameDecode(char line[], size_t length, Frame *frame);
+
+// Encodes a complete frame including the start byte and trailing '\n' into out. out may overlap
+// payload as long as out + FRAME_HEADROOM <= payload. Returns the number of bytes written, 0 if
+// out is too small.
+size_t frameEncode(
+    uint8_t opcode,
+    uint8_t seq,
+    const char *payload,
+    size_t payloadLength,
+    char out[],
+    size_t outLength);
+
+uint16_t frameCrc16(uint16_t crc, const uint8_t *data, size_t length);
+
+#endif /* INC_PROTOCOL_FRAME_H_ */
@@ -13,7 +13,7 @@
 #include "model/cli_model.h"
 #include "model/storage.h"
 
-#define SETTINGS_DEFAULTS_JSON_SIZE 384
+#define SETTINGS_DEFAULTS_JSON_SIZE 640
 #define SETTINGS_METADATA_JSON_SIZE 160
 
 typedef struct SettingsManager {
@@ -26,6 +26,8 @@ bool settingsManagerInit(
 void updateSettings(SettingsManager *manager, ChipSettings *newSettings);
 int getSettingsDefaultsJson(char *buffer, size_t len);
 int getSettingsMetadataJson(char *buffer, size_t len);
+// Builds the writeSettings command that is stored in flash for the given settings.
+int getSettingsCommandJson(const ChipSettings *settings, char *buffer, size_t len);
 int getSettingsResponse(SettingsManager *manager, char *buffer, size_t len);
 
 #endif /* INC_SETTINGS_MANAGER_H_ */
@@ -13,28 +13,46 @@
 #include "mode_manager.h"
 #include "model/log.h"
 #include "model/storage.h"
+#include "model/telemetry.h"
 #include "model/usb.h"
 #include "settings_manager.h"
 
+// usbTask drains every complete line already buffered, up to these limits, so a scripted burst of
+// commands is not paced by the chip tick while a host that never stops sending cannot starve the
+// pattern engine. It also stops once the TX ring could not take another full size response.
+#define USB_TASK_MAX_LINES 8
+#define USB_TASK_BUDGET_MS 20
+
+// Records per readTelemetry response. Either response fits the USB TX ring with room to spare, the
+// host pages through the log with one request per chunk.
+#define USB_TELEMETRY_JSON_RECORDS 48
+#define USB_TELEMETRY_FRAME_RECORDS 128
+
 typedef struct USBManager {
     ModeManager *modeManager;
     SettingsManager *settingsManager;
+    Telemetry *telemetry;
     void (*enterDFU)();
     SaveSettings saveSettings;
     SaveMode saveMode;
     UsbReadTask usbReadTask;
     UsbWrite usbWrite;
+    UsbTxFree usbTxFree;
+    CurrentMilliseconds currentMilliseconds;
 } USBManager;
 
 bool usbInit(
     USBManager *usbManager,
     ModeManager *modeManager,
     SettingsManager *settingsManager,
+    Telemetry *telemetry,
     void (*enterDFU)(),
     SaveSettings saveSettings,
     SaveMode saveMode,
     UsbReadTask usbReadTask,
-    UsbWrite usbWrite);
+    UsbWrite usbWrite,
+    UsbTxFree usbTxFree,
+    CurrentMilliseconds currentMilliseconds);
 
 void usbTask(USBManager *usbManager);
 
@@ -53,8 +53,11 @@ void PendSV_Handler(void);
 void SysTick_Handler(void);
 void RTC_IRQHandler(void);
 void EXTI4_15_IRQHandler(void);
+void TIM1_BRK_UP_TRG_COM_IRQHandler(void);
 void TIM2_IRQHandler(void);
+void TIM3_IRQHandler(void);
 void TIM17_IRQHandler(void);
+void I2C1_IRQHandler(void);
 /* USER CODE BEGIN EFP */
 
 /* USER CODE END EFP */
@@ -12,12 +12,27 @@
 #include <stddef.h>
 #include <stdint.h>
 
+// Outgoing bytes wait here until the vendor TX FIFO has room. Every response is built in the
+// shared JSON buffer, so the ring has to be at least that large or the biggest never fits, see
+// usbReadTask. RAM keeps it from being larger.
+#define USB_TX_RING_SIZE 2048
+
+// Queues buf for transmission and returns without waiting for the host.
 void usbWrite(const char *buf, size_t count);
 
-// returns bytes read if a buffer has read in a full line terminated by \n, 0 otherwise.
+// Bytes the TX ring can still take without dropping a message.
+size_t usbTxFree(void);
+
+// Moves queued bytes into the vendor FIFO. Called from the main loop and on TX completion.
+void usbWriteTask(void);
+
+// returns bytes read if a buffer has read in a full line terminated by \n, 0 otherwise. No line
+// is taken while the TX ring has less than bufferLength free, the response might not fit.
+// bufferLength is the largest response a line can produce, a readMode of a full stored mode.
 int32_t usbReadTask(char usbBuffer[], size_t bufferLength);
 
 #ifdef UNIT_TEST
+void usbWriteReset(void);
 void usbReadTaskReset(void);
 #endif
 
@@ -74,3 +74,27 @@ void writeStringToFlash(uint32_t page, const char str[], size_t length) {
 
     HAL_FLASH_Lock();
 }
+
+void eraseFlashPage(uint32_t page) {
+    memoryPageErase(page);
+}
+
+void writeBytesToFlash(uint32_t page, uint32_t offset, const uint8_t data[], size_t length) {
+    uint32_t address = getHexAddressOfPage(page) + offset;
+
+    HAL_FLASH_Unlock();
+    for (size_t i = 0; i + 8 <= length; i += 8) {
+        uint64_t doubleWord;
+        memcpy(&doubleWord, &data[i], sizeof(doubleWord));
+
+        __disable_irq();
+        HAL_FLASH_Program(TYPEPROGRAM_DOUBLEWORD, address + i, doubleWord);
+        __enable_irq();
+    }
+    HAL_FLASH_Lock();
+}
+
+void readBytesFromFlash(uint32_t page, uint32_t offset, uint8_t buffer[], size_t length) {
+    uint32_t address = getHexAddressOfPage(page) + offset;
+    memcpy(buffer, (const void *)(uintptr_t)address, length);
+}
@@ -119,29 +119,43 @@ int main(void) {
     // TIM3: front rgb led timer - no interrupts
     // TIM17: autoOff timer - interrupts very infrequently when in fake off mode to check time
     static char mainJsonBuffer[PAGE_SECTOR];
+    _Static_assert(
+        sizeof(mainJsonBuffer) <= USB_TX_RING_SIZE, "the TX ring must hold a full response");
     MicroLightDependencies deps = {
-        .i2cWriteRegister = i2cWriteRegister,
-        .i2cReadRegisters = i2cReadRegisters,
+        .i2cStartRead = i2cStartRead,
+        .i2cStartWrite = i2cStartWrite,
+        .i2cAbort = i2cAbort,
+        .i2cMilliseconds = i2cMilliseconds,
         .writeRgbPwmCaseLed = writeRgbPwmCaseLed,
         .writeRgbPwmFrontLed = writeRgbPwmFrontLed,
+        .enableCaseLedDither = enableCaseLedDither,
+        .enableFrontLedDither = enableFrontLedDither,
         .writeBulbLed = writeBulbLed,
         .readButtonPin = readButtonPin,
+        .buttonMilliseconds = rtcMilliseconds,
         .usbReadTask = usbReadTask,
         .usbWrite = usbWrite,
+        .usbTxFree = usbTxFree,
         .readSavedSettings = readSettingsFromFlash,
         .saveSettings = writeSettingsToFlash,
         .readSavedMode = readModeFromFlash,
         .saveMode = writeModeToFlash,
+        .eraseTelemetryPage = eraseTelemetryPage,
+        .writeTelemetry = writeTelemetryToFlash,
+        .readTelemetry = readTelemetryFromFlash,
         .enableChipTickTimer = enableChipTickTimer,
         .enableCaseLedTimer = enableCaseLedTimer,
         .enableFrontLedTimer = enableFrontLedTimer,
         .enableAutoOffTimer = enableAutoOffTimer,
         .enableUsbClock = enableUsbClock,
+        .enableLowPowerClock = enableLowPowerClock,
         .enterStandbyMode = enterStandbyMode,
         .waitForButtonWakeOrAutoLock = waitForButtonWakeOrAutoLock,
+        .enterStopModeForMilliseconds = enterStopModeForMilliseconds,
         .systemReset = NVIC_SystemReset,
         .enterDFU = setBootloaderFlagAndReset,
         .convertTicksToMilliseconds = convertTicksToMilliseconds,
+        .rtcMilliseconds = rtcMilliseconds,
         .rgbTimerPeriod = htim1.Init.Period,
         .jsonBuffer = mainJsonBuffer,
         .jsonBufferSize = sizeof(mainJsonBuffer)};
@@ -161,6 +175,7 @@ int main(void) {
 
     while (1) {
         microLightTask();
+        usbWriteTask();
 
         HAL_SuspendTick();
         HAL_PWR_EnterSLEEPMode(PWR_MAINREGULATOR_ON, PWR_SLEEPENTRY_WFI);
@@ -583,11 +598,17 @@ static void MX_GPIO_Init(void) {
     /*Configure GPIO pin Output Level */
     HAL_GPIO_WritePin(bulbLed_GPIO_Port, bulbLed_Pin, GPIO_PIN_RESET);
 
-    /*Configure GPIO pins : button_Pin chargerIT_Pin */
-    GPIO_InitStruct.Pin = button_Pin | chargerIT_Pin;
+    /*Configure GPIO pin : button_Pin */
+    GPIO_InitStruct.Pin = button_Pin;
+    GPIO_InitStruct.Mode = GPIO_MODE_IT_RISING_FALLING;
+    GPIO_InitStruct.Pull = GPIO_NOPULL;
+    HAL_GPIO_Init(button_GPIO_Port, &GPIO_InitStruct);
+
+    /*Configure GPIO pin : chargerIT_Pin */
+    GPIO_InitStruct.Pin = chargerIT_Pin;
     GPIO_InitStruct.Mode = GPIO_MODE_IT_FALLING;
     GPIO_InitStruct.Pull = GPIO_NOPULL;
-    HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
+    HAL_GPIO_Init(chargerIT_GPIO_Port, &GPIO_InitStruct);
 
     /*Configure GPIO pin : bulbLed_Pin */
     GPIO_InitStruct.Pin = bulbLed_Pin;
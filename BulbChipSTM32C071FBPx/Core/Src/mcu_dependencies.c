@@ -17,8 +17,9 @@ extern TIM_HandleTypeDef htim3;
 extern TIM_HandleTypeDef htim17;
 extern void SystemClock_Config(void);
 
-#define SETTINGS_PAGE 56  // 2K flash reserved for settings starting at page 56
-#define BULB_PAGE_0 57    // 14K flash reserved for bulb modes starting at page 57
+#define TELEMETRY_PAGE_0 54  // 4K flash reserved for the telemetry ring at pages 54 and 55
+#define SETTINGS_PAGE 56     // 2K flash reserved for settings starting at page 56
+#define BULB_PAGE_0 57       // 14K flash reserved for bulb modes starting at page 57
 
 // fBlue pin is shared between GPIO (bulb) and AF (TIM3 PWM) modes.
 // Read the hardware MODER register to detect current pin configuration
@@ -30,20 +31,99 @@ extern void SystemClock_Config(void);
 
 #define I2C_TIMING_48MHZ 0x10805D88U
 #define I2C_TIMING_12MHZ 0x00402D41U
+// 100 kHz from a 3 MHz I2CCLK: SCLL 17 and SCLH 12 cycles of 333 ns, SCLDEL 2 cycles
+#define I2C_TIMING_3MHZ 0x00100B10U
+// about the length of a FIFO burst read at 100 kHz on the slowest clock
+#define I2C_READY_SPIN_LIMIT 20000U
 
 // PWM timer prescaler values to maintain ~8 kHz PWM across clock speeds.
 // 12 MHz / (2+1) / (500+1) ≈ 7984 Hz
 // 48 MHz / (11+1) / (500+1) ≈ 7984 Hz
+// 3 MHz has no integer prescaler for 8 kHz, PWM is never started at that clock speed.
+#define PWM_PRESCALER_3MHZ 0U
 #define PWM_PRESCALER_12MHZ 2U
 #define PWM_PRESCALER_48MHZ 11U
 
+// Chip tick (TIM2) held at ~1.25 ms across clock speeds.
+// 12 MHz / (0+1) / (15000+1), the MX_TIM2_Init values
+// 48 MHz / (3+1) / (15000+1)
+// 3 MHz / (0+1) / (3749+1)
+#define CHIP_TICK_PRESCALER_12MHZ 0U
+#define CHIP_TICK_PRESCALER_48MHZ 3U
+#define CHIP_TICK_PERIOD_12MHZ 15000U
+#define CHIP_TICK_PERIOD_3MHZ 3749U
+
+// Auto off timer (TIM17) held at 0.1 hz.
+// 12 MHz / (1874+1) / (63999+1), the MX_TIM17_Init values
+// 3 MHz / (1874+1) / (15999+1)
+// Left as is at 48 MHz, auto off never counts while USB is powered.
+#define AUTO_OFF_PERIOD_12MHZ 63999U
+#define AUTO_OFF_PERIOD_3MHZ 15999U
+
 #define BUTTON_WAKEUP_PIN PWR_WAKEUP_PIN2_LOW
 #define BUTTON_WAKEUP_PIN_MASK PWR_WAKEUP_PIN2
 #define BUTTON_WAKEUP_FLAG PWR_FLAG_WUF2
 
-// Cached tick-to-millisecond multiplier (file scope so enableUsbClock can invalidate it)
+// Cached tick-to-millisecond multiplier (file scope so clock changes can invalidate it)
 static uint32_t tickMultiplier = 0;
 
+// The RTC shadow registers are out of date. Set on every way into Stop mode and cleared by the
+// first read after the wake, which can be the button interrupt that woke the chip, running before
+// the code after the WFI.
+static volatile bool rtcShadowStale = false;
+
+// SYSCLK levels, in increasing clock speed
+typedef enum { CLOCK_LEVEL_LOW, CLOCK_LEVEL_NORMAL, CLOCK_LEVEL_USB } ClockLevel;
+
+typedef struct {
+    uint32_t hsiDivider;
+    uint32_t flashLatency;
+    uint32_t i2cTiming;
+    uint32_t pwmPrescaler;
+    uint32_t chipTickPrescaler;
+    uint32_t chipTickPeriod;
+    uint32_t autoOffPeriod;
+} ClockProfile;
+
+static const ClockProfile clockProfiles[] = {
+    [CLOCK_LEVEL_LOW] =
+        {
+            .hsiDivider = RCC_HSI_DIV16,
+            .flashLatency = FLASH_LATENCY_0,
+            .i2cTiming = I2C_TIMING_3MHZ,
+            .pwmPrescaler = PWM_PRESCALER_3MHZ,
+            .chipTickPrescaler = CHIP_TICK_PRESCALER_12MHZ,
+            .chipTickPeriod = CHIP_TICK_PERIOD_3MHZ,
+            .autoOffPeriod = AUTO_OFF_PERIOD_3MHZ,
+        },
+    [CLOCK_LEVEL_NORMAL] =
+        {
+            .hsiDivider = RCC_HSI_DIV4,
+            .flashLatency = FLASH_LATENCY_0,
+            .i2cTiming = I2C_TIMING_12MHZ,
+            .pwmPrescaler = PWM_PRESCALER_12MHZ,
+            .chipTickPrescaler = CHIP_TICK_PRESCALER_12MHZ,
+            .chipTickPeriod = CHIP_TICK_PERIOD_12MHZ,
+            .autoOffPeriod = AUTO_OFF_PERIOD_12MHZ,
+        },
+    [CLOCK_LEVEL_USB] =
+        {
+            .hsiDivider = RCC_HSI_DIV1,
+            .flashLatency = FLASH_LATENCY_1,
+            .i2cTiming = I2C_TIMING_48MHZ,
+            .pwmPrescaler = PWM_PRESCALER_48MHZ,
+            .chipTickPrescaler = CHIP_TICK_PRESCALER_48MHZ,
+            .chipTickPeriod = CHIP_TICK_PERIOD_12MHZ,
+            .autoOffPeriod = AUTO_OFF_PERIOD_12MHZ,
+        },
+};
+
+// SystemClock_Config starts at 12 MHz
+static ClockLevel clockLevel = CLOCK_LEVEL_NORMAL;
+static bool usbClockRequested = false;
+static bool lowPowerClockRequested = false;
+static bool fullSpeedClockHeld = false;
+
 static bool requireHalOk(HAL_StatusTypeDef status) {
     if (status != HAL_OK) {
         Error_Handler();
@@ -135,23 +215,35 @@ static void configureFrontBluePwm(void) {
     HAL_GPIO_Init(fBlue_GPIO_Port, &GPIO_InitStruct);
 }
 
+// Starts a write of consecutive registers. Completion arrives through HAL_I2C_MemTxCpltCallback
+// or HAL_I2C_ErrorCallback, `data` has to stay valid until then.
 // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
-bool i2cWriteRegister(uint8_t devAddress, uint8_t reg, uint8_t value) {
-    HAL_StatusTypeDef status =
-        HAL_I2C_Mem_Write(&hi2c1, devAddress, reg, I2C_MEMADD_SIZE_8BIT, &value, 1, 1000);
+bool i2cStartWrite(uint8_t devAddress, uint8_t startReg, const uint8_t *data, size_t len) {
+    HAL_StatusTypeDef status = HAL_I2C_Mem_Write_IT(
+        &hi2c1, devAddress, startReg, I2C_MEMADD_SIZE_8BIT, (uint8_t *)data, (uint16_t)len);
 
     return status == HAL_OK;
 }
 
-// Read multiple consecutive registers. Used with MC3479 (for efficient axis reads)
+// Starts a read of consecutive registers. Used with MC3479 (for efficient FIFO reads)
 // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
-bool i2cReadRegisters(uint8_t devAddress, uint8_t startReg, uint8_t *buf, size_t len) {
-    HAL_StatusTypeDef status =
-        HAL_I2C_Mem_Read(&hi2c1, devAddress, startReg, I2C_MEMADD_SIZE_8BIT, buf, len, 1000);
+bool i2cStartRead(uint8_t devAddress, uint8_t startReg, uint8_t *buf, size_t len) {
+    HAL_StatusTypeDef status = HAL_I2C_Mem_Read_IT(
+        &hi2c1, devAddress, startReg, I2C_MEMADD_SIZE_8BIT, buf, (uint16_t)len);
 
     return status == HAL_OK;
 }
 
+void i2cAbort(void) {
+    // a stuck transfer leaves the handle busy, re-init is the only way the HAL lets go of it
+    HAL_I2C_DeInit(&hi2c1);
+    HAL_I2C_Init(&hi2c1);
+}
+
+uint32_t i2cMilliseconds(void) {
+    return HAL_GetTick();
+}
+
 // NOLINTNEXTLINE(bugprone-easily-swappable-parameters)
 void writeRgbPwmCaseLed(uint16_t redDuty, uint16_t greenDuty, uint16_t blueDuty) {
     TIM1->CCR1 = redDuty;
@@ -166,6 +258,26 @@ void writeRgbPwmFrontLed(uint16_t redDuty, uint16_t greenDuty, uint16_t blueDuty
     TIM3->CCR4 = blueDuty;
 }
 
+// Update interrupt at the start of each PWM period, rgbDitherUpdate loads the next duty into the
+// preloaded compare registers.
+void enableCaseLedDither(bool enable) {
+    if (enable) {
+        __HAL_TIM_CLEAR_FLAG(&htim1, TIM_FLAG_UPDATE);
+        __HAL_TIM_ENABLE_IT(&htim1, TIM_IT_UPDATE);
+    } else {
+        __HAL_TIM_DISABLE_IT(&htim1, TIM_IT_UPDATE);
+    }
+}
+
+void enableFrontLedDither(bool enable) {
+    if (enable) {
+        __HAL_TIM_CLEAR_FLAG(&htim3, TIM_FLAG_UPDATE);
+        __HAL_TIM_ENABLE_IT(&htim3, TIM_IT_UPDATE);
+    } else {
+        __HAL_TIM_DISABLE_IT(&htim3, TIM_IT_UPDATE);
+    }
+}
+
 uint8_t readButtonPin(void) {
     GPIO_PinState state = HAL_GPIO_ReadPin(button_GPIO_Port, button_Pin);
     if (state == GPIO_PIN_RESET) {
@@ -230,6 +342,71 @@ void enableFrontLedTimer(bool enable) {
     }
 }
 
+static ClockLevel requestedClockLevel(void) {
+    if (usbClockRequested) {
+        return CLOCK_LEVEL_USB;
+    }
+    if (lowPowerClockRequested && !fullSpeedClockHeld) {
+        return CLOCK_LEVEL_LOW;
+    }
+    return CLOCK_LEVEL_NORMAL;
+}
+
+// ARR is not preloaded, so move the count in flight to the same fraction of the new period. This
+// keeps the tick in progress the same length and the counter from running past the new reload.
+static void rescaleTimerPeriod(TIM_HandleTypeDef *htim, uint32_t period) {
+    uint32_t oldPeriod = __HAL_TIM_GET_AUTORELOAD(htim);
+    if (period == oldPeriod) {
+        return;
+    }
+    uint64_t counter = (uint64_t)__HAL_TIM_GET_COUNTER(htim) * (period + 1U) / (oldPeriod + 1U);
+    __HAL_TIM_SET_COUNTER(htim, (uint32_t)counter);
+    __HAL_TIM_SET_AUTORELOAD(htim, period);
+}
+
+static void applyClockLevel(ClockLevel level) {
+    if (level == clockLevel) {
+        return;
+    }
+    const ClockProfile *profile = &clockProfiles[level];
+
+    // Increase flash latency before raising clock speed, reduce clock speed before lowering it.
+    if (level > clockLevel) {
+        __HAL_FLASH_SET_LATENCY(profile->flashLatency);
+        MODIFY_REG(RCC->CR, RCC_CR_HSIDIV, profile->hsiDivider);
+    } else {
+        MODIFY_REG(RCC->CR, RCC_CR_HSIDIV, profile->hsiDivider);
+        __HAL_FLASH_SET_LATENCY(profile->flashLatency);
+    }
+    SystemCoreClockUpdate();
+    HAL_InitTick(uwTickPrio);
+    tickMultiplier = 0;
+
+    // let a queued transfer finish before the peripheral is re-initialised under it, the I2C
+    // clock was already scaled with SYSCLK so worst case it finishes slowly
+    for (uint32_t spin = 0; spin < I2C_READY_SPIN_LIMIT; spin++) {
+        if (HAL_I2C_GetState(&hi2c1) == HAL_I2C_STATE_READY) {
+            break;
+        }
+    }
+    hi2c1.Init.Timing = profile->i2cTiming;
+    HAL_I2C_Init(&hi2c1);
+
+    // Scale PWM prescaler to keep frequency constant at ~8 kHz.
+    // PSC is shadow-registered: new value loads at next counter overflow (glitch-free).
+    __HAL_TIM_SET_PRESCALER(&htim1, profile->pwmPrescaler);
+    __HAL_TIM_SET_PRESCALER(&htim3, profile->pwmPrescaler);
+
+    // Keep the chip tick and auto off rates. calculateTickMultiplier reads the chip tick timing
+    // from Init, which __HAL_TIM_SET_PRESCALER does not update.
+    __HAL_TIM_SET_PRESCALER(&htim2, profile->chipTickPrescaler);
+    htim2.Init.Prescaler = profile->chipTickPrescaler;
+    rescaleTimerPeriod(&htim2, profile->chipTickPeriod);
+    rescaleTimerPeriod(&htim17, profile->autoOffPeriod);
+
+    clockLevel = level;
+}
+
 void enableUsbClock(bool enable) {
     if (enable) {
         __HAL_RCC_HSI48_ENABLE();
@@ -240,39 +417,16 @@ void enableUsbClock(bool enable) {
         __HAL_RCC_USB_CLK_ENABLE();
 
         // Boost SYSCLK to 48 MHz for faster USB enumeration.
-        // Increase flash latency before raising clock speed.
-        __HAL_FLASH_SET_LATENCY(FLASH_LATENCY_1);
-        MODIFY_REG(RCC->CR, RCC_CR_HSIDIV, RCC_HSI_DIV1);
-        SystemCoreClockUpdate();
-        HAL_InitTick(uwTickPrio);
-        tickMultiplier = 0;
-
-        hi2c1.Init.Timing = I2C_TIMING_48MHZ;
-        HAL_I2C_Init(&hi2c1);
-
-        // Scale PWM prescaler to keep frequency constant at ~8 kHz.
-        // PSC is shadow-registered: new value loads at next counter overflow (glitch-free).
-        __HAL_TIM_SET_PRESCALER(&htim1, PWM_PRESCALER_48MHZ);
-        __HAL_TIM_SET_PRESCALER(&htim3, PWM_PRESCALER_48MHZ);
+        usbClockRequested = true;
+        applyClockLevel(requestedClockLevel());
 
         tud_connect();
     } else {
         tud_disconnect();
 
-        // Drop SYSCLK back to 12 MHz to save power.
-        // Reduce clock speed before lowering flash latency.
-        MODIFY_REG(RCC->CR, RCC_CR_HSIDIV, RCC_HSI_DIV4);
-        __HAL_FLASH_SET_LATENCY(FLASH_LATENCY_0);
-        SystemCoreClockUpdate();
-        HAL_InitTick(uwTickPrio);
-        tickMultiplier = 0;
-
-        hi2c1.Init.Timing = I2C_TIMING_12MHZ;
-        HAL_I2C_Init(&hi2c1);
-
-        // Restore PWM prescaler for 12 MHz clock speed.
-        __HAL_TIM_SET_PRESCALER(&htim1, PWM_PRESCALER_12MHZ);
-        __HAL_TIM_SET_PRESCALER(&htim3, PWM_PRESCALER_12MHZ);
+        // Drop SYSCLK back to 12 MHz, or lower if requested, to save power.
+        usbClockRequested = false;
+        applyClockLevel(requestedClockLevel());
 
         __HAL_RCC_USB_CLK_DISABLE();
         CRS->CR &= ~(CRS_CR_AUTOTRIMEN | CRS_CR_CEN);
@@ -281,6 +435,11 @@ void enableUsbClock(bool enable) {
     }
 }
 
+void enableLowPowerClock(bool enable) {
+    lowPowerClockRequested = enable;
+    applyClockLevel(requestedClockLevel());
+}
+
 void enableAutoOffTimer(bool enable) {
     if (enable) {
         HAL_TIM_Base_Start_IT(&htim17);
@@ -313,6 +472,7 @@ void enterStopModeWithRtcAlarm(uint16_t wakeIntervalSeconds) {
     }
 
     HAL_SuspendTick();
+    rtcShadowStale = true;
     HAL_PWR_EnterSTOPMode(PWR_MAINREGULATOR_ON, PWR_STOPENTRY_WFI);
     SystemClock_Config();
     HAL_ResumeTick();
@@ -342,6 +502,180 @@ bool waitForButtonWakeOrAutoLock(uint16_t lockThresholdMinutes) {
     return wasWakeFromButton();
 }
 
+// Until the next RTCCLK edge copies the counters over, the calendar shadow registers still hold
+// the time Stop mode began. Clearing RSF and waiting for it to set again makes the next read
+// current. RSF sits in ICSR, which is write protected.
+static bool resyncRtcShadowRegisters(void) {
+    __HAL_RTC_WRITEPROTECTION_DISABLE(&hrtc);
+    HAL_StatusTypeDef status = HAL_RTC_WaitForSynchro(&hrtc);
+    __HAL_RTC_WRITEPROTECTION_ENABLE(&hrtc);
+    return requireHalOk(status);
+}
+
+// RTC time of day in sub second counts. Counts tick at LSI / (AsynchPrediv + 1), every 4 ms.
+static bool readRtcCounts(uint32_t *counts) {
+    RTC_TimeTypeDef currentTime = {0};
+    RTC_DateTypeDef currentDate = {0};
+
+    if (rtcShadowStale) {
+        if (!resyncRtcShadowRegisters()) {
+            return false;
+        }
+        rtcShadowStale = false;
+    }
+
+    // reading the date unlocks the shadow registers latched by reading the time
+    if (!requireHalOk(HAL_RTC_GetTime(&hrtc, &currentTime, RTC_FORMAT_BIN)) ||
+        !requireHalOk(HAL_RTC_GetDate(&hrtc, &currentDate, RTC_FORMAT_BIN))) {
+        return false;
+    }
+
+    uint32_t seconds = (uint32_t)currentTime.Hours * 3600U + (uint32_t)currentTime.Minutes * 60U +
+                       (uint32_t)currentTime.Seconds;
+    *counts = seconds * (hrtc.Init.SynchPrediv + 1U) +
+              (hrtc.Init.SynchPrediv - currentTime.SubSeconds);
+    return true;
+}
+
+static uint32_t rtcCountsPerDay(void) {
+    return 86400U * (hrtc.Init.SynchPrediv + 1U);
+}
+
+static uint32_t rtcCountsToMilliseconds(uint32_t counts) {
+    uint32_t prescaler = hrtc.Init.AsynchPrediv + 1U;
+    return (uint32_t)(((uint64_t)counts * prescaler * 1000U) / LSI_VALUE);
+}
+
+static bool scheduleRtcAlarmAtCounts(uint32_t counts) {
+    RTC_AlarmTypeDef alarm = {0};
+    uint32_t countsPerSecond = hrtc.Init.SynchPrediv + 1U;
+    uint32_t seconds = (counts % rtcCountsPerDay()) / countsPerSecond;
+
+    alarm.AlarmTime.Hours = (uint8_t)(seconds / 3600U);
+    alarm.AlarmTime.Minutes = (uint8_t)((seconds % 3600U) / 60U);
+    alarm.AlarmTime.Seconds = (uint8_t)(seconds % 60U);
+    alarm.AlarmTime.SubSeconds = hrtc.Init.SynchPrediv - (counts % countsPerSecond);
+    alarm.AlarmTime.DayLightSaving = RTC_DAYLIGHTSAVING_NONE;
+    alarm.AlarmTime.StoreOperation = RTC_STOREOPERATION_RESET;
+    // deadlines are always under a day away, the time of day alone identifies them
+    alarm.AlarmMask = RTC_ALARMMASK_DATEWEEKDAY;
+    alarm.AlarmSubSecondMask = RTC_ALARMSUBSECONDMASK_NONE;
+    alarm.AlarmDateWeekDaySel = RTC_ALARMDATEWEEKDAYSEL_DATE;
+    alarm.AlarmDateWeekDay = 1;
+    alarm.Alarm = RTC_ALARM_A;
+
+    if (!requireHalOk(HAL_RTC_DeactivateAlarm(&hrtc, RTC_ALARM_A))) {
+        return false;
+    }
+    __HAL_RTC_ALARM_CLEAR_FLAG(&hrtc, RTC_FLAG_ALRAF);
+    return requireHalOk(HAL_RTC_SetAlarm_IT(&hrtc, &alarm, RTC_FORMAT_BIN));
+}
+
+// TIM17 is halted in Stop mode. Move it on by the time slept so auto off still fires on schedule,
+// raising the update interrupt the same way an overflow would when the slept time crossed one.
+static void advanceAutoOffTimer(uint32_t milliseconds) {
+    if ((htim17.Instance->CR1 & TIM_CR1_CEN) == 0U) {
+        return;
+    }
+
+    uint64_t countsPerSecond = HAL_RCC_GetPCLK1Freq() / (htim17.Init.Prescaler + 1U);
+    uint32_t period = __HAL_TIM_GET_AUTORELOAD(&htim17) + 1U;
+    uint64_t counter =
+        __HAL_TIM_GET_COUNTER(&htim17) + (uint64_t)milliseconds * countsPerSecond / 1000U;
+    if (counter >= period) {
+        // UG also clears the counter, so set the remainder afterwards
+        HAL_TIM_GenerateEvent(&htim17, TIM_EVENTSOURCE_UPDATE);
+        counter %= period;
+    }
+    __HAL_TIM_SET_COUNTER(&htim17, (uint32_t)counter);
+}
+
+uint32_t enterStopModeForMilliseconds(uint32_t milliseconds) {
+    uint32_t prescaler = hrtc.Init.AsynchPrediv + 1U;
+    uint32_t counts = (uint32_t)(((uint64_t)milliseconds * LSI_VALUE) / (prescaler * 1000U));
+    if (counts == 0U) {
+        return 0U;
+    }
+
+    uint32_t startCounts;
+    if (!readRtcCounts(&startCounts) || !scheduleRtcAlarmAtCounts(startCounts + counts)) {
+        return 0U;
+    }
+
+    HAL_SuspendTick();
+    rtcShadowStale = true;
+    HAL_PWR_EnterSTOPMode(PWR_MAINREGULATOR_ON, PWR_STOPENTRY_WFI);
+
+    // Stop mode only ever runs with USB off. SystemClock_Config restores 12 MHz but also starts
+    // HSI48 which stays off here. Timers and I2C kept their setup, return to the divider they
+    // were set up for.
+    SystemClock_Config();
+    __HAL_RCC_HSI48_DISABLE();
+    if (clockLevel != CLOCK_LEVEL_NORMAL) {
+        MODIFY_REG(RCC->CR, RCC_CR_HSIDIV, clockProfiles[clockLevel].hsiDivider);
+        SystemCoreClockUpdate();
+        HAL_InitTick(uwTickPrio);
+    }
+    tickMultiplier = 0;
+    HAL_ResumeTick();
+
+    uint32_t endCounts = startCounts;
+    readRtcCounts(&endCounts);
+    if (!requireHalOk(HAL_RTC_DeactivateAlarm(&hrtc, RTC_ALARM_A))) {
+        return 0U;
+    }
+    __HAL_RTC_ALARM_CLEAR_FLAG(&hrtc, RTC_FLAG_ALRAF);
+
+    uint32_t sleptCounts = (endCounts + rtcCountsPerDay() - startCounts) % rtcCountsPerDay();
+    uint32_t sleptMilliseconds = rtcCountsToMilliseconds(sleptCounts);
+    advanceAutoOffTimer(sleptMilliseconds);
+    return sleptMilliseconds;
+}
+
+// RTC counts since the first read. The time of day wraps daily, so only the deltas are added up.
+static bool rtcClockStarted = false;
+static uint32_t rtcLastCounts = 0;
+static uint32_t rtcElapsedCounts = 0;
+// bumped by every stored read, tells a read that was interrupted by another one to start over
+static volatile uint32_t rtcReadSequence = 0;
+
+/**
+ * Millisecond clock that keeps counting in Stop mode, while the chip tick is off and across clock
+ * changes, at the RTC resolution of 4 ms. Read from the button interrupt as well as the main loop,
+ * where microlight trims it against the chip tick. Reads have to be less than a day apart, a
+ * longer gap loses the whole days in between.
+ *
+ * The RTC is read with interrupts on, the shadow resync times out on HAL_GetTick. Only storing the
+ * read is a critical section, and it restores PRIMASK so callers may already hold one.
+ */
+uint32_t rtcMilliseconds(void) {
+    for (;;) {
+        uint32_t sequence = rtcReadSequence;
+        uint32_t counts;
+        bool read = readRtcCounts(&counts);
+
+        uint32_t primask = __get_PRIMASK();
+        __disable_irq();
+        if (sequence != rtcReadSequence) {
+            // an interrupt stored a later read meanwhile, storing this one would step back a day
+            __set_PRIMASK(primask);
+            continue;
+        }
+        if (read) {
+            if (rtcClockStarted) {
+                rtcElapsedCounts +=
+                    (counts + rtcCountsPerDay() - rtcLastCounts) % rtcCountsPerDay();
+            }
+            rtcClockStarted = true;
+            rtcLastCounts = counts;
+            rtcReadSequence++;
+        }
+        uint32_t milliseconds = rtcCountsToMilliseconds(rtcElapsedCounts);
+        __set_PRIMASK(primask);
+        return milliseconds;
+    }
+}
+
 static uint32_t calculateTickMultiplier(void) {
     RCC_ClkInitTypeDef clkConfig;
     uint32_t flashLatency;
@@ -374,6 +708,12 @@ static uint32_t calculateTickMultiplier(void) {
     return (uint32_t)(numerator / timerClock);
 }
 
+// Tick and millisecond counts the conversion continues from after a clock change
+static uint32_t rebaseTicks = 0;
+static uint32_t rebaseMilliseconds = 0;
+static uint32_t lastTicks = 0;
+static uint32_t lastMilliseconds = 0;
+
 /**
  * @brief Converts chip ticks to milliseconds using fixed-point arithmetic optimization.
  *
@@ -395,16 +735,38 @@ static uint32_t calculateTickMultiplier(void) {
  *   We use uint64_t for the intermediate multiplication to prevent overflow before the shift.
  *   2^20 is chosen to provide sufficient precision while keeping the multiplier within uint32_t
  *   (assuming millisecondsPerTick < ~4000ms) and the intermediate result within uint64_t.
+ *
+ *   The tick rate can change with the clock speed. Whenever the multiplier is invalidated the
+ *   conversion is rebased on the last result, so the new rate only applies to ticks counted
+ *   afterwards and milliseconds stay continuous across clock changes.
  */
 uint32_t convertTicksToMilliseconds(uint32_t ticks) {
     if (tickMultiplier == 0) {
         tickMultiplier = calculateTickMultiplier();
+        rebaseTicks = lastTicks;
+        rebaseMilliseconds = lastMilliseconds;
     }
-    return (uint32_t)(((uint64_t)ticks * tickMultiplier) >> 20);
+    lastTicks = ticks;
+    lastMilliseconds =
+        rebaseMilliseconds + (uint32_t)(((uint64_t)(ticks - rebaseTicks) * tickMultiplier) >> 20);
+    return lastMilliseconds;
+}
+
+// Programming polls the flash with interrupts held off per double word, which takes 4x longer at
+// the low power clock. Writes are rare, run them at 12 MHz or above.
+static void holdFullSpeedClockForFlash(bool hold) {
+    fullSpeedClockHeld = hold;
+    applyClockLevel(requestedClockLevel());
+}
+
+static void writeStringToFlashAtFullSpeed(uint32_t page, const char str[], size_t length) {
+    holdFullSpeedClockForFlash(true);
+    writeStringToFlash(page, str, length);
+    holdFullSpeedClockForFlash(false);
 }
 
 void writeSettingsToFlash(const char str[], size_t length) {
-    writeStringToFlash(SETTINGS_PAGE, str, length);
+    writeStringToFlashAtFullSpeed(SETTINGS_PAGE, str, length);
 }
 
 void readSettingsFromFlash(char buffer[], size_t length) {
@@ -413,7 +775,7 @@ void readSettingsFromFlash(char buffer[], size_t length) {
 
 void writeModeToFlash(uint8_t mode, const char str[], size_t length) {
     uint32_t page = BULB_PAGE_0 + mode;
-    writeStringToFlash(page, str, length);
+    writeStringToFlashAtFullSpeed(page, str, length);
 }
 
 void readModeFromFlash(uint8_t mode, char buffer[], size_t length) {
@@ -421,6 +783,22 @@ void readModeFromFlash(uint8_t mode, char buffer[], size_t length) {
     readStringFromFlash(page, buffer, length);
 }
 
+void eraseTelemetryPage(uint8_t page) {
+    holdFullSpeedClockForFlash(true);
+    eraseFlashPage(TELEMETRY_PAGE_0 + page);
+    holdFullSpeedClockForFlash(false);
+}
+
+void writeTelemetryToFlash(uint32_t offset, const uint8_t data[], size_t length) {
+    holdFullSpeedClockForFlash(true);
+    writeBytesToFlash(TELEMETRY_PAGE_0, offset, data, length);
+    holdFullSpeedClockForFlash(false);
+}
+
+void readTelemetryFromFlash(uint32_t offset, uint8_t buffer[], size_t length) {
+    readBytesFromFlash(TELEMETRY_PAGE_0, offset, buffer, length);
+}
+
 // Blink case LED white forever using direct register writes.
 // Safe to call from any fault context — requires only that TIM1 is running.
 // Uses a busy-loop delay since HAL/SysTick state cannot be trusted.
@@ -24,20 +24,24 @@ static void syncLedWhiteBalance(ChipState *state);
 
 bool configureChipState(ChipState *state, ChipDependencies deps) {
     if (!state || !deps.modeManager || !deps.settings || !deps.button || !deps.chargerIC ||
-        !deps.accel || !deps.caseLed || !deps.frontLed || !deps.enableChipTickTimer ||
-        !deps.enableCaseLedTimer || !deps.enableFrontLedTimer || !deps.enableAutoOffTimer ||
-        !deps.enableUsbClock || !deps.enterStandbyMode || !deps.waitForButtonWakeOrAutoLock ||
-        !deps.systemReset || !deps.log) {
+        !deps.accel || !deps.i2c || !deps.telemetry || !deps.caseLed || !deps.frontLed ||
+        !deps.enableChipTickTimer || !deps.enableCaseLedTimer || !deps.enableFrontLedTimer ||
+        !deps.enableAutoOffTimer || !deps.enableUsbClock || !deps.enableLowPowerClock ||
+        !deps.enterStandbyMode || !deps.waitForButtonWakeOrAutoLock || !deps.systemReset ||
+        !deps.log) {
         return false;
     }
 
     state->deps = deps;
     state->ticksSinceLastUserActivity = 0;
+    state->lastTaskMs = 0;
     state->lastChipTickEnabled = false;
     state->lastCasePwmEnabled = false;
     state->lastFrontPwmEnabled = false;
+    state->lastLowPowerClockEnabled = false;
     syncLedWhiteBalance(state);
-    enum ChargeState initialChargeState = getChargingState(state->deps.chargerIC, 0);
+    enum ChargeState initialChargeState = getChargingState(state->deps.chargerIC);
+    state->lastChargeState = initialChargeState;
     bool usbNeeded = initialChargeState != notConnected;
     state->lastUsbClockEnabled = usbNeeded;
     state->deps.enableUsbClock(usbNeeded);
@@ -51,6 +55,30 @@ bool configureChipState(ChipState *state, ChipDependencies deps) {
     return true;
 }
 
+static void recordTelemetry(
+    ChipState *state, enum TelemetryEvent event, uint8_t arg, uint16_t value) {
+    telemetryRecord(state->deps.telemetry, (uint8_t)event, arg, value, state->lastTaskMs);
+}
+
+// Ship mode and hardware reset both cut power, the record has to reach flash first
+static void lockCharger(ChipState *state) {
+    recordTelemetry(state, TELEMETRY_EVENT_LOCK, 0, 0);
+    telemetryFlush(state->deps.telemetry);
+    lock(state->deps.chargerIC);
+}
+
+static void recordChargerTelemetry(ChipState *state, enum ChargeState chargeState) {
+    if (chargeState != state->lastChargeState) {
+        recordTelemetry(state, TELEMETRY_EVENT_CHARGE_STATE, (uint8_t)chargeState, 0);
+        state->lastChargeState = chargeState;
+    }
+
+    uint8_t faults = bq25180TakeFaults(state->deps.chargerIC);
+    if (faults != 0) {
+        recordTelemetry(state, TELEMETRY_EVENT_CHARGER_FAULT, 0, faults);
+    }
+}
+
 static void syncLedWhiteBalance(ChipState *state) {
     if (!state || !state->deps.settings) {
         return;
@@ -89,6 +117,7 @@ static bool handleAutoOffTimer(
     bool autoOffTimerDone = state->ticksSinceLastUserActivity > ticksUntilAutoOff;
     if (autoOffTimerDone) {
         state->ticksSinceLastUserActivity = 0;
+        recordTelemetry(state, TELEMETRY_EVENT_AUTO_OFF, 0, 0);
         enterShutdown(state, chargeState);
         return true;
     }
@@ -107,7 +136,7 @@ static void enterShutdown(ChipState *state, enum ChargeState chargeState) {
     if (state->deps.settings->shutdownPolicy == autoOffAndAutoLock) {
         uint16_t lockThresholdMinutes = state->deps.settings->minutesUntilLockAfterAutoOff;
         if (lockThresholdMinutes == 0U) {
-            lock(state->deps.chargerIC);
+            lockCharger(state);
             return;
         }
 
@@ -117,7 +146,7 @@ static void enterShutdown(ChipState *state, enum ChargeState chargeState) {
             return;
         }
 
-        lock(state->deps.chargerIC);
+        lockCharger(state);
         return;
     }
 
@@ -132,6 +161,9 @@ static void prepareForLowPowerShutdown(ChipState *state) {
     // Will be re initialized when the system wakes up
     disableWatchdog(state->deps.chargerIC);
     mc3479Disable(state->deps.accel);
+    // both of the above are queued, they have to reach the bus before the MCU stops
+    i2cQueueFlush(state->deps.i2c);
+    telemetryFlush(state->deps.telemetry);
 
     if (state->lastChipTickEnabled) {
         state->deps.enableChipTickTimer(false);
@@ -152,13 +184,18 @@ static void prepareForLowPowerShutdown(ChipState *state) {
         state->deps.enableUsbClock(false);
         state->lastUsbClockEnabled = false;
     }
+
+    // waking from Stop restores the 12 MHz clock, keep the clock level in step with that
+    if (state->lastLowPowerClockEnabled) {
+        state->deps.enableLowPowerClock(false);
+        state->lastLowPowerClockEnabled = false;
+    }
 }
 
 static void applyTimerPolicy(
     ChipState *state,
     ModeOutputs outputs,
     enum ButtonResult buttonResult,
-    bool evaluatingButtonPress,
     enum ChargeState chargeState) {
     if (!state || !state->deps.modeManager) {
         return;
@@ -179,11 +216,21 @@ static void applyTimerPolicy(
     bool showingFrontStatusIndicator =
         buttonResult == indicateShutdown || buttonResult == indicateLockOrHardwareReset;
 
-    bool chipTickEnabled = !fakeOff || chargeLedEnabled || evaluatingButtonPress;
-    bool casePwmEnabled = chargeLedEnabled || caseRgbActive || evaluatingButtonPress;
+    // The button times a hold from its edges, the chip tick is not needed until an indicator shows.
+    bool chipTickEnabled = !fakeOff || chargeLedEnabled || showingFrontStatusIndicator;
+    // A black case color drops the output, a status flash on top still needs the timer to show.
+    bool casePwmEnabled = chargeLedEnabled || caseRgbActive || showingFrontStatusIndicator ||
+                          rgbLayerActive(state->deps.caseLed, RGB_LAYER_STATUS);
     bool frontPwmEnabled = frontRgbActive || showingFrontStatusIndicator;
     bool usbClockEnabled = chargeState != notConnected;
+    bool lowPowerClockEnabled = !casePwmEnabled && !frontPwmEnabled && !usbClockEnabled &&
+                                !modeNeedsFullSpeedClock(manager);
 
+    // Raise the clock before any PWM timer starts, lower it only once they have all stopped.
+    if (!lowPowerClockEnabled && state->lastLowPowerClockEnabled) {
+        state->deps.enableLowPowerClock(false);
+        state->lastLowPowerClockEnabled = false;
+    }
     if (chipTickEnabled != state->lastChipTickEnabled) {
         state->deps.enableChipTickTimer(chipTickEnabled);
         state->lastChipTickEnabled = chipTickEnabled;
@@ -200,28 +247,40 @@ static void applyTimerPolicy(
         state->deps.enableUsbClock(usbClockEnabled);
         state->lastUsbClockEnabled = usbClockEnabled;
     }
+    if (lowPowerClockEnabled && !state->lastLowPowerClockEnabled) {
+        state->deps.enableLowPowerClock(true);
+        state->lastLowPowerClockEnabled = true;
+    }
 }
 
 void stateTask(ChipState *state, uint32_t milliseconds, StateTaskFlags flags) {
     syncLedWhiteBalance(state);
+    // applies from the next mode switch
+    state->deps.modeManager->crossfadeMs = state->deps.settings->modeCrossfadeMs;
 
-    enum ChargeState chargeState = getChargingState(state->deps.chargerIC, milliseconds);
+    state->lastTaskMs = milliseconds;
+    enum ChargeState chargeState = getChargingState(state->deps.chargerIC);
+    recordChargerTelemetry(state, chargeState);
     if (handleAutoOffTimer(state, flags.autoOffTimerInterruptTriggered, chargeState)) {
         return;
     }
 
-    enum ButtonResult buttonResult =
-        buttonInputTask(state->deps.button, milliseconds, flags.buttonInterruptTriggered);
+    enum ButtonResult buttonResult = buttonInputTask(state->deps.button);
     switch (buttonResult) {
         case ignore:
             break;
         case clicked: {
             rgbShowSuccess(state->deps.caseLed);
+            // a mode script waiting on the button takes the tap instead of the next mode
+            if (modeTakeButtonTap(state->deps.modeManager)) {
+                break;
+            }
             uint8_t newModeIndex = state->deps.modeManager->currentModeIndex + 1;
             if (newModeIndex >= state->deps.settings->modeCount) {
                 newModeIndex = 0;
             }
             loadMode(state->deps.modeManager, newModeIndex);
+            recordTelemetry(state, TELEMETRY_EVENT_MODE_CHANGED, newModeIndex, 0);
             char msg[48];
             int len = snprintf(
                 msg, sizeof(msg), "{\"event\":\"modeChanged\",\"index\":%u}\n", newModeIndex);
@@ -235,6 +294,7 @@ void stateTask(ChipState *state, uint32_t milliseconds, StateTaskFlags flags) {
             rgbShowShutdown(state->deps.caseLed);
             break;
         case shutdown: {
+            recordTelemetry(state, TELEMETRY_EVENT_SHUTDOWN, 0, 0);
             enterShutdown(state, chargeState);
             if (chargeState == notConnected) {
                 return;
@@ -246,7 +306,7 @@ void stateTask(ChipState *state, uint32_t milliseconds, StateTaskFlags flags) {
             rgbShowLocked(state->deps.caseLed);
             break;
         case lockOrHardwareReset:
-            lock(state->deps.chargerIC);
+            lockCharger(state);
             enterShutdown(state, chargeState);
             break;
     }
@@ -255,29 +315,20 @@ void stateTask(ChipState *state, uint32_t milliseconds, StateTaskFlags flags) {
         state->ticksSinceLastUserActivity = 0;
     }
 
-    bool ledsReservedForButton =
-        buttonResult == indicateShutdown || buttonResult == indicateLockOrHardwareReset;
-    bool caseLedReservedForStatus = isFakeOff(state->deps.modeManager);
-    bool allowModeFrontLedUpdates = !ledsReservedForButton;
-    bool allowModeCaseLedUpdates = !ledsReservedForButton && !caseLedReservedForStatus;
+    // the button repeats an indicator every tick of the hold, anything else means it has ended
+    if (buttonResult != indicateShutdown && buttonResult != indicateLockOrHardwareReset) {
+        rgbClearLayer(state->deps.frontLed, RGB_LAYER_INDICATOR);
+        rgbClearLayer(state->deps.caseLed, RGB_LAYER_INDICATOR);
+    }
 
+    // the mode keeps running underneath indicators and charging status, see rgbCompose
+    modeNoteCharging(state->deps.modeManager, chargeState != notConnected);
     ModeOutputs outputs = modeTask(
-        state->deps.modeManager,
-        milliseconds,
-        allowModeFrontLedUpdates,
-        allowModeCaseLedUpdates,
-        state->deps.settings->equationEvalIntervalMs);
+        state->deps.modeManager, milliseconds, state->deps.settings->equationEvalIntervalMs);
 
     bool evaluatingButtonPress = isEvaluatingButtonPress(state->deps.button);
-    applyTimerPolicy(
-        state,
-        outputs,
-        buttonResult,
-        evaluatingButtonPress || flags.buttonInterruptTriggered,
-        chargeState);
-
-    rgbTransientTask(state->deps.frontLed, milliseconds);
-    rgbTransientTask(state->deps.caseLed, milliseconds);
+    applyTimerPolicy(state, outputs, buttonResult, chargeState);
+
     mc3479Task(state->deps.accel, milliseconds);
     chargerTask(
         state->deps.chargerIC,
@@ -288,4 +339,47 @@ void stateTask(ChipState *state, uint32_t milliseconds, StateTaskFlags flags) {
             .chargeLedEnabled = isFakeOff(state->deps.modeManager) && chargeState != notConnected &&
                                 !evaluatingButtonPress,
             .serialEnabled = state->deps.settings->enableChargerSerial});
+
+    // every source has had its say for this tick, drive each LED once
+    rgbCompose(state->deps.frontLed, milliseconds);
+    rgbCompose(state->deps.caseLed, milliseconds);
+}
+
+uint32_t stateIdleBudgetMs(ChipState *state) {
+    if (state->lastCasePwmEnabled || state->lastFrontPwmEnabled || state->lastUsbClockEnabled ||
+        rgbLayerActive(state->deps.caseLed, RGB_LAYER_STATUS) ||
+        rgbLayerActive(state->deps.frontLed, RGB_LAYER_STATUS)) {
+        return 0;
+    }
+
+    // A held button only needs the chip awake again once the hold crosses the next threshold.
+    uint32_t budgetMs = buttonMsUntilNextResult(state->deps.button);
+    if (!state->lastChipTickEnabled) {
+        if (budgetMs == UINT32_MAX) {
+            // nothing is scheduled, sleep until the next interrupt
+            return 0;
+        }
+        // without the chip tick nothing else would wake the chip for the threshold, oversleep
+        // it slightly instead
+        if (budgetMs < STOP_IDLE_MIN_MS) {
+            budgetMs = STOP_IDLE_MIN_MS;
+        }
+        return budgetMs;
+    }
+
+    uint32_t modeMs = modeIdleBudgetMs(state->deps.modeManager);
+    if (modeMs < budgetMs) {
+        budgetMs = modeMs;
+    }
+    uint32_t chargerMs = bq25180MsUntilNextRead(state->deps.chargerIC, state->lastTaskMs);
+    if (chargerMs < budgetMs) {
+        budgetMs = chargerMs;
+    }
+    if (budgetMs < STOP_IDLE_MIN_MS) {
+        return 0;
+    }
+    if (budgetMs > STOP_IDLE_MAX_MS) {
+        budgetMs = STOP_IDLE_MAX_MS;
+    }
+    return budgetMs;
 }
@@ -10,9 +10,23 @@
 #include <stdio.h>
 #include <string.h>
 
+#define REGISTER_BIT(reg) ((uint16_t)(1U << (reg)))
+#define ALL_REGISTERS ((uint16_t)(REGISTER_BIT(BQ25180_REGISTER_COUNT) - 1U))
+// change on their own, refreshed by reads rather than cached forever
+#define STATUS_REGISTERS \
+    (REGISTER_BIT(BQ25180_STAT0) | REGISTER_BIT(BQ25180_STAT1) | REGISTER_BIT(BQ25180_FLAG0))
+// SHIP_RST holds self clearing action bits, every write is a command and it is never part of a
+// burst or skipped as redundant
+#define BURST_WRITABLE_REGISTERS \
+    ((uint16_t)(ALL_REGISTERS & ~STATUS_REGISTERS & ~REGISTER_BIT(BQ25180_SHIP_RST)))
+
 // Forward declarations
-static void readAllRegistersJson(BQ25180 *chargerIC, char jsonOutput[], uint32_t len);
-static BQ25180Registers readAllRegisters(BQ25180 *chargerIC);
+static void requestRegisterDump(BQ25180 *chargerIC);
+static void requestChargingState(BQ25180 *chargerIC, uint32_t milliseconds);
+static void handleChargerInterrupt(BQ25180 *chargerIC);
+static void stageRegister(BQ25180 *chargerIC, uint8_t reg, uint8_t value);
+static void commitRegisters(BQ25180 *chargerIC);
+static void readShadow(BQ25180 *chargerIC);
 static void configureChargerIC(BQ25180 *chargerIC);
 static void configureRegister_IC_CTRL(BQ25180 *chargerIC, uint8_t watchdogConfig);
 static void configureRegister_ICHG_CTRL(BQ25180 *chargerIC);
@@ -25,58 +39,76 @@ static void enableShipMode(BQ25180 *chargerIC);
 static void hardwareReset(BQ25180 *chargerIC);
 static void byteToBinary(uint8_t num, char *buf);
 static void bq25180regsToJson(BQ25180Registers registers, char jsonOutput[], uint32_t len);
-static enum ChargeState readChargingState(BQ25180 *chargerIC);
+static enum ChargeState decodeChargingState(uint8_t stat0);
 
 // =================================================================================================
 // Public Interface
 // =================================================================================================
 
-bool bq25180Init(
-    BQ25180 *chargerIC,
-    I2CReadRegisters readRegisters,
-    I2CWriteRegister writeRegister,
-    uint8_t devAddress,
-    Log log,
-    RGBLed *caseLed) {
-    if (!chargerIC || !readRegisters || !writeRegister || !log || !caseLed) {
+bool bq25180Init(BQ25180 *chargerIC, I2CQueue *i2c, uint8_t devAddress, Log log, RGBLed *caseLed) {
+    if (!chargerIC || !i2c || !log || !caseLed) {
         return false;
     }
 
-    chargerIC->readRegisters = readRegisters;
-    chargerIC->writeRegister = writeRegister;
+    chargerIC->i2c = i2c;
     chargerIC->devAddress = devAddress;
     chargerIC->log = log;
     chargerIC->caseLed = caseLed;
 
     chargerIC->chargingState = notConnected;
-    chargerIC->chargeStateCachedAtMs = 0;
     chargerIC->registersReadAtMs = 0;
+    chargerIC->shadowKnown = 0;
+    chargerIC->shadowDirty = 0;
+    chargerIC->stateReadsPending = 0;
+    chargerIC->stateRequestedAtMs = 0;
+    chargerIC->interruptPending = false;
+    chargerIC->faultFlags = 0;
+    chargerIC->registerDumpPending = false;
+
+    // One read fills the shadow and the charge state, the boot mode depends on whether power is
+    // plugged in. The charger keeps its registers across an MCU reset, so after waking from
+    // standby the configuration below usually has nothing left to write.
+    readShadow(chargerIC);
+    i2cQueueFlush(chargerIC->i2c);
 
     configureChargerIC(chargerIC);
+    i2cQueueFlush(chargerIC->i2c);
 
     return true;
 }
 
 // TODO: struct for bools? 4 right next to each other, looks messy passing args.
-void chargerTask(BQ25180 *chargerIC, uint32_t milliseconds, ChargerTaskFlags flags) {
-    enum ChargeState previousState = chargerIC->chargingState;
-    uint32_t elapsedMillis = 0;
+static bool isStateKnown(const BQ25180 *chargerIC) {
+    return (chargerIC->shadowKnown & REGISTER_BIT(BQ25180_STAT0)) != 0;
+}
 
-    if (chargerIC->registersReadAtMs != 0) {
-        elapsedMillis = milliseconds - chargerIC->registersReadAtMs;
+static uint32_t msUntilRefresh(const BQ25180 *chargerIC, uint32_t milliseconds) {
+    if (chargerIC->registersReadAtMs == 0) {
+        return 0;
     }
+    uint32_t elapsed = milliseconds - chargerIC->registersReadAtMs;
+    return elapsed >= BQ25180_REFRESH_MS ? 0 : BQ25180_REFRESH_MS - elapsed;
+}
 
+static uint32_t msUntilRetry(const BQ25180 *chargerIC, uint32_t milliseconds) {
+    if (isStateKnown(chargerIC) || chargerIC->stateReadsPending > 0) {
+        return UINT32_MAX;
+    }
+    uint32_t elapsed = milliseconds - chargerIC->stateRequestedAtMs;
+    return elapsed >= BQ25180_STATE_RETRY_MS ? 0 : BQ25180_STATE_RETRY_MS - elapsed;
+}
+
+// Status is only read on events: the INT edge, the host watchdog refresh, or a retry after a
+// failed read. Between them the state is served from the shadow and the MCU can sleep.
+void chargerTask(BQ25180 *chargerIC, uint32_t milliseconds, ChargerTaskFlags flags) {
     // Refresh the charger state well before the 160 s host watchdog can expire.
     // A separate VIN watchdog path is configured in SYS_REG.
-    if (elapsedMillis > 30000 || chargerIC->registersReadAtMs == 0) {
+    if (msUntilRefresh(chargerIC, milliseconds) == 0) {
         if (flags.serialEnabled) {
-            char registerJson[BQ25180_JSON_BUFFER_SIZE];
-            readAllRegistersJson(chargerIC, registerJson, sizeof(registerJson));
-            chargerIC->log(registerJson, strlen(registerJson));
+            requestRegisterDump(chargerIC);
         }
 
-        chargerIC->chargingState = readChargingState(chargerIC);
-        chargerIC->chargeStateCachedAtMs = milliseconds;
+        requestChargingState(chargerIC, milliseconds);
         chargerIC->registersReadAtMs = milliseconds;
     }
 
@@ -87,41 +119,92 @@ void chargerTask(BQ25180 *chargerIC, uint32_t milliseconds, ChargerTaskFlags fla
     }
 
     if (flags.interruptTriggered) {
-        enum ChargeState state = readChargingState(chargerIC);
-        chargerIC->chargingState = state;
-        chargerIC->chargeStateCachedAtMs = milliseconds;
-
-        bool wasDisconnected = previousState != notConnected && state == notConnected;
-        if (milliseconds != 0 && wasDisconnected && flags.unplugLockEnabled) {
-            // if in fake off mode and power is unplugged, put into ship mode
-            lock(chargerIC);
+        // compare against the state from before the first of several quick interrupts
+        if (!chargerIC->interruptPending) {
+            chargerIC->stateBeforeInterrupt = chargerIC->chargingState;
         }
+        chargerIC->shadowKnown &= (uint16_t)~STATUS_REGISTERS;
+        chargerIC->interruptPending = true;
+        chargerIC->interruptAtMs = milliseconds;
+        chargerIC->interruptFlags = flags;
+        requestChargingState(chargerIC, milliseconds);
+    } else if (msUntilRetry(chargerIC, milliseconds) == 0) {
+        requestChargingState(chargerIC, milliseconds);
+    }
+}
 
-        // only update LED from interrupt when plugged in for immediate feedback.
-        bool wasConnected = previousState == notConnected && state != notConnected;
-        if (wasConnected && flags.chargeLedEnabled) {
-            showChargingState(chargerIC, state);
-        }
+uint32_t bq25180MsUntilNextRead(const BQ25180 *chargerIC, uint32_t milliseconds) {
+    uint32_t refreshMs = msUntilRefresh(chargerIC, milliseconds);
+    uint32_t retryMs = msUntilRetry(chargerIC, milliseconds);
+    return refreshMs < retryMs ? refreshMs : retryMs;
+}
+
+static void handleChargerInterrupt(BQ25180 *chargerIC) {
+    enum ChargeState previousState = chargerIC->stateBeforeInterrupt;
+    enum ChargeState state = chargerIC->chargingState;
+    ChargerTaskFlags flags = chargerIC->interruptFlags;
+
+    bool wasDisconnected = previousState != notConnected && state == notConnected;
+    if (chargerIC->interruptAtMs != 0 && wasDisconnected && flags.unplugLockEnabled) {
+        // if in fake off mode and power is unplugged, put into ship mode
+        enableShipMode(chargerIC);
+    }
+
+    // only update LED from interrupt when plugged in for immediate feedback.
+    bool wasConnected = previousState == notConnected && state != notConnected;
+    if (wasConnected && flags.chargeLedEnabled) {
+        showChargingState(chargerIC, state);
     }
 }
 
-enum ChargeState getChargingState(BQ25180 *chargerIC, uint32_t milliseconds) {
-    uint32_t elapsed = milliseconds - chargerIC->chargeStateCachedAtMs;
-    if (chargerIC->chargeStateCachedAtMs != 0 && elapsed < 1000) {
-        return chargerIC->chargingState;
+static void onChargingStateRead(void *context, bool ok) {
+    BQ25180 *chargerIC = context;
+    chargerIC->stateReadsPending--;
+
+    // a failed read keeps the previous state, and the shadow unknown so chargerTask retries it
+    if (ok) {
+        chargerIC->chargingState = decodeChargingState(chargerIC->shadow[BQ25180_STAT0]);
+        chargerIC->faultFlags |= chargerIC->shadow[BQ25180_FLAG0];
+        chargerIC->shadowKnown |= STATUS_REGISTERS;
     }
 
-    chargerIC->chargingState = readChargingState(chargerIC);
-    chargerIC->chargeStateCachedAtMs = milliseconds;
-    return chargerIC->chargingState;
+    // the last read queued is the one that saw the charger after the interrupt
+    if (chargerIC->interruptPending && chargerIC->stateReadsPending == 0) {
+        chargerIC->interruptPending = false;
+        handleChargerInterrupt(chargerIC);
+    }
 }
 
-static enum ChargeState readChargingState(BQ25180 *chargerIC) {
-    uint8_t regResult = 0;
-    if (!chargerIC->readRegisters(chargerIC->devAddress, BQ25180_STAT0, &regResult, 1)) {
-        return chargerIC->chargingState;
+static void requestChargingState(BQ25180 *chargerIC, uint32_t milliseconds) {
+    // a refresh already on its way is good enough, unless an interrupt needs a read after it
+    if (chargerIC->stateReadsPending > 0 && !chargerIC->interruptPending) {
+        return;
+    }
+
+    chargerIC->stateRequestedAtMs = milliseconds;
+    if (i2cQueueRead(
+            chargerIC->i2c,
+            chargerIC->devAddress,
+            BQ25180_STAT0,
+            &chargerIC->shadow[BQ25180_STAT0],
+            BQ25180_STATUS_READ_LENGTH,
+            onChargingStateRead,
+            chargerIC)) {
+        chargerIC->stateReadsPending++;
     }
+}
+
+enum ChargeState getChargingState(const BQ25180 *chargerIC) {
+    return chargerIC->chargingState;
+}
+
+uint8_t bq25180TakeFaults(BQ25180 *chargerIC) {
+    uint8_t faults = chargerIC->faultFlags;
+    chargerIC->faultFlags = 0;
+    return faults;
+}
 
+static enum ChargeState decodeChargingState(uint8_t regResult) {
     if ((regResult & 0b01000000) > 0) {
         if ((regResult & 0b00100000) > 0) {
             return done;
@@ -140,8 +223,7 @@ static enum ChargeState readChargingState(BQ25180 *chargerIC) {
     return notConnected;
 }
 
-void lock(BQ25180 *chargerIC) {
-    enum ChargeState state = readChargingState(chargerIC);
+static void lockWithState(BQ25180 *chargerIC, enum ChargeState state) {
     if (state == notConnected) {
         enableShipMode(chargerIC);
     } else {
@@ -149,6 +231,31 @@ void lock(BQ25180 *chargerIC) {
     }
 }
 
+static void onLockStateRead(void *context, bool ok) {
+    BQ25180 *chargerIC = context;
+    enum ChargeState state = ok ? decodeChargingState(chargerIC->shadow[BQ25180_STAT0])
+                                : chargerIC->chargingState;
+    lockWithState(chargerIC, state);
+}
+
+void lock(BQ25180 *chargerIC) {
+    // no interrupt since the last read, the charger is still in the state it reported
+    if (isStateKnown(chargerIC) && chargerIC->stateReadsPending == 0) {
+        lockWithState(chargerIC, chargerIC->chargingState);
+    } else {
+        i2cQueueRead(
+            chargerIC->i2c,
+            chargerIC->devAddress,
+            BQ25180_STAT0,
+            &chargerIC->shadow[BQ25180_STAT0],
+            1,
+            onLockStateRead,
+            chargerIC);
+    }
+    // the MCU sleeps or loses power right after, the ship mode or reset write has to land first
+    i2cQueueFlush(chargerIC->i2c);
+}
+
 // =================================================================================================
 // Private Helpers - State & UI
 // =================================================================================================
@@ -184,6 +291,7 @@ static void configureChargerIC(BQ25180 *chargerIC) {
     configureRegister_CHARGECTRL1(chargerIC);
     configureRegister_SYS_REG(chargerIC);
     configureRegister_MASK_ID(chargerIC);
+    commitRegisters(chargerIC);
 }
 
 static void configureRegister_IC_CTRL(BQ25180 *chargerIC, uint8_t watchdogConfig) {
@@ -194,13 +302,13 @@ static void configureRegister_IC_CTRL(BQ25180 *chargerIC, uint8_t watchdogConfig
     newConfig &= (uint8_t)~BQ25180_WATCHDOG_SEL_MASK;
     newConfig |= watchdogConfig;
 
-    chargerIC->writeRegister(chargerIC->devAddress, BQ25180_IC_CTRL, newConfig);
+    stageRegister(chargerIC, BQ25180_IC_CTRL, newConfig);
 }
 
 static void configureRegister_ICHG_CTRL(BQ25180 *chargerIC) {
     // enable charging = bit 7 in data sheet 0
     // 70 milliamp max charge current
-    chargerIC->writeRegister(chargerIC->devAddress, BQ25180_ICHG_CTRL, 0b00100010);
+    stageRegister(chargerIC, BQ25180_ICHG_CTRL, 0b00100010);
 }
 
 static void configureRegister_VBAT_CTRL(BQ25180 *chargerIC) {
@@ -208,7 +316,7 @@ static void configureRegister_VBAT_CTRL(BQ25180 *chargerIC) {
     //	 chargerIC->writeRegister(chargerIC, BQ25180_VBAT_CTRL, 0b01010000);
 
     // 4.4v, (3.5v) + (90 * 10mV), 90 = 0b1011010
-    chargerIC->writeRegister(chargerIC->devAddress, BQ25180_VBAT_CTRL, 0b01011010);
+    stageRegister(chargerIC, BQ25180_VBAT_CTRL, 0b01011010);
 }
 
 static void configureRegister_CHARGECTRL1(BQ25180 *chargerIC) {
@@ -222,7 +330,7 @@ static void configureRegister_CHARGECTRL1(BQ25180 *chargerIC) {
     // Mask ILIM Fault Interrupt = OFF 1b1
     // Mask VINDPM and VDPPM Interrupt = OFF 1b1, TODO: turn back on?, 1b0
 
-    chargerIC->writeRegister(chargerIC->devAddress, BQ25180_CHARGECTRL1, 0b00000011);
+    stageRegister(chargerIC, BQ25180_CHARGECTRL1, 0b00000011);
 }
 
 static void configureRegister_SYS_REG(BQ25180 *chargerIC) {
@@ -232,7 +340,7 @@ static void configureRegister_SYS_REG(BQ25180 *chargerIC) {
     // enabled vin watchdog hardware reset, if no i2c with 15 seconds of vin
     newConfig |= vinWatchdogMask;
 
-    chargerIC->writeRegister(chargerIC->devAddress, BQ25180_SYS_REG, newConfig);
+    stageRegister(chargerIC, BQ25180_SYS_REG, newConfig);
 }
 
 static void configureRegister_MASK_ID(BQ25180 *chargerIC) {
@@ -255,23 +363,100 @@ static void configureRegister_MASK_ID(BQ25180 *chargerIC) {
     // Device_ID: A 4-bit field indicating the device ID.
     //   4b0000: Device ID for the BQ25180.
 
-    chargerIC->writeRegister(chargerIC->devAddress, BQ25180_MASK_ID, 0b00000000);
+    stageRegister(chargerIC, BQ25180_MASK_ID, 0b00000000);
 }
 
 // =================================================================================================
 // Private Helpers - Registers & JSON
 // =================================================================================================
 
-static void readAllRegistersJson(BQ25180 *chargerIC, char jsonOutput[], uint32_t len) {
-    BQ25180Registers registerValues = readAllRegisters(chargerIC);
-    bq25180regsToJson(registerValues, jsonOutput, len);
+static void onShadowRead(void *context, bool ok) {
+    BQ25180 *chargerIC = context;
+    if (!ok) {
+        // everything gets written on the next configure, STAT0 is retried by chargerTask
+        return;
+    }
+
+    chargerIC->shadowKnown = ALL_REGISTERS & (uint16_t)~REGISTER_BIT(BQ25180_SHIP_RST);
+    chargerIC->chargingState = decodeChargingState(chargerIC->shadow[BQ25180_STAT0]);
+    chargerIC->faultFlags |= chargerIC->shadow[BQ25180_FLAG0];
 }
 
-static BQ25180Registers readAllRegisters(BQ25180 *chargerIC) {
-    BQ25180Registers registerValues = {0};
-    uint8_t rxBuffer[13];
+static void readShadow(BQ25180 *chargerIC) {
+    i2cQueueRead(
+        chargerIC->i2c,
+        chargerIC->devAddress,
+        BQ25180_STAT0,
+        chargerIC->shadow,
+        BQ25180_REGISTER_COUNT,
+        onShadowRead,
+        chargerIC);
+}
+
+static void stageRegister(BQ25180 *chargerIC, uint8_t reg, uint8_t value) {
+    uint16_t bit = REGISTER_BIT(reg);
+    if ((chargerIC->shadowKnown & bit) && chargerIC->shadow[reg] == value) {
+        return;
+    }
+    chargerIC->shadow[reg] = value;
+    chargerIC->shadowDirty |= bit;
+}
+
+static void onRegistersWritten(void *context, bool ok) {
+    BQ25180 *chargerIC = context;
+    if (!ok) {
+        // unknown which bytes landed, rewrite everything on the next change
+        chargerIC->shadowKnown &= STATUS_REGISTERS;
+    }
+}
 
-    if (chargerIC->readRegisters(chargerIC->devAddress, BQ25180_STAT0, rxBuffer, 13)) {
+static void commitRegisters(BQ25180 *chargerIC) {
+    uint16_t dirty = chargerIC->shadowDirty;
+    uint8_t reg = 0;
+    while (reg < BQ25180_REGISTER_COUNT) {
+        if (!(dirty & REGISTER_BIT(reg))) {
+            reg++;
+            continue;
+        }
+
+        // Extend the burst to the last staged register it can reach. Known registers in a gap are
+        // rewritten with their current value, cheaper than another transaction.
+        uint8_t end = reg + 1;
+        for (uint8_t next = end; next < BQ25180_REGISTER_COUNT; next++) {
+            uint16_t bit = REGISTER_BIT(next);
+            if (!(BURST_WRITABLE_REGISTERS & bit) || !((dirty | chargerIC->shadowKnown) & bit)) {
+                break;
+            }
+            if (dirty & bit) {
+                end = next + 1;
+            }
+        }
+
+        // Sent straight from the shadow. Restaging a register before the burst goes out only means
+        // the newer value is sent twice.
+        i2cQueueWriteBurst(
+            chargerIC->i2c,
+            chargerIC->devAddress,
+            reg,
+            &chargerIC->shadow[reg],
+            end - reg,
+            onRegistersWritten,
+            chargerIC);
+        for (uint8_t written = reg; written < end; written++) {
+            chargerIC->shadowKnown |= REGISTER_BIT(written);
+        }
+        reg = end;
+    }
+    chargerIC->shadowDirty = 0;
+}
+
+static void onRegistersRead(void *context, bool ok) {
+    BQ25180 *chargerIC = context;
+    chargerIC->registerDumpPending = false;
+
+    BQ25180Registers registerValues = {0};
+    if (ok) {
+        const uint8_t *rxBuffer = chargerIC->registerDump;
         registerValues.stat0 = rxBuffer[0];
         registerValues.stat1 = rxBuffer[1];
         registerValues.flag0 = rxBuffer[2];
@@ -285,9 +470,28 @@ static BQ25180Registers readAllRegisters(BQ25180 *chargerIC) {
         registerValues.sys_reg = rxBuffer[10];
         registerValues.ts_control = rxBuffer[11];
         registerValues.mask_id = rxBuffer[12];
+        // the dump clears FLAG0 as well
+        chargerIC->faultFlags |= registerValues.flag0;
+    }
+
+    char registerJson[BQ25180_JSON_BUFFER_SIZE];
+    bq25180regsToJson(registerValues, registerJson, sizeof(registerJson));
+    chargerIC->log(registerJson, strlen(registerJson));
+}
+
+static void requestRegisterDump(BQ25180 *chargerIC) {
+    if (chargerIC->registerDumpPending) {
+        return;
     }
 
-    return registerValues;
+    chargerIC->registerDumpPending = i2cQueueRead(
+        chargerIC->i2c,
+        chargerIC->devAddress,
+        BQ25180_STAT0,
+        chargerIC->registerDump,
+        BQ25180_REGISTER_COUNT,
+        onRegistersRead,
+        chargerIC);
 }
 
 static void bq25180regsToJson(const BQ25180Registers registers, char jsonOutput[], uint32_t len) {
@@ -372,15 +576,19 @@ static void enableShipMode(BQ25180 *chargerIC) {
     // 1b0 = Disable
     // 1b1 = Enable
 
-    chargerIC->writeRegister(chargerIC->devAddress, BQ25180_SHIP_RST, 0b01000001);
+    i2cQueueWrite(chargerIC->i2c, chargerIC->devAddress, BQ25180_SHIP_RST, 0b01000001, NULL, NULL);
 }
 
 static void hardwareReset(BQ25180 *chargerIC) {
-    chargerIC->writeRegister(chargerIC->devAddress, BQ25180_SHIP_RST, 0b01100001);
+    i2cQueueWrite(chargerIC->i2c, chargerIC->devAddress, BQ25180_SHIP_RST, 0b01100001, NULL, NULL);
 }
 
 void disableWatchdog(BQ25180 *chargerIC) {
     // Disable the host watchdog before long Stop/Standby intervals so the charger
     // does not reset its register state while the MCU is intentionally asleep.
     configureRegister_IC_CTRL(chargerIC, BQ25180_WATCHDOG_DISABLED);
+    commitRegisters(chargerIC);
+
+    // charger interrupts go unhandled while the MCU sleeps
+    chargerIC->shadowKnown &= (uint16_t)~STATUS_REGISTERS;
 }
\ No newline at end of file
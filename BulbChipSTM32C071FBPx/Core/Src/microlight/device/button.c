@@ -7,64 +7,121 @@
 
 #include "microlight/device/button.h"
 
+static const uint32_t debounceMillis = 50U;
 static const uint32_t shutdownHoldMillis = 500U;
 static const uint32_t lockHoldMillis = 1500U;
 
-bool buttonInit(Button *button, uint8_t (*readButtonPin)()) {
-    if (!button || !readButtonPin) {
+bool buttonInit(Button *button, uint8_t (*readButtonPin)(), uint32_t (*milliseconds)(void)) {
+    if (!button || !readButtonPin || !milliseconds) {
         return false;
     }
 
     button->readButtonPin = readButtonPin;
+    button->milliseconds = milliseconds;
 
-    button->evalStartMs = 0;
+    button->edgeHead = 0;
+    button->edgeTail = 0;
+    button->evaluating = false;
+    button->pressMs = 0;
     return true;
 }
 
-enum ButtonResult buttonInputTask(Button *button, uint32_t milliseconds, bool interruptTriggered) {
-    uint8_t state = button->readButtonPin();
-    bool buttonCurrentlyDown = state == 0;
+void buttonEdgeInterrupt(Button *button) {
+    uint8_t head = button->edgeHead;
+    if ((uint8_t)(head - button->edgeTail) >= BUTTON_EDGE_QUEUE_LENGTH) {
+        // full of bounce, buttonInputTask falls back to the pin level for a lost release
+        return;
+    }
+
+    // the level rather than which edge fired, so edges handled out of order still end up right
+    button->edges[head % BUTTON_EDGE_QUEUE_LENGTH] = (ButtonEdge){
+        .milliseconds = button->milliseconds(),
+        .pressed = button->readButtonPin() == 0,
+    };
+    button->edgeHead = head + 1;
+}
 
-    if (interruptTriggered && button->evalStartMs == 0 && buttonCurrentlyDown) {
-        button->evalStartMs = milliseconds;
-        // See timer policy in chip_state.
-        // ChipTick timer needed to properly detect input. Main loop needs to run to detect
-        // that button is being held and show appropriate status.
+static enum ButtonResult releasedAt(Button *button, uint32_t milliseconds) {
+    uint32_t heldMillis = milliseconds - button->pressMs;
+    button->evaluating = false;
+
+    // edge times make this exact, a press shorter than this is contact bounce
+    if (heldMillis <= debounceMillis) {
+        return ignore;
+    }
+    if (heldMillis > lockHoldMillis) {
+        return lockOrHardwareReset;
+    }
+    if (heldMillis > shutdownHoldMillis) {
+        return shutdown;
     }
+    return clicked;
+}
 
-    uint32_t elapsedMillis = 0;
-    if (button->evalStartMs != 0) {
-        elapsedMillis = milliseconds - button->evalStartMs;
+static enum ButtonResult applyEdge(Button *button, ButtonEdge edge) {
+    if (edge.pressed) {
+        // further press edges while down are bounce, the hold counts from the first
+        if (!button->evaluating) {
+            button->evaluating = true;
+            button->pressMs = edge.milliseconds;
+        }
+        return ignore;
     }
 
-    enum ButtonResult buttonState = ignore;
+    if (!button->evaluating) {
+        return ignore;
+    }
+    return releasedAt(button, edge.milliseconds);
+}
+
+enum ButtonResult buttonInputTask(Button *button) {
+    while (button->edgeTail != button->edgeHead) {
+        ButtonEdge edge = button->edges[button->edgeTail % BUTTON_EDGE_QUEUE_LENGTH];
+        button->edgeTail++;
 
-    if (buttonCurrentlyDown) {
-        if (elapsedMillis > lockHoldMillis) {
-            buttonState = indicateLockOrHardwareReset;
-        } else if (elapsedMillis > shutdownHoldMillis) {
-            buttonState = indicateShutdown;
+        // anything left over is picked up on the next task
+        enum ButtonResult result = applyEdge(button, edge);
+        if (result != ignore) {
+            return result;
         }
     }
 
-    if (!buttonCurrentlyDown && button->evalStartMs != 0) {
-        if (elapsedMillis <= 50) {
-            button->evalStartMs = 0;
-            return ignore;
-        }
+    if (!button->evaluating) {
+        return ignore;
+    }
 
-        buttonState = clicked;
-        if (elapsedMillis > lockHoldMillis) {
-            buttonState = lockOrHardwareReset;
-        } else if (elapsedMillis > shutdownHoldMillis) {
-            buttonState = shutdown;
-        }
+    uint32_t milliseconds = button->milliseconds();
+    // Every edge has been handled, the button being up now means its release edge was lost.
+    if (button->readButtonPin() != 0) {
+        return releasedAt(button, milliseconds);
+    }
 
-        button->evalStartMs = 0;
+    uint32_t heldMillis = milliseconds - button->pressMs;
+    if (heldMillis > lockHoldMillis) {
+        return indicateLockOrHardwareReset;
+    }
+    if (heldMillis > shutdownHoldMillis) {
+        return indicateShutdown;
     }
-    return buttonState;
+    return ignore;
 }
 
 bool isEvaluatingButtonPress(Button *button) {
-    return button->evalStartMs != 0;
+    return button->evaluating;
+}
+
+uint32_t buttonMsUntilNextResult(Button *button) {
+    if (!button->evaluating) {
+        return UINT32_MAX;
+    }
+
+    uint32_t heldMillis = button->milliseconds() - button->pressMs;
+    if (heldMillis <= shutdownHoldMillis) {
+        return shutdownHoldMillis + 1U - heldMillis;
+    }
+    if (heldMillis <= lockHoldMillis) {
+        return lockHoldMillis + 1U - heldMillis;
+    }
+    // nothing changes until the release, which wakes the MCU by itself
+    return UINT32_MAX;
 }
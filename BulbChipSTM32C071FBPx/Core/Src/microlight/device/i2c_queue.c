@@ -0,0 +1,195 @@
+/*
+ * i2c_queue.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#include "microlight/device/i2c_queue.h"
+#include <string.h>
+
+bool i2cQueueInit(
+    I2CQueue *queue,
+    I2CStartRead startRead,
+    I2CStartWrite startWrite,
+    void (*abort)(void),
+    uint32_t (*milliseconds)(void),
+    void (*onFailure)(const I2CTransaction *transaction)) {
+    if (!queue || !startRead || !startWrite || !abort || !milliseconds) {
+        return false;
+    }
+
+    memset(queue, 0, sizeof(*queue));
+    queue->startRead = startRead;
+    queue->startWrite = startWrite;
+    queue->abort = abort;
+    queue->milliseconds = milliseconds;
+    queue->onFailure = onFailure;
+    return true;
+}
+
+static void startNext(I2CQueue *queue) {
+    if (queue->inFlight || queue->count == 0) {
+        return;
+    }
+
+    I2CTransaction *transaction = &queue->transactions[queue->head];
+    queue->inFlight = true;
+    queue->completed = false;
+    queue->startedAtMs = queue->milliseconds();
+
+    // the start may complete synchronously and report through i2cQueueComplete before it returns
+    bool started = transaction->isRead
+                       ? queue->startRead(
+                             transaction->devAddress,
+                             transaction->reg,
+                             transaction->buffer,
+                             transaction->length)
+                       : queue->startWrite(
+                             transaction->devAddress,
+                             transaction->reg,
+                             transaction->data ? transaction->data : &transaction->value,
+                             transaction->length);
+    if (!started) {
+        queue->completedOk = false;
+        queue->completed = true;
+    }
+}
+
+static void finishCurrent(I2CQueue *queue, bool ok) {
+    // copied out first, the completion may queue follow up transactions into the freed slot
+    I2CTransaction transaction = queue->transactions[queue->head];
+    queue->head = (queue->head + 1) % I2C_QUEUE_LENGTH;
+    queue->count--;
+    queue->inFlight = false;
+    queue->completed = false;
+
+    if (!ok && queue->onFailure) {
+        queue->onFailure(&transaction);
+    }
+    if (transaction.onComplete) {
+        transaction.onComplete(transaction.context, ok);
+    }
+}
+
+void i2cQueueTask(I2CQueue *queue) {
+    if (!queue) {
+        return;
+    }
+
+    while (queue->inFlight) {
+        if (queue->completed) {
+            finishCurrent(queue, queue->completedOk);
+        } else if (queue->milliseconds() - queue->startedAtMs >= I2C_QUEUE_TIMEOUT_MS) {
+            queue->abort();
+            finishCurrent(queue, false);
+        } else {
+            return;
+        }
+        startNext(queue);
+    }
+    startNext(queue);
+}
+
+static I2CTransaction *reserve(I2CQueue *queue) {
+    while (queue->count == I2C_QUEUE_LENGTH) {
+        i2cQueueTask(queue);
+    }
+
+    I2CTransaction *transaction =
+        &queue->transactions[(queue->head + queue->count) % I2C_QUEUE_LENGTH];
+    queue->count++;
+    return transaction;
+}
+
+bool i2cQueueRead(
+    I2CQueue *queue,
+    uint8_t devAddress,
+    uint8_t startReg,
+    uint8_t *buffer,
+    size_t length,
+    I2CCompletion onComplete,
+    void *context) {
+    if (!queue || !buffer || length == 0) {
+        return false;
+    }
+
+    *reserve(queue) = (I2CTransaction){
+        .devAddress = devAddress,
+        .reg = startReg,
+        .isRead = true,
+        .buffer = buffer,
+        .length = length,
+        .onComplete = onComplete,
+        .context = context,
+    };
+    startNext(queue);
+    return true;
+}
+
+bool i2cQueueWrite(
+    I2CQueue *queue,
+    uint8_t devAddress,
+    uint8_t reg,
+    uint8_t value,
+    I2CCompletion onComplete,
+    void *context) {
+    if (!queue) {
+        return false;
+    }
+
+    *reserve(queue) = (I2CTransaction){
+        .devAddress = devAddress,
+        .reg = reg,
+        .isRead = false,
+        .value = value,
+        .length = 1,
+        .onComplete = onComplete,
+        .context = context,
+    };
+    startNext(queue);
+    return true;
+}
+
+bool i2cQueueWriteBurst(
+    I2CQueue *queue,
+    uint8_t devAddress,
+    uint8_t startReg,
+    const uint8_t *data,
+    size_t length,
+    I2CCompletion onComplete,
+    void *context) {
+    if (!queue || !data || length == 0) {
+        return false;
+    }
+
+    *reserve(queue) = (I2CTransaction){
+        .devAddress = devAddress,
+        .reg = startReg,
+        .isRead = false,
+        .data = data,
+        .length = length,
+        .onComplete = onComplete,
+        .context = context,
+    };
+    startNext(queue);
+    return true;
+}
+
+void i2cQueueComplete(I2CQueue *queue, bool ok) {
+    if (!queue || !queue->inFlight) {
+        return;
+    }
+    queue->completedOk = ok;
+    queue->completed = true;
+}
+
+bool i2cQueueIdle(const I2CQueue *queue) {
+    return !queue || queue->count == 0;
+}
+
+void i2cQueueFlush(I2CQueue *queue) {
+    while (!i2cQueueIdle(queue)) {
+        i2cQueueTask(queue);
+    }
+}
@@ -5,115 +5,161 @@
 #include <stdint.h>
 #include <string.h>
 
-// TODO: set decimation rate?
 // Sensitivity for +/- 16g range: 32768 / 16 = 2048 LSB/g
 #define MC3479_SENSITIVITY_LSB_PER_G 2048ULL
 
-bool mc3479Init(
-    MC3479 *dev,
-    I2CReadRegisters readRegisters,
-    I2CWriteRegister writeRegister,
-    uint8_t devAddress) {
-    if (!dev || !readRegisters || !writeRegister) {
+static void writeRegister(MC3479 *dev, uint8_t reg, uint8_t value) {
+    i2cQueueWrite(dev->i2c, dev->devAddress, reg, value, NULL, NULL);
+}
+
+bool mc3479Init(MC3479 *dev, I2CQueue *i2c, uint8_t devAddress) {
+    if (!dev || !i2c) {
         return false;
     }
 
-    dev->readRegisters = readRegisters;
-    dev->writeRegister = writeRegister;
+    dev->i2c = i2c;
     dev->devAddress = devAddress;
+    dev->drainPending = false;
+    dev->discardDrain = false;
 
     // make sure in STANDBY when configuring
     mc3479Disable(dev);
 
     // set +/- 16g
-    dev->writeRegister(dev->devAddress, MC3479_REG_RANGE, 0b00110000);
+    writeRegister(dev, MC3479_REG_RANGE, 0b00110000);
+
+    // sample into the FIFO at a fixed rate, the jerk math relies on the sample spacing
+    writeRegister(dev, MC3479_REG_CTRL2, MC3479_SAMPLE_RATE_100HZ);
+    writeRegister(
+        dev,
+        MC3479_REG_FIFO_CTRL,
+        MC3479_FIFO_CTRL_ENABLE | MC3479_FIFO_CTRL_WATERMARK_MODE |
+            (MC3479_FIFO_WATERMARK & MC3479_FIFO_CTRL_THRESHOLD_MASK));
     return true;
 }
 
+static void resetSampleState(MC3479 *dev) {
+    dev->lastSampleMs = 0;
+    dev->currentJerkSquaredSum = 0;
+    dev->lastDtMs = 0;
+    jerkFilterReset(&dev->jerkFilter);
+    dev->discardDrain = dev->drainPending;
+}
+
 void mc3479Enable(MC3479 *dev) {
-    if (!dev || !dev->writeRegister) {
+    if (!dev || !dev->i2c) {
         return;
     }
 
+    // drop samples left over from before standby, they would read as one large jerk
+    writeRegister(dev, MC3479_REG_FIFO_CTRL2, MC3479_FIFO_CTRL2_RESET | MC3479_FIFO_CTRL2_BURST);
+    writeRegister(dev, MC3479_REG_FIFO_CTRL2, MC3479_FIFO_CTRL2_BURST);
+
     // put into WAKE mode
-    dev->writeRegister(dev->devAddress, MC3479_REG_CTRL1, 0b00000001);
+    writeRegister(dev, MC3479_REG_CTRL1, 0b00000001);
     dev->enabled = true;
 
-    // reset last sample tick so the task may sample immediately on next mc3479Task call
-    dev->lastSampleMs = 0;
-    dev->currentJerkSquaredSum = 0;
-    dev->lastDtMs = 0;
-    dev->lastRawX = 0;
-    dev->lastRawY = 0;
-    dev->lastRawZ = 0;
+    // reset last sample tick so the task may drain immediately on next mc3479Task call
+    resetSampleState(dev);
 }
 
 void mc3479Disable(MC3479 *dev) {
-    if (!dev || !dev->writeRegister) {
+    if (!dev || !dev->i2c) {
         return;
     }
 
     // Put the sensor into low-power / standby if supported
-    dev->writeRegister(dev->devAddress, MC3479_REG_CTRL1, 0x00);
+    writeRegister(dev, MC3479_REG_CTRL1, 0x00);
     dev->enabled = false;
 
     // reset the sample time and clear the cached magnitude
-    dev->lastSampleMs = 0;
-    dev->currentJerkSquaredSum = 0;
-    dev->lastDtMs = 0;
-    dev->lastRawX = 0;
-    dev->lastRawY = 0;
-    dev->lastRawZ = 0;
+    resetSampleState(dev);
 }
 
-bool mc3479SampleNow(MC3479 *dev, uint32_t milliseconds) {
-    if (!dev || !dev->enabled) {
+// static, a full FIFO is too large for the stack and the buffer must outlive the queued read
+static uint8_t sampleBuffer[MC3479_FIFO_DEPTH * 6];
+
+static bool finishDrain(MC3479 *dev) {
+    dev->drainPending = false;
+    if (dev->discardDrain || !dev->enabled) {
+        dev->discardDrain = false;
         return false;
     }
+    return true;
+}
 
-    // read all 6 bytes
-    uint8_t buf[6] = {0};
-    if (dev->readRegisters) {
-        // readRegisters should read 6 bytes starting at MC3479_REG_XOUT_L
-        bool read_ok = dev->readRegisters(dev->devAddress, MC3479_REG_XOUT_L, buf, 6);
-        if (!read_ok) {
-            return false;
+static void processSamples(MC3479 *dev, uint8_t count) {
+    // An empty FIFO keeps the held value, the filter only decays as samples arrive
+    uint64_t maxJerkSquaredSum = count > 0 ? 0 : dev->currentJerkSquaredSum;
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t *sample = &sampleBuffer[i * 6U];
+        // Assemble as signed 16-bit two's complement
+        int16_t raw_x = (int16_t)(((uint16_t)sample[1] << 8) | sample[0]);
+        int16_t raw_y = (int16_t)(((uint16_t)sample[3] << 8) | sample[2]);
+        int16_t raw_z = (int16_t)(((uint16_t)sample[5] << 8) | sample[4]);
+
+        uint32_t jerkSquaredSum = jerkFilterPush(&dev->jerkFilter, raw_x, raw_y, raw_z);
+        if (jerkSquaredSum > maxJerkSquaredSum) {
+            maxJerkSquaredSum = jerkSquaredSum;
         }
     }
 
-    // Assemble as signed 16-bit two's complement
-    int16_t raw_x = (int16_t)(((uint16_t)buf[1] << 8) | buf[0]);
-    int16_t raw_y = (int16_t)(((uint16_t)buf[3] << 8) | buf[2]);
-    int16_t raw_z = (int16_t)(((uint16_t)buf[5] << 8) | buf[4]);
-
-    // Compute jerk (derivative of acceleration). This driver measures and
-    // stores jerk in units of g per ms (caller ms are used directly).
-    if (dev->lastSampleMs != 0 && milliseconds > dev->lastSampleMs) {
-        uint32_t dt_ms = milliseconds - dev->lastSampleMs;
-        if (dt_ms > 0) {
-            int32_t dax = (int32_t)raw_x - dev->lastRawX;
-            int32_t day = (int32_t)raw_y - dev->lastRawY;
-            int32_t daz = (int32_t)raw_z - dev->lastRawZ;
-
-            dev->currentJerkSquaredSum =
-                (uint64_t)dax * dax + (uint64_t)day * day + (uint64_t)daz * daz;
-            dev->lastDtMs = dt_ms;
-        } else {
-            dev->currentJerkSquaredSum = 0;
-            dev->lastDtMs = 0;
+    dev->currentJerkSquaredSum = maxJerkSquaredSum;
+    dev->lastDtMs = dev->jerkFilter.primed ? MC3479_SAMPLE_PERIOD_MS : 0;
+}
+
+static uint8_t fifoSampleCount(const MC3479 *dev) {
+    uint8_t count = (uint8_t)(dev->fifoPointers[1] - dev->fifoPointers[0]) &
+                    MC3479_FIFO_POINTER_MASK;
+    return count > MC3479_FIFO_DEPTH ? MC3479_FIFO_DEPTH : count;
+}
+
+static void onSamplesRead(void *context, bool ok) {
+    MC3479 *dev = context;
+    if (finishDrain(dev) && ok) {
+        processSamples(dev, fifoSampleCount(dev));
+    }
+}
+
+static void onPointersRead(void *context, bool ok) {
+    MC3479 *dev = context;
+    uint8_t count = fifoSampleCount(dev);
+    if (!ok || dev->discardDrain || !dev->enabled || count == 0) {
+        if (finishDrain(dev) && ok) {
+            processSamples(dev, 0);
         }
-    } else {
-        // Insufficient history to compute jerk yet
-        dev->currentJerkSquaredSum = 0;
-        dev->lastDtMs = 0;
+        return;
     }
 
-    dev->lastRawX = raw_x;
-    dev->lastRawY = raw_y;
-    dev->lastRawZ = raw_z;
+    i2cQueueRead(
+        dev->i2c,
+        dev->devAddress,
+        MC3479_REG_XOUT_L,
+        sampleBuffer,
+        count * 6U,
+        onSamplesRead,
+        dev);
+}
 
-    dev->lastSampleMs = milliseconds;
+bool mc3479StartDrain(MC3479 *dev, uint32_t milliseconds) {
+    if (!dev || !dev->enabled || !dev->i2c || dev->drainPending) {
+        return false;
+    }
 
+    dev->drainPending = true;
+    dev->discardDrain = false;
+    dev->lastSampleMs = milliseconds;
+    if (!i2cQueueRead(
+            dev->i2c,
+            dev->devAddress,
+            MC3479_REG_FIFO_RD_P,
+            dev->fifoPointers,
+            sizeof(dev->fifoPointers),
+            onPointersRead,
+            dev)) {
+        dev->drainPending = false;
+        return false;
+    }
     return true;
 }
 
@@ -122,20 +168,25 @@ void mc3479Task(MC3479 *dev, uint32_t milliseconds) {
         return;
     }
 
-    // If at least 50 milliseconds have elapsed since the last sample, take a new one
+    // The FIFO holds MC3479_FIFO_DEPTH samples, drain well before it can overflow. A drain that is
+    // still in flight, or failed, is simply retried on the next period.
     uint32_t elapsed = milliseconds - dev->lastSampleMs;
-    bool samplePeriodElapsed = elapsed >= 50;
-    if (samplePeriodElapsed) {
-        // Try to sample; if it fails, we leave the previous value intact
-        if (mc3479SampleNow(dev, milliseconds)) {
-            // sample_now updates last_sample_tick
-        } else {
-            // Advance the last_sample_tick anyway to avoid continuous retries
+    if (elapsed >= MC3479_FIFO_DRAIN_MS) {
+        if (!mc3479StartDrain(dev, milliseconds)) {
             dev->lastSampleMs = milliseconds;
         }
     }
 }
 
+uint32_t mc3479MsUntilNextDrain(const MC3479 *dev, uint32_t milliseconds) {
+    if (!dev || !dev->enabled) {
+        return UINT32_MAX;
+    }
+
+    uint32_t elapsed = milliseconds - dev->lastSampleMs;
+    return elapsed >= MC3479_FIFO_DRAIN_MS ? 0 : MC3479_FIFO_DRAIN_MS - elapsed;
+}
+
 bool isOverThreshold(MC3479 *dev, uint8_t threshold) {
     if (!dev || !dev->enabled || dev->lastDtMs == 0) {
         return false;
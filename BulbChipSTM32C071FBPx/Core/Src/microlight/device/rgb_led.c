@@ -10,38 +10,45 @@
 #include <stdbool.h>
 #include <stddef.h>
 
-// TODO: multiple priorities, could create a prioritized led resource mutex if it gets more
-// complicated button input user defined mode color charging
-
-// Gamma 2.2 correction lookup table: maps linear 0-255 input to corrected 0-255 output.
-// Computed as: round(pow(i / 255.0, 2.2) * 255.0) for i in 0..255
-static const uint8_t gammaLUT[256] = {
-    0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   1,   1,   1,
-    1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,   3,   3,   3,   3,   3,   4,
-    4,   4,   4,   5,   5,   5,   5,   6,   6,   6,   6,   7,   7,   7,   8,   8,   8,   9,   9,
-    9,   10,  10,  11,  11,  11,  12,  12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,
-    18,  18,  19,  19,  20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,
-    29,  30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,  42,  43,
-    43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,  56,  57,  58,  59,  60,
-    61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,  73,  74,  75,  76,  77,  78,  79,  81,
-    82,  83,  84,  85,  87,  88,  89,  90,  91,  93,  94,  95,  97,  98,  99,  100, 102, 103, 105,
-    106, 107, 109, 110, 111, 113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132,
-    133, 135, 137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161, 163,
-    165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190, 192, 194, 196, 197,
-    199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221, 223, 225, 227, 229, 231, 234, 236,
-    238, 240, 242, 244, 246, 248, 251, 253, 255,
+// Gamma 2.2 correction lookup table: maps linear 0-255 input to corrected 0-65535 output.
+// Computed as: round(pow(i / 255.0, 2.2) * 65535.0) for i in 0..255
+// An 8 bit curve collapses the first 15 inputs to 0, 16 bits keep the dim end distinct so it can
+// be dithered between whole PWM steps.
+static const uint16_t gammaLUT[256] = {
+    0,     0,     2,     4,     7,     11,    17,    24,    32,    42,    53,    65,    79,
+    94,    111,   129,   148,   169,   192,   216,   242,   270,   299,   330,   362,   396,
+    432,   469,   508,   549,   591,   635,   681,   729,   779,   830,   883,   938,   995,
+    1053,  1113,  1175,  1239,  1305,  1373,  1443,  1514,  1587,  1663,  1740,  1819,  1900,
+    1983,  2068,  2155,  2243,  2334,  2427,  2521,  2618,  2717,  2817,  2920,  3024,  3131,
+    3240,  3350,  3463,  3578,  3694,  3813,  3934,  4057,  4182,  4309,  4438,  4570,  4703,
+    4838,  4976,  5115,  5257,  5401,  5547,  5695,  5845,  5998,  6152,  6309,  6468,  6629,
+    6792,  6957,  7124,  7294,  7466,  7640,  7816,  7994,  8175,  8358,  8543,  8730,  8919,
+    9111,  9305,  9501,  9699,  9900,  10102, 10307, 10515, 10724, 10936, 11150, 11366, 11585,
+    11806, 12029, 12254, 12482, 12712, 12944, 13179, 13416, 13655, 13896, 14140, 14386, 14635,
+    14885, 15138, 15394, 15652, 15912, 16174, 16439, 16706, 16975, 17247, 17521, 17798, 18077,
+    18358, 18642, 18928, 19216, 19507, 19800, 20095, 20393, 20694, 20996, 21301, 21609, 21919,
+    22231, 22546, 22863, 23182, 23504, 23829, 24156, 24485, 24817, 25151, 25487, 25826, 26168,
+    26512, 26858, 27207, 27558, 27912, 28268, 28627, 28988, 29351, 29717, 30086, 30457, 30830,
+    31206, 31585, 31966, 32349, 32735, 33124, 33514, 33908, 34304, 34702, 35103, 35507, 35913,
+    36321, 36732, 37146, 37562, 37981, 38402, 38825, 39252, 39680, 40112, 40546, 40982, 41421,
+    41862, 42306, 42753, 43202, 43654, 44108, 44565, 45025, 45487, 45951, 46418, 46888, 47360,
+    47835, 48313, 48793, 49275, 49761, 50249, 50739, 51232, 51728, 52226, 52727, 53230, 53736,
+    54245, 54756, 55270, 55787, 56306, 56828, 57352, 57879, 58409, 58941, 59476, 60014, 60554,
+    61097, 61642, 62190, 62741, 63295, 63851, 64410, 64971, 65535,
 };
 
 // Convert a linear 0-255 input channel into the post-gamma 0-255 space used by white balance.
 // White balance is applied after gamma correction, so full white (255,255,255) maps to the
 // configured corrected-channel caps while dimmer colors keep the gamma curve shape.
-static uint8_t gammaAndWhiteBalancedColor(uint8_t value, uint8_t whiteBalance) {
-    uint32_t product = (uint32_t)gammaLUT[value] * whiteBalance;
+uint8_t gammaAndWhiteBalancedColor(uint8_t value, uint8_t whiteBalance) {
+    // (x + 128) / 257 lands the 16 bit curve exactly on round(pow(i / 255.0, 2.2) * 255.0)
+    uint32_t corrected = ((uint32_t)gammaLUT[value] + 128U) / 257U;
+    uint32_t product = corrected * whiteBalance;
     // Use the same exact divide-by-255 multiply-shift to keep white-balance scaling integer-only.
     return (uint8_t)((product * 0x8081U) >> 23);
 }
 
-// Scale a post-gamma 0-255 color value to a PWM duty cycle in [0, period + 1].
+// Scale a 0-255 color value to a PWM duty cycle in [0, period + 1].
 //
 // Conceptually: duty = corrected * ((period + 1) / 255)
 // The +1 is intentional: mapping 255 to period would land exactly on ARR, while mapping 255 to
@@ -50,74 +57,152 @@ static uint8_t gammaAndWhiteBalancedColor(uint8_t value, uint8_t whiteBalance) {
 // in ((period + 1) / 255) loses precision for small periods, so we rearrange to multiply first:
 //   duty = (corrected * (period + 1)) / 255
 //
-// The division by 255 is then replaced with a multiply-shift approximation:
-//   x / 255 == (x * 0x8081) >> 23, exact for x in [0, 130559].
-// The intermediate product (x * 0x8081) must fit in a uint32_t, which constrains max period:
-//   255 * (period + 1) * 0x8081 <= UINT32_MAX  =>  period <= 510
+// Only used for the unbalanced status colors, so a plain divide is fine here and any 16 bit
+// period fits: 255 * 65535 < UINT32_MAX.
 static uint16_t colorToDuty(const RGBLed *device, uint8_t corrected) {
     uint32_t product = (uint32_t)corrected * (device->period + 1U);
-    return (uint16_t)((product * 0x8081U) >> 23);
+    return (uint16_t)(product / 255U);
 }
 
-static void writeColorPwm(RGBLed *device, uint8_t red, uint8_t green, uint8_t blue) {
-    uint16_t scaledRed = colorToDuty(device, red);
-    uint16_t scaledGreen = colorToDuty(device, green);
-    uint16_t scaledBlue = colorToDuty(device, blue);
+// Fractional duty bits the tables keep below one PWM step, as many of RGB_DITHER_BITS as still
+// leave room for the full scale duty in 16 bits.
+static uint8_t fractionBitsForPeriod(uint16_t period) {
+    uint8_t bits = RGB_DITHER_BITS;
+    while (bits > 0 && ((uint32_t)period + 1U) << bits > UINT16_MAX) {
+        bits--;
+    }
+    return bits;
+}
 
-    device->writePwm(scaledRed, scaledGreen, scaledBlue);
+// Fold gamma, white balance and duty scaling into one lookup per channel. White balance only
+// changes with settings, so the per color write is a single table load per channel.
+//
+// Entries are duties in fixed point with fractionBits below the PWM step:
+//   duty = gamma16 * (whiteBalance / 255) * ((period + 1) << fractionBits) / 65535
+// Both factors of the last multiply are at most 65535, so the product fits a uint32_t.
+static void buildDutyTables(RGBLed *device) {
+    const uint8_t balance[RGB_CHANNEL_COUNT] = {
+        device->whiteBalance.red,
+        device->whiteBalance.green,
+        device->whiteBalance.blue,
+    };
+    uint32_t fullScale = ((uint32_t)device->period + 1U) << device->fractionBits;
+    for (uint8_t channel = 0; channel < RGB_CHANNEL_COUNT; channel++) {
+        for (uint16_t value = 0; value < 256; value++) {
+            uint32_t balanced = ((uint32_t)gammaLUT[value] * balance[channel] + 127U) / 255U;
+            device->dutyTable[channel][value] =
+                (uint16_t)((balanced * fullScale + UINT16_MAX / 2U) / UINT16_MAX);
+        }
+    }
 }
 
-static void writeColorPwmBalanced(RGBLed *device, uint8_t red, uint8_t green, uint8_t blue) {
-    // Convert each linear channel to its gamma-corrected, white-balanced value first,
-    // then scale that corrected value into the timer duty range.
-    uint8_t balancedRed = gammaAndWhiteBalancedColor(red, device->whiteBalance.red);
-    uint8_t balancedGreen = gammaAndWhiteBalancedColor(green, device->whiteBalance.green);
-    uint8_t balancedBlue = gammaAndWhiteBalancedColor(blue, device->whiteBalance.blue);
+// A fraction of a step only matters near the bottom, brighter levels round to the nearest duty.
+static bool needsDither(const RGBLed *device, uint16_t duty) {
+    uint16_t fraction = duty & ((1U << device->fractionBits) - 1U);
+    return fraction != 0 && (duty >> device->fractionBits) < RGB_DITHER_MAX_DUTY;
+}
 
-    writeColorPwm(device, balancedRed, balancedGreen, balancedBlue);
+static uint16_t roundedDuty(const RGBLed *device, uint16_t duty) {
+    uint32_t half = (1U << device->fractionBits) >> 1;
+    return (uint16_t)(((uint32_t)duty + half) >> device->fractionBits);
 }
 
-// TODO: move transient side effect to different function
-// expect red, green, blue to be in range of 0 to 255
-static void showColor(RGBLed *device, uint8_t red, uint8_t green, uint8_t blue, bool balanced) {
-    if (!device || !device->writePwm) {
+static void stopDither(RGBLed *device) {
+    if (!device->dithering) {
         return;
     }
 
-    device->showingTransientStatus = false;
-    if (balanced) {
-        writeColorPwmBalanced(device, red, green, blue);
-    } else {
-        writeColorPwm(device, red, green, blue);
+    device->enableDither(false);
+    device->dithering = false;
+    // the update interrupt has been writing duties of its own
+    device->dutyWritten = false;
+}
+
+static void writeDuty(RGBLed *device, uint16_t red, uint16_t green, uint16_t blue) {
+    stopDither(device);
+
+    // repeated frames of the same color leave the compare registers alone
+    if (device->dutyWritten && red == device->lastDuty[0] && green == device->lastDuty[1] &&
+        blue == device->lastDuty[2]) {
+        return;
     }
-    device->msOfColorChange = device->ms;
+
+    device->lastDuty[0] = red;
+    device->lastDuty[1] = green;
+    device->lastDuty[2] = blue;
+    device->dutyWritten = true;
+    device->writePwm(red, green, blue);
 }
 
-static void showTransientColor(
-    RGBLed *device, uint8_t red, uint8_t green, uint8_t blue, bool balanced) {
-    if (!device || !device->writePwm) {
+static void writeColorPwm(RGBLed *device, uint8_t red, uint8_t green, uint8_t blue) {
+    writeDuty(
+        device, colorToDuty(device, red), colorToDuty(device, green), colorToDuty(device, blue));
+}
+
+static void writeColorPwmBalanced(RGBLed *device, uint8_t red, uint8_t green, uint8_t blue) {
+    uint16_t redDuty = device->dutyTable[0][red];
+    uint16_t greenDuty = device->dutyTable[1][green];
+    uint16_t blueDuty = device->dutyTable[2][blue];
+
+    bool betweenSteps = needsDither(device, redDuty) || needsDither(device, greenDuty) ||
+                        needsDither(device, blueDuty);
+    if (device->enableDither && betweenSteps) {
+        device->ditherTarget[0] = redDuty;
+        device->ditherTarget[1] = greenDuty;
+        device->ditherTarget[2] = blueDuty;
+        if (!device->dithering) {
+            device->ditherError[0] = 0;
+            device->ditherError[1] = 0;
+            device->ditherError[2] = 0;
+            device->dithering = true;
+            device->enableDither(true);
+        }
         return;
     }
 
-    device->showingTransientStatus = true;
+    writeDuty(
+        device,
+        roundedDuty(device, redDuty),
+        roundedDuty(device, greenDuty),
+        roundedDuty(device, blueDuty));
+}
 
-    if (balanced) {
-        writeColorPwmBalanced(device, red, green, blue);
-    } else {
-        writeColorPwm(device, red, green, blue);
+static void setLayer(
+    RGBLed *device, RGBLayer layer, uint8_t red, uint8_t green, uint8_t blue, bool balanced) {
+    if (!device) {
+        return;
     }
-    device->msOfColorChange = device->ms;
+
+    device->layers[layer] = (RGBLayerColor){
+        .active = true,
+        .balanced = balanced,
+        .red = red,
+        .green = green,
+        .blue = blue,
+    };
 }
 
-bool rgbInit(RGBLed *device, RGBWritePwm writePwm, uint16_t period) {
-    if (!device || !writePwm) {
-        return false;
+static void showStatus(RGBLed *device, uint8_t red, uint8_t green, uint8_t blue) {
+    if (!device) {
+        return;
     }
 
-    // Max period for colorToDuty: 255 * (period + 1) * 0x8081 must fit in uint32_t.
-    // 255 * 511 * 0x8081 = 4,286,644,335 <= UINT32_MAX, but 255 * 512 * 0x8081 overflows,
-    // so period must be <= 510.
-    if (period > 510) {
+    setLayer(device, RGB_LAYER_STATUS, red, green, blue, true);
+    device->msOfStatusChange = device->ms;
+}
+
+static bool statusExpired(const RGBLed *device, uint32_t milliseconds) {
+    return milliseconds - device->msOfStatusChange > RGB_STATUS_MS;
+}
+
+static bool sameLayerColor(const RGBLayerColor *a, const RGBLayerColor *b) {
+    return a->active == b->active && a->balanced == b->balanced && a->red == b->red &&
+           a->green == b->green && a->blue == b->blue;
+}
+
+bool rgbInit(RGBLed *device, RGBWritePwm writePwm, uint16_t period) {
+    // full scale duty is period + 1, which has to fit the compare register
+    if (!device || !writePwm || period == UINT16_MAX) {
         return false;
     }
 
@@ -130,11 +215,17 @@ bool rgbInit(RGBLed *device, RGBWritePwm writePwm, uint16_t period) {
     };
 
     device->ms = 0;
-    device->msOfColorChange = 0;
-    device->showingTransientStatus = false;
-    device->userRed = 0;
-    device->userGreen = 0;
-    device->userBlue = 0;
+    device->msOfStatusChange = 0;
+    for (uint8_t layer = 0; layer < RGB_LAYER_COUNT; layer++) {
+        device->layers[layer] = (RGBLayerColor){0};
+    }
+    // nothing has been driven yet, the first compose always writes
+    device->shown = (RGBLayerColor){0};
+    device->dutyWritten = false;
+    device->enableDither = NULL;
+    device->dithering = false;
+    device->fractionBits = fractionBitsForPeriod(period);
+    buildDutyTables(device);
     return true;
 }
 
@@ -143,64 +234,130 @@ void rgbSetWhiteBalance(RGBLed *device, RGBWhiteBalance whiteBalance) {
         return;
     }
 
+    if (device->whiteBalance.red == whiteBalance.red &&
+        device->whiteBalance.green == whiteBalance.green &&
+        device->whiteBalance.blue == whiteBalance.blue) {
+        return;
+    }
+
     device->whiteBalance = whiteBalance;
+    buildDutyTables(device);
+    // balanced duties changed, the next compose has to look them up again
+    device->shown.active = false;
 }
 
-void rgbTransientTask(RGBLed *device, uint32_t milliseconds) {
+void rgbSetDitherControl(RGBLed *device, RGBEnableDither enableDither) {
     if (!device) {
         return;
     }
 
+    stopDither(device);
+    device->enableDither = enableDither;
+}
+
+void rgbDitherUpdate(RGBLed *device) {
+    if (!device->dithering) {
+        return;
+    }
+
+    // first order sigma-delta, the fraction carried between periods averages out to the target
+    uint16_t duty[RGB_CHANNEL_COUNT];
+    uint16_t mask = (uint16_t)((1U << device->fractionBits) - 1U);
+    for (uint8_t channel = 0; channel < RGB_CHANNEL_COUNT; channel++) {
+        uint32_t accumulated =
+            (uint32_t)device->ditherError[channel] + device->ditherTarget[channel];
+        duty[channel] = (uint16_t)(accumulated >> device->fractionBits);
+        device->ditherError[channel] = (uint16_t)(accumulated & mask);
+    }
+    device->writePwm(duty[0], duty[1], duty[2]);
+}
+
+void rgbCompose(RGBLed *device, uint32_t milliseconds) {
+    if (!device || !device->writePwm) {
+        return;
+    }
+
     device->ms = milliseconds;
+    if (device->layers[RGB_LAYER_STATUS].active && statusExpired(device, milliseconds)) {
+        device->layers[RGB_LAYER_STATUS].active = false;
+    }
 
-    uint32_t elapsedMillis = milliseconds - device->msOfColorChange;
+    // black when no source wants the LED
+    RGBLayerColor top = {.active = true, .balanced = true};
+    for (uint8_t layer = 0; layer < RGB_LAYER_COUNT; layer++) {
+        if (device->layers[layer].active) {
+            top = device->layers[layer];
+            break;
+        }
+    }
 
-    // show status color for 300 milliseconds, then switch back to user color
-    if (device->showingTransientStatus && elapsedMillis > 300) {
-        showColor(device, device->userRed, device->userGreen, device->userBlue, true);
+    if (sameLayerColor(&top, &device->shown)) {
+        return;
+    }
+    device->shown = top;
+
+    if (top.balanced) {
+        writeColorPwmBalanced(device, top.red, top.green, top.blue);
+    } else {
+        writeColorPwm(device, top.red, top.green, top.blue);
     }
 }
 
-void rgbShowUserColor(RGBLed *device, uint8_t red, uint8_t green, uint8_t blue) {
+void rgbClearLayer(RGBLed *device, RGBLayer layer) {
     if (!device) {
         return;
     }
 
-    device->userRed = red;
-    device->userGreen = green;
-    device->userBlue = blue;
+    device->layers[layer].active = false;
+}
 
-    // only change color if not showing transient status, will show after
-    if (!device->showingTransientStatus) {
-        showColor(device, red, green, blue, true);
+bool rgbLayerActive(const RGBLed *device, RGBLayer layer) {
+    return device && device->layers[layer].active;
+}
+
+bool rgbLayerCovered(const RGBLed *device, RGBLayer layer, uint32_t milliseconds) {
+    if (!device) {
+        return false;
+    }
+
+    for (uint8_t above = 0; above < layer; above++) {
+        if (device->layers[above].active &&
+            (above != RGB_LAYER_STATUS || !statusExpired(device, milliseconds))) {
+            return true;
+        }
     }
+    return false;
+}
+
+void rgbShowUserColor(RGBLed *device, uint8_t red, uint8_t green, uint8_t blue) {
+    setLayer(device, RGB_LAYER_USER, red, green, blue, true);
 }
 
 void rgbShowSuccess(RGBLed *device) {
-    showTransientColor(device, 50, 50, 50, true);
+    showStatus(device, 50, 50, 50);
 }
 
 void rgbShowLocked(RGBLed *device) {
     // balanced: false, show on bulb chips too
-    showColor(device, 0, 0, 255, false);
+    setLayer(device, RGB_LAYER_INDICATOR, 0, 0, 255, false);
 }
 
 void rgbShowShutdown(RGBLed *device) {
-    showColor(device, 0, 0, 0, true);
+    setLayer(device, RGB_LAYER_INDICATOR, 0, 0, 0, true);
 }
 
 void rgbShowNotCharging(RGBLed *device) {
-    showTransientColor(device, 25, 0, 25, true);
+    showStatus(device, 25, 0, 25);
 }
 
 void rgbShowConstantCurrentCharging(RGBLed *device) {
-    showTransientColor(device, 25, 0, 0, true);
+    showStatus(device, 25, 0, 0);
 }
 
 void rgbShowConstantVoltageCharging(RGBLed *device) {
-    showTransientColor(device, 25, 25, 0, true);
+    showStatus(device, 25, 25, 0);
 }
 
 void rgbShowDoneCharging(RGBLed *device) {
-    showTransientColor(device, 0, 25, 0, true);
+    showStatus(device, 0, 25, 0);
 }
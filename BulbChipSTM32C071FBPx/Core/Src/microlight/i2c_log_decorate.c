@@ -27,29 +27,15 @@ static void internalLog(
     }
 }
 
-void i2cDecoratedWrite(
-    uint8_t devAddress,
-    uint8_t reg,
-    uint8_t value,
-    I2CWriteRegisterChecked rawFunc,
-    const bool *enableFlag,
-    Log log) {
-    if (rawFunc && !rawFunc(devAddress, reg, value)) {
-        internalLog(log, enableFlag, "Write", devAddress, reg);
+void i2cLogFailure(const I2CTransaction *transaction, const bool *enableFlag, Log log) {
+    if (!transaction) {
+        return;
     }
-}
-
-bool i2cDecoratedReadRegisters(
-    uint8_t devAddress,
-    uint8_t startReg,
-    uint8_t *buffer,
-    size_t length,
-    I2CReadRegisters rawFunc,
-    const bool *enableFlag,
-    Log log) {
-    if (rawFunc && rawFunc(devAddress, startReg, buffer, length)) {
-        return true;
+    const char *operation = "Write";
+    if (transaction->isRead) {
+        operation = "ReadMul";
+    } else if (transaction->length > 1) {
+        operation = "WriteMul";
     }
-    internalLog(log, enableFlag, "ReadMul", devAddress, startReg);
-    return false;
+    internalLog(log, enableFlag, operation, transaction->devAddress, transaction->reg);
 }
@@ -31,11 +31,11 @@ static bool setParserError(ParserErrorContext *ctx, ParserError error, const cha
     return false;
 }
 
-static bool parseUint8Setting(
+static bool parseUint16Setting(
     lwjson_t *lwjson,
     const char *path,
-    uint8_t maxValue,
-    uint8_t *destination,
+    uint16_t maxValue,
+    uint16_t *destination,
     ParserErrorContext *ctx) {
     const lwjson_token_t *token = lwjson_find(lwjson, path);
     if (token == NULL) {
@@ -53,7 +53,21 @@ static bool parseUint8Setting(
         return setParserError(ctx, PARSER_ERR_VALUE_TOO_LARGE, path);
     }
 
-    *destination = (uint8_t)token->u.num_int;
+    *destination = (uint16_t)token->u.num_int;
+    return true;
+}
+
+static bool parseUint8Setting(
+    lwjson_t *lwjson,
+    const char *path,
+    uint8_t maxValue,
+    uint8_t *destination,
+    ParserErrorContext *ctx) {
+    uint16_t value = *destination;
+    if (!parseUint16Setting(lwjson, path, maxValue, &value, ctx)) {
+        return false;
+    }
+    *destination = (uint8_t)value;
     return true;
 }
 
@@ -86,11 +100,24 @@ static uint8_t maxUint8SettingValue(const char *path) {
     return UINT8_MAX;
 }
 
+static uint16_t maxUint16SettingValue(const char *path) {
+    if (strcmp(path, "modeCrossfadeMs") == 0) {
+        return MAX_MODE_CROSSFADE_MS;
+    }
+    return UINT16_MAX;
+}
+
 #define PARSE_SETTING_uint8_t(name, def)                                                        \
     if (!parseUint8Setting(lwjson, #name, maxUint8SettingValue(#name), &settings->name, ctx)) { \
         return false;                                                                           \
     }
 
+#define PARSE_SETTING_uint16_t(name, def)                                              \
+    if (!parseUint16Setting(                                                           \
+            lwjson, #name, maxUint16SettingValue(#name), &settings->name, ctx)) {      \
+        return false;                                                                  \
+    }
+
 #define PARSE_SETTING_bool(name, def)                             \
     if (!parseBoolSetting(lwjson, #name, &settings->name, ctx)) { \
         return false;                                             \
@@ -106,6 +133,7 @@ static bool parseSettingsJson(lwjson_t *lwjson, ChipSettings *settings, ParserEr
 
 #undef PARSE_SETTING
 #undef PARSE_SETTING_bool
+#undef PARSE_SETTING_uint16_t
 #undef PARSE_SETTING_uint8_t
 
 static void handleWriteMode(lwjson_t *lwjson, CliInput *input) {
@@ -142,6 +170,35 @@ static void handleReadMode(lwjson_t *lwjson, CliInput *input) {
     }
 }
 
+static void handleEstimatePower(lwjson_t *lwjson, CliInput *input) {
+    const lwjson_token_t *token = lwjson_find(lwjson, "index");
+    if (token != NULL) {
+        input->modeIndex = token->u.num_int;
+        input->parsedType = parseEstimatePower;
+    }
+}
+
+static void handleReadTelemetry(lwjson_t *lwjson, CliInput *input) {
+    input->telemetryFirst = 0;
+    const lwjson_token_t *token = lwjson_find(lwjson, "first");
+    if (token != NULL) {
+        if (token->type != LWJSON_TYPE_NUM_INT) {
+            setParserError(&input->errorContext, PARSER_ERR_INVALID_VARIANT, "first");
+            return;
+        }
+        if (token->u.num_int < 0) {
+            setParserError(&input->errorContext, PARSER_ERR_VALUE_TOO_SMALL, "first");
+            return;
+        }
+        if (token->u.num_int > UINT16_MAX) {
+            setParserError(&input->errorContext, PARSER_ERR_VALUE_TOO_LARGE, "first");
+            return;
+        }
+        input->telemetryFirst = (uint16_t)token->u.num_int;
+    }
+    input->parsedType = parseReadTelemetry;
+}
+
 static void handleWriteSettings(lwjson_t *lwjson, CliInput *input) {
     ChipSettings settings;
     chipSettingsInitDefaults(&settings);
@@ -179,6 +236,10 @@ static void processCommand(lwjson_t *lwjson, CliInput *input) {
         input->parsedType = parseReadSettings;
     } else if (strncmp(command, "dfu", 3) == 0) {
         input->parsedType = parseDfu;
+    } else if (strncmp(command, "estimatePower", 13) == 0) {
+        handleEstimatePower(lwjson, input);
+    } else if (strncmp(command, "readTelemetry", 13) == 0) {
+        handleReadTelemetry(lwjson, input);
     }
 }
 
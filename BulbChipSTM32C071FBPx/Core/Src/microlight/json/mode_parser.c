@@ -164,6 +164,8 @@ static bool parseChannelConfig(
     lwjson_t *lwjson, lwjson_token_t *token, ChannelConfig *out, ParserErrorContext *ctx);
 static bool parseEquationPattern(
     lwjson_t *lwjson, lwjson_token_t *token, EquationPattern *out, ParserErrorContext *ctx);
+static bool parseKeyframePattern(
+    lwjson_t *lwjson, lwjson_token_t *token, KeyframePattern *out, ParserErrorContext *ctx);
 static bool parseModePattern(
     lwjson_t *lwjson, lwjson_token_t *token, ModePattern *out, ParserErrorContext *ctx);
 static bool parseModeComponent(
@@ -172,6 +174,12 @@ static bool parseModeAccelTrigger(
     lwjson_t *lwjson, lwjson_token_t *token, ModeAccelTrigger *out, ParserErrorContext *ctx);
 static bool parseModeAccel(
     lwjson_t *lwjson, lwjson_token_t *token, ModeAccel *out, ParserErrorContext *ctx);
+static bool parseModeTransition(
+    lwjson_t *lwjson, lwjson_token_t *token, ModeTransition *out, ParserErrorContext *ctx);
+static bool parseModeScriptState(
+    lwjson_t *lwjson, lwjson_token_t *token, ModeScriptState *out, ParserErrorContext *ctx);
+static bool parseModeScript(
+    lwjson_t *lwjson, lwjson_token_t *token, ModeScript *out, ParserErrorContext *ctx);
 
 static bool parsePatternChange(
     lwjson_t *lwjson, lwjson_token_t *token, PatternChange *out, ParserErrorContext *ctx) {
@@ -378,6 +386,75 @@ static bool parseEquationPattern(
     return true;
 }
 
+static bool parseKeyframePattern(
+    lwjson_t *lwjson, lwjson_token_t *token, KeyframePattern *out, ParserErrorContext *ctx) {
+    const lwjson_token_t *tokenField;
+    out->changeAtCount = 0;
+    tokenField = lwjson_find_ex(lwjson, token, "name");
+    if (tokenField != NULL) {
+        if (!parseStringField(tokenField, out->name, 1, MODE_NAME_MAX_LEN - 1, ctx, "name")) {
+            return false;
+        }
+    } else {
+        ctx->error = PARSER_ERR_MISSING_FIELD;
+        strcpy(ctx->path, "name");
+        return false;
+    }
+    tokenField = lwjson_find_ex(lwjson, token, "duration");
+    if (tokenField != NULL) {
+        if (!parseUInt32Field(tokenField, &out->duration, 1, 4294967295U, ctx, "duration")) {
+            return false;
+        }
+    } else {
+        ctx->error = PARSER_ERR_MISSING_FIELD;
+        strcpy(ctx->path, "duration");
+        return false;
+    }
+    tokenField = lwjson_find_ex(lwjson, token, "easing");
+    if (tokenField != NULL) {
+        char enumStr[32];
+        if (!parseStringField(tokenField, enumStr, 1, 31, ctx, "easing")) {
+            return false;
+        }
+        if (strcmp(enumStr, "linear") == 0) {
+            out->easing = KEYFRAME_EASING_LINEAR;
+        } else if (strcmp(enumStr, "ease") == 0) {
+            out->easing = KEYFRAME_EASING_EASE;
+        } else {
+            ctx->error = PARSER_ERR_INVALID_VARIANT;
+            strcpy(ctx->path, "easing");
+            return false;
+        }
+    } else {
+        ctx->error = PARSER_ERR_MISSING_FIELD;
+        strcpy(ctx->path, "easing");
+        return false;
+    }
+    tokenField = lwjson_find_ex(lwjson, token, "changeAt");
+    if (tokenField != NULL) {
+        const lwjson_token_t *child = lwjson_get_first_child(tokenField);
+        while (child != NULL && out->changeAtCount < SIMPLE_PATTERN_CHANGES_MAX) {
+            if (!parsePatternChange(
+                    lwjson, (lwjson_token_t *)child, &out->changeAt[out->changeAtCount], ctx)) {
+                prependContext(ctx, "changeAt", out->changeAtCount);
+                return false;
+            }
+            out->changeAtCount++;
+            child = child->next;
+        }
+        if (out->changeAtCount < 1) {
+            ctx->error = PARSER_ERR_ARRAY_TOO_SHORT;
+            strcpy(ctx->path, "changeAt");
+            return false;
+        }
+    } else {
+        ctx->error = PARSER_ERR_MISSING_FIELD;
+        strcpy(ctx->path, "changeAt");
+        return false;
+    }
+    return true;
+}
+
 static bool parseModePattern(
     lwjson_t *lwjson, lwjson_token_t *token, ModePattern *out, ParserErrorContext *ctx) {
     const lwjson_token_t *tokenField;
@@ -397,6 +474,11 @@ static bool parseModePattern(
             if (!parseEquationPattern(lwjson, token, &out->data.equation, ctx)) {
                 return false;
             }
+        } else if (strcmp(typeStr, "keyframe") == 0) {
+            out->type = PATTERN_TYPE_KEYFRAME;
+            if (!parseKeyframePattern(lwjson, token, &out->data.keyframe, ctx)) {
+                return false;
+            }
         } else {
             ctx->error = PARSER_ERR_INVALID_VARIANT;
             strcpy(ctx->path, "type");
@@ -430,6 +512,7 @@ static bool parseModeComponent(
 static bool parseModeAccelTrigger(
     lwjson_t *lwjson, lwjson_token_t *token, ModeAccelTrigger *out, ParserErrorContext *ctx) {
     const lwjson_token_t *tokenField;
+    out->hasHoldMs = false;
     out->hasFront = false;
     out->hasCaseComp = false;
     tokenField = lwjson_find_ex(lwjson, token, "threshold");
@@ -442,6 +525,13 @@ static bool parseModeAccelTrigger(
         strcpy(ctx->path, "threshold");
         return false;
     }
+    tokenField = lwjson_find_ex(lwjson, token, "holdMs");
+    if (tokenField != NULL) {
+        if (!parseUInt32Field(tokenField, &out->holdMs, 0, 4294967295U, ctx, "holdMs")) {
+            return false;
+        }
+        out->hasHoldMs = true;
+    }
     tokenField = lwjson_find_ex(lwjson, token, "front");
     if (tokenField != NULL) {
         if (!parseModeComponent(lwjson, (lwjson_token_t *)tokenField, &out->front, ctx)) {
@@ -495,11 +585,155 @@ static bool parseModeAccel(
     return true;
 }
 
+static bool parseModeTransition(
+    lwjson_t *lwjson, lwjson_token_t *token, ModeTransition *out, ParserErrorContext *ctx) {
+    const lwjson_token_t *tokenField;
+    out->hasThreshold = false;
+    out->hasMs = false;
+    tokenField = lwjson_find_ex(lwjson, token, "from");
+    if (tokenField != NULL) {
+        if (!parseUInt8Field(tokenField, &out->from, 0, 255, ctx, "from")) {
+            return false;
+        }
+    } else {
+        ctx->error = PARSER_ERR_MISSING_FIELD;
+        strcpy(ctx->path, "from");
+        return false;
+    }
+    tokenField = lwjson_find_ex(lwjson, token, "to");
+    if (tokenField != NULL) {
+        if (!parseUInt8Field(tokenField, &out->to, 0, 255, ctx, "to")) {
+            return false;
+        }
+    } else {
+        ctx->error = PARSER_ERR_MISSING_FIELD;
+        strcpy(ctx->path, "to");
+        return false;
+    }
+    tokenField = lwjson_find_ex(lwjson, token, "on");
+    if (tokenField != NULL) {
+        char enumStr[32];
+        if (!parseStringField(tokenField, enumStr, 1, 31, ctx, "on")) {
+            return false;
+        }
+        if (strcmp(enumStr, "accel") == 0) {
+            out->on = MODE_TRANSITION_EVENT_ACCEL;
+        } else if (strcmp(enumStr, "still") == 0) {
+            out->on = MODE_TRANSITION_EVENT_STILL;
+        } else if (strcmp(enumStr, "timer") == 0) {
+            out->on = MODE_TRANSITION_EVENT_TIMER;
+        } else if (strcmp(enumStr, "button") == 0) {
+            out->on = MODE_TRANSITION_EVENT_BUTTON;
+        } else if (strcmp(enumStr, "charge") == 0) {
+            out->on = MODE_TRANSITION_EVENT_CHARGE;
+        } else {
+            ctx->error = PARSER_ERR_INVALID_VARIANT;
+            strcpy(ctx->path, "on");
+            return false;
+        }
+    } else {
+        ctx->error = PARSER_ERR_MISSING_FIELD;
+        strcpy(ctx->path, "on");
+        return false;
+    }
+    tokenField = lwjson_find_ex(lwjson, token, "threshold");
+    if (tokenField != NULL) {
+        if (!parseUInt8Field(tokenField, &out->threshold, 0, 255, ctx, "threshold")) {
+            return false;
+        }
+        out->hasThreshold = true;
+    }
+    tokenField = lwjson_find_ex(lwjson, token, "ms");
+    if (tokenField != NULL) {
+        if (!parseUInt32Field(tokenField, &out->ms, 0, 4294967295U, ctx, "ms")) {
+            return false;
+        }
+        out->hasMs = true;
+    }
+    return true;
+}
+
+static bool parseModeScriptState(
+    lwjson_t *lwjson, lwjson_token_t *token, ModeScriptState *out, ParserErrorContext *ctx) {
+    const lwjson_token_t *tokenField;
+    out->hasFront = false;
+    out->hasCaseComp = false;
+    tokenField = lwjson_find_ex(lwjson, token, "front");
+    if (tokenField != NULL) {
+        if (!parseUInt8Field(tokenField, &out->front, 0, 255, ctx, "front")) {
+            return false;
+        }
+        out->hasFront = true;
+    }
+    tokenField = lwjson_find_ex(lwjson, token, "case");
+    if (tokenField != NULL) {
+        if (!parseUInt8Field(tokenField, &out->caseComp, 0, 255, ctx, "case")) {
+            return false;
+        }
+        out->hasCaseComp = true;
+    }
+    return true;
+}
+
+static bool parseModeScript(
+    lwjson_t *lwjson, lwjson_token_t *token, ModeScript *out, ParserErrorContext *ctx) {
+    const lwjson_token_t *tokenField;
+    out->hasStates = false;
+    out->statesCount = 0;
+    out->transitionsCount = 0;
+    tokenField = lwjson_find_ex(lwjson, token, "states");
+    if (tokenField != NULL) {
+        const lwjson_token_t *child = lwjson_get_first_child(tokenField);
+        while (child != NULL && out->statesCount < MODE_SCRIPT_STATES_MAX) {
+            if (!parseModeScriptState(
+                    lwjson, (lwjson_token_t *)child, &out->states[out->statesCount], ctx)) {
+                prependContext(ctx, "states", out->statesCount);
+                return false;
+            }
+            out->statesCount++;
+            child = child->next;
+        }
+        if (out->statesCount < 1) {
+            ctx->error = PARSER_ERR_ARRAY_TOO_SHORT;
+            strcpy(ctx->path, "states");
+            return false;
+        }
+        out->hasStates = true;
+    }
+    tokenField = lwjson_find_ex(lwjson, token, "transitions");
+    if (tokenField != NULL) {
+        const lwjson_token_t *child = lwjson_get_first_child(tokenField);
+        while (child != NULL && out->transitionsCount < MODE_SCRIPT_TRANSITIONS_MAX) {
+            if (!parseModeTransition(
+                    lwjson,
+                    (lwjson_token_t *)child,
+                    &out->transitions[out->transitionsCount],
+                    ctx)) {
+                prependContext(ctx, "transitions", out->transitionsCount);
+                return false;
+            }
+            out->transitionsCount++;
+            child = child->next;
+        }
+        if (out->transitionsCount < 1) {
+            ctx->error = PARSER_ERR_ARRAY_TOO_SHORT;
+            strcpy(ctx->path, "transitions");
+            return false;
+        }
+    } else {
+        ctx->error = PARSER_ERR_MISSING_FIELD;
+        strcpy(ctx->path, "transitions");
+        return false;
+    }
+    return true;
+}
+
 bool parseMode(lwjson_t *lwjson, lwjson_token_t *token, Mode *out, ParserErrorContext *ctx) {
     const lwjson_token_t *tokenField;
     out->hasFront = false;
     out->hasCaseComp = false;
     out->hasAccel = false;
+    out->hasScript = false;
     tokenField = lwjson_find_ex(lwjson, token, "name");
     if (tokenField != NULL) {
         if (!parseStringField(tokenField, out->name, 1, MODE_NAME_MAX_LEN - 1, ctx, "name")) {
@@ -534,6 +768,14 @@ bool parseMode(lwjson_t *lwjson, lwjson_token_t *token, Mode *out, ParserErrorCo
         }
         out->hasAccel = true;
     }
+    tokenField = lwjson_find_ex(lwjson, token, "script");
+    if (tokenField != NULL) {
+        if (!parseModeScript(lwjson, (lwjson_token_t *)tokenField, &out->script, ctx)) {
+            prependContext(ctx, "script", -1);
+            return false;
+        }
+        out->hasScript = true;
+    }
     if (!(out->hasFront || out->hasCaseComp)) {
         ctx->error = PARSER_ERR_VALIDATION_FAILED;
         strcpy(ctx->path, "front");
@@ -10,7 +10,20 @@ static volatile bool autoOffTimerInterruptTriggered = false;
 static volatile uint32_t microLightTicks = 0;
 
 static uint32_t (*convertTicksToMilliseconds)(uint32_t ticks) = NULL;
+static uint32_t (*rtcMilliseconds)(void) = NULL;
+static void (*enableChipTickTimer)(bool enable) = NULL;
+static uint32_t (*enterStopModeForMilliseconds)(uint32_t milliseconds) = NULL;
 
+// Time comes from the RTC, which keeps counting in Stop mode, while the chip tick is off and
+// across clock changes. The chip tick runs off the more accurate HSI and trims the RTC rate.
+static MonotonicClock monotonicClock;
+
+// A bus that stays stuck fails on every retry, keep it from cycling the whole telemetry ring
+#define I2C_FAILURE_TELEMETRY_INTERVAL_MS 60000
+static bool i2cFailureRecorded = false;
+static uint32_t i2cFailureRecordedAtMs = 0;
+
+static I2CQueue i2cQueue;
 static BQ25180 chargerIC;
 static Button button;
 static MC3479 accel;
@@ -20,6 +33,20 @@ static ModeManager modeManager;
 static SettingsManager settingsManager;
 static USBManager usbManager;
 static ChipState chipState;
+static Telemetry telemetry;
+
+// if rtcMilliseconds is null, let it crash if not microlight is not configured
+static uint32_t currentMilliseconds(void) {
+    uint32_t milliseconds = monotonicClockUpdate(&monotonicClock, rtcMilliseconds());
+    monotonicClockCalibrate(&monotonicClock, convertTicksToMilliseconds(microLightTicks));
+    return milliseconds;
+}
+
+// chip ticks stop counting with the timer, a window across the gap would trim the rate wrong
+static void internalEnableChipTickTimer(bool enable) {
+    enableChipTickTimer(enable);
+    monotonicClockRestartCalibration(&monotonicClock);
+}
 
 static void internalLog(const char *buffer, size_t length) {
     if (usbManager.usbWrite != NULL) {
@@ -27,52 +54,55 @@ static void internalLog(const char *buffer, size_t length) {
     }
 }
 
-// Wrap I2C dependencies to handle logging internal to this file
-static I2CWriteRegisterChecked rawI2cWrite = NULL;
-static I2CReadRegisters rawI2cReadRegs = NULL;
-
-static void internalI2cWriteRegister(uint8_t devAddress, uint8_t reg, uint8_t value) {
-    i2cDecoratedWrite(
-        devAddress,
-        reg,
-        value,
-        rawI2cWrite,
-        &settingsManager.currentSettings.enableI2cFailureReporting,
-        internalLog);
-}
+// Handle I2C failure logging internal to this file
+static void internalI2cFailure(const I2CTransaction *transaction) {
+    i2cLogFailure(
+        transaction, &settingsManager.currentSettings.enableI2cFailureReporting, internalLog);
 
-static bool internalI2cReadRegisters(
-    uint8_t devAddress, uint8_t startReg, uint8_t *buffer, size_t length) {
-    return i2cDecoratedReadRegisters(
-        devAddress,
-        startReg,
-        buffer,
-        length,
-        rawI2cReadRegs,
-        &settingsManager.currentSettings.enableI2cFailureReporting,
-        internalLog);
+    uint32_t milliseconds = currentMilliseconds();
+    if (i2cFailureRecorded &&
+        milliseconds - i2cFailureRecordedAtMs < I2C_FAILURE_TELEMETRY_INTERVAL_MS) {
+        return;
+    }
+    i2cFailureRecorded = true;
+    i2cFailureRecordedAtMs = milliseconds;
+    uint16_t value = (uint16_t)(transaction->reg | (transaction->isRead ? 0x100 : 0));
+    telemetryRecord(
+        &telemetry, TELEMETRY_EVENT_I2C_FAILURE, transaction->devAddress, value, milliseconds);
 }
 
 bool configureMicroLight(MicroLightDependencies *deps) {
-    if (!deps || !deps->convertTicksToMilliseconds || !deps->i2cReadRegisters ||
-        !deps->i2cWriteRegister || !deps->writeRgbPwmCaseLed || !deps->writeRgbPwmFrontLed ||
-        !deps->readButtonPin || !deps->enableChipTickTimer || !deps->enableCaseLedTimer ||
+    if (!deps || !deps->convertTicksToMilliseconds || !deps->rtcMilliseconds ||
+        !deps->i2cStartRead || !deps->i2cStartWrite || !deps->i2cAbort || !deps->i2cMilliseconds ||
+        !deps->writeRgbPwmCaseLed || !deps->writeRgbPwmFrontLed || !deps->readButtonPin ||
+        !deps->buttonMilliseconds || !deps->enableChipTickTimer || !deps->enableCaseLedTimer ||
         !deps->enableFrontLedTimer || !deps->enableAutoOffTimer || !deps->enableUsbClock ||
-        !deps->enterStandbyMode || !deps->waitForButtonWakeOrAutoLock || !deps->systemReset ||
-        !deps->readSavedMode || !deps->writeBulbLed || !deps->readSavedSettings ||
-        !deps->enterDFU || !deps->saveSettings || !deps->saveMode || !deps->usbReadTask ||
-        !deps->usbWrite || !deps->jsonBuffer || deps->jsonBufferSize == 0) {
+        !deps->enableLowPowerClock || !deps->enterStandbyMode ||
+        !deps->waitForButtonWakeOrAutoLock || !deps->enterStopModeForMilliseconds ||
+        !deps->systemReset || !deps->readSavedMode || !deps->writeBulbLed ||
+        !deps->readSavedSettings || !deps->enterDFU || !deps->saveSettings || !deps->saveMode ||
+        !deps->eraseTelemetryPage || !deps->writeTelemetry || !deps->readTelemetry ||
+        !deps->usbReadTask || !deps->usbWrite || !deps->usbTxFree || !deps->jsonBuffer ||
+        deps->jsonBufferSize == 0) {
         return false;
     }
 
     convertTicksToMilliseconds = deps->convertTicksToMilliseconds;
-    rawI2cWrite = deps->i2cWriteRegister;
-    rawI2cReadRegs = deps->i2cReadRegisters;
+    rtcMilliseconds = deps->rtcMilliseconds;
+    enableChipTickTimer = deps->enableChipTickTimer;
+    enterStopModeForMilliseconds = deps->enterStopModeForMilliseconds;
+    monotonicClockInit(&monotonicClock);
 
     if (!initSharedJsonIOBuffer(deps->jsonBuffer, deps->jsonBufferSize)) {
         return false;
     }
 
+    if (!telemetryInit(
+            &telemetry, deps->eraseTelemetryPage, deps->writeTelemetry, deps->readTelemetry)) {
+        return false;
+    }
+    telemetryRecord(&telemetry, TELEMETRY_EVENT_BOOT, 0, 0, 0);
+
     if (!rgbInit(&caseLed, deps->writeRgbPwmCaseLed, (uint16_t)deps->rgbTimerPeriod)) {
         return false;
     }
@@ -80,23 +110,28 @@ bool configureMicroLight(MicroLightDependencies *deps) {
     if (!rgbInit(&frontLed, deps->writeRgbPwmFrontLed, (uint16_t)deps->rgbTimerPeriod)) {
         return false;
     }
+    rgbSetDitherControl(&caseLed, deps->enableCaseLedDither);
+    rgbSetDitherControl(&frontLed, deps->enableFrontLedDither);
 
-    if (!buttonInit(&button, deps->readButtonPin)) {
+    if (!buttonInit(&button, deps->readButtonPin, deps->buttonMilliseconds)) {
         return false;
     }
 
-    if (!mc3479Init(
-            &accel, internalI2cReadRegisters, internalI2cWriteRegister, MC3479_I2CADDR_DEFAULT)) {
+    if (!i2cQueueInit(
+            &i2cQueue,
+            deps->i2cStartRead,
+            deps->i2cStartWrite,
+            deps->i2cAbort,
+            deps->i2cMilliseconds,
+            internalI2cFailure)) {
         return false;
     }
 
-    if (!bq25180Init(
-            &chargerIC,
-            internalI2cReadRegisters,
-            internalI2cWriteRegister,
-            (0x6A << 1),
-            internalLog,
-            &caseLed)) {
+    if (!mc3479Init(&accel, &i2cQueue, MC3479_I2CADDR_DEFAULT)) {
+        return false;
+    }
+
+    if (!bq25180Init(&chargerIC, &i2cQueue, (0x6A << 1), internalLog, &caseLed)) {
         return false;
     }
 
@@ -119,11 +154,14 @@ bool configureMicroLight(MicroLightDependencies *deps) {
             &usbManager,
             &modeManager,
             &settingsManager,
+            &telemetry,
             deps->enterDFU,
             deps->saveSettings,
             deps->saveMode,
             deps->usbReadTask,
-            deps->usbWrite)) {
+            deps->usbWrite,
+            deps->usbTxFree,
+            currentMilliseconds)) {
         return false;
     }
 
@@ -137,11 +175,14 @@ bool configureMicroLight(MicroLightDependencies *deps) {
                 .frontLed = &frontLed,
                 .chargerIC = &chargerIC,
                 .accel = &accel,
-                .enableChipTickTimer = deps->enableChipTickTimer,
+                .i2c = &i2cQueue,
+                .telemetry = &telemetry,
+                .enableChipTickTimer = internalEnableChipTickTimer,
                 .enableCaseLedTimer = deps->enableCaseLedTimer,
                 .enableFrontLedTimer = deps->enableFrontLedTimer,
                 .enableAutoOffTimer = deps->enableAutoOffTimer,
                 .enableUsbClock = deps->enableUsbClock,
+                .enableLowPowerClock = deps->enableLowPowerClock,
                 .enterStandbyMode = deps->enterStandbyMode,
                 .waitForButtonWakeOrAutoLock = deps->waitForButtonWakeOrAutoLock,
                 .systemReset = deps->systemReset,
@@ -164,8 +205,10 @@ bool configureMicroLight(MicroLightDependencies *deps) {
 void microLightTask(void) {
     usbTask(&usbManager);
 
-    // if convertTicksToMilliseconds is null, let it crash if not microlight is not configured
-    uint32_t milliseconds = convertTicksToMilliseconds(microLightTicks);
+    // hand finished transfers to the drivers before they look at their state
+    i2cQueueTask(&i2cQueue);
+
+    uint32_t milliseconds = currentMilliseconds();
 
     // Potentially could miss an interrupt if it occurs after local copy of false, but set to true
     // in interrupt before clearing. Would need to add critical section mcu dependency to prevent,
@@ -184,11 +227,27 @@ void microLightTask(void) {
             .autoOffTimerInterruptTriggered = autoOffITLocal,
             .buttonInterruptTriggered = buttonITLocal,
             .chargerInterruptTriggered = chargerITLocal});
+
+    // Events are rare, writing them as they come keeps a sudden power loss from taking them along
+    if (telemetryHasPending(&telemetry)) {
+        telemetryFlush(&telemetry);
+    }
+
+    // An interrupt that arrived during stateTask has already been serviced and would not wake the
+    // chip, leave it for the next pass. Stop mode would also halt a transfer in flight.
+    uint32_t idleMs = stateIdleBudgetMs(&chipState);
+    if (idleMs > 0 && i2cQueueIdle(&i2cQueue) && !buttonInterruptTriggered &&
+        !chargerInterruptTriggered && !autoOffTimerInterruptTriggered) {
+        uint32_t sleptMs = enterStopModeForMilliseconds(idleMs);
+        monotonicClockRestartCalibration(&monotonicClock);
+        modeNoteStopModeSleep(&modeManager, sleptMs);
+    }
 }
 
 void microLightInterrupt(enum MicroLightInterrupt interrupt) {
     switch (interrupt) {
         case ButtonInterrupt:
+            buttonEdgeInterrupt(&button);
             buttonInterruptTriggered = true;
             break;
         case ChargerInterrupt:
@@ -200,5 +259,17 @@ void microLightInterrupt(enum MicroLightInterrupt interrupt) {
         case AutoOffTimerInterrupt:
             autoOffTimerInterruptTriggered = true;
             break;
+        case I2CCompleteInterrupt:
+            i2cQueueComplete(&i2cQueue, true);
+            break;
+        case I2CErrorInterrupt:
+            i2cQueueComplete(&i2cQueue, false);
+            break;
+        case CaseLedPwmUpdateInterrupt:
+            rgbDitherUpdate(&caseLed);
+            break;
+        case FrontLedPwmUpdateInterrupt:
+            rgbDitherUpdate(&frontLed);
+            break;
     }
 }
@@ -55,7 +55,17 @@ bool modeManagerInit(
     manager->log = log;
     manager->currentModeIndex = 0;
     manager->shouldResetState = true;
+    manager->modeStartedMs = 0;
+    manager->modeSleptMs = 0;
+    manager->crossfadeMs = 0;
+    memset(&manager->crossfade, 0, sizeof(manager->crossfade));
+    memset(&manager->shownFront, 0, sizeof(manager->shownFront));
+    memset(&manager->shownCase, 0, sizeof(manager->shownCase));
+    memset(&manager->lastOutputs, 0, sizeof(manager->lastOutputs));
     memset(&manager->modeState, 0, sizeof(manager->modeState));
+    memset(&manager->liveStream, 0, sizeof(manager->liveStream));
+    manager->buttonTapped = false;
+    manager->charging = false;
     return true;
 }
 
@@ -64,6 +74,14 @@ void setMode(ModeManager *manager, Mode *mode, uint8_t index) {
     manager->currentModeIndex = index;
     manager->shouldResetState = true;
 
+    // timed from the first modeTask of the new mode
+    manager->crossfade = (ModeCrossfade){
+        .active = manager->crossfadeMs > 0,
+        .durationMs = manager->crossfadeMs,
+        .front = manager->shownFront,
+        .caseColor = manager->shownCase,
+    };
+
     if (manager->currentMode.hasAccel && manager->currentMode.accel.triggersCount > 0) {
         mc3479Enable(manager->accel);
     } else {
@@ -102,6 +120,7 @@ void loadMode(ModeManager *manager, uint8_t index) {
 /// @param manager
 void fakeOffMode(ModeManager *manager) {
     loadMode(manager, FAKE_OFF_MODE_INDEX);
+    manager->crossfade.active = false;
     disableFrontOutputs(manager, NULL);
 }
 
@@ -109,63 +128,107 @@ bool isFakeOff(ModeManager *manager) {
     return manager->currentModeIndex == FAKE_OFF_MODE_INDEX;
 }
 
+void startLiveStream(
+    ModeManager *manager, uint8_t frameIntervalMs, uint8_t prefillFrames, uint32_t milliseconds) {
+    // like a transientTest writeMode, previewing turns the chip on
+    if (isFakeOff(manager)) {
+        loadMode(manager, 0);
+    }
+    liveStreamStart(&manager->liveStream, frameIntervalMs, prefillFrames, milliseconds);
+}
+
+void stopLiveStream(ModeManager *manager) {
+    liveStreamStop(&manager->liveStream);
+    manager->shouldResetState = true;
+}
+
+static void showFrontColor(ModeManager *manager, RGBSimpleOutput color) {
+    manager->shownFront = color;
+    rgbShowUserColor(manager->frontLed, color.r, color.g, color.b);
+}
+
+static void showCaseColor(ModeManager *manager, RGBSimpleOutput color) {
+    manager->shownCase = color;
+    rgbShowUserColor(manager->caseLed, color.r, color.g, color.b);
+}
+
 static void disableFrontOutputs(ModeManager *manager, ModeOutputs *outputs) {
     // Legacy: ensure bulb GPIO is forced low when PWM front output is not used.
     manager->writeBulbLedPin(0);
     // Zero PWM registers for state hygiene even when the timer may be stopped;
     // applyTimerPolicy() will disable the timer afterward if appropriate.
-    rgbShowUserColor(manager->frontLed, 0, 0, 0);
+    showFrontColor(manager, (RGBSimpleOutput){0});
     if (outputs) {
         outputs->frontValid = false;
     }
 }
 
 static void disableCaseOutputs(ModeManager *manager, ModeOutputs *outputs) {
-    rgbShowUserColor(manager->caseLed, 0, 0, 0);
+    showCaseColor(manager, (RGBSimpleOutput){0});
     if (outputs) {
         outputs->caseValid = false;
     }
 }
 
+static bool isBlack(RGBSimpleOutput color) {
+    return color.r == 0 && color.g == 0 && color.b == 0;
+}
+
+static uint8_t blendChannel(uint8_t from, uint8_t to, uint32_t elapsedMs, uint16_t durationMs) {
+    int32_t delta = (int32_t)to - (int32_t)from;
+    return (uint8_t)((int32_t)from + delta * (int32_t)elapsedMs / (int32_t)durationMs);
+}
+
+// The color to show for `to` at the current point of the crossfade, `to` itself once it is over.
+static RGBSimpleOutput crossfadeColor(
+    const ModeCrossfade *crossfade, RGBSimpleOutput from, RGBSimpleOutput to) {
+    if (!crossfade->active) {
+        return to;
+    }
+
+    return (RGBSimpleOutput){
+        .r = blendChannel(from.r, to.r, crossfade->elapsedMs, crossfade->durationMs),
+        .g = blendChannel(from.g, to.g, crossfade->elapsedMs, crossfade->durationMs),
+        .b = blendChannel(from.b, to.b, crossfade->elapsedMs, crossfade->durationMs),
+    };
+}
+
 static void handleFrontOutput(
     ModeManager *manager,
     ModeComponentState *state,
     ModeComponent *component,
     ModeOutputs *outputs,
     uint8_t equationEvalIntervalMs) {
-    if (!state || !component) {
-        disableFrontOutputs(manager, outputs);
-        return;
-    }
-
+    // no output fades to black the same way an RGB output fades in
+    RGBSimpleOutput target = {0};
     SimpleOutput output;
-    if (!modeStateGetSimpleOutput(state, component, &output, equationEvalIntervalMs)) {
-        disableFrontOutputs(manager, outputs);
-        return;
-    }
-
-    if (output.type == BULB) {
-        if (outputs) {
-            outputs->frontValid = true;
-            outputs->frontType = BULB;
+    if (state && component &&
+        modeStateGetSimpleOutput(state, component, &output, equationEvalIntervalMs)) {
+        if (output.type == BULB) {
+            if (outputs) {
+                outputs->frontValid = true;
+                outputs->frontType = BULB;
+            }
+            manager->writeBulbLedPin(output.data.bulb == high ? 1 : 0);
+            return;
         }
-        manager->writeBulbLedPin(output.data.bulb == high ? 1 : 0);
-        return;
+        target = output.data.rgb;
     }
 
-    if (output.type == RGB) {
-        if (outputs) {
-            outputs->frontValid = true;
-            outputs->frontType = RGB;
-        }
-        // Legacy: ensure bulb GPIO is forced low when RGB is active.
-        manager->writeBulbLedPin(0);
-        rgbShowUserColor(
-            manager->frontLed, output.data.rgb.r, output.data.rgb.g, output.data.rgb.b);
+    RGBSimpleOutput color = crossfadeColor(&manager->crossfade, manager->crossfade.front, target);
+    // black needs no PWM, dropping the output lets the timer stop during off phases
+    if (isBlack(color)) {
+        disableFrontOutputs(manager, outputs);
         return;
     }
 
-    disableFrontOutputs(manager, outputs);
+    if (outputs) {
+        outputs->frontValid = true;
+        outputs->frontType = RGB;
+    }
+    // Legacy: ensure bulb GPIO is forced low when RGB is active.
+    manager->writeBulbLedPin(0);
+    showFrontColor(manager, color);
 }
 
 static void handleCaseOutput(
@@ -174,14 +237,17 @@ static void handleCaseOutput(
     ModeComponent *component,
     ModeOutputs *outputs,
     uint8_t equationEvalIntervalMs) {
-    if (!state || !component) {
-        disableCaseOutputs(manager, outputs);
-        return;
+    RGBSimpleOutput target = {0};
+    SimpleOutput output;
+    if (state && component &&
+        modeStateGetSimpleOutput(state, component, &output, equationEvalIntervalMs) &&
+        output.type == RGB) {
+        target = output.data.rgb;
     }
 
-    SimpleOutput output;
-    if (!modeStateGetSimpleOutput(state, component, &output, equationEvalIntervalMs) ||
-        output.type != RGB) {
+    RGBSimpleOutput color =
+        crossfadeColor(&manager->crossfade, manager->crossfade.caseColor, target);
+    if (isBlack(color)) {
         disableCaseOutputs(manager, outputs);
         return;
     }
@@ -189,7 +255,24 @@ static void handleCaseOutput(
     if (outputs) {
         outputs->caseValid = true;
     }
-    rgbShowUserColor(manager->caseLed, output.data.rgb.r, output.data.rgb.g, output.data.rgb.b);
+    showCaseColor(manager, color);
+}
+
+static void showLiveStreamFrame(
+    ModeManager *manager,
+    const LiveStreamFrame *frame,
+    ModeOutputs *outputs) {
+    outputs->frontValid = true;
+    outputs->frontType = RGB;
+    manager->writeBulbLedPin(0);
+    showFrontColor(
+        manager,
+        (RGBSimpleOutput){.r = frame->frontRed, .g = frame->frontGreen, .b = frame->frontBlue});
+
+    outputs->caseValid = true;
+    showCaseColor(
+        manager,
+        (RGBSimpleOutput){.r = frame->caseRed, .g = frame->caseGreen, .b = frame->caseBlue});
 }
 
 typedef struct {
@@ -224,53 +307,89 @@ static void reportEquationError(const ModeManager *manager, const ModeEquationEr
     manager->log(message, (size_t)written);
 }
 
-static ActiveComponents resolveActiveComponents(ModeManager *manager) {
-    ActiveComponents active = {0};
-
-    if (manager->currentMode.hasFront) {
-        active.frontComp = &manager->currentMode.front;
-        active.frontState = &manager->modeState.front;
-    }
-
-    if (manager->currentMode.hasCaseComp) {
-        active.caseComp = &manager->currentMode.caseComp;
-        active.caseState = &manager->modeState.case_comp;
+static bool transitionFires(
+    ModeManager *manager, const ModeMachine *machine, uint8_t index, uint32_t milliseconds) {
+    const ModeTransition *transition = &machine->transitions[index];
+    switch (transition->on) {
+        case MODE_TRANSITION_EVENT_ACCEL:
+            return isOverThreshold(manager->accel, transition->threshold);
+        case MODE_TRANSITION_EVENT_STILL:
+            return !isOverThreshold(manager->accel, transition->threshold) &&
+                   milliseconds - machine->lastOverMs[index] >= transition->ms;
+        case MODE_TRANSITION_EVENT_TIMER:
+            return milliseconds - machine->enteredMs >= transition->ms;
+        case MODE_TRANSITION_EVENT_BUTTON:
+            return manager->buttonTapped;
+        case MODE_TRANSITION_EVENT_CHARGE:
+            return manager->charging != machine->enteredCharging;
     }
+    return false;
+}
 
-    if (manager->currentMode.hasAccel && manager->currentMode.accel.triggersCount > 0) {
-        uint8_t triggerCount = manager->currentMode.accel.triggersCount;
-        if (triggerCount > MODE_ACCEL_TRIGGERS_MAX) {
-            triggerCount = MODE_ACCEL_TRIGGERS_MAX;
+static void stepModeMachine(ModeManager *manager, uint32_t milliseconds) {
+    ModeMachine *machine = &manager->modeState.machine;
+    uint8_t transitionCount = machine->first[machine->stateCount];
+    for (uint8_t i = 0; i < transitionCount; i++) {
+        const ModeTransition *transition = &machine->transitions[i];
+        if (transition->on == MODE_TRANSITION_EVENT_STILL &&
+            isOverThreshold(manager->accel, transition->threshold)) {
+            machine->lastOverMs[i] = milliseconds;
         }
+    }
 
-        for (uint8_t i = 0; i < triggerCount; i++) {
-            ModeAccelTrigger *trigger = &manager->currentMode.accel.triggers[i];
-            if (isOverThreshold(manager->accel, trigger->threshold)) {
-                ModeAccelTriggerState *triggerState = &manager->modeState.accel[i];
-
-                if (trigger->hasFront) {
-                    active.frontComp = &trigger->front;
-                    active.frontState = &triggerState->front;
-                }
-
-                if (trigger->hasCaseComp) {
-                    active.caseComp = &trigger->caseComp;
-                    active.caseState = &triggerState->case_comp;
-                }
-            } else {
+    // several transitions can be due in one tick, bounded so a loop of them cannot spin
+    for (uint8_t hop = 0; hop < machine->stateCount; hop++) {
+        uint8_t next = machine->state;
+        for (uint8_t i = machine->first[machine->state]; i < machine->first[machine->state + 1];
+             i++) {
+            if (transitionFires(manager, machine, i, milliseconds)) {
+                next = machine->transitions[i].to;
                 break;
             }
         }
+        if (next == machine->state) {
+            break;
+        }
+        machine->state = next;
+        machine->enteredMs = milliseconds;
+        machine->enteredCharging = manager->charging;
+        // a tap was taken for the state it was made in, it must not move the machine on again
+        manager->buttonTapped = false;
     }
-    return active;
+    manager->buttonTapped = false;
 }
 
-ModeOutputs modeTask(
+static void slotComponent(
     ModeManager *manager,
-    uint32_t milliseconds,
-    bool canUpdateFrontLed,
-    bool canUpdateCaseLed,
-    uint8_t equationEvalIntervalMs) {
+    uint8_t slot,
+    bool front,
+    ModeComponent **component,
+    ModeComponentState **componentState) {
+    if (slot == MODE_MACHINE_NO_COMPONENT) {
+        return;
+    }
+
+    if (slot == 0) {
+        *component = front ? &manager->currentMode.front : &manager->currentMode.caseComp;
+        *componentState = front ? &manager->modeState.front : &manager->modeState.case_comp;
+        return;
+    }
+
+    ModeAccelTrigger *trigger = &manager->currentMode.accel.triggers[slot - 1];
+    ModeAccelTriggerState *triggerState = &manager->modeState.accel[slot - 1];
+    *component = front ? &trigger->front : &trigger->caseComp;
+    *componentState = front ? &triggerState->front : &triggerState->case_comp;
+}
+
+static ActiveComponents activeComponentsForState(ModeManager *manager, uint8_t state) {
+    const ModeMachine *machine = &manager->modeState.machine;
+    ActiveComponents active = {0};
+    slotComponent(manager, machine->frontSlot[state], true, &active.frontComp, &active.frontState);
+    slotComponent(manager, machine->caseSlot[state], false, &active.caseComp, &active.caseState);
+    return active;
+}
+
+ModeOutputs modeTask(ModeManager *manager, uint32_t milliseconds, uint8_t equationEvalIntervalMs) {
     ModeOutputs outputs = {
         .frontValid = false,
         .caseValid = false,
@@ -279,31 +398,183 @@ ModeOutputs modeTask(
     if (!manager) {
         return outputs;
     }
+
+    if (manager->liveStream.active) {
+        LiveStreamFrame frame;
+        if (liveStreamTask(&manager->liveStream, milliseconds, &frame)) {
+            showLiveStreamFrame(manager, &frame, &outputs);
+            manager->lastOutputs = outputs;
+            return outputs;
+        }
+        // host stopped sending, pick the mode back up from its start
+        manager->shouldResetState = true;
+    }
+
     if (manager->shouldResetState) {
         ModeEquationError equationError = {0};
         bool initOk = modeStateInitialize(
             &manager->modeState, &manager->currentMode, milliseconds, &equationError);
         manager->shouldResetState = false;
+        manager->modeStartedMs = milliseconds;
+        manager->modeSleptMs = 0;
+        manager->crossfade.startMs = milliseconds;
+        manager->modeState.machine.enteredCharging = manager->charging;
         if (!initOk) {
             reportEquationError(manager, &equationError);
         }
     }
 
+    if (manager->crossfade.active) {
+        manager->crossfade.elapsedMs = milliseconds - manager->crossfade.startMs;
+        if (manager->crossfade.elapsedMs >= manager->crossfade.durationMs) {
+            manager->crossfade.active = false;
+        }
+    }
+
     modeStateAdvance(&manager->modeState, &manager->currentMode, milliseconds);
 
-    ActiveComponents active = resolveActiveComponents(manager);
+    stepModeMachine(manager, milliseconds);
+    ActiveComponents active = activeComponentsForState(manager, manager->modeState.machine.state);
 
-    // Update Front LED only if not evaluating button press, need to show shutdown/lock status
-    if (canUpdateFrontLed) {
+    // shutdown/lock indicators and charging status sit above these colors in the LED layers, a
+    // color nobody would see is not worth evaluating an equation for
+    if (rgbLayerCovered(manager->frontLed, RGB_LAYER_USER, milliseconds)) {
+        outputs.frontValid = manager->lastOutputs.frontValid;
+        outputs.frontType = manager->lastOutputs.frontType;
+    } else {
         handleFrontOutput(
             manager, active.frontState, active.frontComp, &outputs, equationEvalIntervalMs);
     }
-
-    // Update Case LED only if not evaluating button press, need to show shutdown/lock status
-    if (canUpdateCaseLed) {
+    if (rgbLayerCovered(manager->caseLed, RGB_LAYER_USER, milliseconds)) {
+        outputs.caseValid = manager->lastOutputs.caseValid;
+    } else {
         handleCaseOutput(
             manager, active.caseState, active.caseComp, &outputs, equationEvalIntervalMs);
     }
 
+    manager->lastOutputs = outputs;
     return outputs;
 }
+
+// Accel events only change at a FIFO drain, the sensor keeps sampling into its FIFO while the
+// MCU sleeps. Timers and quiet periods run out on their own, taps and the charger wake the MCU.
+static uint32_t machineMsUntilNextTransition(ModeManager *manager, uint32_t milliseconds) {
+    const ModeMachine *machine = &manager->modeState.machine;
+    uint32_t budgetMs = UINT32_MAX;
+    for (uint8_t i = machine->first[machine->state]; i < machine->first[machine->state + 1]; i++) {
+        const ModeTransition *transition = &machine->transitions[i];
+        if (transition->on == MODE_TRANSITION_EVENT_BUTTON ||
+            transition->on == MODE_TRANSITION_EVENT_CHARGE) {
+            continue;
+        }
+        uint32_t untilMs = UINT32_MAX;
+        if (transition->on == MODE_TRANSITION_EVENT_TIMER) {
+            untilMs = transition->ms - (milliseconds - machine->enteredMs);
+        } else {
+            untilMs = mc3479MsUntilNextDrain(manager->accel, milliseconds);
+            // a still transition that is not due yet either waits out its quiet period or, with
+            // none, for the jerk to drop at a later drain
+            uint32_t quietMs = transition->ms - (milliseconds - machine->lastOverMs[i]);
+            if (transition->on == MODE_TRANSITION_EVENT_STILL && transition->ms > 0 &&
+                quietMs < untilMs) {
+                untilMs = quietMs;
+            }
+        }
+        if (untilMs < budgetMs) {
+            budgetMs = untilMs;
+        }
+    }
+    return budgetMs;
+}
+
+uint32_t modeIdleBudgetMs(ModeManager *manager) {
+    if (!manager || manager->shouldResetState || manager->liveStream.active ||
+        manager->crossfade.active) {
+        return 0;
+    }
+
+    // only modeTask steps the machine, the budget is taken from the state that left it in
+    uint32_t lastUpdateMs = manager->modeState.lastPatternUpdateMs;
+    ActiveComponents active = activeComponentsForState(manager, manager->modeState.machine.state);
+    uint32_t budgetMs = machineMsUntilNextTransition(manager, lastUpdateMs);
+    if (active.frontComp) {
+        uint32_t frontMs = modeStateMsUntilNextChange(active.frontState, active.frontComp);
+        if (frontMs < budgetMs) {
+            budgetMs = frontMs;
+        }
+    }
+    if (active.caseComp) {
+        uint32_t caseMs = modeStateMsUntilNextChange(active.caseState, active.caseComp);
+        if (caseMs < budgetMs) {
+            budgetMs = caseMs;
+        }
+    }
+    return budgetMs;
+}
+
+void modeNoteStopModeSleep(ModeManager *manager, uint32_t sleptMs) {
+    if (manager) {
+        manager->modeSleptMs += sleptMs;
+    }
+}
+
+bool modeTakeButtonTap(ModeManager *manager) {
+    if (!manager || manager->shouldResetState || manager->liveStream.active) {
+        return false;
+    }
+
+    const ModeMachine *machine = &manager->modeState.machine;
+    for (uint8_t i = machine->first[machine->state]; i < machine->first[machine->state + 1]; i++) {
+        if (machine->transitions[i].on == MODE_TRANSITION_EVENT_BUTTON) {
+            manager->buttonTapped = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+void modeNoteCharging(ModeManager *manager, bool charging) {
+    if (manager) {
+        manager->charging = charging;
+    }
+}
+
+uint16_t modeAwakePermille(ModeManager *manager, uint32_t milliseconds) {
+    if (!manager || manager->shouldResetState) {
+        return 1000U;
+    }
+
+    uint32_t elapsedMs = milliseconds - manager->modeStartedMs;
+    if (elapsedMs == 0U) {
+        return 1000U;
+    }
+    uint32_t sleptMs = manager->modeSleptMs < elapsedMs ? manager->modeSleptMs : elapsedMs;
+    return (uint16_t)(((uint64_t)(elapsedMs - sleptMs) * 1000U) / elapsedMs);
+}
+
+static bool isEquationComponent(bool hasComponent, const ModeComponent *component) {
+    return hasComponent && component->pattern.type == PATTERN_TYPE_EQUATION;
+}
+
+bool modeNeedsFullSpeedClock(ModeManager *manager) {
+    if (!manager) {
+        return false;
+    }
+
+    Mode *mode = &manager->currentMode;
+    if (manager->liveStream.active || isEquationComponent(mode->hasFront, &mode->front) ||
+        isEquationComponent(mode->hasCaseComp, &mode->caseComp)) {
+        return true;
+    }
+
+    if (mode->hasAccel) {
+        for (uint8_t i = 0; i < mode->accel.triggersCount; i++) {
+            ModeAccelTrigger *trigger = &mode->accel.triggers[i];
+            if (isEquationComponent(trigger->hasFront, &trigger->front) ||
+                isEquationComponent(trigger->hasCaseComp, &trigger->caseComp)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,52 @@
+/*
+ * jerk_filter.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#include "microlight/model/jerk_filter.h"
+#include <string.h>
+
+void jerkFilterReset(JerkFilter *filter) {
+    memset(filter, 0, sizeof(*filter));
+}
+
+uint32_t jerkFilterPush(JerkFilter *filter, int16_t x, int16_t y, int16_t z) {
+    const int16_t raw[3] = {x, y, z};
+
+    if (!filter->primed) {
+        memcpy(filter->lastRaw, raw, sizeof(raw));
+        filter->primed = true;
+        return filter->peak;
+    }
+
+    uint64_t jerkSquared = 0;
+    for (uint8_t axis = 0; axis < 3; axis++) {
+        // y[n] = x[n] - x[n-1] + y[n-1] - y[n-1] / 2^shift
+        int32_t previous = filter->highPass[axis];
+        int32_t current = (int32_t)raw[axis] - filter->lastRaw[axis] + previous -
+                          previous / (1 << JERK_FILTER_HIGH_PASS_SHIFT);
+        int32_t jerk = current - previous;
+
+        jerkSquared += (uint64_t)((int64_t)jerk * jerk);
+        filter->highPass[axis] = current;
+        filter->lastRaw[axis] = raw[axis];
+    }
+    if (jerkSquared > UINT32_MAX) {
+        jerkSquared = UINT32_MAX;
+    }
+
+    filter->windowSum -= filter->window[filter->windowIndex];
+    filter->window[filter->windowIndex] = (uint32_t)jerkSquared;
+    filter->windowSum += jerkSquared;
+    filter->windowIndex = (filter->windowIndex + 1) % JERK_FILTER_WINDOW;
+
+    uint32_t meanSquare = (uint32_t)(filter->windowSum / JERK_FILTER_WINDOW);
+    // rounded up so a small held peak still decays to zero
+    uint64_t roundUp = (1U << JERK_FILTER_PEAK_DECAY_SHIFT) - 1U;
+    uint32_t decay = (uint32_t)((filter->peak + roundUp) >> JERK_FILTER_PEAK_DECAY_SHIFT);
+    uint32_t decayed = filter->peak - decay;
+    filter->peak = meanSquare > decayed ? meanSquare : decayed;
+    return filter->peak;
+}
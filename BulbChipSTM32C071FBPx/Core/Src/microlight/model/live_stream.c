@@ -0,0 +1,135 @@
+/*
+ * live_stream.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#include "microlight/model/live_stream.h"
+#include <string.h>
+
+void liveStreamStart(
+    LiveStream *stream, uint8_t frameIntervalMs, uint8_t prefillFrames, uint32_t milliseconds) {
+    memset(stream, 0, sizeof(*stream));
+    if (prefillFrames == 0) {
+        prefillFrames = 1;
+    } else if (prefillFrames > LIVE_STREAM_BUFFER_FRAMES) {
+        prefillFrames = LIVE_STREAM_BUFFER_FRAMES;
+    }
+    stream->frameIntervalMs = frameIntervalMs > 0 ? frameIntervalMs : 1;
+    stream->prefillFrames = prefillFrames;
+    stream->lastReceivedMs = milliseconds;
+    stream->stats.startedAtMs = milliseconds;
+    stream->active = true;
+}
+
+void liveStreamStop(LiveStream *stream) {
+    // stats are kept so they can still be read after the stream ends
+    stream->active = false;
+    stream->playing = false;
+    stream->count = 0;
+}
+
+bool liveStreamPush(LiveStream *stream, const uint8_t data[], uint32_t milliseconds) {
+    if (!stream->active) {
+        return false;
+    }
+
+    stream->stats.framesReceived++;
+    stream->lastReceivedMs = milliseconds;
+
+    if (stream->count == LIVE_STREAM_BUFFER_FRAMES) {
+        stream->head = (stream->head + 1) % LIVE_STREAM_BUFFER_FRAMES;
+        stream->count--;
+        stream->stats.framesDropped++;
+    }
+
+    uint8_t tail = (stream->head + stream->count) % LIVE_STREAM_BUFFER_FRAMES;
+    stream->frames[tail] = (LiveStreamFrame){
+        .frontRed = data[0],
+        .frontGreen = data[1],
+        .frontBlue = data[2],
+        .caseRed = data[3],
+        .caseGreen = data[4],
+        .caseBlue = data[5],
+    };
+    stream->arrivalMs[tail] = milliseconds;
+    stream->count++;
+    return true;
+}
+
+static void playNextFrame(LiveStream *stream, uint32_t milliseconds) {
+    uint32_t latency = milliseconds - stream->arrivalMs[stream->head];
+    if (latency > UINT16_MAX) {
+        latency = UINT16_MAX;
+    }
+
+    stream->current = stream->frames[stream->head];
+    stream->head = (stream->head + 1) % LIVE_STREAM_BUFFER_FRAMES;
+    stream->count--;
+
+    stream->stats.framesPlayed++;
+    stream->stats.lastLatencyMs = (uint16_t)latency;
+    if (latency > stream->stats.maxLatencyMs) {
+        stream->stats.maxLatencyMs = (uint16_t)latency;
+    }
+}
+
+bool liveStreamTask(LiveStream *stream, uint32_t milliseconds, LiveStreamFrame *frame) {
+    if (!stream->active) {
+        return false;
+    }
+
+    if (stream->count == 0 && milliseconds - stream->lastReceivedMs >= LIVE_STREAM_TIMEOUT_MS) {
+        liveStreamStop(stream);
+        return false;
+    }
+
+    if (!stream->playing && stream->count >= stream->prefillFrames) {
+        stream->playing = true;
+        stream->nextFrameMs = milliseconds;
+    }
+
+    if (stream->playing && (int32_t)(milliseconds - stream->nextFrameMs) >= 0) {
+        if (stream->count == 0) {
+            // hold the last frame and rebuild the cushion before playing again
+            stream->stats.underruns++;
+            stream->playing = false;
+        } else {
+            // ticks slower than the frame rate, skip ahead to the newest frame that is due
+            while (stream->count > 1 &&
+                   (int32_t)(milliseconds - stream->nextFrameMs) >= stream->frameIntervalMs) {
+                stream->head = (stream->head + 1) % LIVE_STREAM_BUFFER_FRAMES;
+                stream->count--;
+                stream->stats.framesDropped++;
+                stream->nextFrameMs += stream->frameIntervalMs;
+            }
+            playNextFrame(stream, milliseconds);
+            stream->nextFrameMs += stream->frameIntervalMs;
+        }
+    }
+
+    *frame = stream->current;
+    return true;
+}
+
+static void packU32(uint8_t out[], uint32_t value) {
+    out[0] = (uint8_t)(value & 0xFF);
+    out[1] = (uint8_t)((value >> 8) & 0xFF);
+    out[2] = (uint8_t)((value >> 16) & 0xFF);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+void liveStreamPackStats(const LiveStream *stream, uint32_t milliseconds, uint8_t out[]) {
+    const LiveStreamStats *stats = &stream->stats;
+    packU32(&out[0], stats->framesReceived);
+    packU32(&out[4], stats->framesPlayed);
+    packU32(&out[8], stats->framesDropped);
+    packU32(&out[12], stats->underruns);
+    packU32(&out[16], milliseconds - stats->startedAtMs);
+    out[20] = (uint8_t)(stats->lastLatencyMs & 0xFF);
+    out[21] = (uint8_t)(stats->lastLatencyMs >> 8);
+    out[22] = (uint8_t)(stats->maxLatencyMs & 0xFF);
+    out[23] = (uint8_t)(stats->maxLatencyMs >> 8);
+    out[24] = stream->count;
+}
@@ -27,6 +27,10 @@ static inline void modeStateTest_noteEquationFree(void) {
 
 enum { MODE_EQUATION_PATH_MAX = sizeof(((ModeEquationError *)0)->path) };
 
+// keyframe blend weight in fixed point, KEYFRAME_WEIGHT_ONE is fully on the next keyframe
+#define KEYFRAME_WEIGHT_BITS 12U
+#define KEYFRAME_WEIGHT_ONE (1U << KEYFRAME_WEIGHT_BITS)
+
 static void prependEquationContext(ModeEquationError *error, const char *segment, int32_t index) {
     if (!error || !error->hasError || !segment || segment[0] == '\0') {
         return;
@@ -83,17 +87,20 @@ static bool equationPatternAllowsLoop(const EquationPattern *pattern) {
            pattern->blue.loopAfterDuration;
 }
 
-static void advanceSimplePattern(
-    SimplePatternState *state, const SimplePattern *pattern, uint32_t deltaMs) {
-    if (!state || !pattern || pattern->changeAtCount == 0U || deltaMs == 0U) {
-        if (state && pattern && pattern->changeAtCount > 0U &&
-            state->changeIndex >= pattern->changeAtCount) {
-            state->changeIndex = pattern->changeAtCount - 1U;
+// Shared by simple and keyframe patterns, both walk the same changeAt timeline.
+static void advanceChangeIndex(
+    SimplePatternState *state,
+    const PatternChange changeAt[],
+    uint8_t changeAtCount,
+    uint32_t duration,
+    uint32_t deltaMs) {
+    if (!state || changeAtCount == 0U || deltaMs == 0U) {
+        if (state && changeAtCount > 0U && state->changeIndex >= changeAtCount) {
+            state->changeIndex = changeAtCount - 1U;
         }
         return;
     }
 
-    uint32_t duration = pattern->duration;
     if (duration == 0U) {
         state->elapsedMs = 0U;
         state->changeIndex = 0U;
@@ -101,23 +108,24 @@ static void advanceSimplePattern(
     }
 
     uint32_t elapsed = state->elapsedMs + deltaMs;
-    // Wrap elapsed time back into the pattern duration and jump to first change.
-    while (elapsed >= duration) {
-        elapsed -= duration;
+    // Wrap elapsed time back into the pattern duration and jump to first change. A component
+    // catching up after being hidden can be many durations behind.
+    if (elapsed >= duration) {
+        elapsed %= duration;
         state->changeIndex = 0U;
     }
 
     state->elapsedMs = elapsed;
 
     // If time moved forward, walk the change index forward until the next change lies ahead.
-    while ((state->changeIndex + 1U) < pattern->changeAtCount &&
-           pattern->changeAt[state->changeIndex + 1U].ms <= state->elapsedMs) {
+    while ((state->changeIndex + 1U) < changeAtCount &&
+           changeAt[state->changeIndex + 1U].ms <= state->elapsedMs) {
         state->changeIndex++;
     }
 
     // If time moved backward (e.g., wrap elapsed time by duration shrink loop), walk the change
     // index backward.
-    while (state->changeIndex > 0U && pattern->changeAt[state->changeIndex].ms > state->elapsedMs) {
+    while (state->changeIndex > 0U && changeAt[state->changeIndex].ms > state->elapsedMs) {
         state->changeIndex--;
     }
 }
@@ -130,22 +138,40 @@ static void advanceEquationChannel(
 
     state->sectionElapsedMs += deltaMs;
 
-    // Only check for section transitions if not on the last section,
-    // or if looping is enabled. When on last section with looping disabled,
-    // let it continue indefinitely.
-    bool isLastSection = (state->currentSectionIndex >= config->sectionsCount - 1);
-    bool shouldCheckDuration = !isLastSection || config->loopAfterDuration;
+    // A component catching up after being hidden can be many laps behind. A whole lap from any
+    // section start lands back on that section, so whole laps are dropped and the walk below
+    // never needs more than one.
+    if (config->loopAfterDuration && state->currentSectionIndex < config->sectionsCount &&
+        state->sectionElapsedMs >= config->sections[state->currentSectionIndex].duration) {
+        uint32_t lapMs = 0;
+        for (uint8_t i = 0; i < config->sectionsCount; i++) {
+            lapMs += config->sections[i].duration;
+        }
+        if (lapMs > 0U) {
+            state->sectionElapsedMs %= lapMs;
+        }
+    }
+
+    for (uint8_t step = 0; step < config->sectionsCount; step++) {
+        // Only check for section transitions if not on the last section,
+        // or if looping is enabled. When on last section with looping disabled,
+        // let it continue indefinitely.
+        bool isLastSection = (state->currentSectionIndex >= config->sectionsCount - 1);
+        bool shouldCheckDuration = !isLastSection || config->loopAfterDuration;
+        if (!shouldCheckDuration || state->currentSectionIndex >= config->sectionsCount) {
+            break;
+        }
 
-    if (shouldCheckDuration && state->currentSectionIndex < config->sectionsCount) {
         const EquationSection *section = &config->sections[state->currentSectionIndex];
         // Check if we need to move to next section
-        if (state->sectionElapsedMs >= section->duration) {
-            state->sectionElapsedMs -= section->duration;
+        if (state->sectionElapsedMs < section->duration) {
+            break;
+        }
+        state->sectionElapsedMs -= section->duration;
 
-            state->currentSectionIndex++;
-            if (state->currentSectionIndex >= config->sectionsCount) {
-                state->currentSectionIndex = 0;
-            }
+        state->currentSectionIndex++;
+        if (state->currentSectionIndex >= config->sectionsCount) {
+            state->currentSectionIndex = 0;
         }
     }
 
@@ -211,13 +237,39 @@ static void advanceComponentState(
             componentState->simple.changeIndex = 0U;
             return;
         }
-        advanceSimplePattern(&componentState->simple, pattern, deltaMs);
+        advanceChangeIndex(
+            &componentState->simple,
+            pattern->changeAt,
+            pattern->changeAtCount,
+            pattern->duration,
+            deltaMs);
+    } else if (component->pattern.type == PATTERN_TYPE_KEYFRAME) {
+        const KeyframePattern *pattern = &component->pattern.data.keyframe;
+        advanceChangeIndex(
+            &componentState->simple,
+            pattern->changeAt,
+            pattern->changeAtCount,
+            pattern->duration,
+            deltaMs);
     } else if (component->pattern.type == PATTERN_TYPE_EQUATION) {
         advanceEquationPattern(
             &componentState->equation, &component->pattern.data.equation, deltaMs);
     }
 }
 
+// Moves a component along to where the mode timeline is now.
+static void syncComponentState(ModeComponentState *componentState, const ModeComponent *component) {
+    if (!componentState->timelineMs) {
+        return;
+    }
+
+    uint32_t deltaMs = *componentState->timelineMs - componentState->syncedMs;
+    componentState->syncedMs = *componentState->timelineMs;
+    if (deltaMs > 0U) {
+        advanceComponentState(componentState, component, deltaMs);
+    }
+}
+
 static void captureEquationError(
     ModeEquationError *error, int errorPosition, const char *expression) {
     if (!error || error->hasError) {
@@ -381,6 +433,158 @@ static bool compileModeState(ModeState *state, const Mode *mode, ModeEquationErr
     return success;
 }
 
+// each trigger rises to the next state and every state can fall back to each one below it
+_Static_assert(
+    MODE_ACCEL_TRIGGERS_MAX + MODE_ACCEL_TRIGGERS_MAX * (MODE_ACCEL_TRIGGERS_MAX + 1) / 2 <=
+        MODE_SCRIPT_TRANSITIONS_MAX,
+    "accel triggers do not fit the transition table");
+_Static_assert(
+    MODE_ACCEL_TRIGGERS_MAX + 1 <= MODE_MACHINE_STATES_MAX,
+    "accel triggers do not fit the state table");
+
+static void addTransition(
+    ModeMachine *machine,
+    uint8_t from,
+    uint8_t to,
+    ModeTransitionEvent on,
+    uint8_t threshold,
+    uint32_t ms) {
+    uint8_t index = machine->first[machine->stateCount];
+    machine->transitions[index] = (ModeTransition){
+        .from = from,
+        .to = to,
+        .on = on,
+        .threshold = threshold,
+        .hasThreshold = true,
+        .ms = ms,
+        .hasMs = true,
+    };
+    machine->first[machine->stateCount] = index + 1;
+}
+
+/*
+ * Triggers are expected in ascending threshold order, state n is reached once the first n of them
+ * are active. A trigger with holdMs stays active that long after its last jerk over the threshold.
+ * The lowest trigger to go quiet decides where the machine falls back to, like a scan from the
+ * first trigger up would.
+ */
+static void compileTriggerTransitions(ModeMachine *machine, const ModeAccel *accel) {
+    for (uint8_t from = 0; from < machine->stateCount; from++) {
+        machine->first[from] = machine->first[machine->stateCount];
+        for (uint8_t to = 0; to < from; to++) {
+            const ModeAccelTrigger *trigger = &accel->triggers[to];
+            uint32_t holdMs = trigger->hasHoldMs ? trigger->holdMs : 0U;
+            addTransition(
+                machine, from, to, MODE_TRANSITION_EVENT_STILL, trigger->threshold, holdMs);
+        }
+        if (from + 1U < machine->stateCount) {
+            addTransition(
+                machine,
+                from,
+                from + 1U,
+                MODE_TRANSITION_EVENT_ACCEL,
+                accel->triggers[from].threshold,
+                0U);
+        }
+    }
+}
+
+// transitions between states the mode does not have are dropped
+static void compileScriptTransitions(ModeMachine *machine, const ModeScript *script) {
+    uint8_t count = script->transitionsCount;
+    if (count > MODE_SCRIPT_TRANSITIONS_MAX) {
+        count = MODE_SCRIPT_TRANSITIONS_MAX;
+    }
+
+    for (uint8_t from = 0; from < machine->stateCount; from++) {
+        machine->first[from] = machine->first[machine->stateCount];
+        for (uint8_t i = 0; i < count; i++) {
+            const ModeTransition *transition = &script->transitions[i];
+            if (transition->from == from && transition->to < machine->stateCount) {
+                addTransition(
+                    machine,
+                    from,
+                    transition->to,
+                    transition->on,
+                    transition->hasThreshold ? transition->threshold : 0U,
+                    transition->hasMs ? transition->ms : 0U);
+            }
+        }
+    }
+}
+
+// a trigger without a component for an LED leaves the one of the state below it showing
+static void compileTriggerStates(ModeMachine *machine, const Mode *mode, uint8_t triggerCount) {
+    machine->stateCount = triggerCount + 1U;
+    machine->frontSlot[0] = mode->hasFront ? 0U : MODE_MACHINE_NO_COMPONENT;
+    machine->caseSlot[0] = mode->hasCaseComp ? 0U : MODE_MACHINE_NO_COMPONENT;
+    for (uint8_t i = 0; i < triggerCount; i++) {
+        const ModeAccelTrigger *trigger = &mode->accel.triggers[i];
+        machine->frontSlot[i + 1U] = trigger->hasFront ? i + 1U : machine->frontSlot[i];
+        machine->caseSlot[i + 1U] = trigger->hasCaseComp ? i + 1U : machine->caseSlot[i];
+    }
+}
+
+static uint8_t scriptStateSlot(
+    const Mode *mode, uint8_t triggerCount, bool hasSlot, uint8_t slot, bool front) {
+    if (!hasSlot || slot > triggerCount) {
+        return MODE_MACHINE_NO_COMPONENT;
+    }
+
+    bool hasComponent = false;
+    if (slot == 0) {
+        hasComponent = front ? mode->hasFront : mode->hasCaseComp;
+    } else {
+        const ModeAccelTrigger *trigger = &mode->accel.triggers[slot - 1U];
+        hasComponent = front ? trigger->hasFront : trigger->hasCaseComp;
+    }
+    return hasComponent ? slot : MODE_MACHINE_NO_COMPONENT;
+}
+
+// a state naming a component the mode does not have shows nothing on that LED
+static void compileScriptStates(ModeMachine *machine, const Mode *mode, uint8_t triggerCount) {
+    uint8_t count = mode->script.statesCount;
+    if (count > MODE_MACHINE_STATES_MAX) {
+        count = MODE_MACHINE_STATES_MAX;
+    }
+
+    machine->stateCount = count;
+    for (uint8_t i = 0; i < count; i++) {
+        const ModeScriptState *state = &mode->script.states[i];
+        machine->frontSlot[i] =
+            scriptStateSlot(mode, triggerCount, state->hasFront, state->front, true);
+        machine->caseSlot[i] =
+            scriptStateSlot(mode, triggerCount, state->hasCaseComp, state->caseComp, false);
+    }
+}
+
+static void compileModeMachine(ModeMachine *machine, const Mode *mode, uint32_t initialMs) {
+    uint8_t triggerCount = mode->hasAccel ? mode->accel.triggersCount : 0U;
+    if (triggerCount > MODE_ACCEL_TRIGGERS_MAX) {
+        triggerCount = MODE_ACCEL_TRIGGERS_MAX;
+    }
+    machine->state = 0;
+    machine->enteredMs = initialMs;
+
+    if (mode->hasScript && mode->script.hasStates && mode->script.statesCount > 0) {
+        compileScriptStates(machine, mode, triggerCount);
+    } else {
+        compileTriggerStates(machine, mode, triggerCount);
+    }
+
+    // the running total is kept past the last state until every group is placed
+    machine->first[machine->stateCount] = 0;
+    if (mode->hasScript) {
+        compileScriptTransitions(machine, &mode->script);
+    } else {
+        compileTriggerTransitions(machine, &mode->accel);
+    }
+
+    for (uint8_t i = 0; i < MODE_SCRIPT_TRANSITIONS_MAX; i++) {
+        machine->lastOverMs[i] = initialMs;
+    }
+}
+
 bool modeStateInitialize(
     ModeState *state, const Mode *mode, uint32_t initialMs, ModeEquationError *error) {
     if (!state) {
@@ -399,6 +603,15 @@ bool modeStateInitialize(
 
     memset(state, 0, sizeof(*state));
     state->lastPatternUpdateMs = initialMs;
+    state->front.timelineMs = &state->timelineMs;
+    state->case_comp.timelineMs = &state->timelineMs;
+    for (int i = 0; i < MODE_ACCEL_TRIGGERS_MAX; i++) {
+        state->accel[i].front.timelineMs = &state->timelineMs;
+        state->accel[i].case_comp.timelineMs = &state->timelineMs;
+    }
+    if (mode) {
+        compileModeMachine(&state->machine, mode, initialMs);
+    }
 
     return compileModeState(state, mode, error);
 }
@@ -413,36 +626,7 @@ void modeStateAdvance(ModeState *state, const Mode *mode, uint32_t milliseconds)
         deltaMs = milliseconds - state->lastPatternUpdateMs;
     }
     state->lastPatternUpdateMs = milliseconds;
-    if (deltaMs == 0U) {
-        return;
-    }
-
-    if (mode->hasFront) {
-        advanceComponentState(&state->front, &mode->front, deltaMs);
-    }
-
-    if (mode->hasCaseComp) {
-        advanceComponentState(&state->case_comp, &mode->caseComp, deltaMs);
-    }
-
-    if (mode->hasAccel) {
-        uint8_t triggerCount = mode->accel.triggersCount;
-        if (triggerCount > MODE_ACCEL_TRIGGERS_MAX) {
-            triggerCount = MODE_ACCEL_TRIGGERS_MAX;
-        }
-
-        for (uint8_t i = 0; i < triggerCount; i++) {
-            if (mode->accel.triggers[i].hasFront) {
-                advanceComponentState(
-                    &state->accel[i].front, &mode->accel.triggers[i].front, deltaMs);
-            }
-
-            if (mode->accel.triggers[i].hasCaseComp) {
-                advanceComponentState(
-                    &state->accel[i].case_comp, &mode->accel.triggers[i].caseComp, deltaMs);
-            }
-        }
-    }
+    state->timelineMs += deltaMs;
 }
 
 static uint8_t evalChannel(EquationChannelState *state, uint8_t equationEvalIntervalMs) {
@@ -473,6 +657,88 @@ static uint8_t evalChannel(EquationChannelState *state, uint8_t equationEvalInte
     return state->cachedOutput;
 }
 
+typedef struct {
+    const PatternChange *from;
+    const PatternChange *to;
+    uint32_t offsetMs;
+    uint32_t spanMs;
+} KeyframeSegment;
+
+// Finds the keyframes either side of elapsedMs. Past the last keyframe, and before the first one
+// when it starts after 0, the pattern fades from the last keyframe back into the first.
+static bool keyframeSegment(
+    const KeyframePattern *pattern,
+    uint8_t changeIndex,
+    uint32_t elapsedMs,
+    KeyframeSegment *segment) {
+    if (pattern->changeAtCount < 2U || pattern->duration == 0U) {
+        return false;
+    }
+
+    const PatternChange *first = &pattern->changeAt[0];
+    const PatternChange *last = &pattern->changeAt[pattern->changeAtCount - 1U];
+    if (last->ms >= pattern->duration) {
+        // the app rejects this, hold each keyframe like a simple pattern would
+        return false;
+    }
+    if (elapsedMs < first->ms || (changeIndex + 1U) >= pattern->changeAtCount) {
+        uint32_t lastToEndMs = pattern->duration - last->ms;
+        segment->from = last;
+        segment->to = first;
+        segment->offsetMs = elapsedMs < first->ms ? lastToEndMs + elapsedMs : elapsedMs - last->ms;
+        segment->spanMs = lastToEndMs + first->ms;
+    } else {
+        segment->from = &pattern->changeAt[changeIndex];
+        segment->to = &pattern->changeAt[changeIndex + 1U];
+        segment->offsetMs = elapsedMs - segment->from->ms;
+        segment->spanMs = segment->to->ms - segment->from->ms;
+    }
+    return segment->spanMs > 0U && segment->offsetMs < segment->spanMs;
+}
+
+// bulb levels fade as black and white
+static RGBSimpleOutput keyframeColor(const SimpleOutput *output) {
+    if (output->type == BULB) {
+        uint8_t level = output->data.bulb == high ? 255U : 0U;
+        return (RGBSimpleOutput){level, level, level};
+    }
+    return output->data.rgb;
+}
+
+static uint8_t blendKeyframeChannel(uint8_t from, uint8_t to, uint32_t weight) {
+    return (uint8_t)((from * (KEYFRAME_WEIGHT_ONE - weight) + to * weight +
+                      KEYFRAME_WEIGHT_ONE / 2U) >>
+                     KEYFRAME_WEIGHT_BITS);
+}
+
+static void evalKeyframePattern(
+    const SimplePatternState *state, const KeyframePattern *pattern, RGBSimpleOutput *rgb) {
+    uint8_t index = state->changeIndex;
+    if (index >= pattern->changeAtCount) {
+        index = 0U;
+    }
+
+    KeyframeSegment segment;
+    if (!keyframeSegment(pattern, index, state->elapsedMs, &segment)) {
+        *rgb = keyframeColor(&pattern->changeAt[index].output);
+        return;
+    }
+
+    uint32_t weight = (uint32_t)(((uint64_t)segment.offsetMs << KEYFRAME_WEIGHT_BITS) /
+                                 segment.spanMs);
+    if (pattern->easing == KEYFRAME_EASING_EASE) {
+        // smoothstep, 3w^2 - 2w^3
+        uint32_t squared = (weight * weight) >> KEYFRAME_WEIGHT_BITS;
+        weight = (squared * (3U * KEYFRAME_WEIGHT_ONE - 2U * weight)) >> KEYFRAME_WEIGHT_BITS;
+    }
+
+    RGBSimpleOutput from = keyframeColor(&segment.from->output);
+    RGBSimpleOutput to = keyframeColor(&segment.to->output);
+    rgb->r = blendKeyframeChannel(from.r, to.r, weight);
+    rgb->g = blendKeyframeChannel(from.g, to.g, weight);
+    rgb->b = blendKeyframeChannel(from.b, to.b, weight);
+}
+
 bool modeStateGetSimpleOutput(
     ModeComponentState *componentState,
     const ModeComponent *component,
@@ -481,6 +747,7 @@ bool modeStateGetSimpleOutput(
     if (!componentState || !component || !output) {
         return false;
     }
+    syncComponentState(componentState, component);
 
     if (component->pattern.type == PATTERN_TYPE_SIMPLE) {
         const SimplePattern *pattern = &component->pattern.data.simple;
@@ -497,6 +764,17 @@ bool modeStateGetSimpleOutput(
         return true;
     }
 
+    if (component->pattern.type == PATTERN_TYPE_KEYFRAME) {
+        const KeyframePattern *pattern = &component->pattern.data.keyframe;
+        if (pattern->changeAtCount == 0U) {
+            return false;
+        }
+
+        output->type = RGB;
+        evalKeyframePattern(&componentState->simple, pattern, &output->data.rgb);
+        return true;
+    }
+
     if (component->pattern.type == PATTERN_TYPE_EQUATION) {
         EquationPatternState *state = &componentState->equation;
         output->type = RGB;
@@ -508,3 +786,60 @@ bool modeStateGetSimpleOutput(
 
     return false;
 }
+
+// A fade changes every tick, only a hold between two matching keyframes can be slept through.
+static uint32_t keyframeMsUntilNextChange(
+    const SimplePatternState *state, const KeyframePattern *pattern) {
+    if (pattern->changeAtCount <= 1U || pattern->duration == 0U) {
+        return UINT32_MAX;
+    }
+
+    uint8_t index = state->changeIndex;
+    if (index >= pattern->changeAtCount) {
+        index = 0U;
+    }
+
+    KeyframeSegment segment;
+    if (!keyframeSegment(pattern, index, state->elapsedMs, &segment)) {
+        return 0U;
+    }
+
+    RGBSimpleOutput from = keyframeColor(&segment.from->output);
+    RGBSimpleOutput to = keyframeColor(&segment.to->output);
+    if (from.r != to.r || from.g != to.g || from.b != to.b) {
+        return 0U;
+    }
+    return segment.spanMs - segment.offsetMs;
+}
+
+uint32_t modeStateMsUntilNextChange(
+    ModeComponentState *componentState, const ModeComponent *component) {
+    if (!componentState || !component) {
+        return UINT32_MAX;
+    }
+    syncComponentState(componentState, component);
+
+    if (component->pattern.type == PATTERN_TYPE_KEYFRAME) {
+        return keyframeMsUntilNextChange(
+            &componentState->simple, &component->pattern.data.keyframe);
+    }
+    if (component->pattern.type != PATTERN_TYPE_SIMPLE) {
+        return 0U;
+    }
+
+    const SimplePattern *pattern = &component->pattern.data.simple;
+    // a single change repeats the same output on every wrap
+    if (pattern->changeAtCount <= 1U || pattern->duration == 0U) {
+        return UINT32_MAX;
+    }
+
+    const SimplePatternState *state = &componentState->simple;
+    uint32_t nextChangeMs = pattern->duration;
+    if ((state->changeIndex + 1U) < pattern->changeAtCount) {
+        nextChangeMs = pattern->changeAt[state->changeIndex + 1U].ms;
+    }
+    if (nextChangeMs <= state->elapsedMs) {
+        return 0U;
+    }
+    return nextChangeMs - state->elapsedMs;
+}
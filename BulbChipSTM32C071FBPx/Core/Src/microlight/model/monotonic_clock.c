@@ -0,0 +1,69 @@
+/*
+ * monotonic_clock.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#include "microlight/model/monotonic_clock.h"
+#include <string.h>
+
+void monotonicClockInit(MonotonicClock *clock) {
+    memset(clock, 0, sizeof(*clock));
+    clock->rate = MONOTONIC_CLOCK_RATE_ONE;
+}
+
+uint32_t monotonicClockUpdate(MonotonicClock *clock, uint32_t sourceMs) {
+    if (!clock->started) {
+        clock->started = true;
+        clock->lastSourceMs = sourceMs;
+        return clock->milliseconds;
+    }
+
+    uint32_t delta = sourceMs - clock->lastSourceMs;
+    clock->lastSourceMs = sourceMs;
+
+    uint64_t scaled = (uint64_t)delta * clock->rate + clock->fraction;
+    clock->milliseconds += (uint32_t)(scaled >> 16);
+    clock->fraction = (uint32_t)(scaled & 0xFFFFU);
+
+    if (clock->calibrating) {
+        clock->windowSourceMs += delta;
+    }
+    return clock->milliseconds;
+}
+
+static void openWindow(MonotonicClock *clock, uint32_t referenceMs) {
+    clock->calibrating = true;
+    clock->windowSourceMs = 0;
+    clock->windowStartReferenceMs = referenceMs;
+}
+
+void monotonicClockCalibrate(MonotonicClock *clock, uint32_t referenceMs) {
+    if (!clock->calibrating) {
+        openWindow(clock, referenceMs);
+        return;
+    }
+
+    uint32_t referenceElapsed = referenceMs - clock->windowStartReferenceMs;
+    if (referenceElapsed < MONOTONIC_CLOCK_CALIBRATION_MS) {
+        // a reference that stalls without a restart would hold the window open forever
+        if (clock->windowSourceMs > 2U * MONOTONIC_CLOCK_CALIBRATION_MS) {
+            openWindow(clock, referenceMs);
+        }
+        return;
+    }
+
+    if (clock->windowSourceMs > 0U) {
+        uint64_t rate = ((uint64_t)referenceElapsed << 16) / clock->windowSourceMs;
+        if (rate >= MONOTONIC_CLOCK_RATE_ONE - MONOTONIC_CLOCK_MAX_TRIM &&
+            rate <= MONOTONIC_CLOCK_RATE_ONE + MONOTONIC_CLOCK_MAX_TRIM) {
+            clock->rate = (uint32_t)rate;
+        }
+    }
+    openWindow(clock, referenceMs);
+}
+
+void monotonicClockRestartCalibration(MonotonicClock *clock) {
+    clock->calibrating = false;
+}
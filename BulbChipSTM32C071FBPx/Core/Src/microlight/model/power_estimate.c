@@ -0,0 +1,178 @@
+/*
+ * power_estimate.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#include "microlight/model/power_estimate.h"
+#include "microlight/device/rgb_led.h"
+
+typedef struct {
+    RGBWhiteBalance whiteBalance;
+    // milliamps at 100% duty
+    uint8_t redMa;
+    uint8_t greenMa;
+    uint8_t blueMa;
+    uint8_t bulbMa;
+} ChannelCurrents;
+
+static uint32_t channelMicroamps(uint8_t value, uint8_t whiteBalance, uint8_t currentMa) {
+    // duty is proportional to the corrected value, see colorToDuty
+    return (uint32_t)gammaAndWhiteBalancedColor(value, whiteBalance) * currentMa * 1000U / 255U;
+}
+
+static uint32_t outputMicroamps(const SimpleOutput *output, const ChannelCurrents *currents) {
+    if (output->type == BULB) {
+        return output->data.bulb == high ? currents->bulbMa * 1000U : 0U;
+    }
+
+    const RGBSimpleOutput *rgb = &output->data.rgb;
+    return channelMicroamps(rgb->r, currents->whiteBalance.red, currents->redMa) +
+           channelMicroamps(rgb->g, currents->whiteBalance.green, currents->greenMa) +
+           channelMicroamps(rgb->b, currents->whiteBalance.blue, currents->blueMa);
+}
+
+static uint32_t simplePatternMicroamps(
+    const SimplePattern *pattern, const ChannelCurrents *currents) {
+    if (pattern->changeAtCount == 0U) {
+        return 0U;
+    }
+
+    // mode_state holds the first change until the second and never advances without a duration
+    uint32_t duration = pattern->duration;
+    if (duration == 0U || pattern->changeAtCount == 1U) {
+        return outputMicroamps(&pattern->changeAt[0].output, currents);
+    }
+
+    uint64_t weighted = 0U;
+    uint32_t start = 0U;
+    for (uint8_t i = 0; i < pattern->changeAtCount && start < duration; i++) {
+        uint32_t end = duration;
+        if ((i + 1U) < pattern->changeAtCount && pattern->changeAt[i + 1U].ms < duration) {
+            end = pattern->changeAt[i + 1U].ms;
+        }
+        if (end > start) {
+            weighted += (uint64_t)outputMicroamps(&pattern->changeAt[i].output, currents) *
+                        (end - start);
+            start = end;
+        }
+    }
+    return (uint32_t)(weighted / duration);
+}
+
+// keyframes always drive RGB, bulb levels fade as black and white
+static uint32_t keyframeMicroamps(const SimpleOutput *output, const ChannelCurrents *currents) {
+    if (output->type == BULB) {
+        uint8_t level = output->data.bulb == high ? 255U : 0U;
+        SimpleOutput rgb = {.type = RGB, .data.rgb = {level, level, level}};
+        return outputMicroamps(&rgb, currents);
+    }
+    return outputMicroamps(output, currents);
+}
+
+// Keyframes fade linearly in color, averaging the current at both ends of each fade is an upper
+// bound since gamma makes the mid fade current lower than the mean.
+static uint32_t keyframePatternMicroamps(
+    const KeyframePattern *pattern, const ChannelCurrents *currents) {
+    if (pattern->changeAtCount == 0U) {
+        return 0U;
+    }
+
+    uint32_t duration = pattern->duration;
+    const PatternChange *last = &pattern->changeAt[pattern->changeAtCount - 1U];
+    if (duration == 0U || pattern->changeAtCount == 1U || last->ms >= duration) {
+        return keyframeMicroamps(&pattern->changeAt[0].output, currents);
+    }
+
+    uint64_t weighted = 0U;
+    for (uint8_t i = 0; i < pattern->changeAtCount; i++) {
+        const PatternChange *from = &pattern->changeAt[i];
+        const PatternChange *to = &pattern->changeAt[(i + 1U) % pattern->changeAtCount];
+        // the last keyframe fades back into the first across the loop
+        uint32_t spanMs = to->ms > from->ms ? to->ms - from->ms : duration - from->ms + to->ms;
+        weighted += (uint64_t)(keyframeMicroamps(&from->output, currents) +
+                               keyframeMicroamps(&to->output, currents)) *
+                    spanMs / 2U;
+    }
+    return (uint32_t)(weighted / duration);
+}
+
+static uint32_t componentMicroamps(
+    bool hasComponent,
+    const ModeComponent *component,
+    const ChannelCurrents *currents,
+    bool allowBulb,
+    bool *exact) {
+    if (!hasComponent) {
+        return 0U;
+    }
+
+    if (component->pattern.type == PATTERN_TYPE_EQUATION) {
+        *exact = false;
+        SimpleOutput fullScale = {.type = RGB, .data.rgb = {255, 255, 255}};
+        return outputMicroamps(&fullScale, currents);
+    }
+
+    if (component->pattern.type == PATTERN_TYPE_KEYFRAME) {
+        *exact = false;
+        return keyframePatternMicroamps(&component->pattern.data.keyframe, currents);
+    }
+
+    const SimplePattern *pattern = &component->pattern.data.simple;
+    if (!allowBulb) {
+        // the case LED ignores bulb outputs, count those changes as off
+        ChannelCurrents rgbOnly = *currents;
+        rgbOnly.bulbMa = 0;
+        return simplePatternMicroamps(pattern, &rgbOnly);
+    }
+    return simplePatternMicroamps(pattern, currents);
+}
+
+PowerEstimate powerEstimateMode(
+    const Mode *mode, const ChipSettings *settings, uint16_t awakePermille) {
+    if (awakePermille > 1000U) {
+        awakePermille = 1000U;
+    }
+
+    PowerEstimate estimate = {.awakePermille = awakePermille, .exact = true};
+    estimate.mcuMicroamps = (POWER_MCU_RUN_MICROAMPS * awakePermille +
+                             POWER_MCU_STOP_MICROAMPS * (1000U - awakePermille)) /
+                            1000U;
+    if (!mode || !settings) {
+        return estimate;
+    }
+
+    const ChannelCurrents front = {
+        .whiteBalance =
+            {settings->frontWhiteBalanceRed,
+             settings->frontWhiteBalanceGreen,
+             settings->frontWhiteBalanceBlue},
+        .redMa = settings->frontRedCurrentMa,
+        .greenMa = settings->frontGreenCurrentMa,
+        .blueMa = settings->frontBlueCurrentMa,
+        .bulbMa = settings->bulbCurrentMa,
+    };
+    const ChannelCurrents caseLed = {
+        .whiteBalance =
+            {settings->caseWhiteBalanceRed,
+             settings->caseWhiteBalanceGreen,
+             settings->caseWhiteBalanceBlue},
+        .redMa = settings->caseRedCurrentMa,
+        .greenMa = settings->caseGreenCurrentMa,
+        .blueMa = settings->caseBlueCurrentMa,
+    };
+
+    estimate.frontMicroamps =
+        componentMicroamps(mode->hasFront, &mode->front, &front, true, &estimate.exact);
+    estimate.caseMicroamps =
+        componentMicroamps(mode->hasCaseComp, &mode->caseComp, &caseLed, false, &estimate.exact);
+    if (mode->hasAccel && mode->accel.triggersCount > 0) {
+        estimate.exact = false;
+    }
+    return estimate;
+}
+
+uint32_t powerEstimateTotalMicroamps(const PowerEstimate *estimate) {
+    return estimate->frontMicroamps + estimate->caseMicroamps + estimate->mcuMicroamps;
+}
@@ -0,0 +1,195 @@
+/*
+ * telemetry.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#include "microlight/model/telemetry.h"
+#include <string.h>
+
+static void packU32(uint8_t out[], uint32_t value) {
+    out[0] = (uint8_t)(value & 0xFF);
+    out[1] = (uint8_t)((value >> 8) & 0xFF);
+    out[2] = (uint8_t)((value >> 16) & 0xFF);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+static uint32_t unpackU32(const uint8_t data[]) {
+    return (uint32_t)data[0] | ((uint32_t)data[1] << 8) | ((uint32_t)data[2] << 16) |
+           ((uint32_t)data[3] << 24);
+}
+
+static uint32_t slotOffset(uint8_t page, uint16_t slot) {
+    return (uint32_t)page * TELEMETRY_PAGE_SIZE + (uint32_t)slot * TELEMETRY_RECORD_SIZE;
+}
+
+static bool readHeader(const Telemetry *telemetry, uint8_t page, uint32_t *sequence) {
+    uint8_t header[TELEMETRY_RECORD_SIZE];
+    telemetry->read(slotOffset(page, 0), header, sizeof(header));
+    if (unpackU32(&header[0]) != TELEMETRY_PAGE_MAGIC) {
+        return false;
+    }
+    *sequence = unpackU32(&header[4]);
+    return true;
+}
+
+static void startPage(Telemetry *telemetry, uint8_t page, uint32_t sequence) {
+    uint8_t header[TELEMETRY_RECORD_SIZE];
+    packU32(&header[0], TELEMETRY_PAGE_MAGIC);
+    packU32(&header[4], sequence);
+    telemetry->erasePage(page);
+    telemetry->write(slotOffset(page, 0), header, sizeof(header));
+
+    telemetry->page = page;
+    telemetry->sequence = sequence;
+    telemetry->slot = 1;
+}
+
+static uint16_t findFreeSlot(const Telemetry *telemetry) {
+    uint8_t data[TELEMETRY_RECORD_SIZE];
+    for (uint16_t slot = 1; slot <= TELEMETRY_RECORDS_PER_PAGE; slot++) {
+        telemetry->read(slotOffset(telemetry->page, slot), data, sizeof(data));
+        if (data[0] == TELEMETRY_EVENT_NONE) {
+            return slot;
+        }
+    }
+    return TELEMETRY_RECORDS_PER_PAGE + 1;
+}
+
+bool telemetryInit(
+    Telemetry *telemetry, EraseTelemetryPage erasePage, WriteTelemetry write, ReadTelemetry read) {
+    if (!telemetry || !erasePage || !write || !read) {
+        return false;
+    }
+
+    memset(telemetry, 0, sizeof(*telemetry));
+    telemetry->erasePage = erasePage;
+    telemetry->write = write;
+    telemetry->read = read;
+
+    bool found = false;
+    uint32_t newest = 0;
+    for (uint8_t page = 0; page < TELEMETRY_PAGE_COUNT; page++) {
+        uint32_t sequence;
+        if (readHeader(telemetry, page, &sequence) &&
+            (!found || (int32_t)(sequence - newest) > 0)) {
+            found = true;
+            newest = sequence;
+            telemetry->page = page;
+        }
+    }
+
+    if (!found) {
+        startPage(telemetry, 0, 0);
+        return true;
+    }
+
+    telemetry->sequence = newest;
+    telemetry->slot = findFreeSlot(telemetry);
+
+    // pages only advance once full, so every page in sequence behind the newest one is full
+    for (uint8_t back = 1; back < TELEMETRY_PAGE_COUNT; back++) {
+        uint8_t page = (telemetry->page + TELEMETRY_PAGE_COUNT - back) % TELEMETRY_PAGE_COUNT;
+        uint32_t sequence;
+        if (!readHeader(telemetry, page, &sequence) || sequence != newest - back) {
+            break;
+        }
+        telemetry->olderPages++;
+    }
+    return true;
+}
+
+void telemetryRecord(
+    Telemetry *telemetry, uint8_t event, uint8_t arg, uint16_t value, uint32_t milliseconds) {
+    if (telemetry->pendingCount == TELEMETRY_PENDING_RECORDS) {
+        if (telemetry->dropped < UINT16_MAX) {
+            telemetry->dropped++;
+        }
+        return;
+    }
+
+    telemetry->pending[telemetry->pendingCount++] = (TelemetryRecord){
+        .event = event,
+        .arg = arg,
+        .value = value,
+        .milliseconds = milliseconds,
+    };
+}
+
+bool telemetryHasPending(const Telemetry *telemetry) {
+    return telemetry->pendingCount > 0 || telemetry->dropped > 0;
+}
+
+static void append(Telemetry *telemetry, const TelemetryRecord *record) {
+    if (telemetry->slot > TELEMETRY_RECORDS_PER_PAGE) {
+        // the page wrapped onto holds the oldest history, the one just filled takes its place
+        startPage(
+            telemetry, (telemetry->page + 1) % TELEMETRY_PAGE_COUNT, telemetry->sequence + 1);
+        if (telemetry->olderPages < TELEMETRY_PAGE_COUNT - 1) {
+            telemetry->olderPages++;
+        }
+    }
+
+    uint8_t data[TELEMETRY_RECORD_SIZE];
+    data[0] = record->event;
+    data[1] = record->arg;
+    data[2] = (uint8_t)(record->value & 0xFF);
+    data[3] = (uint8_t)(record->value >> 8);
+    packU32(&data[4], record->milliseconds);
+    telemetry->write(slotOffset(telemetry->page, telemetry->slot), data, sizeof(data));
+    telemetry->slot++;
+}
+
+void telemetryFlush(Telemetry *telemetry) {
+    for (uint8_t i = 0; i < telemetry->pendingCount; i++) {
+        append(telemetry, &telemetry->pending[i]);
+    }
+
+    if (telemetry->dropped > 0) {
+        uint32_t milliseconds = telemetry->pendingCount > 0
+                                    ? telemetry->pending[telemetry->pendingCount - 1].milliseconds
+                                    : 0;
+        TelemetryRecord dropped = {
+            .event = TELEMETRY_EVENT_DROPPED,
+            .value = telemetry->dropped,
+            .milliseconds = milliseconds,
+        };
+        append(telemetry, &dropped);
+        telemetry->dropped = 0;
+    }
+    telemetry->pendingCount = 0;
+}
+
+uint16_t telemetryCount(const Telemetry *telemetry) {
+    return (uint16_t)(telemetry->olderPages * TELEMETRY_RECORDS_PER_PAGE + telemetry->slot - 1);
+}
+
+uint16_t telemetryRead(
+    const Telemetry *telemetry, uint16_t first, uint8_t out[], uint16_t maxRecords) {
+    uint16_t count = telemetryCount(telemetry);
+    if (first >= count) {
+        return 0;
+    }
+    if (maxRecords > count - first) {
+        maxRecords = count - first;
+    }
+
+    uint8_t oldestPage =
+        (telemetry->page + TELEMETRY_PAGE_COUNT - telemetry->olderPages) % TELEMETRY_PAGE_COUNT;
+    for (uint16_t i = 0; i < maxRecords; i++) {
+        uint16_t index = first + i;
+        uint8_t page = (oldestPage + index / TELEMETRY_RECORDS_PER_PAGE) % TELEMETRY_PAGE_COUNT;
+        uint16_t slot = 1 + index % TELEMETRY_RECORDS_PER_PAGE;
+        telemetry->read(
+            slotOffset(page, slot), &out[i * TELEMETRY_RECORD_SIZE], TELEMETRY_RECORD_SIZE);
+    }
+    return maxRecords;
+}
+
+void telemetryUnpack(const uint8_t data[], TelemetryRecord *record) {
+    record->event = data[0];
+    record->arg = data[1];
+    record->value = (uint16_t)(data[2] | (data[3] << 8));
+    record->milliseconds = unpackU32(&data[4]);
+}
@@ -0,0 +1,153 @@
+/*
+ * frame.c
+ *
+ *  Created on: Oct 18, 2026
+ *      Author: jameshunt
+ */
+
+#include "microlight/protocol/frame.h"
+
+#define COBS_MAX_CODE 0xFF
+#define FRAME_CRC_INIT 0xFFFF
+#define FRAME_XOR_BYTE ((uint8_t)'\n')
+
+// CRC-16/CCITT-FALSE, a nibble at a time. 32 bytes of table instead of 512.
+static const uint16_t crcNibbleTable[16] = {
+    0x0000,
+    0x1021,
+    0x2042,
+    0x3063,
+    0x4084,
+    0x50A5,
+    0x60C6,
+    0x70E7,
+    0x8108,
+    0x9129,
+    0xA14A,
+    0xB16B,
+    0xC18C,
+    0xD1AD,
+    0xE1CE,
+    0xF1EF};
+
+uint16_t frameCrc16(uint16_t crc, const uint8_t *data, size_t length) {
+    for (size_t i = 0; i < length; i++) {
+        crc = (uint16_t)((crc << 4) ^ crcNibbleTable[(crc >> 12) ^ (data[i] >> 4)]);
+        crc = (uint16_t)((crc << 4) ^ crcNibbleTable[(crc >> 12) ^ (data[i] & 0x0F)]);
+    }
+    return crc;
+}
+
+typedef struct {
+    Frame *frame;
+    size_t decoded;
+    uint16_t crc;
+} DecodeState;
+
+static void emitDecoded(DecodeState *state, char line[], uint8_t byte) {
+    state->crc = frameCrc16(state->crc, &byte, 1);
+    if (state->decoded == 0) {
+        state->frame->opcode = byte;
+    } else if (state->decoded == 1) {
+        state->frame->seq = byte;
+    } else {
+        // always behind the read position, so decoding in place is safe
+        line[state->decoded - FRAME_HEADER_SIZE] = (char)byte;
+    }
+    state->decoded++;
+}
+
+FrameError frameDecode(char line[], size_t length, Frame *frame) {
+    if (!line || !frame || length == 0 || line[0] != FRAME_START_BYTE) {
+        return FRAME_ERR_MALFORMED;
+    }
+
+    size_t end = length;
+    if (line[end - 1] == '\n') {
+        end--;
+    }
+
+    DecodeState state = {.frame = frame, .decoded = 0, .crc = FRAME_CRC_INIT};
+    size_t in = 1;
+    while (in < end) {
+        uint8_t code = (uint8_t)line[in++] ^ FRAME_XOR_BYTE;
+        if (code == 0) {
+            return FRAME_ERR_MALFORMED;
+        }
+        for (uint8_t i = 1; i < code; i++) {
+            if (in >= end) {
+                return FRAME_ERR_MALFORMED;
+            }
+            emitDecoded(&state, line, (uint8_t)line[in++] ^ FRAME_XOR_BYTE);
+        }
+        if (code != COBS_MAX_CODE && in < end) {
+            emitDecoded(&state, line, 0);
+        }
+    }
+
+    if (state.decoded < FRAME_HEADER_SIZE + FRAME_CRC_SIZE) {
+        return FRAME_ERR_MALFORMED;
+    }
+
+    // running the CRC over data followed by its own big endian CRC leaves zero
+    if (state.crc != 0) {
+        return FRAME_ERR_CRC;
+    }
+
+    frame->payload = line;
+    frame->payloadLength = state.decoded - FRAME_HEADER_SIZE - FRAME_CRC_SIZE;
+    return FRAME_OK;
+}
+
+size_t frameEncode(
+    uint8_t opcode,
+    uint8_t seq,
+    const char *payload,
+    size_t payloadLength,
+    char out[],
+    size_t outLength) {
+    size_t frameLength = FRAME_HEADER_SIZE + payloadLength + FRAME_CRC_SIZE;
+    // start byte, data, one code byte per started 254 byte block, '\n'
+    size_t needed = 1 + frameLength + frameLength / (COBS_MAX_CODE - 1) + 1 + 1;
+    if (!out || (!payload && payloadLength > 0) || outLength < needed) {
+        return 0;
+    }
+
+    // CRC first, encoding in place overwrites the payload as it goes
+    const uint8_t header[FRAME_HEADER_SIZE] = {opcode, seq};
+    uint16_t crc = frameCrc16(FRAME_CRC_INIT, header, sizeof(header));
+    crc = frameCrc16(crc, (const uint8_t *)payload, payloadLength);
+    const uint8_t trailer[FRAME_CRC_SIZE] = {(uint8_t)(crc >> 8), (uint8_t)(crc & 0xFF)};
+
+    out[0] = FRAME_START_BYTE;
+    size_t codeIndex = 1;
+    size_t written = 2;
+    uint8_t code = 1;
+    for (size_t i = 0; i < frameLength; i++) {
+        uint8_t byte;
+        if (i < FRAME_HEADER_SIZE) {
+            byte = header[i];
+        } else if (i < FRAME_HEADER_SIZE + payloadLength) {
+            byte = (uint8_t)payload[i - FRAME_HEADER_SIZE];
+        } else {
+            byte = trailer[i - FRAME_HEADER_SIZE - payloadLength];
+        }
+
+        if (byte != 0) {
+            out[written++] = (char)byte;
+            code++;
+        }
+        if (byte == 0 || code == COBS_MAX_CODE) {
+            out[codeIndex] = (char)code;
+            codeIndex = written++;
+            code = 1;
+        }
+    }
+    out[codeIndex] = (char)code;
+
+    for (size_t i = 1; i < written; i++) {
+        out[i] = (char)((uint8_t)out[i] ^ FRAME_XOR_BYTE);
+    }
+    out[written++] = '\n';
+    return written;
+}
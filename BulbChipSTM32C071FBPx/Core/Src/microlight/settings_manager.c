@@ -60,8 +60,26 @@ static int appendJson(char *buffer, size_t length, int offset, const char *forma
 
 // Helper macros for printing
 #define PRINT_VAL_uint8_t(val) "%d", (int)(val)
+#define PRINT_VAL_uint16_t(val) "%d", (int)(val)
 #define PRINT_VAL_bool(val) "%s", (val) ? "true" : "false"
 
+static int appendSettingsFields(
+    const ChipSettings *settings, char *buffer, size_t length, int offset) {
+    bool first = true;
+#define X_PRINT(type, name, def)                                                   \
+    if (!first) {                                                                  \
+        offset = appendJson(buffer, length, offset, ",");                          \
+    }                                                                              \
+    offset = appendJson(buffer, length, offset, "\"" #name "\":");                 \
+    offset = appendJson(buffer, length, offset, PRINT_VAL_##type(settings->name)); \
+    first = false;
+
+    CHIP_SETTINGS_MAP(X_PRINT)
+#undef X_PRINT
+
+    return offset;
+}
+
 int getSettingsDefaultsJson(char *buffer, size_t length) {
     ChipSettings settings;
     chipSettingsInitDefaults(&settings);
@@ -69,19 +87,17 @@ int getSettingsDefaultsJson(char *buffer, size_t length) {
     int offset = 0;
 
     offset = appendJson(buffer, length, offset, "{");
+    offset = appendSettingsFields(&settings, buffer, length, offset);
+    offset = appendJson(buffer, length, offset, "}");
 
-    bool first = true;
-#define X_PRINT(type, name, def)                                                  \
-    if (!first) {                                                                 \
-        offset = appendJson(buffer, length, offset, ",");                         \
-    }                                                                             \
-    offset = appendJson(buffer, length, offset, "\"" #name "\":");                \
-    offset = appendJson(buffer, length, offset, PRINT_VAL_##type(settings.name)); \
-    first = false;
+    return offset;
+}
 
-    CHIP_SETTINGS_MAP(X_PRINT)
-#undef X_PRINT
+int getSettingsCommandJson(const ChipSettings *settings, char *buffer, size_t length) {
+    int offset = 0;
 
+    offset = appendJson(buffer, length, offset, "{\"command\":\"writeSettings\",");
+    offset = appendSettingsFields(settings, buffer, length, offset);
     offset = appendJson(buffer, length, offset, "}");
 
     return offset;
@@ -138,12 +154,12 @@ int getSettingsResponse(SettingsManager *manager, char *buffer, size_t length) {
         offset = appendJson(buffer, length, offset, "{\"settings\":null");
     }
 
-    char defaultsBuf[SETTINGS_DEFAULTS_JSON_SIZE];
-    getSettingsDefaultsJson(defaultsBuf, sizeof(defaultsBuf));
+    // defaults are appended in place, a stack copy of them no longer fits comfortably
+    offset = appendJson(buffer, length, offset, ",\"defaults\":");
+    offset += getSettingsDefaultsJson(buffer + offset, offset < (int)length ? length - offset : 0);
     char metadataBuf[SETTINGS_METADATA_JSON_SIZE];
     getSettingsMetadataJson(metadataBuf, sizeof(metadataBuf));
 
-    offset = appendJson(buffer, length, offset, ",\"defaults\":%s", defaultsBuf);
     offset = appendJson(buffer, length, offset, ",\"metadata\":%s", metadataBuf);
     offset = appendJson(buffer, length, offset, "}\n");
     return offset;
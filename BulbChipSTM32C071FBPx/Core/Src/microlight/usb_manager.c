@@ -12,32 +12,160 @@
 #include "microlight/chip_state.h"
 #include "microlight/json/command_parser.h"
 #include "microlight/json/json_buf.h"
+#include "microlight/model/power_estimate.h"
+#include "microlight/protocol/frame.h"
 
 // integration guide: https://github.com/hathach/tinyusb/discussions/633
 bool usbInit(
     USBManager *usbManager,
     ModeManager *modeManager,
     SettingsManager *settingsManager,
+    Telemetry *telemetry,
     void (*enterDFU)(),
     SaveSettings saveSettings,
     SaveMode saveMode,
     UsbReadTask usbReadTask,
-    UsbWrite usbWrite) {
-    if (!usbManager || !modeManager || !settingsManager || !enterDFU || !saveSettings ||
-        !saveMode || !usbReadTask || !usbWrite) {
+    UsbWrite usbWrite,
+    UsbTxFree usbTxFree,
+    CurrentMilliseconds currentMilliseconds) {
+    if (!usbManager || !modeManager || !settingsManager || !telemetry || !enterDFU ||
+        !saveSettings || !saveMode || !usbReadTask || !usbWrite || !usbTxFree ||
+        !currentMilliseconds) {
         return false;
     }
     usbManager->modeManager = modeManager;
     usbManager->settingsManager = settingsManager;
+    usbManager->telemetry = telemetry;
     usbManager->enterDFU = enterDFU;
     usbManager->saveSettings = saveSettings;
     usbManager->saveMode = saveMode;
     usbManager->usbReadTask = usbReadTask;
     usbManager->usbWrite = usbWrite;
+    usbManager->usbTxFree = usbTxFree;
+    usbManager->currentMilliseconds = currentMilliseconds;
 
     return true;
 }
 
+static void applyWriteMode(USBManager *usbManager, const char buffer[], size_t length) {
+    if (strcmp(cliInput.mode.name, "transientTest") == 0) {
+        // do not write to flash for transient test
+        setMode(usbManager->modeManager, &cliInput.mode, cliInput.modeIndex);
+    } else {
+        usbManager->saveMode(cliInput.modeIndex, buffer, length);
+        setMode(usbManager->modeManager, &cliInput.mode, cliInput.modeIndex);
+    }
+}
+
+static void applyWriteSettings(USBManager *usbManager, const char buffer[], size_t length) {
+    ChipSettings settings = cliInput.settings;
+#ifdef MICROLIGHT_LEGACY_PCB_BUTTON_PA7
+    assert(settings.shutdownPolicy == autoOffAndAutoLock);
+#endif
+    usbManager->saveSettings(buffer, length);
+    updateSettings(usbManager->settingsManager, &settings);
+}
+
+// Reads the stored mode at modeIndex into buffer and parses it into cliInput. Returns false when
+// nothing valid is stored there.
+static bool loadSavedMode(USBManager *usbManager, uint8_t modeIndex, char buffer[]) {
+    usbManager->modeManager->readSavedMode(modeIndex, buffer, sharedJsonIOBufferLength);
+    parseJson(buffer, sharedJsonIOBufferLength, &cliInput);
+    return cliInput.parsedType == parseWriteMode;
+}
+
+// Formats "powerEstimate":{...} for the mode in cliInput. The awake fraction is only known for the
+// running mode, any other is assumed to never enter Stop mode.
+static int formatPowerEstimate(
+    USBManager *usbManager, uint8_t modeIndex, char out[], size_t length) {
+    ModeManager *modeManager = usbManager->modeManager;
+    bool awakeMeasured = modeIndex == modeManager->currentModeIndex;
+    uint16_t awakePermille = awakeMeasured
+                                 ? modeAwakePermille(modeManager, usbManager->currentMilliseconds())
+                                 : 1000U;
+    PowerEstimate estimate = powerEstimateMode(
+        &cliInput.mode, &usbManager->settingsManager->currentSettings, awakePermille);
+
+    return snprintf(
+        out,
+        length,
+        "\"powerEstimate\":{\"averageMicroamps\":%lu,\"frontMicroamps\":%lu,"
+        "\"caseMicroamps\":%lu,\"mcuMicroamps\":%lu,\"awakePermille\":%u,"
+        "\"awakeMeasured\":%s,\"exact\":%s}",
+        (unsigned long)powerEstimateTotalMicroamps(&estimate),
+        (unsigned long)estimate.frontMicroamps,
+        (unsigned long)estimate.caseMicroamps,
+        (unsigned long)estimate.mcuMicroamps,
+        (unsigned)estimate.awakePermille,
+        awakeMeasured ? "true" : "false",
+        estimate.exact ? "true" : "false");
+}
+
+static void writeReadModeResponse(USBManager *usbManager, uint8_t modeIndex, char buffer[]) {
+    bool hasMode = loadSavedMode(usbManager, modeIndex, buffer);
+    size_t len = strlen(buffer);
+
+    // splice the estimate in as a last field of the stored command when it fits
+    char *closing = hasMode ? strrchr(buffer, '}') : NULL;
+    if (closing) {
+        char estimate[200];
+        int estimateLen = formatPowerEstimate(usbManager, modeIndex, estimate, sizeof(estimate));
+        size_t at = (size_t)(closing - buffer);
+        if (estimateLen > 0 && (size_t)estimateLen < sizeof(estimate) &&
+            at + 1 + (size_t)estimateLen + 3 <= sharedJsonIOBufferLength) {
+            buffer[at] = ',';
+            memcpy(&buffer[at + 1], estimate, (size_t)estimateLen);
+            len = at + 1 + (size_t)estimateLen;
+            buffer[len++] = '}';
+            buffer[len] = '\0';
+        }
+    }
+
+    if (len > sharedJsonIOBufferLength - 2) {
+        len = sharedJsonIOBufferLength - 2;
+    }
+    buffer[len] = '\n';
+    buffer[len + 1] = '\0';
+    usbManager->usbWrite(buffer, len + 1);
+}
+
+static void writeEstimatePowerResponse(USBManager *usbManager, uint8_t modeIndex, char buffer[]) {
+    char response[208];
+    if (!loadSavedMode(usbManager, modeIndex, buffer)) {
+        snprintf(response, sizeof(response), "{\"error\":\"no mode at index %u\"}\n", modeIndex);
+    } else {
+        int len = snprintf(response, sizeof(response), "{");
+        len += formatPowerEstimate(
+            usbManager, modeIndex, &response[len], sizeof(response) - (size_t)len);
+        snprintf(&response[len], sizeof(response) - (size_t)len, "}\n");
+    }
+    usbManager->usbWrite(response, strlen(response));
+}
+
+static void writeReadTelemetryResponse(USBManager *usbManager, uint16_t first, char buffer[]) {
+    static const char hexDigits[] = "0123456789ABCDEF";
+    Telemetry *telemetry = usbManager->telemetry;
+    // records queued in RAM are part of the history too
+    telemetryFlush(telemetry);
+
+    uint8_t records[USB_TELEMETRY_JSON_RECORDS * TELEMETRY_RECORD_SIZE];
+    uint16_t count = telemetryRead(telemetry, first, records, USB_TELEMETRY_JSON_RECORDS);
+
+    int len = snprintf(
+        buffer,
+        sharedJsonIOBufferLength,
+        "{\"telemetry\":{\"total\":%u,\"first\":%u,\"records\":\"",
+        (unsigned)telemetryCount(telemetry),
+        (unsigned)first);
+    size_t at = (size_t)len;
+    for (size_t i = 0; i < (size_t)count * TELEMETRY_RECORD_SIZE; i++) {
+        buffer[at++] = hexDigits[records[i] >> 4];
+        buffer[at++] = hexDigits[records[i] & 0x0F];
+    }
+    memcpy(&buffer[at], "\"}}\n", 4);
+    usbManager->usbWrite(buffer, at + 4);
+}
+
 static void handleJson(USBManager *usbManager, char buffer[], size_t length) {
     parseJson(buffer, length, &cliInput);
 
@@ -58,34 +186,15 @@ static void handleJson(USBManager *usbManager, char buffer[], size_t length) {
             break;
         }
         case parseWriteMode: {
-            if (strcmp(cliInput.mode.name, "transientTest") == 0) {
-                // do not write to flash for transient test
-                setMode(usbManager->modeManager, &cliInput.mode, cliInput.modeIndex);
-            } else {
-                usbManager->saveMode(cliInput.modeIndex, buffer, length);
-                setMode(usbManager->modeManager, &cliInput.mode, cliInput.modeIndex);
-            }
+            applyWriteMode(usbManager, buffer, length);
             break;
         }
         case parseReadMode: {
-            usbManager->modeManager->readSavedMode(
-                cliInput.modeIndex, buffer, sharedJsonIOBufferLength);
-            size_t len = strlen(buffer);
-            if (len > sharedJsonIOBufferLength - 2) {
-                len = sharedJsonIOBufferLength - 2;
-            }
-            buffer[len] = '\n';
-            buffer[len + 1] = '\0';
-            usbManager->usbWrite(buffer, len + 1);
+            writeReadModeResponse(usbManager, cliInput.modeIndex, buffer);
             break;
         }
         case parseWriteSettings: {
-            ChipSettings settings = cliInput.settings;
-#ifdef MICROLIGHT_LEGACY_PCB_BUTTON_PA7
-            assert(settings.shutdownPolicy == autoOffAndAutoLock);
-#endif
-            usbManager->saveSettings(buffer, length);
-            updateSettings(usbManager->settingsManager, &settings);
+            applyWriteSettings(usbManager, buffer, length);
             break;
         }
         case parseReadSettings: {
@@ -98,12 +207,240 @@ static void handleJson(USBManager *usbManager, char buffer[], size_t length) {
             usbManager->enterDFU();
             break;
         }
+        case parseEstimatePower: {
+            writeEstimatePowerResponse(usbManager, cliInput.modeIndex, buffer);
+            break;
+        }
+        case parseReadTelemetry: {
+            writeReadTelemetryResponse(usbManager, cliInput.telemetryFirst, buffer);
+            break;
+        }
+    }
+}
+
+// Responses are encoded into the start of the shared buffer. payload may already live there as
+// long as it starts at least FRAME_HEADROOM bytes in.
+static void writeFrame(
+    USBManager *usbManager, uint8_t opcode, uint8_t seq, const char *payload, size_t length) {
+    size_t written = frameEncode(
+        opcode, seq, payload, length, sharedJsonIOBuffer, sharedJsonIOBufferLength);
+    if (written > 0) {
+        usbManager->usbWrite(sharedJsonIOBuffer, written);
+    }
+}
+
+static void writeFrameError(
+    USBManager *usbManager, uint8_t seq, FrameError error, const char *detail) {
+    char payload[96];
+    payload[0] = (char)error;
+    snprintf(&payload[1], sizeof(payload) - 1, "%s", detail ? detail : "");
+    writeFrame(usbManager, FRAME_OP_ERROR, seq, payload, 1 + strlen(&payload[1]));
+}
+
+static void writeFrameParseError(USBManager *usbManager, uint8_t seq) {
+    char detail[64];
+    if (cliInput.errorContext.error != PARSER_OK) {
+        snprintf(
+            detail,
+            sizeof(detail),
+            "%s: %s",
+            parserErrorToString(cliInput.errorContext.error),
+            cliInput.errorContext.path);
+    } else {
+        snprintf(detail, sizeof(detail), "unable to parse json");
+    }
+    writeFrameError(usbManager, seq, FRAME_ERR_INVALID_PAYLOAD, detail);
+}
+
+static void writeLiveStreamStats(
+    USBManager *usbManager, uint8_t opcode, uint8_t seq, uint32_t milliseconds) {
+    uint8_t payload[LIVE_STREAM_STATS_SIZE];
+    liveStreamPackStats(&usbManager->modeManager->liveStream, milliseconds, payload);
+    writeFrame(usbManager, opcode, seq, (const char *)payload, sizeof(payload));
+}
+
+static void writeTelemetryFrame(
+    USBManager *usbManager, uint8_t opcode, uint8_t seq, uint16_t first) {
+    Telemetry *telemetry = usbManager->telemetry;
+    telemetryFlush(telemetry);
+
+    uint8_t *payload = (uint8_t *)&sharedJsonIOBuffer[FRAME_HEADROOM];
+    uint16_t total = telemetryCount(telemetry);
+    uint16_t count = telemetryRead(
+        telemetry, first, &payload[TELEMETRY_FRAME_HEADER_SIZE], USB_TELEMETRY_FRAME_RECORDS);
+    payload[0] = (uint8_t)(total & 0xFF);
+    payload[1] = (uint8_t)(total >> 8);
+    payload[2] = (uint8_t)(first & 0xFF);
+    payload[3] = (uint8_t)(first >> 8);
+    writeFrame(
+        usbManager,
+        opcode,
+        seq,
+        (const char *)payload,
+        TELEMETRY_FRAME_HEADER_SIZE + (size_t)count * TELEMETRY_RECORD_SIZE);
+}
+
+static void handleFrame(
+    USBManager *usbManager, char buffer[], size_t length, uint32_t milliseconds) {
+    Frame frame = {0};
+    FrameError error = frameDecode(buffer, length, &frame);
+    if (error != FRAME_OK) {
+        writeFrameError(usbManager, frame.seq, error, NULL);
+        return;
+    }
+
+    uint8_t response = frame.opcode | FRAME_RESPONSE_FLAG;
+    switch (frame.opcode) {
+        case FRAME_OP_HELLO: {
+            size_t maxPayload = sharedJsonIOBufferLength - FRAME_HEADROOM;
+            char payload[4] = {
+                FRAME_PROTOCOL_VERSION,
+                (char)(maxPayload & 0xFF),
+                (char)(maxPayload >> 8),
+                CHIP_SETTINGS_PACKED_SIZE};
+            writeFrame(usbManager, response, frame.seq, payload, sizeof(payload));
+            break;
+        }
+        case FRAME_OP_WRITE_MODE: {
+            // the CRC trails the payload, so there is room to terminate it for the parser
+            frame.payload[frame.payloadLength] = '\0';
+            parseJson(frame.payload, frame.payloadLength + 1, &cliInput);
+            if (cliInput.parsedType != parseWriteMode) {
+                writeFrameParseError(usbManager, frame.seq);
+                break;
+            }
+            applyWriteMode(usbManager, frame.payload, frame.payloadLength + 1);
+            writeFrame(usbManager, response, frame.seq, NULL, 0);
+            break;
+        }
+        case FRAME_OP_READ_MODE: {
+            if (frame.payloadLength != 1) {
+                writeFrameError(usbManager, frame.seq, FRAME_ERR_INVALID_PAYLOAD, NULL);
+                break;
+            }
+            uint8_t modeIndex = (uint8_t)frame.payload[0];
+            char *mode = &sharedJsonIOBuffer[FRAME_HEADROOM];
+            size_t capacity = sharedJsonIOBufferLength - FRAME_HEADROOM;
+            usbManager->modeManager->readSavedMode(modeIndex, mode, capacity);
+            const char *end = memchr(mode, '\0', capacity);
+            if (end == NULL) {
+                // a cut off mode would read back as a different, broken one
+                writeFrameError(usbManager, frame.seq, FRAME_ERR_INVALID_PAYLOAD, "mode too large");
+                break;
+            }
+            writeFrame(usbManager, response, frame.seq, mode, (size_t)(end - mode));
+            break;
+        }
+        case FRAME_OP_WRITE_SETTINGS: {
+            if (frame.payloadLength != CHIP_SETTINGS_PACKED_SIZE) {
+                writeFrameError(usbManager, frame.seq, FRAME_ERR_INVALID_PAYLOAD, NULL);
+                break;
+            }
+            ChipSettings settings;
+            chipSettingsUnpack((const uint8_t *)frame.payload, &settings);
+
+            // flash holds the JSON command, round trip it so validation matches the JSON path
+            int len = getSettingsCommandJson(&settings, buffer, sharedJsonIOBufferLength);
+            if (len <= 0 || (size_t)len >= sharedJsonIOBufferLength) {
+                writeFrameError(usbManager, frame.seq, FRAME_ERR_INVALID_PAYLOAD, NULL);
+                break;
+            }
+            parseJson(buffer, (size_t)len + 1, &cliInput);
+            if (cliInput.parsedType != parseWriteSettings) {
+                writeFrameParseError(usbManager, frame.seq);
+                break;
+            }
+            applyWriteSettings(usbManager, buffer, (size_t)len + 1);
+            writeFrame(usbManager, response, frame.seq, NULL, 0);
+            break;
+        }
+        case FRAME_OP_READ_SETTINGS: {
+            uint8_t payload[CHIP_SETTINGS_PACKED_SIZE];
+            chipSettingsPack(&usbManager->settingsManager->currentSettings, payload);
+            writeFrame(usbManager, response, frame.seq, (const char *)payload, sizeof(payload));
+            break;
+        }
+        case FRAME_OP_DFU: {
+            usbManager->enterDFU();
+            break;
+        }
+        case FRAME_OP_STREAM_START: {
+            if (frame.payloadLength < 1 || frame.payloadLength > 2) {
+                writeFrameError(usbManager, frame.seq, FRAME_ERR_INVALID_PAYLOAD, NULL);
+                break;
+            }
+            uint8_t frameIntervalMs = (uint8_t)frame.payload[0];
+            uint8_t prefillFrames = frame.payloadLength == 2 ? (uint8_t)frame.payload[1]
+                                                             : LIVE_STREAM_DEFAULT_PREFILL;
+            startLiveStream(usbManager->modeManager, frameIntervalMs, prefillFrames, milliseconds);
+            char payload[1] = {LIVE_STREAM_BUFFER_FRAMES};
+            writeFrame(usbManager, response, frame.seq, payload, sizeof(payload));
+            break;
+        }
+        case FRAME_OP_STREAM_FRAMES: {
+            LiveStream *stream = &usbManager->modeManager->liveStream;
+            if (frame.payloadLength == 0 || frame.payloadLength % LIVE_STREAM_FRAME_SIZE != 0 ||
+                !stream->active) {
+                writeFrameError(usbManager, frame.seq, FRAME_ERR_INVALID_PAYLOAD, NULL);
+                break;
+            }
+            for (size_t i = 0; i < frame.payloadLength; i += LIVE_STREAM_FRAME_SIZE) {
+                liveStreamPush(stream, (const uint8_t *)&frame.payload[i], milliseconds);
+            }
+            break;
+        }
+        case FRAME_OP_STREAM_STOP: {
+            stopLiveStream(usbManager->modeManager);
+            writeLiveStreamStats(usbManager, response, frame.seq, milliseconds);
+            break;
+        }
+        case FRAME_OP_STREAM_STATS: {
+            writeLiveStreamStats(usbManager, response, frame.seq, milliseconds);
+            break;
+        }
+        case FRAME_OP_READ_TELEMETRY: {
+            if (frame.payloadLength != 0 && frame.payloadLength != 2) {
+                writeFrameError(usbManager, frame.seq, FRAME_ERR_INVALID_PAYLOAD, NULL);
+                break;
+            }
+            uint16_t first = 0;
+            if (frame.payloadLength == 2) {
+                first = (uint16_t)((uint8_t)frame.payload[0] | ((uint8_t)frame.payload[1] << 8));
+            }
+            writeTelemetryFrame(usbManager, response, frame.seq, first);
+            break;
+        }
+        default: {
+            writeFrameError(usbManager, frame.seq, FRAME_ERR_UNKNOWN_OPCODE, NULL);
+            break;
+        }
     }
 }
 
 void usbTask(USBManager *usbManager) {
-    int32_t bytesRead = usbManager->usbReadTask(sharedJsonIOBuffer, sharedJsonIOBufferLength);
-    if (bytesRead > 0) {
-        handleJson(usbManager, sharedJsonIOBuffer, (size_t)bytesRead);
+    uint32_t startMs = usbManager->currentMilliseconds();
+    for (uint8_t line = 0; line < USB_TASK_MAX_LINES; line++) {
+        // A response can fill the shared buffer, leave the next line with the host until it would
+        // fit. The first read always happens, usbReadTask holds back on its own and keeps USB
+        // serviced while it waits.
+        if (line > 0 && usbManager->usbTxFree() < sharedJsonIOBufferLength) {
+            break;
+        }
+        int32_t bytesRead = usbManager->usbReadTask(sharedJsonIOBuffer, sharedJsonIOBufferLength);
+        if (bytesRead <= 0) {
+            break;
+        }
+
+        // flash writes take a while, sample the clock per line
+        uint32_t milliseconds = usbManager->currentMilliseconds();
+        if (sharedJsonIOBuffer[0] == FRAME_START_BYTE) {
+            handleFrame(usbManager, sharedJsonIOBuffer, (size_t)bytesRead, milliseconds);
+        } else {
+            handleJson(usbManager, sharedJsonIOBuffer, (size_t)bytesRead);
+        }
+
+        if (usbManager->currentMilliseconds() - startMs >= USB_TASK_BUDGET_MS) {
+            break;
+        }
     }
 }
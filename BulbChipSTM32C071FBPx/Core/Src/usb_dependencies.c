@@ -6,107 +6,236 @@
  */
 
 #include "usb_dependencies.h"
-#include "bsp/board_api.h"
 #include "tusb.h"
 
-// File-scope state for usbReadTask buffering
-static uint16_t jsonIndex = 0;
-static char readBuf[64];
-static uint8_t readBufCount = 0;
-static uint8_t readBufPos = 0;
+#include <string.h>
 
-void usbWrite(const char *buf, size_t count) {
-    size_t sent = 0;
-    // Large payloads can span many 64-byte packets. Give the host
-    // enough time to drain the vendor TX FIFO instead of truncating the tail.
-    const uint32_t writeTimeoutMs = 1000;
-    uint32_t lastProgressAt = board_millis();
-
-    while (sent < count) {
-        if (!tud_vendor_mounted()) {
+// File-scope state for usbReadTask buffering. Incoming data is read straight into the tail of the
+// caller's buffer; only bytes that arrive after a line terminator in the same packet are held in
+// carryBuf until the next call.
+#define USB_READ_CHUNK_SIZE 64
+
+typedef uint32_t __attribute__((may_alias)) AliasedWord;
+
+static size_t jsonIndex = 0;
+static char carryBuf[USB_READ_CHUNK_SIZE];
+static uint8_t carryCount = 0;
+static uint8_t carryPos = 0;
+static bool discardingLine = false;
+
+#define USB_TX_RING_MASK (USB_TX_RING_SIZE - 1)
+
+static char txRing[USB_TX_RING_SIZE];
+// free running, wrap naturally at 2^16
+static uint16_t txHead = 0;
+static uint16_t txTail = 0;
+
+void usbWriteTask(void) {
+    if (!tud_vendor_mounted()) {
+        // nobody is listening, stale output should not be delivered on the next connect
+        txTail = txHead;
+        return;
+    }
+
+    bool wrote = false;
+    while (txHead != txTail) {
+        uint32_t available = tud_vendor_write_available();
+        if (available == 0) {
             break;
         }
 
-        uint32_t available = tud_vendor_write_available();
-        if (available > 0) {
-            uint32_t to_send = (uint32_t)(count - sent);
-            if (to_send > available) {
-                to_send = available;
-            }
+        uint16_t start = txTail & USB_TX_RING_MASK;
+        uint32_t run = (uint16_t)(txHead - txTail);
+        if (run > USB_TX_RING_SIZE - start) {
+            run = USB_TX_RING_SIZE - start;
+        }
+        if (run > available) {
+            run = available;
+        }
 
-            uint32_t written = tud_vendor_write(buf + sent, to_send);
-            sent += written;
-            if (written > 0) {
-                lastProgressAt = board_millis();
-                if (sent < count) {
-                    tud_vendor_write_flush();
-                }
-            }
-        } else {
-            tud_vendor_write_flush();
-            if (board_millis() - lastProgressAt >= writeTimeoutMs) {
-                break;
-            }
+        uint32_t written = tud_vendor_write(&txRing[start], run);
+        if (written == 0) {
+            break;
         }
-        tud_task();
+        txTail += (uint16_t)written;
+        wrote = true;
     }
-    tud_vendor_write_flush();
-    tud_task();
+
+    if (wrote) {
+        tud_vendor_write_flush();
+    }
+}
+
+// Invoked by TinyUSB from tud_task when an IN transfer completes, the FIFO has room again.
+void tud_vendor_tx_cb(uint8_t itf, uint32_t sent_bytes) {
+    (void)itf;
+    (void)sent_bytes;
+    usbWriteTask();
+}
+
+size_t usbTxFree(void) {
+    return USB_TX_RING_SIZE - (uint16_t)(txHead - txTail);
+}
+
+// Never blocks. Messages are queued whole or dropped whole, so the host never sees half a line.
+// usbReadTask holds commands back until a response fits, a drop means a write ignored that.
+void usbWrite(const char *buf, size_t count) {
+    if (!tud_vendor_mounted()) {
+        return;
+    }
+
+    uint16_t used = (uint16_t)(txHead - txTail);
+    if (count > (size_t)(USB_TX_RING_SIZE - used)) {
+        return;
+    }
+
+    uint16_t start = txHead & USB_TX_RING_MASK;
+    size_t firstRun = USB_TX_RING_SIZE - start;
+    if (firstRun > count) {
+        firstRun = count;
+    }
+    memcpy(&txRing[start], buf, firstRun);
+    memcpy(txRing, buf + firstRun, count - firstRun);
+    txHead += (uint16_t)count;
+
+    usbWriteTask();
 }
 
 #ifdef UNIT_TEST
+void usbWriteReset(void) {
+    txHead = 0;
+    txTail = 0;
+}
+
 void usbReadTaskReset(void) {
     jsonIndex = 0;
-    readBufCount = 0;
-    readBufPos = 0;
+    carryCount = 0;
+    carryPos = 0;
+    discardingLine = false;
 }
 #endif
 
+// Returns the first '\n' in data, or NULL. newlib-nano builds memchr for size and compares a byte
+// at a time, so once aligned this compares four bytes per load instead.
+static const char *findLineEnd(const char *data, size_t length) {
+    const char *end = data + length;
+    while (data < end && ((uintptr_t)data & (sizeof(uint32_t) - 1)) != 0) {
+        if (*data == '\n') {
+            return data;
+        }
+        data++;
+    }
+
+    while ((size_t)(end - data) >= sizeof(uint32_t)) {
+        // a byte of word is zero exactly where data holds '\n'
+        uint32_t word = *(const AliasedWord *)data ^ 0x0A0A0A0AU;
+        if (((word - 0x01010101U) & ~word & 0x80808080U) != 0) {
+            break;
+        }
+        data += sizeof(uint32_t);
+    }
+
+    while (data < end) {
+        if (*data == '\n') {
+            return data;
+        }
+        data++;
+    }
+    return NULL;
+}
+
+static int32_t completeLine(void) {
+    int32_t len = (int32_t)jsonIndex;
+    jsonIndex = 0;
+    return len;
+}
+
+// The rest of an oversized line is dropped up to its terminator so the next command parses cleanly.
+static void payloadTooLong(void) {
+    const char *error = "{\"error\":\"payload too long\"}\n";
+    usbWrite(error, strlen(error));
+    jsonIndex = 0;
+    discardingLine = true;
+}
+
+static int32_t drainCarry(char usbBuffer[], size_t bufferLength) {
+    if (discardingLine) {
+        const char *lineEnd = findLineEnd(&carryBuf[carryPos], carryCount - carryPos);
+        if (!lineEnd) {
+            carryPos = carryCount;
+            return 0;
+        }
+        carryPos = (uint8_t)(lineEnd - carryBuf + 1);
+        discardingLine = false;
+    }
+
+    size_t pending = carryCount - carryPos;
+    const char *lineEnd = findLineEnd(&carryBuf[carryPos], pending);
+    size_t take = lineEnd ? (size_t)(lineEnd - &carryBuf[carryPos]) + 1 : pending;
+    if (jsonIndex + take > bufferLength) {
+        payloadTooLong();
+        return 0;
+    }
+
+    memcpy(&usbBuffer[jsonIndex], &carryBuf[carryPos], take);
+    carryPos += (uint8_t)take;
+    jsonIndex += take;
+    return lineEnd ? completeLine() : 0;
+}
+
 // returns bytes read if a buffer has read in a full line terminated by \n, 0 otherwise.
 int32_t usbReadTask(char usbBuffer[], size_t bufferLength) {
+    // A response can fill a buffer as long as the command, take no new line until it would fit.
+    // With the ring as large as the buffer that means an empty ring, but the 512 byte vendor TX
+    // FIFO drains it first, so only a response longer than the FIFO still going out holds input.
+    // Unread bytes stay in the vendor RX FIFO and USB flow control holds the host back meanwhile.
+    if (usbTxFree() < bufferLength) {
+        // completes IN transfers, the ring only drains once TinyUSB has seen them
+        tud_task();
+        return 0;
+    }
+
     // Process any leftover bytes from a previous read before pulling new data
-    while (readBufPos < readBufCount) {
-        if (jsonIndex + 1 > bufferLength) {
-            const char *error = "{\"error\":\"payload too long\"}\n";
-            usbWrite(error, strlen(error));
-            jsonIndex = 0;
-            readBufPos = 0;
-            readBufCount = 0;
-            return 0;
-        }
-        char chr = readBuf[readBufPos++];
-        usbBuffer[jsonIndex++] = chr;
-        if (chr == '\n') {
-            int32_t len = (int32_t)jsonIndex;
-            jsonIndex = 0;
+    if (carryPos < carryCount) {
+        int32_t len = drainCarry(usbBuffer, bufferLength);
+        if (len != 0 || carryPos < carryCount) {
             return len;
         }
     }
 
-    // All leftover bytes consumed, try to read new data
     tud_task();
-    if (tud_vendor_available()) {
-        // cast count as uint8_t, readBuf is only 64 bytes
-        readBufCount = (uint8_t)tud_vendor_read(readBuf, sizeof(readBuf));
-        readBufPos = 0;
-
-        if (jsonIndex + readBufCount > bufferLength) {
-            const char *error = "{\"error\":\"payload too long\"}\n";
-            usbWrite(error, strlen(error));
-            jsonIndex = 0;
-            readBufPos = 0;
-            readBufCount = 0;
-        } else {
-            while (readBufPos < readBufCount) {
-                char chr = readBuf[readBufPos++];
-                usbBuffer[jsonIndex++] = chr;
-                if (chr == '\n') {
-                    int32_t len = (int32_t)jsonIndex;
-                    jsonIndex = 0;
-                    return len;
-                }
+    while (tud_vendor_available()) {
+        if (discardingLine) {
+            carryCount = (uint8_t)tud_vendor_read(carryBuf, sizeof(carryBuf));
+            carryPos = 0;
+            int32_t len = drainCarry(usbBuffer, bufferLength);
+            if (len != 0 || carryPos < carryCount) {
+                return len;
             }
+            continue;
+        }
+
+        if (jsonIndex >= bufferLength) {
+            payloadTooLong();
+            return 0;
+        }
+
+        // Read at most one packet at a time so bytes past a terminator always fit in carryBuf
+        size_t space = bufferLength - jsonIndex;
+        uint32_t chunk = space < USB_READ_CHUNK_SIZE ? (uint32_t)space : USB_READ_CHUNK_SIZE;
+        char *tail = &usbBuffer[jsonIndex];
+        uint32_t count = tud_vendor_read(tail, chunk);
+
+        const char *lineEnd = findLineEnd(tail, count);
+        if (lineEnd) {
+            size_t lineBytes = (size_t)(lineEnd - tail) + 1;
+            carryCount = (uint8_t)(count - lineBytes);
+            carryPos = 0;
+            memcpy(carryBuf, lineEnd + 1, carryCount);
+            jsonIndex += lineBytes;
+            return completeLine();
         }
+        jsonIndex += count;
     }
 
     return 0;
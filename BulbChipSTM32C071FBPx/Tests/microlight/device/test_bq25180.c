@@ -2,6 +2,7 @@
 #include <string.h>
 #include "lwjson/lwjson.h"
 #include "microlight/device/bq25180.h"
+#include "microlight/device/i2c_queue.h"
 #include "unity.h"
 
 // Mocks
@@ -9,12 +10,15 @@ static uint8_t mockRegisters[20];
 static uint8_t lastWrittenReg;
 static uint8_t lastWrittenValue;
 static bool writeCalled = false;
+static int writeTransactions = 0;
+static int readTransactions = 0;
 static bool mockReadRegistersShouldFail = false;
 static char serialBuffer[1024];
 static uint32_t serialBufferLen = 0;
+static I2CQueue queue;
 
-bool mock_readRegisters(uint8_t devAddress, uint8_t startReg, uint8_t *buf, size_t len) {
-    (void)devAddress;
+static bool readRegisters(uint8_t startReg, uint8_t *buf, size_t len) {
+    readTransactions++;
     if (mockReadRegistersShouldFail) {
         return false;
     }
@@ -26,11 +30,31 @@ bool mock_readRegisters(uint8_t devAddress, uint8_t startReg, uint8_t *buf, size
     return false;
 }
 
-void mock_writeRegister(uint8_t devAddress, uint8_t reg, uint8_t value) {
-    lastWrittenReg = reg;
-    lastWrittenValue = value;
+// The mock bus finishes every transfer as soon as it starts, i2cQueueTask hands out the results
+bool mock_startRead(uint8_t devAddress, uint8_t startReg, uint8_t *buf, size_t len) {
+    (void)devAddress;
+    i2cQueueComplete(&queue, readRegisters(startReg, buf, len));
+    return true;
+}
+
+bool mock_startWrite(uint8_t devAddress, uint8_t startReg, const uint8_t *data, size_t length) {
+    (void)devAddress;
+    for (size_t i = 0; i < length; i++) {
+        lastWrittenReg = (uint8_t)(startReg + i);
+        lastWrittenValue = data[i];
+        mockRegisters[lastWrittenReg] = data[i];
+    }
     writeCalled = true;
-    mockRegisters[reg] = value;
+    writeTransactions++;
+    i2cQueueComplete(&queue, true);
+    return true;
+}
+
+void mock_abort(void) {
+}
+
+uint32_t mock_milliseconds(void) {
+    return 0;
 }
 
 void mock_writeToSerial(const char *buf, size_t count) {
@@ -68,6 +92,11 @@ void rgbShowUserColor(RGBLed *led, uint8_t r, uint8_t g, uint8_t b) {
 static BQ25180 charger;
 static RGBLed mockLed;
 
+static void runChargerTask(uint32_t milliseconds, ChargerTaskFlags flags) {
+    chargerTask(&charger, milliseconds, flags);
+    i2cQueueTask(&queue);
+}
+
 void setUp(void) {
     memset(&charger, 0, sizeof(BQ25180));
     memset(&mockLed, 0, sizeof(RGBLed));
@@ -86,13 +115,15 @@ void setUp(void) {
     rgbConstantVoltageCalled = false;
     rgbDoneChargingCalled = false;
 
-    bq25180Init(
-        &charger, mock_readRegisters, mock_writeRegister, 0x6A, mock_writeToSerial, &mockLed);
+    i2cQueueInit(&queue, mock_startRead, mock_startWrite, mock_abort, mock_milliseconds, NULL);
+    bq25180Init(&charger, &queue, 0x6A, mock_writeToSerial, &mockLed);
 
     // Reset write flag after init, as init performs writes
     writeCalled = false;
     lastWrittenReg = 0;
     lastWrittenValue = 0;
+    writeTransactions = 0;
+    readTransactions = 0;
 }
 
 void tearDown(void) {
@@ -101,20 +132,63 @@ void tearDown(void) {
 void test_Bq25180Init_Configures160SecondHardwareResetWatchdog(void) {
     BQ25180 freshCharger = {0};
 
-    bq25180Init(
-        &freshCharger, mock_readRegisters, mock_writeRegister, 0x6A, mock_writeToSerial, &mockLed);
+    bq25180Init(&freshCharger, &queue, 0x6A, mock_writeToSerial, &mockLed);
 
     TEST_ASSERT_EQUAL_UINT8(
         BQ25180_WATCHDOG_160S_HW_RESET, mockRegisters[BQ25180_IC_CTRL] & BQ25180_WATCHDOG_SEL_MASK);
 }
 
+void test_Bq25180Init_CoalescesConfigurationIntoBursts(void) {
+    BQ25180 freshCharger = {0};
+    memset(mockRegisters, 0, sizeof(mockRegisters));
+    writeTransactions = 0;
+    readTransactions = 0;
+
+    bq25180Init(&freshCharger, &queue, 0x6A, mock_writeToSerial, &mockLed);
+
+    // VBAT_CTRL..IC_CTRL and SYS_REG..MASK_ID, the gaps are rewritten with what was read
+    TEST_ASSERT_EQUAL_INT(1, readTransactions);
+    TEST_ASSERT_EQUAL_INT(2, writeTransactions);
+    TEST_ASSERT_EQUAL_HEX8(0b00100010, mockRegisters[BQ25180_ICHG_CTRL]);
+    TEST_ASSERT_EQUAL_HEX8(0, mockRegisters[BQ25180_CHARGECTRL0]);
+    TEST_ASSERT_EQUAL_HEX8(0, mockRegisters[BQ25180_SHIP_RST]);
+    TEST_ASSERT_EQUAL_UINT16(0, freshCharger.shadowDirty);
+}
+
+void test_Bq25180Init_SkipsWritesWhenAlreadyConfigured(void) {
+    // setUp already configured the mock charger, as after an MCU reset from standby
+    BQ25180 freshCharger = {0};
+
+    bq25180Init(&freshCharger, &queue, 0x6A, mock_writeToSerial, &mockLed);
+
+    TEST_ASSERT_EQUAL_INT(1, readTransactions);
+    TEST_ASSERT_FALSE(writeCalled);
+}
+
+void test_Bq25180Init_FailedReadWritesEverything(void) {
+    BQ25180 freshCharger = {0};
+    mockReadRegistersShouldFail = true;
+
+    bq25180Init(&freshCharger, &queue, 0x6A, mock_writeToSerial, &mockLed);
+
+    // nothing known to bridge the gaps with
+    TEST_ASSERT_EQUAL_INT(4, writeTransactions);
+    TEST_ASSERT_EQUAL(notConnected, freshCharger.chargingState);
+}
+
 void test_DisableWatchdog_DisablesHostWatchdog(void) {
     disableWatchdog(&charger);
+    i2cQueueFlush(&queue);
 
     TEST_ASSERT_TRUE(writeCalled);
     TEST_ASSERT_EQUAL_UINT8(BQ25180_IC_CTRL, lastWrittenReg);
     TEST_ASSERT_EQUAL_UINT8(
         BQ25180_WATCHDOG_DISABLED, lastWrittenValue & BQ25180_WATCHDOG_SEL_MASK);
+
+    // already disabled, nothing to send
+    disableWatchdog(&charger);
+    i2cQueueFlush(&queue);
+    TEST_ASSERT_EQUAL_INT(1, writeTransactions);
 }
 
 void test_ChargerTask_Locks_WhenUnplugged_And_UnplugLockEnabled(void) {
@@ -128,8 +202,7 @@ void test_ChargerTask_Locks_WhenUnplugged_And_UnplugLockEnabled(void) {
     // 3. Trigger interrupt handling
 
     // 4. Run task with unplugLockEnabled = true
-    chargerTask(
-        &charger,
+    runChargerTask(
         1000,
         (ChargerTaskFlags){
             .interruptTriggered = true, .unplugLockEnabled = true});  // interruptTriggered=true
@@ -145,10 +218,8 @@ void test_ChargerTask_DoesNotLock_WhenUnplugged_And_UnplugLockDisabled(void) {
     charger.chargingState = constantCurrent;
     mockRegisters[BQ25180_STAT0] = 0b00000000;  // Not connected
 
-    chargerTask(
-        &charger,
-        1000,
-        (ChargerTaskFlags){.interruptTriggered = true});  // unplugLockEnabled = false
+    // unplugLockEnabled = false
+    runChargerTask(1000, (ChargerTaskFlags){.interruptTriggered = true});
 
     TEST_ASSERT_FALSE(writeCalled);
 }
@@ -158,14 +229,14 @@ void test_ChargerTask_PeriodicallyShowsChargingState(void) {
     charger.registersReadAtMs = 100;  // Prevent register read
 
     // Test at (ms & 0x3FF) < 50 (e.g., 1024)
-    chargerTask(&charger, 1024, (ChargerTaskFlags){.chargeLedEnabled = true});  // ledEnabled = true
+    runChargerTask(1024, (ChargerTaskFlags){.chargeLedEnabled = true});  // ledEnabled = true
     TEST_ASSERT_TRUE(rgbConstantCurrentCalled);
 
     // Reset
     rgbConstantCurrentCalled = false;
 
     // Test at (ms & 0x3FF) >= 50 (e.g., 1100)
-    chargerTask(&charger, 1100, (ChargerTaskFlags){.chargeLedEnabled = true});
+    runChargerTask(1100, (ChargerTaskFlags){.chargeLedEnabled = true});
     TEST_ASSERT_FALSE(rgbConstantCurrentCalled);
 }
 
@@ -173,7 +244,7 @@ void test_ChargerTask_DoesNotUpdateLed_WhenChargeLedDisabled(void) {
     charger.chargingState = constantCurrent;
     charger.registersReadAtMs = 100;  // Prevent register read
 
-    chargerTask(&charger, 1024, (ChargerTaskFlags){.chargeLedEnabled = false});
+    runChargerTask(1024, (ChargerTaskFlags){.chargeLedEnabled = false});
 
     TEST_ASSERT_FALSE(rgbConstantCurrentCalled);
 }
@@ -187,8 +258,7 @@ void test_ChargerTask_UpdatesLed_WhenStateChangesFromNotConnectedToConnected(voi
     mockRegisters[BQ25180_STAT0] = 0b01100000;  // Done charging (Bit 6=1, Bit 5=1)
 
     // Run task at time that does NOT trigger periodic flash
-    chargerTask(
-        &charger,
+    runChargerTask(
         1060,
         (ChargerTaskFlags){
             .interruptTriggered = true, .chargeLedEnabled = true});  // Interrupt triggered
@@ -210,7 +280,7 @@ void test_ChargerTask_WritesRegistersToSerial_WhenSerialEnabled(void) {
     charger.registersReadAtMs = 0;
 
     // Run task with serialEnabled = true
-    chargerTask(&charger, 1000, (ChargerTaskFlags){.serialEnabled = true});
+    runChargerTask(1000, (ChargerTaskFlags){.serialEnabled = true});
 
     // Verify the output contains the expected binary strings
     TEST_ASSERT_NOT_NULL(strstr(serialBuffer, "\"stat0\":\"10101010\""));
@@ -223,7 +293,7 @@ void test_ChargerTask_WritesValidJson_And_FitsInBuffer(void) {
     charger.registersReadAtMs = 0;
 
     // Run task with serialEnabled = true
-    chargerTask(&charger, 1000, (ChargerTaskFlags){.serialEnabled = true});
+    runChargerTask(1000, (ChargerTaskFlags){.serialEnabled = true});
 
     // Check validity
     lwjson_t lwjson;
@@ -247,28 +317,111 @@ void test_ChargerTask_WritesValidJson_And_FitsInBuffer(void) {
         "JSON output length mismatch with buffer size");
 }
 
-void test_GetChargingState_PreservesPreviousState_WhenReadFails(void) {
+void test_ChargerTask_RetriesFailedStatusReadOncePerSecond(void) {
     charger.chargingState = notCharging;
-    charger.chargeStateCachedAtMs = 1;
+    charger.registersReadAtMs = 100;  // Prevent register read
+    charger.shadowKnown &= (uint16_t)~REGISTER_BIT(BQ25180_STAT0);
     mockReadRegistersShouldFail = true;
 
-    enum ChargeState state = getChargingState(&charger, 2000);
+    runChargerTask(2000, (ChargerTaskFlags){0});
+    TEST_ASSERT_EQUAL_INT(1, readTransactions);
+    TEST_ASSERT_EQUAL(notCharging, getChargingState(&charger));
+
+    runChargerTask(2000 + BQ25180_STATE_RETRY_MS - 1, (ChargerTaskFlags){0});
+    TEST_ASSERT_EQUAL_INT(1, readTransactions);
+    runChargerTask(2000 + BQ25180_STATE_RETRY_MS, (ChargerTaskFlags){0});
+    TEST_ASSERT_EQUAL_INT(2, readTransactions);
+
+    mockReadRegistersShouldFail = false;
+    runChargerTask(2000 + 2 * BQ25180_STATE_RETRY_MS, (ChargerTaskFlags){0});
+    runChargerTask(2000 + 4 * BQ25180_STATE_RETRY_MS, (ChargerTaskFlags){0});
+    TEST_ASSERT_EQUAL_INT(3, readTransactions);
+}
+
+void test_ChargerTask_ReadsStatusOnlyOnInterrupt(void) {
+    charger.registersReadAtMs = 100;  // Prevent register read
+    mockRegisters[BQ25180_STAT0] = 0b00100001;  // constant current
+
+    runChargerTask(2000, (ChargerTaskFlags){0});
+    runChargerTask(20000, (ChargerTaskFlags){0});
+    TEST_ASSERT_EQUAL(notConnected, getChargingState(&charger));
+    TEST_ASSERT_EQUAL_INT(0, readTransactions);
 
-    TEST_ASSERT_EQUAL(notCharging, state);
-    TEST_ASSERT_EQUAL(notCharging, charger.chargingState);
+    runChargerTask(20000, (ChargerTaskFlags){.interruptTriggered = true});
+    TEST_ASSERT_EQUAL_INT(1, readTransactions);
+    TEST_ASSERT_EQUAL(constantCurrent, getChargingState(&charger));
+}
+
+void test_ChargerTask_LatchesFaultFlagsUntilTaken(void) {
+    charger.registersReadAtMs = 100;  // Prevent register read
+    mockRegisters[BQ25180_FLAG0] = 0b00000010;  // BUVLO
+
+    runChargerTask(2000, (ChargerTaskFlags){.interruptTriggered = true});
+    // FLAG0 clears on read, the flag is kept by the driver
+    mockRegisters[BQ25180_FLAG0] = 0;
+    runChargerTask(2010, (ChargerTaskFlags){.interruptTriggered = true});
+
+    TEST_ASSERT_EQUAL_HEX8(0b00000010, bq25180TakeFaults(&charger));
+    TEST_ASSERT_EQUAL_HEX8(0, bq25180TakeFaults(&charger));
+}
+
+void test_MsUntilNextRead_FollowsRefreshAndRetry(void) {
+    charger.registersReadAtMs = 0;
+    TEST_ASSERT_EQUAL_UINT32(0, bq25180MsUntilNextRead(&charger, 1000));
+
+    charger.registersReadAtMs = 1000;
+    TEST_ASSERT_EQUAL_UINT32(BQ25180_REFRESH_MS, bq25180MsUntilNextRead(&charger, 1000));
+    TEST_ASSERT_EQUAL_UINT32(5, bq25180MsUntilNextRead(&charger, 1000 + BQ25180_REFRESH_MS - 5));
+
+    // a failed read wants to be retried sooner
+    charger.shadowKnown &= (uint16_t)~REGISTER_BIT(BQ25180_STAT0);
+    charger.stateRequestedAtMs = 1500;
+    TEST_ASSERT_EQUAL_UINT32(500, bq25180MsUntilNextRead(&charger, 2000));
+}
+
+void test_Lock_WaitsForShipModeWrite_WhenUnplugged(void) {
+    mockRegisters[BQ25180_STAT0] = 0b00000000;
+
+    lock(&charger);
+
+    // no interrupt since init, the cached state is used as is
+    TEST_ASSERT_EQUAL_INT(0, readTransactions);
+    TEST_ASSERT_TRUE(i2cQueueIdle(&queue));
+    TEST_ASSERT_EQUAL_UINT8(BQ25180_SHIP_RST, lastWrittenReg);
+    TEST_ASSERT_EQUAL_UINT8(0b01000001, lastWrittenValue);
+}
+
+void test_Lock_RereadsStateAfterSleep(void) {
+    disableWatchdog(&charger);
+    mockRegisters[BQ25180_STAT0] = 0b00000001;  // plugged in while asleep
+    readTransactions = 0;
+
+    lock(&charger);
+
+    TEST_ASSERT_EQUAL_INT(1, readTransactions);
+    TEST_ASSERT_EQUAL_UINT8(BQ25180_SHIP_RST, lastWrittenReg);
+    TEST_ASSERT_EQUAL_UINT8(0b01100001, lastWrittenValue);
 }
 
 int main(void) {
     UNITY_BEGIN();
+    RUN_TEST(test_Bq25180Init_CoalescesConfigurationIntoBursts);
     RUN_TEST(test_Bq25180Init_Configures160SecondHardwareResetWatchdog);
+    RUN_TEST(test_Bq25180Init_FailedReadWritesEverything);
+    RUN_TEST(test_Bq25180Init_SkipsWritesWhenAlreadyConfigured);
     RUN_TEST(test_ChargerTask_DoesNotLock_WhenUnplugged_And_UnplugLockDisabled);
     RUN_TEST(test_ChargerTask_DoesNotUpdateLed_WhenChargeLedDisabled);
+    RUN_TEST(test_ChargerTask_LatchesFaultFlagsUntilTaken);
     RUN_TEST(test_ChargerTask_Locks_WhenUnplugged_And_UnplugLockEnabled);
     RUN_TEST(test_ChargerTask_PeriodicallyShowsChargingState);
+    RUN_TEST(test_ChargerTask_ReadsStatusOnlyOnInterrupt);
+    RUN_TEST(test_ChargerTask_RetriesFailedStatusReadOncePerSecond);
     RUN_TEST(test_ChargerTask_UpdatesLed_WhenStateChangesFromNotConnectedToConnected);
     RUN_TEST(test_ChargerTask_WritesRegistersToSerial_WhenSerialEnabled);
     RUN_TEST(test_ChargerTask_WritesValidJson_And_FitsInBuffer);
     RUN_TEST(test_DisableWatchdog_DisablesHostWatchdog);
-    RUN_TEST(test_GetChargingState_PreservesPreviousState_WhenReadFails);
+    RUN_TEST(test_Lock_RereadsStateAfterSleep);
+    RUN_TEST(test_Lock_WaitsForShipModeWrite_WhenUnplugged);
+    RUN_TEST(test_MsUntilNextRead_FollowsRefreshAndRetry);
     return UNITY_END();
 }
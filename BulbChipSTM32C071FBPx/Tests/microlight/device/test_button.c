@@ -8,138 +8,195 @@
 // Mock Data
 static Button button;
 static uint8_t mockButtonPinState = 1;  // 1 = released, 0 = pressed
+static uint32_t mockNowMs = 0;
 
 // Mock Functions
 uint8_t mock_readButtonPin() {
     return mockButtonPinState;
 }
 
+uint32_t mock_milliseconds(void) {
+    return mockNowMs;
+}
+
 // Include source
 #include "../../../Core/Src/microlight/device/button.c"
 
+// Drives the pin and raises the EXTI interrupt for the edge at the given time
+static void edgeAt(uint32_t milliseconds, bool pressed) {
+    mockNowMs = milliseconds;
+    mockButtonPinState = pressed ? 0 : 1;
+    buttonEdgeInterrupt(&button);
+}
+
 void setUp(void) {
     memset(&button, 0, sizeof(Button));
     mockButtonPinState = 1;
+    mockNowMs = 0;
 
-    buttonInit(&button, mock_readButtonPin);
+    buttonInit(&button, mock_readButtonPin, mock_milliseconds);
 }
 
 void tearDown(void) {
 }
 
+void test_ButtonInit_RequiresClock(void) {
+    Button other;
+    TEST_ASSERT_FALSE(buttonInit(&other, mock_readButtonPin, NULL));
+    TEST_ASSERT_FALSE(buttonInit(&other, NULL, mock_milliseconds));
+}
+
 void test_ButtonInputTask_ReturnsIgnore_Idle(void) {
-    enum ButtonResult result = buttonInputTask(&button, 100, false);
+    mockNowMs = 100;
+    enum ButtonResult result = buttonInputTask(&button);
     TEST_ASSERT_EQUAL(ignore, result);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, buttonMsUntilNextResult(&button));
 }
 
 void test_ButtonInputTask_ReturnsClicked_AfterShortPress(void) {
-    // Determine if interrupt
-    bool interrupt = true;
-
-    // First call, starts evaluation
-    mockButtonPinState = 0;  // Pressed
-    enum ButtonResult result = buttonInputTask(&button, 100, interrupt);
+    edgeAt(100, true);
+    enum ButtonResult result = buttonInputTask(&button);
     TEST_ASSERT_EQUAL(ignore, result);
     TEST_ASSERT_TRUE(isEvaluatingButtonPress(&button));
 
-    // Advance time, button still pressed
-    buttonInputTask(&button, 200, false);  // 100ms elapsed
-
-    // Release button
-    mockButtonPinState = 1;
-    result = buttonInputTask(&button, 300, false);  // 200ms elapsed total
+    edgeAt(300, false);
+    result = buttonInputTask(&button);
 
     TEST_ASSERT_EQUAL(clicked, result);
     TEST_ASSERT_FALSE(isEvaluatingButtonPress(&button));
 }
 
+void test_ButtonInputTask_ClassifiesFromEdgeTimes_NotTaskTime(void) {
+    // The MCU slept through the whole press, both edges are handled in one late task
+    edgeAt(100, true);
+    edgeAt(700, false);
+    mockNowMs = 5000;
+
+    TEST_ASSERT_EQUAL(shutdown, buttonInputTask(&button));
+}
+
 void test_ButtonInputTask_ReturnsShutdown_AfterLongPress(void) {
-    bool interrupt = true;
-    mockButtonPinState = 0;
-    buttonInputTask(&button, 100, interrupt);
+    edgeAt(100, true);
+    buttonInputTask(&button);
 
-    // Advance past the shutdown hold threshold (>500ms elapsed)
-    enum ButtonResult result = buttonInputTask(&button, 650, false);
+    // Past the shutdown hold threshold (>500ms elapsed)
+    mockNowMs = 650;
+    enum ButtonResult result = buttonInputTask(&button);
     TEST_ASSERT_EQUAL(indicateShutdown, result);
 
-    // Release
-    mockButtonPinState = 1;
-    result = buttonInputTask(&button, 800, false);
+    edgeAt(800, false);
+    result = buttonInputTask(&button);
 
     TEST_ASSERT_EQUAL(shutdown, result);
 }
 
 void test_ButtonInputTask_ReturnsLock_AfterVeryLongPress(void) {
-    bool interrupt = true;
-    mockButtonPinState = 0;
-    buttonInputTask(&button, 100, interrupt);
-
-    // Past the shutdown hold threshold (>500ms elapsed)
-    enum ButtonResult result = buttonInputTask(&button, 650, false);
-    TEST_ASSERT_EQUAL(indicateShutdown, result);
+    edgeAt(100, true);
+    buttonInputTask(&button);
 
     // Past the lock hold threshold (>1500ms elapsed)
-    result = buttonInputTask(&button, 1650, false);
+    mockNowMs = 1650;
+    enum ButtonResult result = buttonInputTask(&button);
     TEST_ASSERT_EQUAL(indicateLockOrHardwareReset, result);
 
-    // Release
-    mockButtonPinState = 1;
-    result = buttonInputTask(&button, 1800, false);
+    edgeAt(1800, false);
+    result = buttonInputTask(&button);
 
     TEST_ASSERT_EQUAL(lockOrHardwareReset, result);
 }
 
 void test_ButtonInputTask_IndicatesStatus_WhileHeld(void) {
-    bool interrupt = true;
-    mockButtonPinState = 0;
-    enum ButtonResult result = buttonInputTask(&button, 100, interrupt);
+    edgeAt(100, true);
+    enum ButtonResult result = buttonInputTask(&button);
 
     // Below the shutdown threshold, nothing to indicate yet
     TEST_ASSERT_EQUAL(ignore, result);
 
     // Shutdown feedback window (>500ms elapsed)
-    result = buttonInputTask(&button, 650, false);
+    mockNowMs = 650;
+    result = buttonInputTask(&button);
     TEST_ASSERT_EQUAL(indicateShutdown, result);
 
     // Lock feedback window (>1500ms elapsed)
-    result = buttonInputTask(&button, 1650, false);
+    mockNowMs = 1650;
+    result = buttonInputTask(&button);
     TEST_ASSERT_EQUAL(indicateLockOrHardwareReset, result);
 }
 
 void test_ButtonInputTask_IgnoresReleasedInterruptBounce(void) {
-    enum ButtonResult result = buttonInputTask(&button, 100, true);
+    edgeAt(100, false);
+    enum ButtonResult result = buttonInputTask(&button);
 
     TEST_ASSERT_EQUAL(ignore, result);
     TEST_ASSERT_FALSE(isEvaluatingButtonPress(&button));
+}
 
-    result = buttonInputTask(&button, 200, false);
+void test_ButtonInputTask_CancelsPressReleasedBeforeDebounce(void) {
+    edgeAt(100, true);
+    edgeAt(150, false);
 
-    TEST_ASSERT_EQUAL(ignore, result);
+    TEST_ASSERT_EQUAL(ignore, buttonInputTask(&button));
+    TEST_ASSERT_FALSE(isEvaluatingButtonPress(&button));
+
+    // One millisecond past the debounce is a click, edge times make the boundary exact
+    edgeAt(200, true);
+    edgeAt(251, false);
+
+    TEST_ASSERT_EQUAL(clicked, buttonInputTask(&button));
 }
 
-void test_ButtonInputTask_CancelsPressReleasedBeforeDebounce(void) {
-    mockButtonPinState = 0;
-    buttonInputTask(&button, 100, true);
+void test_ButtonInputTask_HoldCountsFromFirstPressEdge(void) {
+    // Contact bounce on the way down
+    edgeAt(100, true);
+    edgeAt(102, false);
+    edgeAt(104, true);
 
-    mockButtonPinState = 1;
-    enum ButtonResult result = buttonInputTask(&button, 120, false);
+    TEST_ASSERT_EQUAL(ignore, buttonInputTask(&button));
+    TEST_ASSERT_TRUE(isEvaluatingButtonPress(&button));
 
-    TEST_ASSERT_EQUAL(ignore, result);
+    edgeAt(300, false);
+    TEST_ASSERT_EQUAL(clicked, buttonInputTask(&button));
+}
+
+void test_ButtonInputTask_LostReleaseEdge_ReleasesOnPinLevel(void) {
+    for (uint8_t i = 0; i < BUTTON_EDGE_QUEUE_LENGTH; i++) {
+        edgeAt(100 + i, true);
+    }
+    // The queue is full, this release is dropped
+    edgeAt(700, false);
+
+    TEST_ASSERT_EQUAL(shutdown, buttonInputTask(&button));
     TEST_ASSERT_FALSE(isEvaluatingButtonPress(&button));
+}
 
-    result = buttonInputTask(&button, 200, false);
+void test_ButtonMsUntilNextResult_CountsDownToEachThreshold(void) {
+    edgeAt(100, true);
+    buttonInputTask(&button);
 
-    TEST_ASSERT_EQUAL(ignore, result);
+    mockNowMs = 200;
+    TEST_ASSERT_EQUAL_UINT32(401, buttonMsUntilNextResult(&button));
+
+    mockNowMs = 700;
+    TEST_ASSERT_EQUAL_UINT32(901, buttonMsUntilNextResult(&button));
+
+    // nothing left until the release
+    mockNowMs = 1700;
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, buttonMsUntilNextResult(&button));
 }
 
 int main(void) {
     UNITY_BEGIN();
+    RUN_TEST(test_ButtonInit_RequiresClock);
     RUN_TEST(test_ButtonInputTask_CancelsPressReleasedBeforeDebounce);
+    RUN_TEST(test_ButtonInputTask_ClassifiesFromEdgeTimes_NotTaskTime);
+    RUN_TEST(test_ButtonInputTask_HoldCountsFromFirstPressEdge);
     RUN_TEST(test_ButtonInputTask_IgnoresReleasedInterruptBounce);
     RUN_TEST(test_ButtonInputTask_IndicatesStatus_WhileHeld);
+    RUN_TEST(test_ButtonInputTask_LostReleaseEdge_ReleasesOnPinLevel);
     RUN_TEST(test_ButtonInputTask_ReturnsClicked_AfterShortPress);
     RUN_TEST(test_ButtonInputTask_ReturnsIgnore_Idle);
     RUN_TEST(test_ButtonInputTask_ReturnsLock_AfterVeryLongPress);
     RUN_TEST(test_ButtonInputTask_ReturnsShutdown_AfterLongPress);
+    RUN_TEST(test_ButtonMsUntilNextResult_CountsDownToEachThreshold);
     return UNITY_END();
 }
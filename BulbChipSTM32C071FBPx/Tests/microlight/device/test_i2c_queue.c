@@ -0,0 +1,231 @@
+#include <stdbool.h>
+#include <string.h>
+#include "microlight/device/i2c_queue.h"
+#include "unity.h"
+
+// Mock bus, transfers stay in flight until the test completes them
+static I2CQueue queue;
+static uint8_t startedRegs[16];
+static int startCount;
+static uint8_t writtenData[8];
+static size_t writtenLength;
+static bool startShouldFail;
+static int abortCount;
+static uint32_t mockNowMs;
+
+static uint8_t completedRegs[16];
+static bool completedOk[16];
+static int completedCount;
+static int failureCount;
+
+bool mock_startRead(uint8_t devAddress, uint8_t startReg, uint8_t *buffer, size_t length) {
+    (void)devAddress;
+    memset(buffer, startReg, length);
+    startedRegs[startCount++] = startReg;
+    return !startShouldFail;
+}
+
+bool mock_startWrite(uint8_t devAddress, uint8_t startReg, const uint8_t *data, size_t length) {
+    (void)devAddress;
+    memcpy(writtenData, data, length);
+    writtenLength = length;
+    startedRegs[startCount++] = startReg;
+    return !startShouldFail;
+}
+
+void mock_abort(void) {
+    abortCount++;
+}
+
+uint32_t mock_milliseconds(void) {
+    return mockNowMs;
+}
+
+void mock_onFailure(const I2CTransaction *transaction) {
+    (void)transaction;
+    failureCount++;
+}
+
+static void recordCompletion(void *context, bool ok) {
+    completedRegs[completedCount] = *(uint8_t *)context;
+    completedOk[completedCount] = ok;
+    completedCount++;
+}
+
+static uint8_t followUpReg = 0x30;
+static void submitFollowUp(void *context, bool ok) {
+    recordCompletion(context, ok);
+    i2cQueueWrite(&queue, 0x10, followUpReg, 1, recordCompletion, &followUpReg);
+}
+
+void setUp(void) {
+    memset(startedRegs, 0, sizeof(startedRegs));
+    startCount = 0;
+    memset(writtenData, 0, sizeof(writtenData));
+    writtenLength = 0;
+    startShouldFail = false;
+    abortCount = 0;
+    mockNowMs = 1000;
+    memset(completedRegs, 0, sizeof(completedRegs));
+    memset(completedOk, 0, sizeof(completedOk));
+    completedCount = 0;
+    failureCount = 0;
+    i2cQueueInit(
+        &queue, mock_startRead, mock_startWrite, mock_abort, mock_milliseconds, mock_onFailure);
+}
+
+void tearDown(void) {
+}
+
+void test_I2CQueue_InitRequiresBus(void) {
+    I2CQueue other;
+    TEST_ASSERT_FALSE(
+        i2cQueueInit(&other, NULL, mock_startWrite, mock_abort, mock_milliseconds, NULL));
+    TEST_ASSERT_FALSE(
+        i2cQueueInit(&other, mock_startRead, mock_startWrite, NULL, mock_milliseconds, NULL));
+    TEST_ASSERT_TRUE(
+        i2cQueueInit(&other, mock_startRead, mock_startWrite, mock_abort, mock_milliseconds, NULL));
+}
+
+void test_I2CQueue_StartsFirstAndRunsRestInOrder(void) {
+    static uint8_t regs[3] = {0x01, 0x02, 0x03};
+    uint8_t buffer[2];
+    i2cQueueWrite(&queue, 0x10, regs[0], 5, recordCompletion, &regs[0]);
+    i2cQueueRead(&queue, 0x10, regs[1], buffer, sizeof(buffer), recordCompletion, &regs[1]);
+    i2cQueueWrite(&queue, 0x10, regs[2], 6, recordCompletion, &regs[2]);
+
+    // only one transfer on the bus at a time
+    TEST_ASSERT_EQUAL_INT(1, startCount);
+    TEST_ASSERT_FALSE(i2cQueueIdle(&queue));
+
+    // nothing is delivered from the interrupt itself
+    i2cQueueComplete(&queue, true);
+    TEST_ASSERT_EQUAL_INT(0, completedCount);
+
+    i2cQueueTask(&queue);
+    TEST_ASSERT_EQUAL_INT(1, completedCount);
+    TEST_ASSERT_EQUAL_INT(2, startCount);
+    TEST_ASSERT_EQUAL_HEX8(0x02, buffer[0]);
+
+    i2cQueueComplete(&queue, true);
+    i2cQueueTask(&queue);
+    i2cQueueComplete(&queue, true);
+    i2cQueueTask(&queue);
+
+    TEST_ASSERT_EQUAL_INT(3, completedCount);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(regs, completedRegs, 3);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(regs, startedRegs, 3);
+    TEST_ASSERT_TRUE(i2cQueueIdle(&queue));
+}
+
+void test_I2CQueue_WritesSingleByteAndBurst(void) {
+    static const uint8_t burst[3] = {0xA1, 0xA2, 0xA3};
+    i2cQueueWrite(&queue, 0x10, 0x04, 0x55, NULL, NULL);
+    TEST_ASSERT_EQUAL_UINT32(1, writtenLength);
+    TEST_ASSERT_EQUAL_HEX8(0x55, writtenData[0]);
+
+    i2cQueueWriteBurst(&queue, 0x10, 0x05, burst, sizeof(burst), NULL, NULL);
+    i2cQueueComplete(&queue, true);
+    i2cQueueTask(&queue);
+    TEST_ASSERT_EQUAL_HEX8(0x05, startedRegs[1]);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(burst), writtenLength);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(burst, writtenData, sizeof(burst));
+}
+
+void test_I2CQueue_ErrorReportsFailureAndMovesOn(void) {
+    static uint8_t regs[2] = {0x01, 0x02};
+    i2cQueueWrite(&queue, 0x10, regs[0], 0, recordCompletion, &regs[0]);
+    i2cQueueWrite(&queue, 0x10, regs[1], 0, recordCompletion, &regs[1]);
+
+    i2cQueueComplete(&queue, false);
+    i2cQueueTask(&queue);
+
+    TEST_ASSERT_EQUAL_INT(1, failureCount);
+    TEST_ASSERT_FALSE(completedOk[0]);
+    TEST_ASSERT_EQUAL_INT(2, startCount);
+}
+
+void test_I2CQueue_FailedStartCompletesOnNextTask(void) {
+    static uint8_t reg = 0x01;
+    startShouldFail = true;
+    i2cQueueWrite(&queue, 0x10, reg, 0, recordCompletion, &reg);
+
+    i2cQueueTask(&queue);
+    TEST_ASSERT_EQUAL_INT(1, completedCount);
+    TEST_ASSERT_FALSE(completedOk[0]);
+    TEST_ASSERT_TRUE(i2cQueueIdle(&queue));
+}
+
+void test_I2CQueue_StuckTransferTimesOutAndAborts(void) {
+    static uint8_t reg = 0x01;
+    i2cQueueWrite(&queue, 0x10, reg, 0, recordCompletion, &reg);
+
+    mockNowMs += I2C_QUEUE_TIMEOUT_MS - 1;
+    i2cQueueTask(&queue);
+    TEST_ASSERT_EQUAL_INT(0, completedCount);
+
+    mockNowMs++;
+    i2cQueueTask(&queue);
+    TEST_ASSERT_EQUAL_INT(1, abortCount);
+    TEST_ASSERT_EQUAL_INT(1, failureCount);
+    TEST_ASSERT_FALSE(completedOk[0]);
+
+    // a late interrupt for the aborted transfer is ignored
+    i2cQueueComplete(&queue, true);
+    i2cQueueTask(&queue);
+    TEST_ASSERT_EQUAL_INT(1, completedCount);
+}
+
+void test_I2CQueue_CompletionCanSubmitMore(void) {
+    static uint8_t reg = 0x01;
+    i2cQueueWrite(&queue, 0x10, reg, 0, submitFollowUp, &reg);
+
+    i2cQueueComplete(&queue, true);
+    i2cQueueTask(&queue);
+    TEST_ASSERT_EQUAL_INT(2, startCount);
+    TEST_ASSERT_EQUAL_HEX8(followUpReg, startedRegs[1]);
+
+    i2cQueueComplete(&queue, true);
+    i2cQueueTask(&queue);
+    TEST_ASSERT_EQUAL_INT(2, completedCount);
+    TEST_ASSERT_EQUAL_HEX8(followUpReg, completedRegs[1]);
+}
+
+void test_I2CQueue_FullQueueWaitsForSlot(void) {
+    for (int i = 0; i < I2C_QUEUE_LENGTH; i++) {
+        i2cQueueWrite(&queue, 0x10, (uint8_t)i, 0, NULL, NULL);
+    }
+
+    // the head transfer has to time out before the next write finds a slot
+    mockNowMs += I2C_QUEUE_TIMEOUT_MS;
+    i2cQueueWrite(&queue, 0x10, 0x20, 0, NULL, NULL);
+
+    TEST_ASSERT_EQUAL_INT(1, abortCount);
+    TEST_ASSERT_EQUAL_UINT8(I2C_QUEUE_LENGTH, queue.count);
+}
+
+void test_I2CQueue_FlushDrainsEverything(void) {
+    startShouldFail = true;
+    for (int i = 0; i < 3; i++) {
+        i2cQueueWrite(&queue, 0x10, (uint8_t)i, 0, NULL, NULL);
+    }
+
+    i2cQueueFlush(&queue);
+    TEST_ASSERT_TRUE(i2cQueueIdle(&queue));
+    TEST_ASSERT_EQUAL_INT(3, startCount);
+    TEST_ASSERT_EQUAL_INT(3, failureCount);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_I2CQueue_CompletionCanSubmitMore);
+    RUN_TEST(test_I2CQueue_ErrorReportsFailureAndMovesOn);
+    RUN_TEST(test_I2CQueue_FailedStartCompletesOnNextTask);
+    RUN_TEST(test_I2CQueue_FlushDrainsEverything);
+    RUN_TEST(test_I2CQueue_FullQueueWaitsForSlot);
+    RUN_TEST(test_I2CQueue_InitRequiresBus);
+    RUN_TEST(test_I2CQueue_StartsFirstAndRunsRestInOrder);
+    RUN_TEST(test_I2CQueue_StuckTransferTimesOutAndAborts);
+    RUN_TEST(test_I2CQueue_WritesSingleByteAndBurst);
+    return UNITY_END();
+}
@@ -0,0 +1,267 @@
+#include <stdbool.h>
+#include <string.h>
+#include "microlight/device/mc3479.h"
+#include "unity.h"
+
+#include "../../../Core/Src/microlight/device/mc3479.c"
+
+// Mock sensor, samples queued here are handed out by XOUT burst reads
+static uint8_t mockRegisters[0x40];
+static int16_t mockFifo[MC3479_FIFO_DEPTH][3];
+static uint8_t mockFifoCount;
+static uint8_t mockReadPointer;
+static int readCalls;
+static bool mockReadShouldFail;
+static I2CQueue queue;
+static MC3479 dev;
+
+static bool readRegisters(uint8_t startReg, uint8_t *buf, size_t len) {
+    readCalls++;
+    if (mockReadShouldFail) {
+        return false;
+    }
+
+    if (startReg == MC3479_REG_FIFO_RD_P && len == 2) {
+        buf[0] = mockReadPointer;
+        buf[1] = (uint8_t)(mockReadPointer + mockFifoCount) & MC3479_FIFO_POINTER_MASK;
+        return true;
+    }
+
+    if (startReg == MC3479_REG_XOUT_L && len % 6 == 0 && len / 6 <= mockFifoCount) {
+        for (size_t i = 0; i < len / 6; i++) {
+            for (int axis = 0; axis < 3; axis++) {
+                uint16_t value = (uint16_t)mockFifo[i][axis];
+                buf[i * 6 + axis * 2] = (uint8_t)(value & 0xFF);
+                buf[i * 6 + axis * 2 + 1] = (uint8_t)(value >> 8);
+            }
+        }
+        uint8_t popped = (uint8_t)(len / 6);
+        memmove(mockFifo, &mockFifo[popped], (mockFifoCount - popped) * sizeof(mockFifo[0]));
+        mockFifoCount -= popped;
+        mockReadPointer = (uint8_t)(mockReadPointer + popped) & MC3479_FIFO_POINTER_MASK;
+        return true;
+    }
+    return false;
+}
+
+// The mock bus finishes every transfer as soon as it starts, i2cQueueTask hands out the results
+bool mock_startRead(uint8_t devAddress, uint8_t startReg, uint8_t *buf, size_t len) {
+    (void)devAddress;
+    i2cQueueComplete(&queue, readRegisters(startReg, buf, len));
+    return true;
+}
+
+bool mock_startWrite(uint8_t devAddress, uint8_t startReg, const uint8_t *data, size_t length) {
+    (void)devAddress;
+    memcpy(&mockRegisters[startReg], data, length);
+    i2cQueueComplete(&queue, true);
+    return true;
+}
+
+void mock_abort(void) {
+}
+
+uint32_t mock_milliseconds(void) {
+    return 0;
+}
+
+static bool drain(uint32_t milliseconds) {
+    bool started = mc3479StartDrain(&dev, milliseconds);
+    i2cQueueTask(&queue);
+    return started;
+}
+
+static void task(uint32_t milliseconds) {
+    mc3479Task(&dev, milliseconds);
+    i2cQueueTask(&queue);
+}
+
+static void push_sample(int16_t x, int16_t y, int16_t z) {
+    mockFifo[mockFifoCount][0] = x;
+    mockFifo[mockFifoCount][1] = y;
+    mockFifo[mockFifoCount][2] = z;
+    mockFifoCount++;
+}
+
+void setUp(void) {
+    memset(mockRegisters, 0, sizeof(mockRegisters));
+    memset(mockFifo, 0, sizeof(mockFifo));
+    mockFifoCount = 0;
+    mockReadPointer = 60;  // close to the pointer wrap
+    readCalls = 0;
+    mockReadShouldFail = false;
+    memset(&dev, 0, sizeof(dev));
+    i2cQueueInit(&queue, mock_startRead, mock_startWrite, mock_abort, mock_milliseconds, NULL);
+    mc3479Init(&dev, &queue, MC3479_I2CADDR_DEFAULT);
+    i2cQueueFlush(&queue);
+}
+
+void tearDown(void) {
+}
+
+void test_MC3479_InitConfiguresRateAndFifo(void) {
+    TEST_ASSERT_EQUAL_HEX8(MC3479_SAMPLE_RATE_100HZ, mockRegisters[MC3479_REG_CTRL2]);
+    TEST_ASSERT_EQUAL_HEX8(
+        MC3479_FIFO_CTRL_ENABLE | MC3479_FIFO_CTRL_WATERMARK_MODE | MC3479_FIFO_WATERMARK,
+        mockRegisters[MC3479_REG_FIFO_CTRL]);
+    TEST_ASSERT_FALSE(dev.enabled);
+}
+
+void test_MC3479_EnableWakesWithBurstReads(void) {
+    mc3479Enable(&dev);
+    i2cQueueFlush(&queue);
+    TEST_ASSERT_TRUE(dev.enabled);
+    TEST_ASSERT_EQUAL_HEX8(0x01, mockRegisters[MC3479_REG_CTRL1]);
+    TEST_ASSERT_EQUAL_HEX8(MC3479_FIFO_CTRL2_BURST, mockRegisters[MC3479_REG_FIFO_CTRL2]);
+}
+
+void test_MC3479_DrainReadsEverySampleInOneBurst(void) {
+    mc3479Enable(&dev);
+    for (int i = 0; i < 10; i++) {
+        push_sample(0, 0, 2048);
+    }
+
+    TEST_ASSERT_TRUE(drain(100));
+    TEST_ASSERT_EQUAL_INT(2, readCalls);
+    TEST_ASSERT_EQUAL_UINT8(0, mockFifoCount);
+    TEST_ASSERT_EQUAL_UINT32(MC3479_SAMPLE_PERIOD_MS, dev.lastDtMs);
+    TEST_ASSERT_EQUAL_UINT64(0, dev.currentJerkSquaredSum);
+}
+
+void test_MC3479_ShortImpactBetweenDrainsIsCaught(void) {
+    mc3479Enable(&dev);
+    push_sample(0, 0, 2048);
+    push_sample(0, 0, 2048);
+    push_sample(300, 0, 2048);  // one 10 ms spike
+    push_sample(0, 0, 2048);
+    push_sample(0, 0, 2048);
+
+    TEST_ASSERT_TRUE(drain(100));
+    // up and back down again, both jerks land in the same window
+    TEST_ASSERT_EQUAL_UINT64(50896, dev.currentJerkSquaredSum);
+
+    // sqrt(50896) LSB in 10 ms at 2048 LSB/g is ~11 g/s
+    TEST_ASSERT_TRUE(isOverThreshold(&dev, 11));
+    TEST_ASSERT_FALSE(isOverThreshold(&dev, 12));
+}
+
+void test_MC3479_JerkContinuesAcrossDrains(void) {
+    mc3479Enable(&dev);
+    push_sample(0, 0, 2048);
+    TEST_ASSERT_TRUE(drain(80));
+    TEST_ASSERT_EQUAL_UINT32(MC3479_SAMPLE_PERIOD_MS, dev.lastDtMs);
+    TEST_ASSERT_FALSE(isOverThreshold(&dev, 1));
+
+    push_sample(0, 400, 2048);
+    TEST_ASSERT_TRUE(drain(160));
+    TEST_ASSERT_EQUAL_UINT64(400 * 400 / JERK_FILTER_WINDOW, dev.currentJerkSquaredSum);
+}
+
+void test_MC3479_EmptyDrainHoldsJerk(void) {
+    mc3479Enable(&dev);
+    push_sample(0, 0, 0);
+    push_sample(500, 0, 0);
+    TEST_ASSERT_TRUE(drain(80));
+    TEST_ASSERT_TRUE(isOverThreshold(&dev, 1));
+
+    TEST_ASSERT_TRUE(drain(160));
+    TEST_ASSERT_EQUAL_INT(3, readCalls);
+    TEST_ASSERT_TRUE(isOverThreshold(&dev, 1));
+
+    // decays once quiet samples arrive, each drain reports the largest value in its batch
+    for (int batch = 0; batch < 3; batch++) {
+        for (int i = 0; i < MC3479_FIFO_DEPTH; i++) {
+            push_sample(500, 0, 0);
+        }
+        TEST_ASSERT_TRUE(drain(240 + batch * 320));
+    }
+    TEST_ASSERT_FALSE(isOverThreshold(&dev, 1));
+}
+
+void test_MC3479_TaskDrainsOncePerWatermarkPeriod(void) {
+    mc3479Enable(&dev);
+    task(1000);
+    TEST_ASSERT_EQUAL_INT(1, readCalls);
+
+    task(1000 + MC3479_FIFO_DRAIN_MS - 1);
+    TEST_ASSERT_EQUAL_INT(1, readCalls);
+
+    task(1000 + MC3479_FIFO_DRAIN_MS);
+    TEST_ASSERT_EQUAL_INT(2, readCalls);
+}
+
+void test_MC3479_FailedDrainKeepsJerkAndWaits(void) {
+    mc3479Enable(&dev);
+    push_sample(0, 0, 0);
+    push_sample(500, 0, 0);
+    task(1000);
+    TEST_ASSERT_TRUE(isOverThreshold(&dev, 1));
+
+    mockReadShouldFail = true;
+    task(1000 + MC3479_FIFO_DRAIN_MS);
+    TEST_ASSERT_TRUE(isOverThreshold(&dev, 1));
+    TEST_ASSERT_EQUAL_UINT32(1000 + MC3479_FIFO_DRAIN_MS, dev.lastSampleMs);
+}
+
+void test_MC3479_MsUntilNextDrainFollowsTask(void) {
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, mc3479MsUntilNextDrain(&dev, 1000));
+
+    mc3479Enable(&dev);
+    TEST_ASSERT_EQUAL_UINT32(0, mc3479MsUntilNextDrain(&dev, 1000));
+    task(1000);
+    TEST_ASSERT_EQUAL_UINT32(MC3479_FIFO_DRAIN_MS, mc3479MsUntilNextDrain(&dev, 1000));
+    TEST_ASSERT_EQUAL_UINT32(MC3479_FIFO_DRAIN_MS - 30, mc3479MsUntilNextDrain(&dev, 1030));
+    TEST_ASSERT_EQUAL_UINT32(0, mc3479MsUntilNextDrain(&dev, 1000 + MC3479_FIFO_DRAIN_MS));
+}
+
+void test_MC3479_DisabledDoesNotRead(void) {
+    push_sample(0, 0, 0);
+    task(1000);
+    TEST_ASSERT_FALSE(drain(1000));
+    TEST_ASSERT_EQUAL_INT(0, readCalls);
+    TEST_ASSERT_FALSE(isOverThreshold(&dev, 0));
+}
+
+void test_MC3479_OneDrainInFlightAtATime(void) {
+    mc3479Enable(&dev);
+    push_sample(0, 0, 0);
+    TEST_ASSERT_TRUE(mc3479StartDrain(&dev, 1000));
+    TEST_ASSERT_FALSE(mc3479StartDrain(&dev, 1000));
+
+    i2cQueueTask(&queue);
+    TEST_ASSERT_EQUAL_INT(2, readCalls);
+    TEST_ASSERT_FALSE(dev.drainPending);
+    TEST_ASSERT_EQUAL_UINT8(0, mockFifoCount);
+}
+
+void test_MC3479_DisableDiscardsDrainInFlight(void) {
+    mc3479Enable(&dev);
+    push_sample(0, 0, 0);
+    push_sample(500, 0, 0);
+    TEST_ASSERT_TRUE(mc3479StartDrain(&dev, 1000));
+    mc3479Disable(&dev);
+    mc3479Enable(&dev);
+
+    // the samples still come off the sensor but are not counted as a jerk
+    i2cQueueFlush(&queue);
+    TEST_ASSERT_FALSE(dev.drainPending);
+    TEST_ASSERT_EQUAL_UINT32(0, dev.lastDtMs);
+    TEST_ASSERT_EQUAL_UINT64(0, dev.currentJerkSquaredSum);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_MC3479_DisableDiscardsDrainInFlight);
+    RUN_TEST(test_MC3479_DisabledDoesNotRead);
+    RUN_TEST(test_MC3479_DrainReadsEverySampleInOneBurst);
+    RUN_TEST(test_MC3479_EmptyDrainHoldsJerk);
+    RUN_TEST(test_MC3479_EnableWakesWithBurstReads);
+    RUN_TEST(test_MC3479_FailedDrainKeepsJerkAndWaits);
+    RUN_TEST(test_MC3479_InitConfiguresRateAndFifo);
+    RUN_TEST(test_MC3479_JerkContinuesAcrossDrains);
+    RUN_TEST(test_MC3479_MsUntilNextDrainFollowsTask);
+    RUN_TEST(test_MC3479_OneDrainInFlightAtATime);
+    RUN_TEST(test_MC3479_ShortImpactBetweenDrainsIsCaught);
+    RUN_TEST(test_MC3479_TaskDrainsOncePerWatermarkPeriod);
+    return UNITY_END();
+}
@@ -9,19 +9,29 @@
 
 static uint16_t capturedRed, capturedGreen, capturedBlue;
 static bool writePwmCalled;
+static int writePwmCount;
+static bool ditherEnabled;
+static int ditherToggleCount;
 
 static void mock_writePwm(uint16_t red, uint16_t green, uint16_t blue) {
     capturedRed = red;
     capturedGreen = green;
     capturedBlue = blue;
     writePwmCalled = true;
+    writePwmCount++;
+}
+
+static void mock_enableDither(bool enable) {
+    ditherEnabled = enable;
+    ditherToggleCount++;
 }
 
 // Include source under test
 #include "../../../Core/Src/microlight/device/rgb_led.c"
 
+// Without dither control every balanced color drives the nearest whole duty.
 static uint16_t expectedDutyForLinearColor(const RGBLed *device, uint8_t value) {
-    return colorToDuty(device, gammaLUT[value]);
+    return roundedDuty(device, device->dutyTable[0][value]);
 }
 
 // ── Fixtures ────────────────────────────────────────────────────────
@@ -32,6 +42,9 @@ void setUp(void) {
     memset(&led, 0, sizeof(led));
     capturedRed = capturedGreen = capturedBlue = 0;
     writePwmCalled = false;
+    writePwmCount = 0;
+    ditherEnabled = false;
+    ditherToggleCount = 0;
 }
 
 void tearDown(void) {
@@ -47,13 +60,13 @@ void test_rgbInit_NullCallback_ReturnsFalse(void) {
     TEST_ASSERT_FALSE(rgbInit(&led, NULL, 255));
 }
 
-void test_rgbInit_PeriodAbove510_ReturnsFalse(void) {
-    TEST_ASSERT_FALSE(rgbInit(&led, mock_writePwm, 511));
+void test_rgbInit_PeriodWithoutRoomForFullScale_ReturnsFalse(void) {
+    TEST_ASSERT_FALSE(rgbInit(&led, mock_writePwm, UINT16_MAX));
 }
 
-void test_rgbInit_Period510_Accepted(void) {
-    TEST_ASSERT_TRUE(rgbInit(&led, mock_writePwm, 510));
-    TEST_ASSERT_EQUAL_UINT16(510, led.period);
+void test_rgbInit_PeriodAbove510_Accepted(void) {
+    TEST_ASSERT_TRUE(rgbInit(&led, mock_writePwm, 4799));
+    TEST_ASSERT_EQUAL_UINT16(4799, led.period);
 }
 
 void test_rgbInit_ValidParams_SetsFieldsCorrectly(void) {
@@ -63,25 +76,25 @@ void test_rgbInit_ValidParams_SetsFieldsCorrectly(void) {
     TEST_ASSERT_EQUAL_UINT8(255, led.whiteBalance.red);
     TEST_ASSERT_EQUAL_UINT8(255, led.whiteBalance.green);
     TEST_ASSERT_EQUAL_UINT8(255, led.whiteBalance.blue);
-    TEST_ASSERT_FALSE(led.showingTransientStatus);
-    TEST_ASSERT_EQUAL_UINT8(0, led.userRed);
-    TEST_ASSERT_EQUAL_UINT8(0, led.userGreen);
-    TEST_ASSERT_EQUAL_UINT8(0, led.userBlue);
+    for (int layer = 0; layer < RGB_LAYER_COUNT; layer++) {
+        TEST_ASSERT_FALSE(rgbLayerActive(&led, (RGBLayer)layer));
+    }
 }
 
 // ── Gamma LUT sanity ────────────────────────────────────────────────
 
 void test_gammaLUT_Endpoints(void) {
-    TEST_ASSERT_EQUAL_UINT8(0, gammaLUT[0]);
-    TEST_ASSERT_EQUAL_UINT8(255, gammaLUT[255]);
+    TEST_ASSERT_EQUAL_UINT16(0, gammaLUT[0]);
+    TEST_ASSERT_EQUAL_UINT16(65535, gammaLUT[255]);
 }
 
 void test_gammaLUT_KnownPoints(void) {
-    // gammaLUT[15] == 1 (verify neighbouring entry is still 0)
-    TEST_ASSERT_EQUAL_UINT8(0, gammaLUT[14]);
-    TEST_ASSERT_EQUAL_UINT8(1, gammaLUT[15]);
-    // pow(25/255, 2.2)*255 ≈ 1.54 → rounds to 2
-    TEST_ASSERT_EQUAL_UINT8(2, gammaLUT[25]);
+    // pow(1/255, 2.2)*65535 ≈ 0.34 → rounds to 0, the only other zero entry
+    TEST_ASSERT_EQUAL_UINT16(0, gammaLUT[1]);
+    TEST_ASSERT_EQUAL_UINT16(2, gammaLUT[2]);
+    // inputs an 8 bit curve collapses to 0 stay distinct
+    TEST_ASSERT_EQUAL_UINT16(111, gammaLUT[14]);
+    TEST_ASSERT_EQUAL_UINT16(129, gammaLUT[15]);
 }
 
 void test_gammaLUT_Monotonic(void) {
@@ -89,6 +102,17 @@ void test_gammaLUT_Monotonic(void) {
         TEST_ASSERT_TRUE_MESSAGE(
             gammaLUT[i] >= gammaLUT[i - 1], "gammaLUT is not monotonically non-decreasing");
     }
+    for (int i = 3; i < 256; i++) {
+        TEST_ASSERT_TRUE_MESSAGE(gammaLUT[i] > gammaLUT[i - 1], "gammaLUT repeats a value");
+    }
+}
+
+void test_gammaAndWhiteBalancedColor_MatchesEightBitCurve(void) {
+    TEST_ASSERT_EQUAL_UINT8(0, gammaAndWhiteBalancedColor(14, 255));
+    TEST_ASSERT_EQUAL_UINT8(1, gammaAndWhiteBalancedColor(15, 255));
+    TEST_ASSERT_EQUAL_UINT8(2, gammaAndWhiteBalancedColor(25, 255));
+    TEST_ASSERT_EQUAL_UINT8(255, gammaAndWhiteBalancedColor(255, 255));
+    TEST_ASSERT_EQUAL_UINT8(128, gammaAndWhiteBalancedColor(255, 128));
 }
 
 // ── colorToDuty boundaries ──────────────────────────────────────────
@@ -140,79 +164,236 @@ void test_colorToDuty_Monotonic_Period510(void) {
     }
 }
 
-// ── colorToDuty known computed values ───────────────────────────────
-// gammaLUT[15] = 1
-//   period 255: (1 * 256 * 0x8081) >> 23 = 1
-//   period 510: (1 * 511 * 0x8081) >> 23 = 2
-// gammaLUT[25] = 2
-//   period 510: (2 * 511 * 0x8081) >> 23 = 4
+// ── duty table known computed values ────────────────────────────────
+// entry = gammaLUT * ((period + 1) << 4) / 65535, driven rounded to the nearest step
+// gammaLUT[15] = 129
+//   period 255: 129 * 4096 / 65535 = 8.06 → 8, 0.5 of a step → 1
+//   period 510: 129 * 8176 / 65535 = 16.09 → 16, one step → 1
+// gammaLUT[25] = 396
+//   period 510: 396 * 8176 / 65535 = 49.40 → 49, 3.06 steps → 3
 
-void test_colorToDuty_KnownPoint_Period255_Value15(void) {
+void test_dutyTable_KnownPoint_Period255_Value15(void) {
     rgbInit(&led, mock_writePwm, 255);
+    TEST_ASSERT_EQUAL_UINT16(8, led.dutyTable[0][15]);
     TEST_ASSERT_EQUAL_UINT16(1, expectedDutyForLinearColor(&led, 15));
 }
 
-void test_colorToDuty_KnownPoint_Period510_Value15(void) {
+void test_dutyTable_KnownPoint_Period510_Value15(void) {
     rgbInit(&led, mock_writePwm, 510);
-    TEST_ASSERT_EQUAL_UINT16(2, expectedDutyForLinearColor(&led, 15));
+    TEST_ASSERT_EQUAL_UINT16(16, led.dutyTable[0][15]);
+    TEST_ASSERT_EQUAL_UINT16(1, expectedDutyForLinearColor(&led, 15));
 }
 
-void test_colorToDuty_KnownPoint_Period510_Value25(void) {
+void test_dutyTable_KnownPoint_Period510_Value25(void) {
     rgbInit(&led, mock_writePwm, 510);
-    TEST_ASSERT_EQUAL_UINT16(4, expectedDutyForLinearColor(&led, 25));
+    TEST_ASSERT_EQUAL_UINT16(49, led.dutyTable[0][25]);
+    TEST_ASSERT_EQUAL_UINT16(3, expectedDutyForLinearColor(&led, 25));
+}
+
+void test_dutyTable_DimInputsKeepFractionalDuty(void) {
+    rgbInit(&led, mock_writePwm, 500);
+    // every input from 4 up lands somewhere above zero, an 8 bit curve only gets there at 15
+    for (int i = 4; i < 256; i++) {
+        TEST_ASSERT_TRUE(led.dutyTable[0][i] > 0);
+    }
+    TEST_ASSERT_EQUAL_UINT8(RGB_DITHER_BITS, led.fractionBits);
+}
+
+void test_dutyTable_LargePeriodDropsFractionBits(void) {
+    rgbInit(&led, mock_writePwm, 8190);
+    TEST_ASSERT_EQUAL_UINT8(3, led.fractionBits);
+    TEST_ASSERT_EQUAL_UINT16(8191U << 3, led.dutyTable[0][255]);
+
+    rgbInit(&led, mock_writePwm, 65534);
+    TEST_ASSERT_EQUAL_UINT8(0, led.fractionBits);
+}
+
+void test_colorToDuty_MaxInput_ReturnsPeriodPlusOne65534(void) {
+    rgbInit(&led, mock_writePwm, 65534);
+    TEST_ASSERT_EQUAL_UINT16(65535, expectedDutyForLinearColor(&led, 255));
+}
+
+// ── duty tables ─────────────────────────────────────────────────────
+
+void test_dutyTable_MatchesGammaWhiteBalanceAndScaling(void) {
+    rgbInit(&led, mock_writePwm, 4799);
+    rgbSetWhiteBalance(
+        &led,
+        (RGBWhiteBalance){
+            .red = 255,
+            .green = 180,
+            .blue = 90,
+        });
+
+    for (int i = 0; i < 256; i++) {
+        // within one fixed point unit of the exact value, either side
+        double fullScale = 4800.0 * (1 << led.fractionBits);
+        double exact = gammaLUT[i] / 65535.0 * fullScale;
+        TEST_ASSERT_INT_WITHIN(1, (int)(exact + 0.5), led.dutyTable[0][i]);
+        TEST_ASSERT_INT_WITHIN(1, (int)(exact * 180.0 / 255.0 + 0.5), led.dutyTable[1][i]);
+        TEST_ASSERT_INT_WITHIN(1, (int)(exact * 90.0 / 255.0 + 0.5), led.dutyTable[2][i]);
+    }
+}
+
+void test_rgbShowUserColor_SameColor_SkipsPwmWrite(void) {
+    rgbInit(&led, mock_writePwm, 255);
+    rgbShowUserColor(&led, 10, 20, 30);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_TRUE(writePwmCalled);
+
+    writePwmCalled = false;
+    rgbShowUserColor(&led, 10, 20, 30);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_FALSE(writePwmCalled);
+
+    rgbShowUserColor(&led, 10, 20, 200);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_TRUE(writePwmCalled);
 }
 
-// ── rgbTransientTask ────────────────────────────────────────────────
+void test_rgbShowUserColor_FirstWriteAfterInit_AlwaysDrives(void) {
+    rgbInit(&led, mock_writePwm, 255);
+    rgbShowShutdown(&led);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_TRUE(writePwmCalled);
+}
 
-void test_rgbTransientTask_NullDevice_NoOp(void) {
-    rgbTransientTask(NULL, 1000);
+// ── rgbCompose ──────────────────────────────────────────────────────
+
+void test_rgbCompose_NullDevice_NoOp(void) {
+    rgbCompose(NULL, 1000);
     // Should not crash
 }
 
-void test_rgbTransientTask_NotTransient_NoChange(void) {
+void test_rgbCompose_NothingActive_DrivesBlack(void) {
+    rgbInit(&led, mock_writePwm, 255);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_TRUE(writePwmCalled);
+    TEST_ASSERT_EQUAL_UINT16(0, capturedRed);
+    TEST_ASSERT_EQUAL_UINT16(0, capturedGreen);
+    TEST_ASSERT_EQUAL_UINT16(0, capturedBlue);
+}
+
+void test_rgbCompose_LayersOnlyReachPwmOnCompose(void) {
+    rgbInit(&led, mock_writePwm, 255);
+    rgbShowUserColor(&led, 100, 0, 0);
+    rgbShowSuccess(&led);
+    TEST_ASSERT_FALSE(writePwmCalled);
+
+    rgbCompose(&led, 0);
+    TEST_ASSERT_EQUAL_INT(1, writePwmCount);
+    TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 50), capturedRed);
+}
+
+void test_rgbCompose_UnchangedUser_NoChange(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowUserColor(&led, 100, 100, 100);
+    rgbCompose(&led, 0);
     writePwmCalled = false;
-    rgbTransientTask(&led, 1000);
+    rgbShowUserColor(&led, 100, 100, 100);
+    rgbCompose(&led, 1000);
     TEST_ASSERT_FALSE(writePwmCalled);
 }
 
-void test_rgbTransientTask_TransientRevert_After300ms(void) {
+void test_rgbCompose_StatusRevert_After300ms(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowUserColor(&led, 100, 0, 0);
-    // Show a transient (success = 50,50,50)
+    // Show a status (success = 50,50,50)
     rgbShowSuccess(&led);
+    rgbCompose(&led, 0);
     // Advance time past 300 ms
     writePwmCalled = false;
-    rgbTransientTask(&led, 301);
+    rgbCompose(&led, 301);
     // Should revert to user color
     TEST_ASSERT_TRUE(writePwmCalled);
+    TEST_ASSERT_FALSE(rgbLayerActive(&led, RGB_LAYER_STATUS));
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 100), capturedRed);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedGreen);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedBlue);
 }
 
-void test_rgbTransientTask_TransientHeld_Before300ms(void) {
+void test_rgbCompose_StatusHeld_Before300ms(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowUserColor(&led, 100, 0, 0);
     rgbShowSuccess(&led);
+    rgbCompose(&led, 0);
     writePwmCalled = false;
-    rgbTransientTask(&led, 300);  // exactly 300 ms — not yet expired
+    rgbCompose(&led, 300);  // exactly 300 ms — not yet expired
     TEST_ASSERT_FALSE(writePwmCalled);
 }
 
-// ── rgbShowUserColor while transient ────────────────────────────────
+void test_rgbCompose_StatusTimedFromLastCompose(void) {
+    rgbInit(&led, mock_writePwm, 255);
+    rgbCompose(&led, 1000);
+    rgbShowSuccess(&led);
+    rgbCompose(&led, 1200);
+    rgbCompose(&led, 1300);
+    TEST_ASSERT_TRUE(rgbLayerActive(&led, RGB_LAYER_STATUS));
+    rgbCompose(&led, 1301);
+    TEST_ASSERT_FALSE(rgbLayerActive(&led, RGB_LAYER_STATUS));
+}
+
+void test_rgbCompose_IndicatorCoversStatusAndUser(void) {
+    rgbInit(&led, mock_writePwm, 255);
+    rgbShowUserColor(&led, 100, 0, 0);
+    rgbShowDoneCharging(&led);
+    rgbShowLocked(&led);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 255), capturedBlue);
+
+    // the status is still live once the indicator is gone
+    rgbClearLayer(&led, RGB_LAYER_INDICATOR);
+    rgbCompose(&led, 100);
+    TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 25), capturedGreen);
+    TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedBlue);
+}
+
+void test_rgbLayerCovered_UntilStatusRunsOut(void) {
+    rgbInit(&led, mock_writePwm, 255);
+    rgbShowUserColor(&led, 100, 0, 0);
+    TEST_ASSERT_FALSE(rgbLayerCovered(&led, RGB_LAYER_USER, 0));
+
+    rgbShowSuccess(&led);
+    TEST_ASSERT_TRUE(rgbLayerCovered(&led, RGB_LAYER_USER, 300));
+    TEST_ASSERT_FALSE(rgbLayerCovered(&led, RGB_LAYER_STATUS, 300));
+    // still active, but the compose at 301 drops it
+    TEST_ASSERT_FALSE(rgbLayerCovered(&led, RGB_LAYER_USER, 301));
+
+    rgbShowLocked(&led);
+    TEST_ASSERT_TRUE(rgbLayerCovered(&led, RGB_LAYER_USER, 301));
+    TEST_ASSERT_TRUE(rgbLayerCovered(&led, RGB_LAYER_STATUS, 301));
+    TEST_ASSERT_FALSE(rgbLayerCovered(NULL, RGB_LAYER_USER, 0));
+}
+
+void test_rgbCompose_SeveralSourcesInOneTick_WritesOnce(void) {
+    rgbInit(&led, mock_writePwm, 255);
+    rgbShowUserColor(&led, 10, 0, 0);
+    rgbShowUserColor(&led, 20, 0, 0);
+    rgbShowNotCharging(&led);
+    rgbShowSuccess(&led);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_EQUAL_INT(1, writePwmCount);
+
+    // a user color changing underneath the status leaves the PWM alone
+    rgbShowUserColor(&led, 30, 0, 0);
+    rgbCompose(&led, 10);
+    TEST_ASSERT_EQUAL_INT(1, writePwmCount);
+}
+
+// ── rgbShowUserColor while status ───────────────────────────────────
 
-void test_rgbShowUserColor_WhileTransient_StoresButDoesNotDrive(void) {
+void test_rgbShowUserColor_WhileStatus_StoresButDoesNotDrive(void) {
     rgbInit(&led, mock_writePwm, 255);
-    rgbShowSuccess(&led);  // sets transient
+    rgbShowSuccess(&led);
+    rgbCompose(&led, 0);
     writePwmCalled = false;
     rgbShowUserColor(&led, 200, 100, 50);
-    // User color stored but PWM not updated while transient is active
+    rgbCompose(&led, 0);
+    // User color stored but PWM not updated while the status is active
     TEST_ASSERT_FALSE(writePwmCalled);
-    TEST_ASSERT_EQUAL_UINT8(200, led.userRed);
-    TEST_ASSERT_EQUAL_UINT8(100, led.userGreen);
-    TEST_ASSERT_EQUAL_UINT8(50, led.userBlue);
+    TEST_ASSERT_EQUAL_UINT8(200, led.layers[RGB_LAYER_USER].red);
+    TEST_ASSERT_EQUAL_UINT8(100, led.layers[RGB_LAYER_USER].green);
+    TEST_ASSERT_EQUAL_UINT8(50, led.layers[RGB_LAYER_USER].blue);
 }
 
 // ── rgbShow* wrapper colors ─────────────────────────────────────────
@@ -220,71 +401,78 @@ void test_rgbShowUserColor_WhileTransient_StoresButDoesNotDrive(void) {
 void test_rgbShowSuccess_DrivesExpectedColor(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowSuccess(&led);
+    rgbCompose(&led, 0);
     TEST_ASSERT_TRUE(writePwmCalled);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 50), capturedRed);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 50), capturedGreen);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 50), capturedBlue);
-    TEST_ASSERT_TRUE(led.showingTransientStatus);
+    TEST_ASSERT_TRUE(rgbLayerActive(&led, RGB_LAYER_STATUS));
 }
 
 void test_rgbShowLocked_DrivesExpectedColor(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowLocked(&led);
+    rgbCompose(&led, 0);
     TEST_ASSERT_TRUE(writePwmCalled);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedRed);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedGreen);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 255), capturedBlue);
-    TEST_ASSERT_FALSE(led.showingTransientStatus);
+    TEST_ASSERT_TRUE(rgbLayerActive(&led, RGB_LAYER_INDICATOR));
 }
 
 void test_rgbShowShutdown_DrivesExpectedColor(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowShutdown(&led);
+    rgbCompose(&led, 0);
     TEST_ASSERT_TRUE(writePwmCalled);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedRed);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedGreen);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedBlue);
-    TEST_ASSERT_FALSE(led.showingTransientStatus);
+    TEST_ASSERT_TRUE(rgbLayerActive(&led, RGB_LAYER_INDICATOR));
 }
 
 void test_rgbShowNotCharging_DrivesExpectedColor(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowNotCharging(&led);
+    rgbCompose(&led, 0);
     TEST_ASSERT_TRUE(writePwmCalled);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 25), capturedRed);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedGreen);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 25), capturedBlue);
-    TEST_ASSERT_TRUE(led.showingTransientStatus);
+    TEST_ASSERT_TRUE(rgbLayerActive(&led, RGB_LAYER_STATUS));
 }
 
 void test_rgbShowConstantCurrentCharging_DrivesExpectedColor(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowConstantCurrentCharging(&led);
+    rgbCompose(&led, 0);
     TEST_ASSERT_TRUE(writePwmCalled);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 25), capturedRed);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedGreen);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedBlue);
-    TEST_ASSERT_TRUE(led.showingTransientStatus);
+    TEST_ASSERT_TRUE(rgbLayerActive(&led, RGB_LAYER_STATUS));
 }
 
 void test_rgbShowConstantVoltageCharging_DrivesExpectedColor(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowConstantVoltageCharging(&led);
+    rgbCompose(&led, 0);
     TEST_ASSERT_TRUE(writePwmCalled);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 25), capturedRed);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 25), capturedGreen);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedBlue);
-    TEST_ASSERT_TRUE(led.showingTransientStatus);
+    TEST_ASSERT_TRUE(rgbLayerActive(&led, RGB_LAYER_STATUS));
 }
 
 void test_rgbShowDoneCharging_DrivesExpectedColor(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowDoneCharging(&led);
+    rgbCompose(&led, 0);
     TEST_ASSERT_TRUE(writePwmCalled);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedRed);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 25), capturedGreen);
     TEST_ASSERT_EQUAL_UINT16(expectedDutyForLinearColor(&led, 0), capturedBlue);
-    TEST_ASSERT_TRUE(led.showingTransientStatus);
+    TEST_ASSERT_TRUE(rgbLayerActive(&led, RGB_LAYER_STATUS));
 }
 
 void test_rgbShowUserColor_WhiteBalance_ScalesWhiteAfterGamma(void) {
@@ -299,17 +487,20 @@ void test_rgbShowUserColor_WhiteBalance_ScalesWhiteAfterGamma(void) {
 
     writePwmCalled = false;
     rgbShowUserColor(&led, 255, 255, 255);
+    rgbCompose(&led, 0);
 
     TEST_ASSERT_TRUE(writePwmCalled);
-    TEST_ASSERT_EQUAL_UINT16(colorToDuty(&led, 255), capturedRed);
-    TEST_ASSERT_EQUAL_UINT16(colorToDuty(&led, 200), capturedGreen);
-    TEST_ASSERT_EQUAL_UINT16(colorToDuty(&led, 160), capturedBlue);
+    // balance / 255 of the 256 step full scale, rounded to the nearest step
+    TEST_ASSERT_EQUAL_UINT16(256, capturedRed);
+    TEST_ASSERT_EQUAL_UINT16(201, capturedGreen);
+    TEST_ASSERT_EQUAL_UINT16(161, capturedBlue);
 }
 
-void test_rgbSetWhiteBalance_DoesNotReapplyCurrentColor(void) {
+void test_rgbSetWhiteBalance_ReappliesOnNextCompose(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowUserColor(&led, 200, 100, 50);
     rgbShowSuccess(&led);
+    rgbCompose(&led, 0);
 
     writePwmCalled = false;
     rgbSetWhiteBalance(
@@ -321,10 +512,99 @@ void test_rgbSetWhiteBalance_DoesNotReapplyCurrentColor(void) {
         });
 
     TEST_ASSERT_FALSE(writePwmCalled);
-    TEST_ASSERT_TRUE(led.showingTransientStatus);
+    TEST_ASSERT_TRUE(rgbLayerActive(&led, RGB_LAYER_STATUS));
     TEST_ASSERT_EQUAL_UINT8(255, led.whiteBalance.red);
     TEST_ASSERT_EQUAL_UINT8(128, led.whiteBalance.green);
     TEST_ASSERT_EQUAL_UINT8(255, led.whiteBalance.blue);
+
+    // the same status color now needs different duties
+    rgbCompose(&led, 10);
+    TEST_ASSERT_TRUE(writePwmCalled);
+    TEST_ASSERT_EQUAL_UINT16(roundedDuty(&led, led.dutyTable[1][50]), capturedGreen);
+}
+
+// ── Dithering ───────────────────────────────────────────────────────
+
+void test_dither_NoControl_RoundsDimColor(void) {
+    rgbInit(&led, mock_writePwm, 510);
+    rgbShowUserColor(&led, 25, 0, 0);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_TRUE(writePwmCalled);
+    TEST_ASSERT_EQUAL_UINT16(3, capturedRed);
+}
+
+void test_dither_DimColor_HandsOverToUpdateInterrupt(void) {
+    rgbInit(&led, mock_writePwm, 510);
+    rgbSetDitherControl(&led, mock_enableDither);
+
+    rgbShowUserColor(&led, 25, 0, 0);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_TRUE(ditherEnabled);
+    TEST_ASSERT_FALSE(writePwmCalled);
+
+    // 49 / 16 = 3.0625 steps, over 16 periods that is one period at 4 and the rest at 3
+    uint32_t total = 0;
+    int high = 0;
+    for (int period = 0; period < (1 << RGB_DITHER_BITS); period++) {
+        rgbDitherUpdate(&led);
+        TEST_ASSERT_TRUE(capturedRed == 3 || capturedRed == 4);
+        TEST_ASSERT_EQUAL_UINT16(0, capturedGreen);
+        total += capturedRed;
+        high += capturedRed == 4;
+    }
+    TEST_ASSERT_EQUAL_UINT32(49, total);
+    TEST_ASSERT_EQUAL_INT(1, high);
+}
+
+void test_dither_FadeStaysInInterruptUntilBright(void) {
+    rgbInit(&led, mock_writePwm, 510);
+    rgbSetDitherControl(&led, mock_enableDither);
+
+    rgbShowUserColor(&led, 20, 0, 0);
+    rgbCompose(&led, 0);
+    rgbShowUserColor(&led, 25, 0, 0);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_EQUAL_INT(1, ditherToggleCount);
+    TEST_ASSERT_EQUAL_UINT16(49, led.ditherTarget[0]);
+
+    rgbShowUserColor(&led, 255, 0, 0);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_FALSE(ditherEnabled);
+    TEST_ASSERT_TRUE(writePwmCalled);
+    TEST_ASSERT_EQUAL_UINT16(511, capturedRed);
+
+    // stopped dithering, further updates do nothing
+    writePwmCalled = false;
+    rgbDitherUpdate(&led);
+    TEST_ASSERT_FALSE(writePwmCalled);
+}
+
+void test_dither_WholeStepColorSkipsInterrupt(void) {
+    rgbInit(&led, mock_writePwm, 510);
+    rgbSetDitherControl(&led, mock_enableDither);
+
+    rgbShowUserColor(&led, 0, 0, 0);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_EQUAL_INT(0, ditherToggleCount);
+    TEST_ASSERT_TRUE(writePwmCalled);
+}
+
+void test_dither_ResumesDirectWritesAfterStopping(void) {
+    rgbInit(&led, mock_writePwm, 510);
+    rgbSetDitherControl(&led, mock_enableDither);
+    rgbShowUserColor(&led, 0, 0, 0);
+    rgbCompose(&led, 0);
+    rgbShowUserColor(&led, 25, 0, 0);
+    rgbCompose(&led, 0);
+    rgbDitherUpdate(&led);
+
+    // the interrupt changed the registers, so black has to be written again
+    writePwmCount = 0;
+    rgbShowUserColor(&led, 0, 0, 0);
+    rgbCompose(&led, 0);
+    TEST_ASSERT_FALSE(ditherEnabled);
+    TEST_ASSERT_EQUAL_INT(1, writePwmCount);
+    TEST_ASSERT_EQUAL_UINT16(0, capturedRed);
 }
 
 // ── Integration: rgbShowUserColor drives PWM correctly ──────────────
@@ -332,6 +612,7 @@ void test_rgbSetWhiteBalance_DoesNotReapplyCurrentColor(void) {
 void test_rgbShowUserColor_Black_DrivesPwmToZero(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowUserColor(&led, 0, 0, 0);
+    rgbCompose(&led, 0);
     TEST_ASSERT_TRUE(writePwmCalled);
     TEST_ASSERT_EQUAL_UINT16(0, capturedRed);
     TEST_ASSERT_EQUAL_UINT16(0, capturedGreen);
@@ -341,6 +622,7 @@ void test_rgbShowUserColor_Black_DrivesPwmToZero(void) {
 void test_rgbShowUserColor_White_DrivesPwmToMax_Period255(void) {
     rgbInit(&led, mock_writePwm, 255);
     rgbShowUserColor(&led, 255, 255, 255);
+    rgbCompose(&led, 0);
     TEST_ASSERT_TRUE(writePwmCalled);
     TEST_ASSERT_EQUAL_UINT16(256, capturedRed);
     TEST_ASSERT_EQUAL_UINT16(256, capturedGreen);
@@ -350,6 +632,7 @@ void test_rgbShowUserColor_White_DrivesPwmToMax_Period255(void) {
 void test_rgbShowUserColor_White_DrivesPwmToMax_Period510(void) {
     rgbInit(&led, mock_writePwm, 510);
     rgbShowUserColor(&led, 255, 255, 255);
+    rgbCompose(&led, 0);
     TEST_ASSERT_TRUE(writePwmCalled);
     TEST_ASSERT_EQUAL_UINT16(511, capturedRed);
     TEST_ASSERT_EQUAL_UINT16(511, capturedGreen);
@@ -358,25 +641,45 @@ void test_rgbShowUserColor_White_DrivesPwmToMax_Period510(void) {
 
 int main(void) {
     UNITY_BEGIN();
-    RUN_TEST(test_colorToDuty_KnownPoint_Period255_Value15);
-    RUN_TEST(test_colorToDuty_KnownPoint_Period510_Value15);
-    RUN_TEST(test_colorToDuty_KnownPoint_Period510_Value25);
     RUN_TEST(test_colorToDuty_MaxInput_ReturnsPeriodPlusOne1);
     RUN_TEST(test_colorToDuty_MaxInput_ReturnsPeriodPlusOne100);
     RUN_TEST(test_colorToDuty_MaxInput_ReturnsPeriodPlusOne255);
     RUN_TEST(test_colorToDuty_MaxInput_ReturnsPeriodPlusOne510);
+    RUN_TEST(test_colorToDuty_MaxInput_ReturnsPeriodPlusOne65534);
     RUN_TEST(test_colorToDuty_Monotonic_Period255);
     RUN_TEST(test_colorToDuty_Monotonic_Period510);
     RUN_TEST(test_colorToDuty_ZeroInput_ReturnsZero);
+    RUN_TEST(test_dither_DimColor_HandsOverToUpdateInterrupt);
+    RUN_TEST(test_dither_FadeStaysInInterruptUntilBright);
+    RUN_TEST(test_dither_NoControl_RoundsDimColor);
+    RUN_TEST(test_dither_ResumesDirectWritesAfterStopping);
+    RUN_TEST(test_dither_WholeStepColorSkipsInterrupt);
+    RUN_TEST(test_dutyTable_DimInputsKeepFractionalDuty);
+    RUN_TEST(test_dutyTable_KnownPoint_Period255_Value15);
+    RUN_TEST(test_dutyTable_KnownPoint_Period510_Value15);
+    RUN_TEST(test_dutyTable_KnownPoint_Period510_Value25);
+    RUN_TEST(test_dutyTable_LargePeriodDropsFractionBits);
+    RUN_TEST(test_dutyTable_MatchesGammaWhiteBalanceAndScaling);
+    RUN_TEST(test_gammaAndWhiteBalancedColor_MatchesEightBitCurve);
     RUN_TEST(test_gammaLUT_Endpoints);
     RUN_TEST(test_gammaLUT_KnownPoints);
     RUN_TEST(test_gammaLUT_Monotonic);
+    RUN_TEST(test_rgbCompose_IndicatorCoversStatusAndUser);
+    RUN_TEST(test_rgbCompose_LayersOnlyReachPwmOnCompose);
+    RUN_TEST(test_rgbCompose_NothingActive_DrivesBlack);
+    RUN_TEST(test_rgbCompose_NullDevice_NoOp);
+    RUN_TEST(test_rgbCompose_SeveralSourcesInOneTick_WritesOnce);
+    RUN_TEST(test_rgbCompose_StatusHeld_Before300ms);
+    RUN_TEST(test_rgbCompose_StatusRevert_After300ms);
+    RUN_TEST(test_rgbCompose_StatusTimedFromLastCompose);
+    RUN_TEST(test_rgbCompose_UnchangedUser_NoChange);
     RUN_TEST(test_rgbInit_NullCallback_ReturnsFalse);
     RUN_TEST(test_rgbInit_NullDevice_ReturnsFalse);
-    RUN_TEST(test_rgbInit_Period510_Accepted);
-    RUN_TEST(test_rgbInit_PeriodAbove510_ReturnsFalse);
+    RUN_TEST(test_rgbInit_PeriodAbove510_Accepted);
+    RUN_TEST(test_rgbInit_PeriodWithoutRoomForFullScale_ReturnsFalse);
     RUN_TEST(test_rgbInit_ValidParams_SetsFieldsCorrectly);
-    RUN_TEST(test_rgbSetWhiteBalance_DoesNotReapplyCurrentColor);
+    RUN_TEST(test_rgbLayerCovered_UntilStatusRunsOut);
+    RUN_TEST(test_rgbSetWhiteBalance_ReappliesOnNextCompose);
     RUN_TEST(test_rgbShowConstantCurrentCharging_DrivesExpectedColor);
     RUN_TEST(test_rgbShowConstantVoltageCharging_DrivesExpectedColor);
     RUN_TEST(test_rgbShowDoneCharging_DrivesExpectedColor);
@@ -385,13 +688,11 @@ int main(void) {
     RUN_TEST(test_rgbShowShutdown_DrivesExpectedColor);
     RUN_TEST(test_rgbShowSuccess_DrivesExpectedColor);
     RUN_TEST(test_rgbShowUserColor_Black_DrivesPwmToZero);
-    RUN_TEST(test_rgbShowUserColor_WhileTransient_StoresButDoesNotDrive);
+    RUN_TEST(test_rgbShowUserColor_FirstWriteAfterInit_AlwaysDrives);
+    RUN_TEST(test_rgbShowUserColor_SameColor_SkipsPwmWrite);
+    RUN_TEST(test_rgbShowUserColor_WhileStatus_StoresButDoesNotDrive);
     RUN_TEST(test_rgbShowUserColor_WhiteBalance_ScalesWhiteAfterGamma);
     RUN_TEST(test_rgbShowUserColor_White_DrivesPwmToMax_Period255);
     RUN_TEST(test_rgbShowUserColor_White_DrivesPwmToMax_Period510);
-    RUN_TEST(test_rgbTransientTask_NotTransient_NoChange);
-    RUN_TEST(test_rgbTransientTask_NullDevice_NoOp);
-    RUN_TEST(test_rgbTransientTask_TransientHeld_Before300ms);
-    RUN_TEST(test_rgbTransientTask_TransientRevert_After300ms);
     return UNITY_END();
 }
@@ -172,6 +172,19 @@ void test_ParseJson_WriteSettings_RejectsInvalidValues(void) {
     TEST_ASSERT_EQUAL_STRING("frontWhiteBalanceGreen", cliInput.errorContext.path);
 }
 
+void test_ParseJson_WriteSettings_ModeCrossfadeMsTakesSixteenBits(void) {
+    char *json = "{\"command\":\"writeSettings\",\"modeCrossfadeMs\":1500}";
+    parseJson((uint8_t *)json, strlen(json) + 1, &cliInput);
+    TEST_ASSERT_EQUAL(parseWriteSettings, cliInput.parsedType);
+    TEST_ASSERT_EQUAL_UINT16(1500, cliInput.settings.modeCrossfadeMs);
+
+    char *tooLong = "{\"command\":\"writeSettings\",\"modeCrossfadeMs\":5001}";
+    parseJson((uint8_t *)tooLong, strlen(tooLong) + 1, &cliInput);
+    TEST_ASSERT_EQUAL(parseError, cliInput.parsedType);
+    TEST_ASSERT_EQUAL(PARSER_ERR_VALUE_TOO_LARGE, cliInput.errorContext.error);
+    TEST_ASSERT_EQUAL_STRING("modeCrossfadeMs", cliInput.errorContext.path);
+}
+
 void test_ParseJson_WriteSettings_AcceptsAutoOffAndAutoLockShutdownPolicy(void) {
     char *json = "{\"command\":\"writeSettings\",\"shutdownPolicy\":2}";
 
@@ -189,6 +202,30 @@ void test_ParseJson_Dfu_SetsDfuAction(void) {
     TEST_ASSERT_EQUAL(parseDfu, cliInput.parsedType);
 }
 
+void test_ParseJson_ReadTelemetry_DefaultsToOldestRecord(void) {
+    char *json = "{\"command\":\"readTelemetry\"}";
+    cliInput.telemetryFirst = 9;
+
+    parseJson((uint8_t *)json, strlen(json) + 1, &cliInput);
+
+    TEST_ASSERT_EQUAL(parseReadTelemetry, cliInput.parsedType);
+    TEST_ASSERT_EQUAL_UINT16(0, cliInput.telemetryFirst);
+}
+
+void test_ParseJson_ReadTelemetry_ParsesFirst(void) {
+    char *json = "{\"command\":\"readTelemetry\",\"first\":300}";
+
+    parseJson((uint8_t *)json, strlen(json) + 1, &cliInput);
+
+    TEST_ASSERT_EQUAL(parseReadTelemetry, cliInput.parsedType);
+    TEST_ASSERT_EQUAL_UINT16(300, cliInput.telemetryFirst);
+
+    json = "{\"command\":\"readTelemetry\",\"first\":-1}";
+    parseJson((uint8_t *)json, strlen(json) + 1, &cliInput);
+    TEST_ASSERT_EQUAL(parseError, cliInput.parsedType);
+    TEST_ASSERT_EQUAL(PARSER_ERR_VALUE_TOO_SMALL, cliInput.errorContext.error);
+}
+
 void test_ParseJson_InvalidJson_DoesNotCrash(void) {
     char *json = "{invalid json";
 
@@ -202,8 +239,11 @@ int main(void) {
     RUN_TEST(test_ParseJson_Dfu_SetsDfuAction);
     RUN_TEST(test_ParseJson_InvalidJson_DoesNotCrash);
     RUN_TEST(test_ParseJson_ReadMode_SetsReadAction);
+    RUN_TEST(test_ParseJson_ReadTelemetry_DefaultsToOldestRecord);
+    RUN_TEST(test_ParseJson_ReadTelemetry_ParsesFirst);
     RUN_TEST(test_ParseJson_WriteMode_ParsesIndexAndData);
     RUN_TEST(test_ParseJson_WriteSettings_AcceptsAutoOffAndAutoLockShutdownPolicy);
+    RUN_TEST(test_ParseJson_WriteSettings_ModeCrossfadeMsTakesSixteenBits);
     RUN_TEST(test_ParseJson_WriteSettings_ParsesBooleanValues);
     RUN_TEST(test_ParseJson_WriteSettings_ParsesSettingsValues);
     RUN_TEST(test_ParseJson_WriteSettings_RejectsIntegerForBoolean);
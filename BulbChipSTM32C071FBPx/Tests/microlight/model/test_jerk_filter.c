@@ -0,0 +1,98 @@
+#include <string.h>
+#include "unity.h"
+
+#include "microlight/model/jerk_filter.h"
+
+static JerkFilter filter;
+
+static uint32_t push_repeated(int16_t x, int16_t y, int16_t z, int count) {
+    uint32_t peak = 0;
+    for (int i = 0; i < count; i++) {
+        peak = jerkFilterPush(&filter, x, y, z);
+    }
+    return peak;
+}
+
+void setUp(void) {
+    jerkFilterReset(&filter);
+}
+
+void tearDown(void) {
+}
+
+void test_JerkFilter_FirstSampleOnlyPrimes(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, jerkFilterPush(&filter, 100, -200, 2048));
+    TEST_ASSERT_TRUE(filter.primed);
+}
+
+void test_JerkFilter_GravityIsRejected(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, push_repeated(0, 0, 2048, 20));
+}
+
+void test_JerkFilter_StepAveragedOverWindow(void) {
+    jerkFilterPush(&filter, 0, 0, 2048);
+    TEST_ASSERT_EQUAL_UINT32(400 * 400 / JERK_FILTER_WINDOW, jerkFilterPush(&filter, 400, 0, 2048));
+}
+
+void test_JerkFilter_SustainedShakeOutweighsLoneSpike(void) {
+    jerkFilterPush(&filter, 0, 0, 0);
+    jerkFilterPush(&filter, 200, 0, 0);
+    uint32_t spike = push_repeated(200, 0, 0, 1);
+
+    jerkFilterReset(&filter);
+    jerkFilterPush(&filter, 0, 0, 0);
+    uint32_t shake = 0;
+    for (int i = 0; i < JERK_FILTER_WINDOW; i++) {
+        shake = jerkFilterPush(&filter, (i % 2) ? 0 : 200, 0, 0);
+    }
+    TEST_ASSERT_GREATER_THAN_UINT32(spike, shake);
+}
+
+void test_JerkFilter_PeakDecaysOnceQuiet(void) {
+    jerkFilterPush(&filter, 0, 0, 0);
+    jerkFilterPush(&filter, 0, 0, 800);
+    // the step stays in the window for JERK_FILTER_WINDOW samples
+    uint32_t peak = push_repeated(0, 0, 800, JERK_FILTER_WINDOW - 1);
+
+    uint32_t previous = peak;
+    for (int i = 0; i < 10; i++) {
+        uint32_t next = jerkFilterPush(&filter, 0, 0, 800);
+        TEST_ASSERT_LESS_OR_EQUAL_UINT32(previous, next);
+        TEST_ASSERT_GREATER_THAN_UINT32(previous / 2, next);
+        previous = next;
+    }
+    TEST_ASSERT_LESS_THAN_UINT32(peak / 2, previous);
+    TEST_ASSERT_EQUAL_UINT32(0, push_repeated(0, 0, 800, 200));
+}
+
+void test_JerkFilter_FullScaleSaturates(void) {
+    jerkFilterPush(&filter, INT16_MAX, INT16_MAX, INT16_MAX);
+    uint32_t peak = 0;
+    for (int i = 0; i < JERK_FILTER_WINDOW * 2; i++) {
+        int16_t value = (i % 2) ? INT16_MAX : INT16_MIN;
+        peak = jerkFilterPush(&filter, value, value, value);
+    }
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, peak);
+}
+
+void test_JerkFilter_ResetClearsHistory(void) {
+    jerkFilterPush(&filter, 0, 0, 0);
+    jerkFilterPush(&filter, 500, 0, 0);
+    jerkFilterReset(&filter);
+
+    TEST_ASSERT_FALSE(filter.primed);
+    TEST_ASSERT_EQUAL_UINT32(0, jerkFilterPush(&filter, 500, 0, 0));
+    TEST_ASSERT_EQUAL_UINT32(0, jerkFilterPush(&filter, 500, 0, 0));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_JerkFilter_FirstSampleOnlyPrimes);
+    RUN_TEST(test_JerkFilter_FullScaleSaturates);
+    RUN_TEST(test_JerkFilter_GravityIsRejected);
+    RUN_TEST(test_JerkFilter_PeakDecaysOnceQuiet);
+    RUN_TEST(test_JerkFilter_ResetClearsHistory);
+    RUN_TEST(test_JerkFilter_StepAveragedOverWindow);
+    RUN_TEST(test_JerkFilter_SustainedShakeOutweighsLoneSpike);
+    return UNITY_END();
+}
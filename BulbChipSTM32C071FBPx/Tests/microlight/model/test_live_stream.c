@@ -0,0 +1,171 @@
+#include <string.h>
+#include "unity.h"
+
+#include "microlight/model/live_stream.h"
+
+static LiveStream stream;
+static LiveStreamFrame shown;
+
+static void push_frame(uint8_t value, uint32_t ms) {
+    const uint8_t data[LIVE_STREAM_FRAME_SIZE] = {value, value, value, value, value, value};
+    TEST_ASSERT_TRUE(liveStreamPush(&stream, data, ms));
+}
+
+void setUp(void) {
+    memset(&stream, 0, sizeof(stream));
+    memset(&shown, 0, sizeof(shown));
+}
+
+void tearDown(void) {
+}
+
+void test_LiveStream_PushRejectedWhenInactive(void) {
+    const uint8_t data[LIVE_STREAM_FRAME_SIZE] = {0};
+    TEST_ASSERT_FALSE(liveStreamPush(&stream, data, 0));
+    TEST_ASSERT_FALSE(liveStreamTask(&stream, 0, &shown));
+}
+
+void test_LiveStream_StartClampsArguments(void) {
+    liveStreamStart(&stream, 0, 0, 0);
+    TEST_ASSERT_EQUAL_UINT8(1, stream.frameIntervalMs);
+    TEST_ASSERT_EQUAL_UINT8(1, stream.prefillFrames);
+
+    liveStreamStart(&stream, 20, 200, 0);
+    TEST_ASSERT_EQUAL_UINT8(LIVE_STREAM_BUFFER_FRAMES, stream.prefillFrames);
+}
+
+void test_LiveStream_WaitsForPrefillBeforePlaying(void) {
+    liveStreamStart(&stream, 20, 2, 0);
+    push_frame(10, 0);
+
+    TEST_ASSERT_TRUE(liveStreamTask(&stream, 5, &shown));
+    TEST_ASSERT_EQUAL_UINT8(0, shown.frontRed);
+    TEST_ASSERT_EQUAL_UINT32(0, stream.stats.framesPlayed);
+
+    push_frame(20, 8);
+    TEST_ASSERT_TRUE(liveStreamTask(&stream, 10, &shown));
+    TEST_ASSERT_EQUAL_UINT8(10, shown.frontRed);
+    TEST_ASSERT_EQUAL_UINT32(1, stream.stats.framesPlayed);
+    TEST_ASSERT_EQUAL_UINT16(10, stream.stats.lastLatencyMs);
+}
+
+void test_LiveStream_PlaysOneFramePerInterval(void) {
+    liveStreamStart(&stream, 20, 1, 0);
+    push_frame(1, 0);
+    push_frame(2, 0);
+    push_frame(3, 0);
+
+    liveStreamTask(&stream, 0, &shown);
+    TEST_ASSERT_EQUAL_UINT8(1, shown.caseBlue);
+    liveStreamTask(&stream, 19, &shown);
+    TEST_ASSERT_EQUAL_UINT8(1, shown.caseBlue);
+    liveStreamTask(&stream, 20, &shown);
+    TEST_ASSERT_EQUAL_UINT8(2, shown.caseBlue);
+    liveStreamTask(&stream, 40, &shown);
+    TEST_ASSERT_EQUAL_UINT8(3, shown.caseBlue);
+    TEST_ASSERT_EQUAL_UINT16(40, stream.stats.maxLatencyMs);
+}
+
+void test_LiveStream_UnderrunHoldsLastFrameAndRebuffers(void) {
+    liveStreamStart(&stream, 20, 2, 0);
+    push_frame(1, 0);
+    push_frame(2, 0);
+    liveStreamTask(&stream, 0, &shown);
+    liveStreamTask(&stream, 20, &shown);
+
+    TEST_ASSERT_TRUE(liveStreamTask(&stream, 40, &shown));
+    TEST_ASSERT_EQUAL_UINT8(2, shown.frontGreen);
+    TEST_ASSERT_EQUAL_UINT32(1, stream.stats.underruns);
+
+    // one frame is not enough to resume with a prefill of two
+    push_frame(3, 45);
+    liveStreamTask(&stream, 60, &shown);
+    TEST_ASSERT_EQUAL_UINT8(2, shown.frontGreen);
+
+    push_frame(4, 62);
+    liveStreamTask(&stream, 65, &shown);
+    TEST_ASSERT_EQUAL_UINT8(3, shown.frontGreen);
+}
+
+void test_LiveStream_FullBufferDropsOldest(void) {
+    liveStreamStart(&stream, 20, LIVE_STREAM_BUFFER_FRAMES, 0);
+    for (uint8_t i = 0; i < LIVE_STREAM_BUFFER_FRAMES + 2; i++) {
+        push_frame(i, 0);
+    }
+
+    TEST_ASSERT_EQUAL_UINT8(LIVE_STREAM_BUFFER_FRAMES, stream.count);
+    TEST_ASSERT_EQUAL_UINT32(2, stream.stats.framesDropped);
+    liveStreamTask(&stream, 0, &shown);
+    TEST_ASSERT_EQUAL_UINT8(2, shown.frontRed);
+}
+
+void test_LiveStream_SlowTickSkipsToNewestDueFrame(void) {
+    liveStreamStart(&stream, 10, 1, 0);
+    for (uint8_t i = 1; i <= 5; i++) {
+        push_frame(i, 0);
+    }
+    liveStreamTask(&stream, 0, &shown);
+
+    // frames 2, 3 and 4 were due at 10, 20 and 30
+    liveStreamTask(&stream, 30, &shown);
+    TEST_ASSERT_EQUAL_UINT8(4, shown.frontRed);
+    TEST_ASSERT_EQUAL_UINT32(2, stream.stats.framesDropped);
+    TEST_ASSERT_EQUAL_UINT32(2, stream.stats.framesPlayed);
+
+    liveStreamTask(&stream, 39, &shown);
+    TEST_ASSERT_EQUAL_UINT8(4, shown.frontRed);
+    liveStreamTask(&stream, 40, &shown);
+    TEST_ASSERT_EQUAL_UINT8(5, shown.frontRed);
+}
+
+void test_LiveStream_TimesOutOnceIdleAndEmpty(void) {
+    liveStreamStart(&stream, 20, 1, 100);
+    push_frame(1, 100);
+    TEST_ASSERT_TRUE(liveStreamTask(&stream, 100, &shown));
+
+    TEST_ASSERT_TRUE(liveStreamTask(&stream, 100 + LIVE_STREAM_TIMEOUT_MS - 1, &shown));
+    TEST_ASSERT_FALSE(liveStreamTask(&stream, 100 + LIVE_STREAM_TIMEOUT_MS, &shown));
+    TEST_ASSERT_FALSE(stream.active);
+    TEST_ASSERT_EQUAL_UINT32(1, stream.stats.framesPlayed);
+}
+
+void test_LiveStream_PackStatsLittleEndian(void) {
+    liveStreamStart(&stream, 20, 2, 1000);
+    push_frame(0, 1000);
+    stream.stats.framesReceived = 0x01020304;
+    stream.stats.framesPlayed = 5;
+    stream.stats.framesDropped = 6;
+    stream.stats.underruns = 7;
+    stream.stats.lastLatencyMs = 0x0102;
+    stream.stats.maxLatencyMs = 0x0304;
+
+    uint8_t out[LIVE_STREAM_STATS_SIZE];
+    liveStreamPackStats(&stream, 1000 + 0x0100, out);
+
+    TEST_ASSERT_EQUAL_HEX8(0x04, out[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, out[3]);
+    TEST_ASSERT_EQUAL_UINT8(5, out[4]);
+    TEST_ASSERT_EQUAL_UINT8(6, out[8]);
+    TEST_ASSERT_EQUAL_UINT8(7, out[12]);
+    TEST_ASSERT_EQUAL_HEX8(0x00, out[16]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, out[17]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, out[20]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, out[21]);
+    TEST_ASSERT_EQUAL_HEX8(0x04, out[22]);
+    TEST_ASSERT_EQUAL_HEX8(0x03, out[23]);
+    TEST_ASSERT_EQUAL_UINT8(1, out[24]);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_LiveStream_FullBufferDropsOldest);
+    RUN_TEST(test_LiveStream_PackStatsLittleEndian);
+    RUN_TEST(test_LiveStream_PlaysOneFramePerInterval);
+    RUN_TEST(test_LiveStream_PushRejectedWhenInactive);
+    RUN_TEST(test_LiveStream_SlowTickSkipsToNewestDueFrame);
+    RUN_TEST(test_LiveStream_StartClampsArguments);
+    RUN_TEST(test_LiveStream_TimesOutOnceIdleAndEmpty);
+    RUN_TEST(test_LiveStream_UnderrunHoldsLastFrameAndRebuffers);
+    RUN_TEST(test_LiveStream_WaitsForPrefillBeforePlaying);
+    return UNITY_END();
+}
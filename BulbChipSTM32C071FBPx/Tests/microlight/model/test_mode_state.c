@@ -47,6 +47,34 @@ static void add_rgb_change(
     }
 }
 
+static KeyframePattern *use_keyframe_front(uint32_t duration, KeyframeEasing easing) {
+    mode.hasFront = true;
+    mode.front.pattern.type = PATTERN_TYPE_KEYFRAME;
+    KeyframePattern *pattern = &mode.front.pattern.data.keyframe;
+    memset(pattern, 0, sizeof(*pattern));
+    pattern->duration = duration;
+    pattern->easing = easing;
+    return pattern;
+}
+
+static void add_keyframe(
+    KeyframePattern *pattern, uint8_t index, uint32_t ms, uint8_t r, uint8_t g, uint8_t b) {
+    pattern->changeAt[index].ms = ms;
+    pattern->changeAt[index].output.type = RGB;
+    pattern->changeAt[index].output.data.rgb = (RGBSimpleOutput){r, g, b};
+    if (index + 1U > pattern->changeAtCount) {
+        pattern->changeAtCount = index + 1U;
+    }
+}
+
+static void assert_front_rgb(uint8_t r, uint8_t g, uint8_t b) {
+    TEST_ASSERT_TRUE(modeStateGetSimpleOutput(&state.front, &mode.front, &output, 0));
+    TEST_ASSERT_EQUAL(RGB, output.type);
+    TEST_ASSERT_EQUAL_UINT8(r, output.data.rgb.r);
+    TEST_ASSERT_EQUAL_UINT8(g, output.data.rgb.g);
+    TEST_ASSERT_EQUAL_UINT8(b, output.data.rgb.b);
+}
+
 static void init_equation_channel(ChannelConfig *channel, const char *equation, uint32_t duration) {
     memset(channel, 0, sizeof(*channel));
     channel->sectionsCount = 1;
@@ -88,19 +116,19 @@ void test_ModeStateAdvance_FrontPatternAdvancesAndWraps(void) {
     TEST_ASSERT_EQUAL_UINT32(0U, state.front.simple.elapsedMs);
 
     advance_to_ms(10U);
-    TEST_ASSERT_EQUAL_UINT32(10U, state.front.simple.elapsedMs);
     TEST_ASSERT_TRUE(modeStateGetSimpleOutput(&state.front, &mode.front, &output, 50));
     TEST_ASSERT_EQUAL_UINT8(high, output.data.bulb);
+    TEST_ASSERT_EQUAL_UINT32(10U, state.front.simple.elapsedMs);
 
     advance_to_ms(60U);
-    TEST_ASSERT_EQUAL_UINT32(60U, state.front.simple.elapsedMs);
     TEST_ASSERT_TRUE(modeStateGetSimpleOutput(&state.front, &mode.front, &output, 50));
     TEST_ASSERT_EQUAL_UINT8(low, output.data.bulb);
+    TEST_ASSERT_EQUAL_UINT32(60U, state.front.simple.elapsedMs);
 
     advance_to_ms(210U);
-    TEST_ASSERT_EQUAL_UINT32(10U, state.front.simple.elapsedMs);
     TEST_ASSERT_TRUE(modeStateGetSimpleOutput(&state.front, &mode.front, &output, 50));
     TEST_ASSERT_EQUAL_UINT8(high, output.data.bulb);
+    TEST_ASSERT_EQUAL_UINT32(10U, state.front.simple.elapsedMs);
 }
 
 void test_ModeStateAdvance_CaseAndTriggersAdvance(void) {
@@ -300,12 +328,43 @@ void test_ModeStateAdvance_IgnoresNonMonotonicTime(void) {
 
     TEST_ASSERT_TRUE(modeStateInitialize(&state, &mode, 0U, NULL));
     modeStateAdvance(&state, &mode, 60U);
-    TEST_ASSERT_EQUAL_UINT8(1, state.front.simple.changeIndex);
+    TEST_ASSERT_EQUAL_UINT32(60U, state.timelineMs);
 
     modeStateAdvance(&state, &mode, 20U);
+    TEST_ASSERT_EQUAL_UINT32(60U, state.timelineMs);
+    TEST_ASSERT_TRUE(modeStateGetSimpleOutput(&state.front, &mode.front, &output, 50));
     TEST_ASSERT_EQUAL_UINT8(1, state.front.simple.changeIndex);
 }
 
+void test_ModeStateAdvance_HiddenComponentsCatchUpWhenShown(void) {
+    mode.hasFront = true;
+    mode.front.pattern.type = PATTERN_TYPE_SIMPLE;
+    init_simple_pattern(&mode.front.pattern.data.simple, 100U);
+    add_bulb_change(&mode.front.pattern.data.simple, 0, 0U, low);
+    add_bulb_change(&mode.front.pattern.data.simple, 1, 50U, high);
+
+    mode.hasAccel = true;
+    mode.accel.triggersCount = 1;
+    mode.accel.triggers[0].hasFront = true;
+    mode.accel.triggers[0].front = mode.front;
+
+    TEST_ASSERT_TRUE(modeStateInitialize(&state, &mode, 0U, NULL));
+    advance_to_ms(1070U);
+
+    // nothing read the trigger component while the timeline moved
+    TEST_ASSERT_EQUAL_UINT32(1070U, state.timelineMs);
+    TEST_ASSERT_EQUAL_UINT32(0U, state.accel[0].front.syncedMs);
+    TEST_ASSERT_EQUAL_UINT32(0U, state.accel[0].front.simple.elapsedMs);
+
+    // once shown it is in step with the mode's own component, as if it had run all along
+    TEST_ASSERT_TRUE(modeStateGetSimpleOutput(
+        &state.accel[0].front, &mode.accel.triggers[0].front, &output, 50));
+    TEST_ASSERT_EQUAL_UINT8(high, output.data.bulb);
+    TEST_ASSERT_EQUAL_UINT32(70U, state.accel[0].front.simple.elapsedMs);
+    TEST_ASSERT_EQUAL_UINT32(
+        30U, modeStateMsUntilNextChange(&state.accel[0].front, &mode.accel.triggers[0].front));
+}
+
 void test_ModeStateGetSimpleOutput_FalseWhenNoChanges(void) {
     ModeComponent component = {0};
     component.pattern.type = PATTERN_TYPE_SIMPLE;
@@ -558,6 +617,30 @@ void test_equation_loopAfterDuration_true_loops_back(void) {
     TEST_ASSERT_EQUAL_UINT8(50, output.data.rgb.r);  // t=0.5 => 50
 }
 
+void test_equation_loopAfterDuration_true_catches_up_several_laps(void) {
+    mode.hasFront = true;
+    mode.front.pattern.type = PATTERN_TYPE_EQUATION;
+    EquationPattern *eq = &mode.front.pattern.data.equation;
+
+    // Red: t * 100 over sections of 400 and 600 ms, one lap a second
+    init_equation_channel(&eq->red, "t * 100", 400);
+    eq->red.sectionsCount = 2;
+    strcpy(eq->red.sections[1].equation, "t * 100");
+    eq->red.sections[1].duration = 600;
+
+    TEST_ASSERT_TRUE(modeStateInitialize(&state, &mode, 0, NULL));
+    modeStateAdvance(&state, &mode, 100);
+    TEST_ASSERT_TRUE(modeStateGetSimpleOutput(&state.front, &mode.front, &output, 50));
+    TEST_ASSERT_EQUAL_UINT8(10, output.data.rgb.r);
+
+    // hidden for five and a half laps, shown 350 ms into the second section
+    modeStateAdvance(&state, &mode, 5750);
+    TEST_ASSERT_TRUE(modeStateGetSimpleOutput(&state.front, &mode.front, &output, 50));
+    TEST_ASSERT_EQUAL_UINT8(1, state.front.equation.red.currentSectionIndex);
+    TEST_ASSERT_EQUAL_UINT32(350, state.front.equation.red.sectionElapsedMs);
+    TEST_ASSERT_EQUAL_UINT8(35, output.data.rgb.r);
+}
+
 void test_equation_loopAfterDuration_mixed_channels(void) {
     memset(&mode, 0, sizeof(mode));
     mode.hasFront = true;
@@ -647,25 +730,231 @@ void test_equation_caching_respects_interval(void) {
     TEST_ASSERT_EQUAL_UINT8(70, output.data.rgb.r);
 }
 
+void test_ModeStateMsUntilNextChange_CountsToNextChangeAndWrap(void) {
+    mode.hasFront = true;
+    mode.front.pattern.type = PATTERN_TYPE_SIMPLE;
+    init_simple_pattern(&mode.front.pattern.data.simple, 100U);
+    add_bulb_change(&mode.front.pattern.data.simple, 0, 0U, high);
+    add_bulb_change(&mode.front.pattern.data.simple, 1, 50U, low);
+    TEST_ASSERT_TRUE(modeStateInitialize(&state, &mode, 0U, NULL));
+
+    advance_to_ms(20U);
+    TEST_ASSERT_EQUAL_UINT32(30U, modeStateMsUntilNextChange(&state.front, &mode.front));
+
+    advance_to_ms(70U);
+    TEST_ASSERT_EQUAL_UINT32(30U, modeStateMsUntilNextChange(&state.front, &mode.front));
+}
+
+void test_ModeStateMsUntilNextChange_StaticAndEquationPatterns(void) {
+    mode.hasFront = true;
+    mode.front.pattern.type = PATTERN_TYPE_SIMPLE;
+    init_simple_pattern(&mode.front.pattern.data.simple, 100U);
+    add_rgb_change(&mode.front.pattern.data.simple, 0, 0U, 1, 2, 3);
+    TEST_ASSERT_TRUE(modeStateInitialize(&state, &mode, 0U, NULL));
+
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, modeStateMsUntilNextChange(&state.front, &mode.front));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, modeStateMsUntilNextChange(&state.front, NULL));
+
+    mode.front.pattern.type = PATTERN_TYPE_EQUATION;
+    TEST_ASSERT_EQUAL_UINT32(0U, modeStateMsUntilNextChange(&state.front, &mode.front));
+}
+
+void test_keyframe_linear_interpolates_and_fades_back_to_first(void) {
+    KeyframePattern *pattern = use_keyframe_front(1000U, KEYFRAME_EASING_LINEAR);
+    add_keyframe(pattern, 0, 0U, 0, 0, 0);
+    add_keyframe(pattern, 1, 500U, 200, 100, 0);
+    TEST_ASSERT_TRUE(modeStateInitialize(&state, &mode, 0U, NULL));
+
+    assert_front_rgb(0, 0, 0);
+    advance_to_ms(250U);
+    assert_front_rgb(100, 50, 0);
+    advance_to_ms(500U);
+    assert_front_rgb(200, 100, 0);
+
+    // past the last keyframe the pattern fades back into the first one
+    advance_to_ms(750U);
+    assert_front_rgb(100, 50, 0);
+    advance_to_ms(1250U);
+    assert_front_rgb(100, 50, 0);
+}
+
+void test_keyframe_ease_is_slower_near_keyframes(void) {
+    KeyframePattern *pattern = use_keyframe_front(1000U, KEYFRAME_EASING_EASE);
+    add_keyframe(pattern, 0, 0U, 0, 0, 0);
+    add_keyframe(pattern, 1, 500U, 200, 0, 0);
+    TEST_ASSERT_TRUE(modeStateInitialize(&state, &mode, 0U, NULL));
+
+    // smoothstep(0.25) = 0.15625 where linear would be at 50
+    modeStateAdvance(&state, &mode, 125U);
+    assert_front_rgb(31, 0, 0);
+
+    advance_to_ms(250U);
+    assert_front_rgb(100, 0, 0);
+}
+
+void test_keyframe_first_keyframe_after_zero_fades_across_the_loop(void) {
+    KeyframePattern *pattern = use_keyframe_front(1000U, KEYFRAME_EASING_LINEAR);
+    add_keyframe(pattern, 0, 200U, 255, 0, 0);
+    add_keyframe(pattern, 1, 600U, 0, 0, 255);
+    TEST_ASSERT_TRUE(modeStateInitialize(&state, &mode, 0U, NULL));
+
+    // 400ms into the 600ms fade from blue at 600 to red at 200 of the next loop
+    assert_front_rgb(170, 0, 85);
+    advance_to_ms(200U);
+    assert_front_rgb(255, 0, 0);
+}
+
+void test_ModeStateMsUntilNextChange_KeyframeOnlySleepsThroughHolds(void) {
+    KeyframePattern *pattern = use_keyframe_front(1000U, KEYFRAME_EASING_LINEAR);
+    add_keyframe(pattern, 0, 0U, 255, 0, 0);
+    add_keyframe(pattern, 1, 400U, 255, 0, 0);
+    add_keyframe(pattern, 2, 600U, 0, 0, 255);
+    TEST_ASSERT_TRUE(modeStateInitialize(&state, &mode, 0U, NULL));
+
+    advance_to_ms(100U);
+    TEST_ASSERT_EQUAL_UINT32(300U, modeStateMsUntilNextChange(&state.front, &mode.front));
+
+    advance_to_ms(500U);
+    TEST_ASSERT_EQUAL_UINT32(0U, modeStateMsUntilNextChange(&state.front, &mode.front));
+
+    pattern->changeAtCount = 1U;
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, modeStateMsUntilNextChange(&state.front, &mode.front));
+}
+
+void test_ModeStateInitialize_CompilesTriggersIntoMachine(void) {
+    mode.hasFront = true;
+    mode.hasCaseComp = true;
+    mode.hasAccel = true;
+    mode.accel.triggersCount = 2;
+    mode.accel.triggers[0].threshold = 10;
+    mode.accel.triggers[0].hasHoldMs = true;
+    mode.accel.triggers[0].holdMs = 300;
+    mode.accel.triggers[0].hasCaseComp = true;
+    mode.accel.triggers[1].threshold = 20;
+    mode.accel.triggers[1].hasFront = true;
+    TEST_ASSERT_TRUE(modeStateInitialize(&state, &mode, 50U, NULL));
+
+    const ModeMachine *machine = &state.machine;
+    TEST_ASSERT_EQUAL_UINT8(3, machine->stateCount);
+    TEST_ASSERT_EQUAL_UINT8(0, machine->state);
+    TEST_ASSERT_EQUAL_UINT32(50U, machine->enteredMs);
+
+    // state 0 rises, state 1 falls or rises, state 2 falls to either state below
+    const uint8_t first[] = {0, 1, 3, 5};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(first, machine->first, 4);
+    TEST_ASSERT_EQUAL(MODE_TRANSITION_EVENT_ACCEL, machine->transitions[0].on);
+    TEST_ASSERT_EQUAL_UINT8(10, machine->transitions[0].threshold);
+    TEST_ASSERT_EQUAL(MODE_TRANSITION_EVENT_STILL, machine->transitions[1].on);
+    TEST_ASSERT_EQUAL_UINT32(300U, machine->transitions[1].ms);
+    TEST_ASSERT_EQUAL_UINT8(0, machine->transitions[3].to);
+    TEST_ASSERT_EQUAL_UINT8(1, machine->transitions[4].to);
+    TEST_ASSERT_EQUAL_UINT32(0U, machine->transitions[4].ms);
+
+    // a trigger without a component keeps the one of the state below
+    const uint8_t frontSlots[] = {0, 0, 2};
+    const uint8_t caseSlots[] = {0, 1, 1};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frontSlots, machine->frontSlot, 3);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(caseSlots, machine->caseSlot, 3);
+}
+
+void test_ModeStateInitialize_GroupsScriptByStateAndDropsMissingStates(void) {
+    mode.hasFront = true;
+    mode.hasAccel = true;
+    mode.accel.triggersCount = 1;
+    mode.accel.triggers[0].hasFront = true;
+    mode.hasScript = true;
+    mode.script.transitionsCount = 4;
+    mode.script.transitions[0] = (ModeTransition){
+        .from = 1, .to = 0, .on = MODE_TRANSITION_EVENT_TIMER, .ms = 500, .hasMs = true};
+    mode.script.transitions[1] = (ModeTransition){
+        .from = 0,
+        .to = 2,
+        .on = MODE_TRANSITION_EVENT_ACCEL,
+        .threshold = 90,
+        .hasThreshold = true};
+    mode.script.transitions[2] = (ModeTransition){
+        .from = 0,
+        .to = 1,
+        .on = MODE_TRANSITION_EVENT_ACCEL,
+        .threshold = 40,
+        .hasThreshold = true};
+    mode.script.transitions[3] = (ModeTransition){
+        .from = 2, .to = 0, .on = MODE_TRANSITION_EVENT_TIMER};
+    TEST_ASSERT_TRUE(modeStateInitialize(&state, &mode, 0U, NULL));
+
+    const ModeMachine *machine = &state.machine;
+    TEST_ASSERT_EQUAL_UINT8(2, machine->stateCount);
+    const uint8_t first[] = {0, 1, 2};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(first, machine->first, 3);
+    TEST_ASSERT_EQUAL_UINT8(40, machine->transitions[0].threshold);
+    TEST_ASSERT_EQUAL(MODE_TRANSITION_EVENT_TIMER, machine->transitions[1].on);
+    TEST_ASSERT_EQUAL_UINT32(500U, machine->transitions[1].ms);
+}
+
+void test_ModeStateInitialize_CompilesScriptStates(void) {
+    mode.hasFront = true;
+    mode.hasAccel = true;
+    mode.accel.triggersCount = 1;
+    mode.accel.triggers[0].hasCaseComp = true;
+    mode.hasScript = true;
+    mode.script.hasStates = true;
+    mode.script.statesCount = 4;
+    mode.script.states[0] = (ModeScriptState){.front = 0, .hasFront = true};
+    mode.script.states[1] = (ModeScriptState){.caseComp = 1, .hasCaseComp = true};
+    // the trigger has no front component and there is no second trigger
+    mode.script.states[2] = (ModeScriptState){
+        .front = 1, .hasFront = true, .caseComp = 2, .hasCaseComp = true};
+    mode.script.states[3] = (ModeScriptState){0};
+    mode.script.transitionsCount = 2;
+    mode.script.transitions[0] = (ModeTransition){
+        .from = 0, .to = 3, .on = MODE_TRANSITION_EVENT_BUTTON};
+    mode.script.transitions[1] = (ModeTransition){
+        .from = 3, .to = 0, .on = MODE_TRANSITION_EVENT_CHARGE};
+    TEST_ASSERT_TRUE(modeStateInitialize(&state, &mode, 0U, NULL));
+
+    const ModeMachine *machine = &state.machine;
+    TEST_ASSERT_EQUAL_UINT8(4, machine->stateCount);
+    const uint8_t first[] = {0, 1, 1, 1, 2};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(first, machine->first, 5);
+    TEST_ASSERT_EQUAL(MODE_TRANSITION_EVENT_CHARGE, machine->transitions[1].on);
+
+    const uint8_t none = MODE_MACHINE_NO_COMPONENT;
+    const uint8_t frontSlots[] = {0, none, none, none};
+    const uint8_t caseSlots[] = {none, 1, none, none};
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(frontSlots, machine->frontSlot, 4);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(caseSlots, machine->caseSlot, 4);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_ModeStateAdvance_CaseAndTriggersAdvance);
     RUN_TEST(test_ModeStateAdvance_FrontPatternAdvancesAndWraps);
+    RUN_TEST(test_ModeStateAdvance_HiddenComponentsCatchUpWhenShown);
     RUN_TEST(test_ModeStateAdvance_IgnoresNonMonotonicTime);
     RUN_TEST(test_ModeStateGetSimpleOutput_FalseWhenNoChanges);
+    RUN_TEST(test_ModeStateInitialize_CompilesScriptStates);
+    RUN_TEST(test_ModeStateInitialize_CompilesTriggersIntoMachine);
     RUN_TEST(test_ModeStateInitialize_FailsOnInvalidEquation);
     RUN_TEST(test_ModeStateInitialize_FreesAccelEquationsOnReinit);
     RUN_TEST(test_ModeStateInitialize_FreesFrontAndCaseEquationsOnReinit);
+    RUN_TEST(test_ModeStateInitialize_GroupsScriptByStateAndDropsMissingStates);
     RUN_TEST(test_ModeStateInitialize_ReportsAccelEquationError);
     RUN_TEST(test_ModeStateInitialize_SeedsInitialTime);
+    RUN_TEST(test_ModeStateMsUntilNextChange_CountsToNextChangeAndWrap);
+    RUN_TEST(test_ModeStateMsUntilNextChange_KeyframeOnlySleepsThroughHolds);
+    RUN_TEST(test_ModeStateMsUntilNextChange_StaticAndEquationPatterns);
     RUN_TEST(test_equation_caching_respects_interval);
     RUN_TEST(test_equation_case_insensitive);
     RUN_TEST(test_equation_loopAfterDuration_false_continues_indefinitely);
     RUN_TEST(test_equation_loopAfterDuration_false_multi_section_stays_on_last);
     RUN_TEST(test_equation_loopAfterDuration_mixed_channels);
+    RUN_TEST(test_equation_loopAfterDuration_true_catches_up_several_laps);
     RUN_TEST(test_equation_loopAfterDuration_true_loops_back);
     RUN_TEST(test_equation_multi_section);
     RUN_TEST(test_equation_pattern);
     RUN_TEST(test_equation_pattern_respects_channel_loop_flags);
+    RUN_TEST(test_keyframe_ease_is_slower_near_keyframes);
+    RUN_TEST(test_keyframe_first_keyframe_after_zero_fades_across_the_loop);
+    RUN_TEST(test_keyframe_linear_interpolates_and_fades_back_to_first);
     return UNITY_END();
 }
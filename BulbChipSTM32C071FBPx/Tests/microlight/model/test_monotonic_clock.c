@@ -0,0 +1,118 @@
+#include <string.h>
+#include "unity.h"
+
+#include "microlight/model/monotonic_clock.h"
+
+static MonotonicClock clock;
+static uint32_t sourceMs;
+static uint32_t referenceMs;
+
+// the RTC moves in 4 ms counts, the reference runs `referencePerMille` as fast
+static uint32_t runFor(uint32_t milliseconds, uint32_t referencePerMille) {
+    uint32_t result = 0;
+    for (uint32_t elapsed = 4; elapsed <= milliseconds; elapsed += 4) {
+        sourceMs += 4;
+        if (elapsed % 1000U == 0) {
+            referenceMs += referencePerMille;
+        }
+        result = monotonicClockUpdate(&clock, sourceMs);
+        monotonicClockCalibrate(&clock, referenceMs);
+    }
+    return result;
+}
+
+void setUp(void) {
+    monotonicClockInit(&clock);
+    sourceMs = 0;
+    referenceMs = 0;
+}
+
+void tearDown(void) {
+}
+
+void test_MonotonicClock_CountsFromFirstUpdate(void) {
+    sourceMs = 5000;
+    TEST_ASSERT_EQUAL_UINT32(0, monotonicClockUpdate(&clock, sourceMs));
+    TEST_ASSERT_EQUAL_UINT32(0, monotonicClockUpdate(&clock, sourceMs));
+    TEST_ASSERT_EQUAL_UINT32(1000, runFor(1000, 1000));
+}
+
+void test_MonotonicClock_KeepsCountingAcrossSourceWrap(void) {
+    monotonicClockUpdate(&clock, UINT32_MAX - 3);
+    TEST_ASSERT_EQUAL_UINT32(8, monotonicClockUpdate(&clock, 4));
+}
+
+void test_MonotonicClock_TrimsRateAfterFullWindow(void) {
+    monotonicClockUpdate(&clock, sourceMs);
+    monotonicClockCalibrate(&clock, referenceMs);
+
+    // the reference is 1% fast, the rate only moves once the window is full
+    runFor(MONOTONIC_CLOCK_CALIBRATION_MS - 1000, 1010);
+    TEST_ASSERT_EQUAL_UINT32(MONOTONIC_CLOCK_RATE_ONE, clock.rate);
+    uint32_t before = runFor(1000, 1010);
+    TEST_ASSERT_UINT32_WITHIN(10, MONOTONIC_CLOCK_RATE_ONE * 101 / 100, clock.rate);
+
+    TEST_ASSERT_UINT32_WITHIN(1, before + 1010, runFor(1000, 1010));
+}
+
+void test_MonotonicClock_CarriesFractionBetweenUpdates(void) {
+    clock.rate = MONOTONIC_CLOCK_RATE_ONE * 101 / 100;
+    monotonicClockUpdate(&clock, 0);
+
+    // 4 ms counts are 4.04 ms each, none of the hundredths are dropped
+    for (uint32_t ms = 4; ms <= 10000; ms += 4) {
+        monotonicClockUpdate(&clock, ms);
+    }
+    MonotonicClock single;
+    monotonicClockInit(&single);
+    single.rate = clock.rate;
+    monotonicClockUpdate(&single, 0);
+
+    TEST_ASSERT_EQUAL_UINT32(monotonicClockUpdate(&single, 10000), clock.milliseconds);
+    TEST_ASSERT_EQUAL_UINT32(10099, clock.milliseconds);
+}
+
+void test_MonotonicClock_IgnoresWindowFarFromNominal(void) {
+    monotonicClockUpdate(&clock, sourceMs);
+    monotonicClockCalibrate(&clock, referenceMs);
+
+    runFor(MONOTONIC_CLOCK_CALIBRATION_MS, 750);
+    runFor(MONOTONIC_CLOCK_CALIBRATION_MS, 750);
+    TEST_ASSERT_EQUAL_UINT32(MONOTONIC_CLOCK_RATE_ONE, clock.rate);
+}
+
+void test_MonotonicClock_StalledReferenceRestartsWindow(void) {
+    monotonicClockUpdate(&clock, sourceMs);
+    monotonicClockCalibrate(&clock, referenceMs);
+
+    // chip tick off for longer than two windows, the window it leaves behind is thrown away
+    runFor(3 * MONOTONIC_CLOCK_CALIBRATION_MS, 0);
+    runFor(MONOTONIC_CLOCK_CALIBRATION_MS, 1010);
+    TEST_ASSERT_EQUAL_UINT32(MONOTONIC_CLOCK_RATE_ONE, clock.rate);
+
+    runFor(MONOTONIC_CLOCK_CALIBRATION_MS, 1010);
+    TEST_ASSERT_UINT32_WITHIN(10, MONOTONIC_CLOCK_RATE_ONE * 101 / 100, clock.rate);
+}
+
+void test_MonotonicClock_RestartDropsTimeBeforeIt(void) {
+    monotonicClockUpdate(&clock, sourceMs);
+    monotonicClockCalibrate(&clock, referenceMs);
+    runFor(10000, 0);
+
+    // Stop mode halted the reference, only the window after it counts
+    monotonicClockRestartCalibration(&clock);
+    runFor(MONOTONIC_CLOCK_CALIBRATION_MS, 1010);
+    TEST_ASSERT_UINT32_WITHIN(20, MONOTONIC_CLOCK_RATE_ONE * 101 / 100, clock.rate);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_MonotonicClock_CarriesFractionBetweenUpdates);
+    RUN_TEST(test_MonotonicClock_CountsFromFirstUpdate);
+    RUN_TEST(test_MonotonicClock_IgnoresWindowFarFromNominal);
+    RUN_TEST(test_MonotonicClock_KeepsCountingAcrossSourceWrap);
+    RUN_TEST(test_MonotonicClock_RestartDropsTimeBeforeIt);
+    RUN_TEST(test_MonotonicClock_StalledReferenceRestartsWindow);
+    RUN_TEST(test_MonotonicClock_TrimsRateAfterFullWindow);
+    return UNITY_END();
+}
@@ -0,0 +1,183 @@
+#include <string.h>
+#include "unity.h"
+
+#include "microlight/model/power_estimate.h"
+
+static Mode mode;
+static ChipSettings settings;
+
+static void set_change(
+    SimplePattern *pattern, uint8_t index, uint32_t ms, uint8_t r, uint8_t g, uint8_t b) {
+    pattern->changeAt[index].ms = ms;
+    pattern->changeAt[index].output.type = RGB;
+    pattern->changeAt[index].output.data.rgb = (RGBSimpleOutput){r, g, b};
+    if (index >= pattern->changeAtCount) {
+        pattern->changeAtCount = index + 1;
+    }
+}
+
+static SimplePattern *use_simple_front(uint32_t duration) {
+    mode.hasFront = true;
+    mode.front.pattern.type = PATTERN_TYPE_SIMPLE;
+    mode.front.pattern.data.simple.duration = duration;
+    return &mode.front.pattern.data.simple;
+}
+
+void setUp(void) {
+    memset(&mode, 0, sizeof(mode));
+    chipSettingsInitDefaults(&settings);
+    settings.frontWhiteBalanceRed = 255;
+    settings.frontWhiteBalanceGreen = 255;
+    settings.frontWhiteBalanceBlue = 255;
+    settings.caseWhiteBalanceRed = 255;
+    settings.caseWhiteBalanceGreen = 255;
+    settings.caseWhiteBalanceBlue = 255;
+    settings.frontRedCurrentMa = 20;
+    settings.frontGreenCurrentMa = 20;
+    settings.frontBlueCurrentMa = 20;
+    settings.caseRedCurrentMa = 5;
+    settings.caseGreenCurrentMa = 5;
+    settings.caseBlueCurrentMa = 5;
+    settings.bulbCurrentMa = 20;
+}
+
+void tearDown(void) {
+}
+
+void test_PowerEstimate_SimplePatternIsTimeWeighted(void) {
+    SimplePattern *pattern = use_simple_front(1000);
+    set_change(pattern, 0, 0, 255, 0, 0);
+    set_change(pattern, 1, 250, 0, 0, 0);
+
+    PowerEstimate estimate = powerEstimateMode(&mode, &settings, 1000);
+
+    TEST_ASSERT_EQUAL_UINT32(5000, estimate.frontMicroamps);
+    TEST_ASSERT_EQUAL_UINT32(0, estimate.caseMicroamps);
+    TEST_ASSERT_TRUE(estimate.exact);
+}
+
+void test_PowerEstimate_AppliesGammaAndWhiteBalance(void) {
+    SimplePattern *pattern = use_simple_front(0);
+    set_change(pattern, 0, 0, 255, 0, 0);
+    settings.frontWhiteBalanceRed = 128;
+
+    PowerEstimate estimate = powerEstimateMode(&mode, &settings, 1000);
+    TEST_ASSERT_EQUAL_UINT32(128U * 20U * 1000U / 255U, estimate.frontMicroamps);
+
+    // gamma 2.2 puts half input well under half duty
+    settings.frontWhiteBalanceRed = 255;
+    set_change(pattern, 0, 0, 128, 0, 0);
+    estimate = powerEstimateMode(&mode, &settings, 1000);
+    TEST_ASSERT_EQUAL_UINT32(56U * 20U * 1000U / 255U, estimate.frontMicroamps);
+}
+
+void test_PowerEstimate_BulbUsesBulbCurrent(void) {
+    SimplePattern *pattern = use_simple_front(1000);
+    pattern->changeAt[0] = (PatternChange){.ms = 0, .output = {.type = BULB, .data.bulb = high}};
+    pattern->changeAt[1] = (PatternChange){.ms = 500, .output = {.type = BULB, .data.bulb = low}};
+    pattern->changeAtCount = 2;
+
+    PowerEstimate estimate = powerEstimateMode(&mode, &settings, 1000);
+    TEST_ASSERT_EQUAL_UINT32(10000, estimate.frontMicroamps);
+}
+
+void test_PowerEstimate_CaseUsesCaseCurrents(void) {
+    mode.hasCaseComp = true;
+    mode.caseComp.pattern.type = PATTERN_TYPE_SIMPLE;
+    SimplePattern *pattern = &mode.caseComp.pattern.data.simple;
+    pattern->duration = 100;
+    set_change(pattern, 0, 0, 255, 255, 255);
+    // the case LED ignores bulb outputs
+    pattern->changeAt[1] = (PatternChange){.ms = 50, .output = {.type = BULB, .data.bulb = high}};
+    pattern->changeAtCount = 2;
+
+    PowerEstimate estimate = powerEstimateMode(&mode, &settings, 1000);
+    TEST_ASSERT_EQUAL_UINT32(0, estimate.frontMicroamps);
+    TEST_ASSERT_EQUAL_UINT32(7500, estimate.caseMicroamps);
+}
+
+void test_PowerEstimate_ChangesPastDurationAreIgnored(void) {
+    SimplePattern *pattern = use_simple_front(100);
+    set_change(pattern, 0, 0, 0, 0, 255);
+    set_change(pattern, 1, 50, 0, 0, 0);
+    set_change(pattern, 2, 200, 255, 255, 255);
+
+    PowerEstimate estimate = powerEstimateMode(&mode, &settings, 1000);
+    TEST_ASSERT_EQUAL_UINT32(10000, estimate.frontMicroamps);
+}
+
+void test_PowerEstimate_EquationCountedAtFullScale(void) {
+    mode.hasFront = true;
+    mode.front.pattern.type = PATTERN_TYPE_EQUATION;
+
+    PowerEstimate estimate = powerEstimateMode(&mode, &settings, 1000);
+    TEST_ASSERT_EQUAL_UINT32(60000, estimate.frontMicroamps);
+    TEST_ASSERT_FALSE(estimate.exact);
+}
+
+void test_PowerEstimate_KeyframeAveragesEachFade(void) {
+    mode.hasFront = true;
+    mode.front.pattern.type = PATTERN_TYPE_KEYFRAME;
+    KeyframePattern *pattern = &mode.front.pattern.data.keyframe;
+    pattern->duration = 1000;
+    pattern->changeAt[0] =
+        (PatternChange){.ms = 0, .output = {.type = RGB, .data.rgb = {255, 0, 0}}};
+    pattern->changeAt[1] = (PatternChange){.ms = 500, .output = {.type = BULB, .data.bulb = low}};
+    pattern->changeAtCount = 2;
+
+    PowerEstimate estimate = powerEstimateMode(&mode, &settings, 1000);
+
+    // fades to off and back again, half of full red on average
+    TEST_ASSERT_EQUAL_UINT32(10000, estimate.frontMicroamps);
+    TEST_ASSERT_FALSE(estimate.exact);
+}
+
+void test_PowerEstimate_AccelTriggersAreNotExact(void) {
+    SimplePattern *pattern = use_simple_front(0);
+    set_change(pattern, 0, 0, 0, 0, 0);
+    mode.hasAccel = true;
+    mode.accel.triggersCount = 1;
+
+    PowerEstimate estimate = powerEstimateMode(&mode, &settings, 1000);
+    TEST_ASSERT_FALSE(estimate.exact);
+}
+
+void test_PowerEstimate_McuCurrentFollowsAwakeFraction(void) {
+    PowerEstimate estimate = powerEstimateMode(&mode, &settings, 1000);
+    TEST_ASSERT_EQUAL_UINT32(POWER_MCU_RUN_MICROAMPS, estimate.mcuMicroamps);
+
+    estimate = powerEstimateMode(&mode, &settings, 0);
+    TEST_ASSERT_EQUAL_UINT32(POWER_MCU_STOP_MICROAMPS, estimate.mcuMicroamps);
+
+    estimate = powerEstimateMode(&mode, &settings, 500);
+    TEST_ASSERT_EQUAL_UINT32(
+        (POWER_MCU_RUN_MICROAMPS + POWER_MCU_STOP_MICROAMPS) / 2, estimate.mcuMicroamps);
+    TEST_ASSERT_EQUAL_UINT16(500, estimate.awakePermille);
+
+    estimate = powerEstimateMode(&mode, &settings, 2000);
+    TEST_ASSERT_EQUAL_UINT16(1000, estimate.awakePermille);
+}
+
+void test_PowerEstimate_TotalSumsEveryConsumer(void) {
+    SimplePattern *pattern = use_simple_front(0);
+    set_change(pattern, 0, 0, 255, 0, 0);
+
+    PowerEstimate estimate = powerEstimateMode(&mode, &settings, 0);
+    TEST_ASSERT_EQUAL_UINT32(
+        20000 + POWER_MCU_STOP_MICROAMPS, powerEstimateTotalMicroamps(&estimate));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_PowerEstimate_AccelTriggersAreNotExact);
+    RUN_TEST(test_PowerEstimate_AppliesGammaAndWhiteBalance);
+    RUN_TEST(test_PowerEstimate_BulbUsesBulbCurrent);
+    RUN_TEST(test_PowerEstimate_CaseUsesCaseCurrents);
+    RUN_TEST(test_PowerEstimate_ChangesPastDurationAreIgnored);
+    RUN_TEST(test_PowerEstimate_EquationCountedAtFullScale);
+    RUN_TEST(test_PowerEstimate_KeyframeAveragesEachFade);
+    RUN_TEST(test_PowerEstimate_McuCurrentFollowsAwakeFraction);
+    RUN_TEST(test_PowerEstimate_SimplePatternIsTimeWeighted);
+    RUN_TEST(test_PowerEstimate_TotalSumsEveryConsumer);
+    return UNITY_END();
+}
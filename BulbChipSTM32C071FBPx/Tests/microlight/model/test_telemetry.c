@@ -0,0 +1,177 @@
+#include <string.h>
+#include "unity.h"
+
+#include "microlight/model/telemetry.h"
+
+// Flash mock, programming can only clear bits like the real thing
+static uint8_t flash[TELEMETRY_PAGE_COUNT * TELEMETRY_PAGE_SIZE];
+static int eraseCount;
+static int writeCount;
+static bool wroteOverProgrammedFlash;
+static Telemetry telemetry;
+
+void mock_erasePage(uint8_t page) {
+    TEST_ASSERT_TRUE(page < TELEMETRY_PAGE_COUNT);
+    memset(&flash[page * TELEMETRY_PAGE_SIZE], 0xFF, TELEMETRY_PAGE_SIZE);
+    eraseCount++;
+}
+
+void mock_write(uint32_t offset, const uint8_t *data, size_t length) {
+    TEST_ASSERT_EQUAL_UINT32(0, offset % TELEMETRY_RECORD_SIZE);
+    TEST_ASSERT_EQUAL_UINT32(TELEMETRY_RECORD_SIZE, length);
+    for (size_t i = 0; i < length; i++) {
+        if (flash[offset + i] != 0xFF) {
+            wroteOverProgrammedFlash = true;
+        }
+        flash[offset + i] &= data[i];
+    }
+    writeCount++;
+}
+
+void mock_read(uint32_t offset, uint8_t *buffer, size_t length) {
+    memcpy(buffer, &flash[offset], length);
+}
+
+static void initTelemetry(void) {
+    TEST_ASSERT_TRUE(telemetryInit(&telemetry, mock_erasePage, mock_write, mock_read));
+}
+
+static void recordAndFlush(uint16_t count, uint16_t firstValue) {
+    for (uint16_t i = 0; i < count; i++) {
+        telemetryRecord(&telemetry, TELEMETRY_EVENT_MODE_CHANGED, 0, firstValue + i, i);
+        if (telemetry.pendingCount == TELEMETRY_PENDING_RECORDS) {
+            telemetryFlush(&telemetry);
+        }
+    }
+    telemetryFlush(&telemetry);
+}
+
+static TelemetryRecord readRecord(uint16_t index) {
+    uint8_t data[TELEMETRY_RECORD_SIZE];
+    TEST_ASSERT_EQUAL_UINT16(1, telemetryRead(&telemetry, index, data, 1));
+    TelemetryRecord record;
+    telemetryUnpack(data, &record);
+    return record;
+}
+
+void setUp(void) {
+    memset(flash, 0xFF, sizeof(flash));
+    memset(&telemetry, 0, sizeof(telemetry));
+    eraseCount = 0;
+    writeCount = 0;
+    wroteOverProgrammedFlash = false;
+}
+
+void tearDown(void) {
+    TEST_ASSERT_FALSE(wroteOverProgrammedFlash);
+}
+
+void test_Telemetry_InitRequiresFlash(void) {
+    TEST_ASSERT_FALSE(telemetryInit(&telemetry, NULL, mock_write, mock_read));
+    TEST_ASSERT_FALSE(telemetryInit(&telemetry, mock_erasePage, NULL, mock_read));
+    TEST_ASSERT_FALSE(telemetryInit(&telemetry, mock_erasePage, mock_write, NULL));
+}
+
+void test_Telemetry_BlankFlashStartsEmptyLog(void) {
+    initTelemetry();
+
+    TEST_ASSERT_EQUAL_INT(1, eraseCount);
+    TEST_ASSERT_EQUAL_UINT16(0, telemetryCount(&telemetry));
+    TEST_ASSERT_EQUAL_HEX8(0x54, flash[0]);  // magic, little endian "TLM1"
+}
+
+void test_Telemetry_RecordsWaitInRamUntilFlushed(void) {
+    initTelemetry();
+    int writesAfterInit = writeCount;
+
+    telemetryRecord(&telemetry, TELEMETRY_EVENT_CHARGE_STATE, 2, 0, 0x01020304);
+    TEST_ASSERT_EQUAL_INT(writesAfterInit, writeCount);
+    TEST_ASSERT_EQUAL_UINT16(0, telemetryCount(&telemetry));
+
+    telemetryFlush(&telemetry);
+    TEST_ASSERT_FALSE(telemetryHasPending(&telemetry));
+    TEST_ASSERT_EQUAL_UINT16(1, telemetryCount(&telemetry));
+
+    TelemetryRecord record = readRecord(0);
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_EVENT_CHARGE_STATE, record.event);
+    TEST_ASSERT_EQUAL_UINT8(2, record.arg);
+    TEST_ASSERT_EQUAL_HEX32(0x01020304, record.milliseconds);
+}
+
+void test_Telemetry_ResumesAfterRebootWithoutErasing(void) {
+    initTelemetry();
+    recordAndFlush(3, 10);
+
+    eraseCount = 0;
+    memset(&telemetry, 0, sizeof(telemetry));
+    initTelemetry();
+    TEST_ASSERT_EQUAL_INT(0, eraseCount);
+    TEST_ASSERT_EQUAL_UINT16(3, telemetryCount(&telemetry));
+
+    telemetryRecord(&telemetry, TELEMETRY_EVENT_BOOT, 0, 0, 0);
+    telemetryFlush(&telemetry);
+    TEST_ASSERT_EQUAL_UINT16(4, telemetryCount(&telemetry));
+    TEST_ASSERT_EQUAL_UINT16(12, readRecord(2).value);
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_EVENT_BOOT, readRecord(3).event);
+}
+
+void test_Telemetry_ErasesOncePerPageAndKeepsNewestHistory(void) {
+    initTelemetry();
+    eraseCount = 0;
+
+    // fill the ring and then half a page more
+    uint16_t total = TELEMETRY_CAPACITY + TELEMETRY_RECORDS_PER_PAGE / 2;
+    recordAndFlush(total, 0);
+
+    TEST_ASSERT_EQUAL_INT(TELEMETRY_PAGE_COUNT, eraseCount);
+    uint16_t kept = telemetryCount(&telemetry);
+    TEST_ASSERT_EQUAL_UINT16(
+        (TELEMETRY_PAGE_COUNT - 1) * TELEMETRY_RECORDS_PER_PAGE + TELEMETRY_RECORDS_PER_PAGE / 2,
+        kept);
+
+    // oldest first and contiguous up to the newest record
+    TEST_ASSERT_EQUAL_UINT16(total - kept, readRecord(0).value);
+    TEST_ASSERT_EQUAL_UINT16(total - 1, readRecord(kept - 1).value);
+
+    // a reboot finds the same history
+    memset(&telemetry, 0, sizeof(telemetry));
+    initTelemetry();
+    TEST_ASSERT_EQUAL_UINT16(kept, telemetryCount(&telemetry));
+    TEST_ASSERT_EQUAL_UINT16(total - kept, readRecord(0).value);
+}
+
+void test_Telemetry_FullQueueCountsDropped(void) {
+    initTelemetry();
+    for (uint16_t i = 0; i < TELEMETRY_PENDING_RECORDS + 3; i++) {
+        telemetryRecord(&telemetry, TELEMETRY_EVENT_I2C_FAILURE, 0x6A, i, 500);
+    }
+
+    telemetryFlush(&telemetry);
+
+    TEST_ASSERT_EQUAL_UINT16(TELEMETRY_PENDING_RECORDS + 1, telemetryCount(&telemetry));
+    TelemetryRecord dropped = readRecord(TELEMETRY_PENDING_RECORDS);
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_EVENT_DROPPED, dropped.event);
+    TEST_ASSERT_EQUAL_UINT16(3, dropped.value);
+    TEST_ASSERT_EQUAL_UINT32(500, dropped.milliseconds);
+}
+
+void test_Telemetry_ReadClampsToStoredRecords(void) {
+    initTelemetry();
+    recordAndFlush(4, 0);
+
+    uint8_t out[8 * TELEMETRY_RECORD_SIZE];
+    TEST_ASSERT_EQUAL_UINT16(2, telemetryRead(&telemetry, 2, out, 8));
+    TEST_ASSERT_EQUAL_UINT16(0, telemetryRead(&telemetry, 4, out, 8));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_Telemetry_BlankFlashStartsEmptyLog);
+    RUN_TEST(test_Telemetry_ErasesOncePerPageAndKeepsNewestHistory);
+    RUN_TEST(test_Telemetry_FullQueueCountsDropped);
+    RUN_TEST(test_Telemetry_InitRequiresFlash);
+    RUN_TEST(test_Telemetry_ReadClampsToStoredRecords);
+    RUN_TEST(test_Telemetry_RecordsWaitInRamUntilFlushed);
+    RUN_TEST(test_Telemetry_ResumesAfterRebootWithoutErasing);
+    return UNITY_END();
+}
@@ -0,0 +1,122 @@
+#include <stdbool.h>
+#include <string.h>
+#include "unity.h"
+
+#include "microlight/protocol/frame.h"
+
+static char wire[4096];
+
+void setUp(void) {
+    memset(wire, 0, sizeof(wire));
+}
+
+void tearDown(void) {
+}
+
+void test_frameCrc16_MatchesCcittFalseCheckValue(void) {
+    const char *check = "123456789";
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, frameCrc16(0xFFFF, (const uint8_t *)check, strlen(check)));
+}
+
+void test_frameEncode_RoundTripsPayloadWithZerosAndNewlines(void) {
+    const char payload[] = {'a', 0, '\n', 0, 0, 'z', (char)0xF0, '\n'};
+
+    size_t written = frameEncode(0x42, 7, payload, sizeof(payload), wire, sizeof(wire));
+
+    TEST_ASSERT_GREATER_THAN(0, written);
+    TEST_ASSERT_EQUAL_CHAR(FRAME_START_BYTE, wire[0]);
+    TEST_ASSERT_EQUAL_CHAR('\n', wire[written - 1]);
+    TEST_ASSERT_NULL(memchr(wire, '\n', written - 1));
+
+    Frame frame;
+    TEST_ASSERT_EQUAL(FRAME_OK, frameDecode(wire, written, &frame));
+    TEST_ASSERT_EQUAL_UINT8(0x42, frame.opcode);
+    TEST_ASSERT_EQUAL_UINT8(7, frame.seq);
+    TEST_ASSERT_EQUAL(sizeof(payload), frame.payloadLength);
+    TEST_ASSERT_EQUAL_MEMORY(payload, frame.payload, sizeof(payload));
+}
+
+void test_frameEncode_RoundTripsEmptyPayload(void) {
+    size_t written = frameEncode(FRAME_OP_READ_SETTINGS, 1, NULL, 0, wire, sizeof(wire));
+
+    Frame frame;
+    TEST_ASSERT_EQUAL(FRAME_OK, frameDecode(wire, written, &frame));
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_READ_SETTINGS, frame.opcode);
+    TEST_ASSERT_EQUAL(0, frame.payloadLength);
+}
+
+void test_frameEncode_RoundTripsPayloadLongerThanCobsBlock(void) {
+    static char payload[1000];
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        // long zero free runs force maximum length COBS blocks
+        payload[i] = (i % 300 == 299) ? 0 : (char)('A' + i % 26);
+    }
+
+    size_t written = frameEncode(0x02, 200, payload, sizeof(payload), wire, sizeof(wire));
+    TEST_ASSERT_NULL(memchr(wire, '\n', written - 1));
+
+    Frame frame;
+    TEST_ASSERT_EQUAL(FRAME_OK, frameDecode(wire, written, &frame));
+    TEST_ASSERT_EQUAL(sizeof(payload), frame.payloadLength);
+    TEST_ASSERT_EQUAL_MEMORY(payload, frame.payload, sizeof(payload));
+}
+
+void test_frameEncode_InPlaceWithHeadroom(void) {
+    static char expected[2000];
+    for (size_t i = 0; i < sizeof(expected); i++) {
+        expected[i] = (char)(i * 7);
+    }
+    memcpy(&wire[FRAME_HEADROOM], expected, sizeof(expected));
+
+    size_t written =
+        frameEncode(0x03, 9, &wire[FRAME_HEADROOM], sizeof(expected), wire, sizeof(wire));
+
+    Frame frame;
+    TEST_ASSERT_EQUAL(FRAME_OK, frameDecode(wire, written, &frame));
+    TEST_ASSERT_EQUAL(sizeof(expected), frame.payloadLength);
+    TEST_ASSERT_EQUAL_MEMORY(expected, frame.payload, sizeof(expected));
+}
+
+void test_frameEncode_FailsWhenOutputTooSmall(void) {
+    const char payload[] = "hello";
+    TEST_ASSERT_EQUAL(0, frameEncode(0x01, 0, payload, 5, wire, 8));
+}
+
+void test_frameDecode_DetectsCorruption(void) {
+    const char payload[] = "mode";
+    size_t written = frameEncode(0x02, 3, payload, 4, wire, sizeof(wire));
+    wire[5] ^= 0x01;
+
+    Frame frame;
+    TEST_ASSERT_EQUAL(FRAME_ERR_CRC, frameDecode(wire, written, &frame));
+}
+
+void test_frameDecode_RejectsTruncatedFrame(void) {
+    const char payload[] = "mode";
+    size_t written = frameEncode(0x02, 3, payload, 4, wire, sizeof(wire));
+
+    Frame frame;
+    TEST_ASSERT_NOT_EQUAL(FRAME_OK, frameDecode(wire, written - 4, &frame));
+    TEST_ASSERT_EQUAL(FRAME_ERR_MALFORMED, frameDecode(wire, 2, &frame));
+}
+
+void test_frameDecode_RejectsJsonLine(void) {
+    strcpy(wire, "{\"command\":\"readSettings\"}\n");
+
+    Frame frame;
+    TEST_ASSERT_EQUAL(FRAME_ERR_MALFORMED, frameDecode(wire, strlen(wire), &frame));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+    RUN_TEST(test_frameCrc16_MatchesCcittFalseCheckValue);
+    RUN_TEST(test_frameDecode_DetectsCorruption);
+    RUN_TEST(test_frameDecode_RejectsJsonLine);
+    RUN_TEST(test_frameDecode_RejectsTruncatedFrame);
+    RUN_TEST(test_frameEncode_FailsWhenOutputTooSmall);
+    RUN_TEST(test_frameEncode_InPlaceWithHeadroom);
+    RUN_TEST(test_frameEncode_RoundTripsEmptyPayload);
+    RUN_TEST(test_frameEncode_RoundTripsPayloadLongerThanCobsBlock);
+    RUN_TEST(test_frameEncode_RoundTripsPayloadWithZerosAndNewlines);
+    return UNITY_END();
+}
@@ -18,6 +18,8 @@ static ChipSettings mockSettings;
 static Button mockButton;
 static BQ25180 mockCharger;
 static MC3479 mockAccel;
+static I2CQueue mockI2c;
+static Telemetry mockTelemetry;
 static RGBLed mockCaseLed;
 static RGBLed mockFrontLed;
 static ChipState state;
@@ -30,13 +32,18 @@ static bool chipTickTimerEnabled = false;
 static bool caseLedTimerEnabled = false;
 static bool frontLedTimerEnabled = false;
 static bool usbClockEnabled = false;
+static bool lowPowerClockEnabled = false;
+// clock level seen by the last PWM timer start, PWM must never start at the low power clock
+static bool lowPowerClockAtPwmStart = false;
 static uint32_t chipTickTimerCallCount = 0;
 static uint32_t caseLedTimerCallCount = 0;
 static uint32_t frontLedTimerCallCount = 0;
 static uint32_t usbClockCallCount = 0;
+static uint32_t lowPowerClockCallCount = 0;
 static bool chargerTaskCalled = false;
 static ChargerTaskFlags lastChargerFlags;
-static bool lastModeTaskCanUpdateCaseLed = false;
+static uint32_t rgbComposeCallCount = 0;
+static bool composedAfterChargerTask = false;
 static ModeOutputs nextModeOutputs;
 static uint32_t enterStandbyModeCallCount = 0;
 static uint32_t enterStopModeCallCount = 0;
@@ -48,6 +55,13 @@ static bool mockWakeFromButton = false;
 static bool mockSystemResetCalled = false;
 static uint32_t mc3479DisableCallCount = 0;
 static uint32_t disableWatchdogCallCount = 0;
+static uint32_t i2cFlushCallCount = 0;
+static uint8_t telemetryEvents[8];
+static uint16_t telemetryValues[8];
+static uint8_t telemetryEventCount = 0;
+static uint32_t telemetryFlushCallCount = 0;
+static bool lockedBeforeTelemetryFlush = false;
+static uint8_t mockChargerFaults = 0;
 
 // Mock Function Implementations
 uint32_t mock_convertTicksToMs(uint32_t ticks) {
@@ -64,11 +78,19 @@ void mock_writeUsbSerial(const char *buf, size_t count) {
 
 // External Mocks (Functions called by chip_state.c)
 enum ChargeState mockChargeState = notConnected;
-enum ChargeState getChargingState(BQ25180 *dev, uint32_t milliseconds) {
-    (void)milliseconds;
+enum ChargeState getChargingState(const BQ25180 *dev) {
+    (void)dev;
     return mockChargeState;
 }
 
+static uint32_t mockChargerMsUntilNextRead = UINT32_MAX;
+static uint32_t lastChargerBudgetQueryMs = 0;
+uint32_t bq25180MsUntilNextRead(const BQ25180 *dev, uint32_t milliseconds) {
+    (void)dev;
+    lastChargerBudgetQueryMs = milliseconds;
+    return mockChargerMsUntilNextRead;
+}
+
 uint8_t lastLoadedModeIndex = 255;
 void loadMode(ModeManager *manager, uint8_t index) {
     lastLoadedModeIndex = index;
@@ -81,11 +103,17 @@ void mock_enableChipTickTimer(bool enable) {
 }
 
 void mock_enableCaseLedTimer(bool enable) {
+    if (enable) {
+        lowPowerClockAtPwmStart = lowPowerClockEnabled;
+    }
     caseLedTimerEnabled = enable;
     caseLedTimerCallCount++;
 }
 
 void mock_enableFrontLedTimer(bool enable) {
+    if (enable) {
+        lowPowerClockAtPwmStart = lowPowerClockEnabled;
+    }
     frontLedTimerEnabled = enable;
     frontLedTimerCallCount++;
 }
@@ -100,8 +128,13 @@ void mock_enableUsbClock(bool enable) {
     usbClockCallCount++;
 }
 
+void mock_enableLowPowerClock(bool enable) {
+    lowPowerClockEnabled = enable;
+    lowPowerClockCallCount++;
+}
+
 enum ButtonResult mockButtonResult = ignore;
-enum ButtonResult buttonInputTask(Button *button, uint32_t ms, bool interruptTriggered) {
+enum ButtonResult buttonInputTask(Button *button) {
     return mockButtonResult;
 }
 
@@ -131,6 +164,31 @@ void rgbSetWhiteBalance(RGBLed *device, RGBWhiteBalance whiteBalance) {
 bool mockLockCalled = false;
 void lock(BQ25180 *dev) {
     mockLockCalled = true;
+    lockedBeforeTelemetryFlush = telemetryFlushCallCount == 0;
+}
+
+uint8_t bq25180TakeFaults(BQ25180 *dev) {
+    (void)dev;
+    uint8_t faults = mockChargerFaults;
+    mockChargerFaults = 0;
+    return faults;
+}
+
+void telemetryRecord(
+    Telemetry *telemetry, uint8_t event, uint8_t arg, uint16_t value, uint32_t milliseconds) {
+    (void)telemetry;
+    (void)arg;
+    (void)milliseconds;
+    if (telemetryEventCount < sizeof(telemetryEvents)) {
+        telemetryEvents[telemetryEventCount] = event;
+        telemetryValues[telemetryEventCount] = value;
+        telemetryEventCount++;
+    }
+}
+
+void telemetryFlush(Telemetry *telemetry) {
+    (void)telemetry;
+    telemetryFlushCallCount++;
 }
 
 void disableWatchdog(BQ25180 *dev) {
@@ -138,12 +196,29 @@ void disableWatchdog(BQ25180 *dev) {
     disableWatchdogCallCount++;
 }
 
-void rgbTransientTask(RGBLed *led, uint32_t ms) {
+void rgbClearLayer(RGBLed *led, RGBLayer layer) {
+    led->layers[layer].active = false;
+}
+
+bool rgbLayerActive(const RGBLed *led, RGBLayer layer) {
+    return led->layers[layer].active;
 }
+
+void rgbCompose(RGBLed *led, uint32_t ms) {
+    (void)led;
+    (void)ms;
+    rgbComposeCallCount++;
+    composedAfterChargerTask = chargerTaskCalled;
+}
+
 void mc3479Disable(MC3479 *dev) {
     (void)dev;
     mc3479DisableCallCount++;
 }
+void i2cQueueFlush(I2CQueue *queue) {
+    (void)queue;
+    i2cFlushCallCount++;
+}
 void mc3479Task(MC3479 *dev, uint32_t ms) {
 }
 void chargerTask(BQ25180 *dev, uint32_t ms, ChargerTaskFlags flags) {
@@ -152,20 +227,39 @@ void chargerTask(BQ25180 *dev, uint32_t ms, ChargerTaskFlags flags) {
     chargerTaskCalled = true;
     lastChargerFlags = flags;
 }
-ModeOutputs modeTask(
-    ModeManager *manager,
-    uint32_t ms,
-    bool canUpdateFrontLed,
-    bool canUpdateCaseLed,
-    uint8_t equationEvalIntervalMs) {
+ModeOutputs modeTask(ModeManager *manager, uint32_t ms, uint8_t equationEvalIntervalMs) {
     (void)manager;
     (void)ms;
-    (void)canUpdateFrontLed;
-    lastModeTaskCanUpdateCaseLed = canUpdateCaseLed;
     (void)equationEvalIntervalMs;
     return nextModeOutputs;
 }
 
+static uint32_t mockModeIdleBudgetMs = 0;
+uint32_t modeIdleBudgetMs(ModeManager *manager) {
+    (void)manager;
+    return mockModeIdleBudgetMs;
+}
+
+static bool mockModeTakesButtonTap = false;
+static uint32_t modeButtonTapCount = 0;
+bool modeTakeButtonTap(ModeManager *manager) {
+    (void)manager;
+    modeButtonTapCount++;
+    return mockModeTakesButtonTap;
+}
+
+static bool lastModeCharging = false;
+void modeNoteCharging(ModeManager *manager, bool charging) {
+    (void)manager;
+    lastModeCharging = charging;
+}
+
+static bool mockModeNeedsFullSpeedClock = false;
+bool modeNeedsFullSpeedClock(ModeManager *manager) {
+    (void)manager;
+    return mockModeNeedsFullSpeedClock;
+}
+
 bool isFakeOff(ModeManager *manager) {
     return manager->currentModeIndex == FAKE_OFF_MODE_INDEX;
 }
@@ -174,6 +268,10 @@ bool mockIsEvaluatingButtonPress = false;
 bool isEvaluatingButtonPress(Button *button) {
     return mockIsEvaluatingButtonPress;
 }
+uint32_t mockButtonMsUntilNextResult = UINT32_MAX;
+uint32_t buttonMsUntilNextResult(Button *button) {
+    return mockButtonMsUntilNextResult;
+}
 
 void fakeOffMode(ModeManager *manager) {
     // isFakeOff() derives state from manager->currentModeIndex (set by loadMode).
@@ -229,13 +327,17 @@ void setUp(void) {
     caseLedTimerEnabled = false;
     frontLedTimerEnabled = false;
     usbClockEnabled = false;
+    lowPowerClockEnabled = false;
+    lowPowerClockAtPwmStart = false;
     chipTickTimerCallCount = 0;
     caseLedTimerCallCount = 0;
     frontLedTimerCallCount = 0;
     usbClockCallCount = 0;
+    lowPowerClockCallCount = 0;
     chargerTaskCalled = false;
     memset(&lastChargerFlags, 0, sizeof(lastChargerFlags));
-    lastModeTaskCanUpdateCaseLed = false;
+    rgbComposeCallCount = 0;
+    composedAfterChargerTask = false;
     enterStandbyModeCallCount = 0;
     enterStopModeCallCount = 0;
     autoOffTimerEnableCallCount = 0;
@@ -246,6 +348,13 @@ void setUp(void) {
     mockSystemResetCalled = false;
     mc3479DisableCallCount = 0;
     disableWatchdogCallCount = 0;
+    i2cFlushCallCount = 0;
+    memset(telemetryEvents, 0, sizeof(telemetryEvents));
+    memset(telemetryValues, 0, sizeof(telemetryValues));
+    telemetryEventCount = 0;
+    telemetryFlushCallCount = 0;
+    lockedBeforeTelemetryFlush = false;
+    mockChargerFaults = 0;
     nextModeOutputs = (ModeOutputs){
         .frontValid = false,
         .caseValid = false,
@@ -258,6 +367,14 @@ void setUp(void) {
     mockRgbShowSuccessCalled = false;
     mockLockCalled = false;
     mockIsEvaluatingButtonPress = false;
+    mockButtonMsUntilNextResult = UINT32_MAX;
+    mockModeIdleBudgetMs = 0;
+    mockChargerMsUntilNextRead = UINT32_MAX;
+    lastChargerBudgetQueryMs = 0;
+    mockModeNeedsFullSpeedClock = false;
+    mockModeTakesButtonTap = false;
+    modeButtonTapCount = 0;
+    lastModeCharging = false;
 
     state = (ChipState){0};  // Reset internal state
 
@@ -267,6 +384,8 @@ void setUp(void) {
         .button = &mockButton,
         .chargerIC = &mockCharger,
         .accel = &mockAccel,
+        .i2c = &mockI2c,
+        .telemetry = &mockTelemetry,
         .caseLed = &mockCaseLed,
         .frontLed = &mockFrontLed,
         .enableChipTickTimer = mock_enableChipTickTimer,
@@ -274,6 +393,7 @@ void setUp(void) {
         .enableFrontLedTimer = mock_enableFrontLedTimer,
         .enableAutoOffTimer = mock_enableAutoOffTimer,
         .enableUsbClock = mock_enableUsbClock,
+        .enableLowPowerClock = mock_enableLowPowerClock,
         .enterStandbyMode = enterStandbyMode,
         .waitForButtonWakeOrAutoLock = mock_waitForButtonWakeOrAutoLock,
         .systemReset = mock_systemReset,
@@ -325,6 +445,34 @@ void test_StateTask_ButtonResult_Clicked_WrapsModeIndex(void) {
     TEST_ASSERT_EQUAL_UINT8(0, lastLoadedModeIndex);
 }
 
+void test_StateTask_ButtonResult_Clicked_GoesToModeScriptWaitingOnButton(void) {
+    configureChipState(&state, mockDeps);
+
+    mockModeManager.currentModeIndex = 1;
+    mockSettings.modeCount = 5;
+    mockButtonResult = clicked;
+    mockModeTakesButtonTap = true;
+    lastLoadedModeIndex = 255;
+
+    stateTask(&state, 0, (StateTaskFlags){0});
+
+    TEST_ASSERT_TRUE(mockRgbShowSuccessCalled);
+    TEST_ASSERT_EQUAL_UINT32(1, modeButtonTapCount);
+    TEST_ASSERT_EQUAL_UINT8(255, lastLoadedModeIndex);
+}
+
+void test_StateTask_FeedsChargerPowerToMode(void) {
+    configureChipState(&state, mockDeps);
+
+    mockChargeState = constantCurrent;
+    stateTask(&state, 0, (StateTaskFlags){0});
+    TEST_ASSERT_TRUE(lastModeCharging);
+
+    mockChargeState = notConnected;
+    stateTask(&state, 10, (StateTaskFlags){0});
+    TEST_ASSERT_FALSE(lastModeCharging);
+}
+
 void test_StateTask_ButtonResult_Shutdown_EntersStandby_WhenNotCharging(void) {
     configureChipState(&state, mockDeps);
 
@@ -339,6 +487,7 @@ void test_StateTask_ButtonResult_Shutdown_EntersStandby_WhenNotCharging(void) {
     TEST_ASSERT_EQUAL_UINT32(1, autoOffTimerEnableCallCount);
     TEST_ASSERT_FALSE(autoOffTimerEnabled);
     TEST_ASSERT_EQUAL_UINT32(1, disableWatchdogCallCount);
+    TEST_ASSERT_EQUAL_UINT32(1, i2cFlushCallCount);
 }
 
 void test_StateTask_ButtonResult_Shutdown_EntersStopMode_WhenAutoLockEnabled(void) {
@@ -456,21 +605,38 @@ void test_StateTask_ChargeLedDisabled_WhenNotCharging(void) {
     TEST_ASSERT_FALSE(lastChargerFlags.chargeLedEnabled);
 }
 
-void test_StateTask_ModeTask_DisabledCaseLed_WhenFakeOff(void) {
+void test_StateTask_ComposesEachLedOnceAfterEverySource(void) {
     configureChipState(&state, mockDeps);
 
-    mockModeManager.currentModeIndex = FAKE_OFF_MODE_INDEX;
+    stateTask(&state, 0, (StateTaskFlags){0});
 
+    TEST_ASSERT_EQUAL_UINT32(2, rgbComposeCallCount);
+    TEST_ASSERT_TRUE(composedAfterChargerTask);
+}
+
+void test_StateTask_IndicatorLayerClearedOnceHoldEnds(void) {
+    configureChipState(&state, mockDeps);
+
+    mockButtonResult = indicateShutdown;
+    mockFrontLed.layers[RGB_LAYER_INDICATOR].active = true;
+    mockCaseLed.layers[RGB_LAYER_INDICATOR].active = true;
     stateTask(&state, 0, (StateTaskFlags){0});
+    TEST_ASSERT_TRUE(mockFrontLed.layers[RGB_LAYER_INDICATOR].active);
+    TEST_ASSERT_TRUE(mockCaseLed.layers[RGB_LAYER_INDICATOR].active);
 
-    TEST_ASSERT_FALSE(lastModeTaskCanUpdateCaseLed);
+    // released before the shutdown threshold
+    mockButtonResult = ignore;
+    stateTask(&state, 10, (StateTaskFlags){0});
+    TEST_ASSERT_FALSE(mockFrontLed.layers[RGB_LAYER_INDICATOR].active);
+    TEST_ASSERT_FALSE(mockCaseLed.layers[RGB_LAYER_INDICATOR].active);
 }
 
-void test_StateTask_ButtonInterrupt_EnablesCasePwm(void) {
+void test_StateTask_ButtonHold_EnablesCasePwm_OnlyForIndicator(void) {
     configureChipState(&state, mockDeps);
 
     mockChargeState = notConnected;
-    mockIsEvaluatingButtonPress = false;
+    mockIsEvaluatingButtonPress = true;
+    mockButtonResult = ignore;
     nextModeOutputs = (ModeOutputs){
         .frontValid = false,
         .caseValid = false,
@@ -478,8 +644,36 @@ void test_StateTask_ButtonInterrupt_EnablesCasePwm(void) {
     };
 
     stateTask(&state, 0, (StateTaskFlags){.buttonInterruptTriggered = true});
+    TEST_ASSERT_FALSE(caseLedTimerEnabled);
+
+    mockButtonResult = indicateShutdown;
+    stateTask(&state, 10, (StateTaskFlags){0});
+    TEST_ASSERT_TRUE(caseLedTimerEnabled);
+}
+
+void test_StateTask_StatusFlashOverBlackCase_EnablesCasePwm(void) {
+    configureChipState(&state, mockDeps);
 
+    mockChargeState = notConnected;
+    mockButtonResult = ignore;
+    // the off phase of a blink, black drops the case output
+    nextModeOutputs = (ModeOutputs){
+        .frontValid = false,
+        .caseValid = false,
+        .frontType = BULB,
+    };
+
+    stateTask(&state, 0, (StateTaskFlags){0});
+    TEST_ASSERT_FALSE(caseLedTimerEnabled);
+
+    // a click shows its success flash on the status layer
+    mockCaseLed.layers[RGB_LAYER_STATUS].active = true;
+    stateTask(&state, 10, (StateTaskFlags){0});
     TEST_ASSERT_TRUE(caseLedTimerEnabled);
+
+    mockCaseLed.layers[RGB_LAYER_STATUS].active = false;
+    stateTask(&state, 20, (StateTaskFlags){0});
+    TEST_ASSERT_FALSE(caseLedTimerEnabled);
 }
 
 void test_StateTask_ButtonHold_DoesNotEnableFrontPwm_WhileBulbPatternRuns(void) {
@@ -536,7 +730,7 @@ void test_StateTask_IndicateLock_EnablesFrontPwm(void) {
     TEST_ASSERT_TRUE(frontLedTimerEnabled);
 }
 
-void test_StateTask_ButtonInterrupt_EnablesChipTickTimer_WhenFakeOff(void) {
+void test_StateTask_ButtonHold_EnablesChipTickTimer_OnlyForIndicator_WhenFakeOff(void) {
     configureChipState(&state, mockDeps);
 
     mockChargeState = notConnected;
@@ -552,9 +746,15 @@ void test_StateTask_ButtonInterrupt_EnablesChipTickTimer_WhenFakeOff(void) {
     stateTask(&state, 0, (StateTaskFlags){0});
     TEST_ASSERT_FALSE(chipTickTimerEnabled);
 
-    // Button interrupt fires — chip tick should be enabled to service the press
-    chipTickTimerCallCount = 0;
+    // The press is timed from its edges, the chip tick stays off while it is held
+    mockIsEvaluatingButtonPress = true;
     stateTask(&state, 10, (StateTaskFlags){.buttonInterruptTriggered = true});
+    TEST_ASSERT_FALSE(chipTickTimerEnabled);
+
+    // Indicators animate on the chip tick
+    chipTickTimerCallCount = 0;
+    mockButtonResult = indicateShutdown;
+    stateTask(&state, 20, (StateTaskFlags){0});
     TEST_ASSERT_TRUE(chipTickTimerEnabled);
     TEST_ASSERT_GREATER_THAN_UINT32(0, chipTickTimerCallCount);
 }
@@ -569,6 +769,58 @@ void test_StateTask_ButtonResult_Lock_LocksCharger(void) {
     TEST_ASSERT_TRUE(mockLockCalled);
 }
 
+void test_Telemetry_RecordsChargeStateChangesAndFaults(void) {
+    configureChipState(&state, mockDeps);
+
+    stateTask(&state, 0, (StateTaskFlags){0});
+    TEST_ASSERT_EQUAL_UINT8(0, telemetryEventCount);
+
+    mockChargeState = constantCurrent;
+    mockChargerFaults = 0x02;
+    stateTask(&state, 10, (StateTaskFlags){0});
+    stateTask(&state, 20, (StateTaskFlags){0});
+
+    TEST_ASSERT_EQUAL_UINT8(2, telemetryEventCount);
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_EVENT_CHARGE_STATE, telemetryEvents[0]);
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_EVENT_CHARGER_FAULT, telemetryEvents[1]);
+    TEST_ASSERT_EQUAL_UINT16(0x02, telemetryValues[1]);
+}
+
+void test_Telemetry_RecordsModeChanges(void) {
+    configureChipState(&state, mockDeps);
+    mockSettings.modeCount = 3;
+    mockButtonResult = clicked;
+
+    stateTask(&state, 0, (StateTaskFlags){0});
+
+    TEST_ASSERT_EQUAL_UINT8(1, telemetryEventCount);
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_EVENT_MODE_CHANGED, telemetryEvents[0]);
+}
+
+void test_Telemetry_FlushedBeforeLockCutsPower(void) {
+    configureChipState(&state, mockDeps);
+    mockButtonResult = lockOrHardwareReset;
+
+    stateTask(&state, 0, (StateTaskFlags){0});
+
+    TEST_ASSERT_TRUE(mockLockCalled);
+    TEST_ASSERT_FALSE(lockedBeforeTelemetryFlush);
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_EVENT_LOCK, telemetryEvents[0]);
+}
+
+void test_Telemetry_FlushedBeforeStandby(void) {
+    configureChipState(&state, mockDeps);
+    mockSettings.shutdownPolicy = autoOffNoAutoLock;
+    mockSettings.minutesUntilAutoOff = 1;
+    state.ticksSinceLastUserActivity = 7;
+
+    stateTask(&state, 0, (StateTaskFlags){.autoOffTimerInterruptTriggered = true});
+
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_EVENT_AUTO_OFF, telemetryEvents[0]);
+    TEST_ASSERT_EQUAL_UINT32(1, telemetryFlushCallCount);
+    TEST_ASSERT_EQUAL_UINT32(1, enterStandbyModeCallCount);
+}
+
 void test_AutoOffTimer_DoesNothing_WhenManualShutdownOnly(void) {
     configureChipState(&state, mockDeps);
 
@@ -860,6 +1112,139 @@ void test_TimerPolicy_FrontBulbType_DisablesFrontTimer(void) {
         frontLedTimerEnabled, "front timer should be disabled after RGB→BULB transition");
 }
 
+// Stop mode idle budget
+
+static void setIdleTimers(void) {
+    configureChipState(&state, mockDeps);
+    state.lastChipTickEnabled = true;
+    state.lastCasePwmEnabled = false;
+    state.lastFrontPwmEnabled = false;
+    state.lastUsbClockEnabled = false;
+}
+
+void test_IdleBudget_ReturnsModeBudgetWhenNothingNeedsTimers(void) {
+    setIdleTimers();
+    mockModeIdleBudgetMs = 250;
+
+    TEST_ASSERT_EQUAL_UINT32(250, stateIdleBudgetMs(&state));
+}
+
+void test_IdleBudget_ClampedToMax(void) {
+    setIdleTimers();
+    mockModeIdleBudgetMs = UINT32_MAX;
+
+    TEST_ASSERT_EQUAL_UINT32(STOP_IDLE_MAX_MS, stateIdleBudgetMs(&state));
+}
+
+void test_IdleBudget_BoundedByNextChargerRead(void) {
+    setIdleTimers();
+    mockModeIdleBudgetMs = UINT32_MAX;
+    mockChargerMsUntilNextRead = 4000;
+    state.lastTaskMs = 1234;
+
+    TEST_ASSERT_EQUAL_UINT32(4000, stateIdleBudgetMs(&state));
+    TEST_ASSERT_EQUAL_UINT32(1234, lastChargerBudgetQueryMs);
+
+    // a failed status read is retried soon, too soon to be worth Stop mode
+    mockChargerMsUntilNextRead = STOP_IDLE_MIN_MS - 1;
+    TEST_ASSERT_EQUAL_UINT32(0, stateIdleBudgetMs(&state));
+}
+
+void test_IdleBudget_ZeroBelowMinimum(void) {
+    setIdleTimers();
+    mockModeIdleBudgetMs = STOP_IDLE_MIN_MS - 1;
+
+    TEST_ASSERT_EQUAL_UINT32(0, stateIdleBudgetMs(&state));
+}
+
+void test_IdleBudget_BoundedByHeldButtonThreshold(void) {
+    setIdleTimers();
+    mockModeIdleBudgetMs = 500;
+    mockButtonMsUntilNextResult = 120;
+
+    TEST_ASSERT_EQUAL_UINT32(120, stateIdleBudgetMs(&state));
+}
+
+void test_IdleBudget_ChipTickOff_WakesOnlyForHeldButton(void) {
+    setIdleTimers();
+    state.lastChipTickEnabled = false;
+    mockModeIdleBudgetMs = 50;
+
+    mockButtonMsUntilNextResult = 300;
+    TEST_ASSERT_EQUAL_UINT32(300, stateIdleBudgetMs(&state));
+
+    // nothing else would wake the chip for the threshold
+    mockButtonMsUntilNextResult = STOP_IDLE_MIN_MS - 1;
+    TEST_ASSERT_EQUAL_UINT32(STOP_IDLE_MIN_MS, stateIdleBudgetMs(&state));
+}
+
+void test_IdleBudget_ZeroWhileAnyTimerIsActive(void) {
+    mockModeIdleBudgetMs = 500;
+
+    setIdleTimers();
+    state.lastFrontPwmEnabled = true;
+    TEST_ASSERT_EQUAL_UINT32(0, stateIdleBudgetMs(&state));
+
+    setIdleTimers();
+    state.lastCasePwmEnabled = true;
+    TEST_ASSERT_EQUAL_UINT32(0, stateIdleBudgetMs(&state));
+
+    setIdleTimers();
+    state.lastUsbClockEnabled = true;
+    TEST_ASSERT_EQUAL_UINT32(0, stateIdleBudgetMs(&state));
+
+    setIdleTimers();
+    state.lastChipTickEnabled = false;
+    TEST_ASSERT_EQUAL_UINT32(0, stateIdleBudgetMs(&state));
+
+    setIdleTimers();
+    mockCaseLed.layers[RGB_LAYER_STATUS].active = true;
+    TEST_ASSERT_EQUAL_UINT32(0, stateIdleBudgetMs(&state));
+}
+
+// Clock governor
+
+void test_ClockPolicy_LowPowerClockWhileNoPwmIsNeeded(void) {
+    configureChipState(&state, mockDeps);
+
+    stateTask(&state, 0, (StateTaskFlags){0});
+    TEST_ASSERT_TRUE(lowPowerClockEnabled);
+
+    stateTask(&state, 10, (StateTaskFlags){0});
+    TEST_ASSERT_EQUAL_UINT32_MESSAGE(1, lowPowerClockCallCount, "clock set redundantly");
+}
+
+void test_ClockPolicy_RaisesClockBeforeStartingPwm(void) {
+    configureChipState(&state, mockDeps);
+    stateTask(&state, 0, (StateTaskFlags){0});
+    TEST_ASSERT_TRUE(lowPowerClockEnabled);
+
+    nextModeOutputs = (ModeOutputs){
+        .frontValid = true,
+        .caseValid = true,
+        .frontType = RGB,
+    };
+    stateTask(&state, 10, (StateTaskFlags){0});
+
+    TEST_ASSERT_TRUE(frontLedTimerEnabled);
+    TEST_ASSERT_TRUE(caseLedTimerEnabled);
+    TEST_ASSERT_FALSE(lowPowerClockEnabled);
+    TEST_ASSERT_FALSE(lowPowerClockAtPwmStart);
+}
+
+void test_ClockPolicy_FullSpeedForEquationsAndUsb(void) {
+    configureChipState(&state, mockDeps);
+
+    mockModeNeedsFullSpeedClock = true;
+    stateTask(&state, 0, (StateTaskFlags){0});
+    TEST_ASSERT_FALSE(lowPowerClockEnabled);
+
+    mockModeNeedsFullSpeedClock = false;
+    mockChargeState = constantCurrent;
+    stateTask(&state, 10, (StateTaskFlags){0});
+    TEST_ASSERT_FALSE(lowPowerClockEnabled);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_AutoOffTimer_AutoLock_StopsAutoOffTimer_BeforeStopMode);
@@ -867,15 +1252,26 @@ int main(void) {
     RUN_TEST(test_AutoOffTimer_DoesNothing_WhenFakeOff);
     RUN_TEST(test_AutoOffTimer_DoesNothing_WhenManualShutdownOnly);
     RUN_TEST(test_AutoOffTimer_EntersStandby_AfterTimeout_WhenAutoOffEnabled);
+    RUN_TEST(test_ClockPolicy_FullSpeedForEquationsAndUsb);
+    RUN_TEST(test_ClockPolicy_LowPowerClockWhileNoPwmIsNeeded);
+    RUN_TEST(test_ClockPolicy_RaisesClockBeforeStartingPwm);
     RUN_TEST(test_ConfigureChipState_WhenCharging_EntersFakeOff);
     RUN_TEST(test_ConfigureChipState_WhenNotCharging_LoadsModeZero);
+    RUN_TEST(test_IdleBudget_BoundedByHeldButtonThreshold);
+    RUN_TEST(test_IdleBudget_BoundedByNextChargerRead);
+    RUN_TEST(test_IdleBudget_ChipTickOff_WakesOnlyForHeldButton);
+    RUN_TEST(test_IdleBudget_ClampedToMax);
+    RUN_TEST(test_IdleBudget_ReturnsModeBudgetWhenNothingNeedsTimers);
+    RUN_TEST(test_IdleBudget_ZeroBelowMinimum);
+    RUN_TEST(test_IdleBudget_ZeroWhileAnyTimerIsActive);
     RUN_TEST(test_Settings_MinutesUntilAutoOff_ChangesTimeout);
     RUN_TEST(test_Settings_MinutesUntilLockAfterAutoOff_ChangesStopLockTimeout);
     RUN_TEST(test_Settings_ModeCount_LimitsModeCycling);
     RUN_TEST(test_StateTask_ButtonHold_DoesNotEnableFrontPwm_WhileBulbPatternRuns);
-    RUN_TEST(test_StateTask_ButtonInterrupt_EnablesCasePwm);
-    RUN_TEST(test_StateTask_ButtonInterrupt_EnablesChipTickTimer_WhenFakeOff);
+    RUN_TEST(test_StateTask_ButtonHold_EnablesCasePwm_OnlyForIndicator);
+    RUN_TEST(test_StateTask_ButtonHold_EnablesChipTickTimer_OnlyForIndicator_WhenFakeOff);
     RUN_TEST(test_StateTask_ButtonResult_Clicked_CyclesToNextMode);
+    RUN_TEST(test_StateTask_ButtonResult_Clicked_GoesToModeScriptWaitingOnButton);
     RUN_TEST(test_StateTask_ButtonResult_Clicked_WrapsModeIndex);
     RUN_TEST(test_StateTask_ButtonResult_Lock_LocksCharger);
     RUN_TEST(test_StateTask_ButtonResult_Shutdown_DisablesActiveTimers_BeforeLowPower);
@@ -885,11 +1281,18 @@ int main(void) {
     RUN_TEST(test_StateTask_ButtonResult_Shutdown_ForcesFrontLedLow_WhenFrontPwmAlreadyDisabled);
     RUN_TEST(test_StateTask_ButtonResult_Shutdown_ImmediateLock_SkipsStopMode);
     RUN_TEST(test_StateTask_ChargeLedDisabled_WhenNotCharging);
+    RUN_TEST(test_StateTask_ComposesEachLedOnceAfterEverySource);
+    RUN_TEST(test_StateTask_FeedsChargerPowerToMode);
     RUN_TEST(test_StateTask_IndicateLock_EnablesFrontPwm);
     RUN_TEST(test_StateTask_IndicateShutdown_EnablesFrontPwm);
-    RUN_TEST(test_StateTask_ModeTask_DisabledCaseLed_WhenFakeOff);
+    RUN_TEST(test_StateTask_IndicatorLayerClearedOnceHoldEnds);
     RUN_TEST(test_StateTask_Shutdown_ChargeLedEnabled_WhenCharging);
+    RUN_TEST(test_StateTask_StatusFlashOverBlackCase_EnablesCasePwm);
     RUN_TEST(test_StateTask_StopMode_ButtonWake_ResetsSystem);
+    RUN_TEST(test_Telemetry_FlushedBeforeLockCutsPower);
+    RUN_TEST(test_Telemetry_FlushedBeforeStandby);
+    RUN_TEST(test_Telemetry_RecordsChargeStateChangesAndFaults);
+    RUN_TEST(test_Telemetry_RecordsModeChanges);
     RUN_TEST(test_TimerPolicy_FrontBulbType_DisablesFrontTimer);
     RUN_TEST(test_TimerPolicy_SkipsRedundantCalls);
     return UNITY_END();
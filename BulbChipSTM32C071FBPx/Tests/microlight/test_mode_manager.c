@@ -49,10 +49,21 @@ void rgbShowUserColor(RGBLed *led, uint8_t r, uint8_t g, uint8_t b) {
     }
 }
 
+static bool mockCaseCovered;
+static bool mockFrontCovered;
+bool rgbLayerCovered(const RGBLed *led, RGBLayer layer, uint32_t milliseconds) {
+    return led == &mockFrontLed ? mockFrontCovered : mockCaseCovered;
+}
+
 bool isOverThreshold(MC3479 *dev, uint8_t threshold) {
     return mockAccelMagnitude > threshold;
 }
 
+static uint32_t mockMsUntilNextDrain = UINT32_MAX;
+uint32_t mc3479MsUntilNextDrain(const MC3479 *dev, uint32_t milliseconds) {
+    return mockMsUntilNextDrain;
+}
+
 void mock_writeToSerial(const char *buf, size_t count) {
     writeToSerialCalled = true;
     if (count >= sizeof(lastSerialBuffer)) {
@@ -88,6 +99,34 @@ void mock_readSavedMode(uint8_t mode, char buffer[], size_t length) {
             "{\"command\":\"writeMode\",\"index\":3,\"mode\":{\"name\":\"no_accel\",\"front\":{"
             "\"pattern\":{\"type\":\"simple\",\"name\":\"on\",\"duration\":100,\"changeAt\":[{"
             "\"ms\":0,\"output\":\"high\"}]}}}}");
+    } else if (mode == 4) {
+        // Keyframe fade
+        strcpy(
+            buffer,
+            "{\"command\":\"writeMode\",\"index\":4,\"mode\":{\"name\":\"fade\",\"front\":{"
+            "\"pattern\":{\"type\":\"keyframe\",\"name\":\"fade\",\"duration\":1000,"
+            "\"easing\":\"ease\",\"changeAt\":[{\"ms\":0,\"output\":\"#000000\"},"
+            "{\"ms\":500,\"output\":\"#FF8000\"}]}}}}");
+    } else if (mode == 5) {
+        // Script that leaves the trigger state after a timer
+        strcpy(
+            buffer,
+            "{\"command\":\"writeMode\",\"index\":5,\"mode\":{\"name\":\"script\",\"front\":{"
+            "\"pattern\":{\"type\":\"simple\",\"name\":\"on\",\"duration\":100,\"changeAt\":[{"
+            "\"ms\":0,\"output\":\"high\"}]}},\"accel\":{\"triggers\":[{\"threshold\":100,"
+            "\"front\":{\"pattern\":{\"type\":\"simple\",\"name\":\"flash\",\"duration\":100,"
+            "\"changeAt\":[{\"ms\":0,\"output\":\"low\"}]}}}]},\"script\":{\"transitions\":["
+            "{\"from\":0,\"to\":1,\"on\":\"accel\",\"threshold\":40},"
+            "{\"from\":1,\"to\":0,\"on\":\"timer\",\"ms\":2000}]}}}");
+    } else if (mode == 6) {
+        // Script with its own states, toggled by the button and the charger
+        strcpy(
+            buffer,
+            "{\"command\":\"writeMode\",\"index\":6,\"mode\":{\"name\":\"tap\",\"front\":{"
+            "\"pattern\":{\"type\":\"simple\",\"name\":\"on\",\"duration\":100,\"changeAt\":[{"
+            "\"ms\":0,\"output\":\"high\"}]}},\"script\":{\"states\":[{\"front\":0},{}],"
+            "\"transitions\":[{\"from\":0,\"to\":1,\"on\":\"button\"},"
+            "{\"from\":1,\"to\":0,\"on\":\"charge\"}]}}}");
     } else {
         // Default or empty
         strcpy(buffer, "");
@@ -97,6 +136,7 @@ void mock_readSavedMode(uint8_t mode, char buffer[], size_t length) {
 // Include source
 char testJsonBuf[TEST_JSON_BUFFER_SIZE];
 #include "../../Core/Src/microlight/mode_manager.c"
+#include "../../Core/Src/microlight/model/live_stream.c"
 #include "../../Core/Src/microlight/model/mode_state.c"
 
 void setUp(void) {
@@ -114,6 +154,9 @@ void setUp(void) {
     lastFrontRgbG = 0;
     lastFrontRgbB = 0;
     mockAccelMagnitude = 0;
+    mockCaseCovered = false;
+    mockFrontCovered = false;
+    mockMsUntilNextDrain = UINT32_MAX;
     writeToSerialCalled = false;
     memset(lastSerialBuffer, 0, sizeof(lastSerialBuffer));
     lastSerialCount = 0;
@@ -217,6 +260,7 @@ void test_UpdateMode_FrontLed_FollowsSimplePattern(void) {
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
     // Setup a simple pattern: High at 0ms, Low at 500ms
     manager.currentMode.hasFront = true;
@@ -235,11 +279,11 @@ void test_UpdateMode_FrontLed_FollowsSimplePattern(void) {
     manager.shouldResetState = false;
 
     // Test at 100ms (should be High)
-    modeTask(&manager, 100, true, true, 50);
+    modeTask(&manager, 100, 50);
     TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
 
     // Test at 600ms (should be Low)
-    modeTask(&manager, 600, true, true, 50);
+    modeTask(&manager, 600, 50);
     TEST_ASSERT_EQUAL_UINT8(0, lastWrittenBulbState);
 }
 
@@ -253,6 +297,7 @@ void test_UpdateMode_FrontRgb_EnablesFrontTimerAndWritesRgb(void) {
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
     manager.currentMode.hasFront = true;
     manager.currentMode.front.pattern.type = PATTERN_TYPE_SIMPLE;
@@ -267,7 +312,7 @@ void test_UpdateMode_FrontRgb_EnablesFrontTimerAndWritesRgb(void) {
     modeStateInitialize(&manager.modeState, &manager.currentMode, 0, NULL);
     manager.shouldResetState = false;
 
-    ModeOutputs outputs = modeTask(&manager, 100, true, true, 50);
+    ModeOutputs outputs = modeTask(&manager, 100, 50);
 
     TEST_ASSERT_EQUAL_UINT8(0, lastWrittenBulbState);
     TEST_ASSERT_EQUAL_UINT8(10, lastFrontRgbR);
@@ -287,6 +332,7 @@ void test_ModeTask_ReturnsCaseRgbActive(void) {
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
     manager.currentMode.hasCaseComp = true;
     manager.currentMode.caseComp.pattern.type = PATTERN_TYPE_SIMPLE;
@@ -301,11 +347,52 @@ void test_ModeTask_ReturnsCaseRgbActive(void) {
     modeStateInitialize(&manager.modeState, &manager.currentMode, 0, NULL);
     manager.shouldResetState = false;
 
-    ModeOutputs outputs = modeTask(&manager, 10, true, true, 50);
+    ModeOutputs outputs = modeTask(&manager, 10, 50);
 
     TEST_ASSERT_TRUE(outputs.caseValid);
 }
 
+void test_ModeTask_CoveredCase_SkipsEvaluationUntilShown(void) {
+    ModeManager manager;
+    modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
+
+    manager.currentMode.hasCaseComp = true;
+    manager.currentMode.caseComp.pattern.type = PATTERN_TYPE_SIMPLE;
+    manager.currentMode.caseComp.pattern.data.simple.duration = 200;
+    manager.currentMode.caseComp.pattern.data.simple.changeAtCount = 2;
+    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].ms = 0;
+    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].output.type = RGB;
+    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].output.data.rgb.r = 255;
+    manager.currentMode.caseComp.pattern.data.simple.changeAt[1].ms = 100;
+    manager.currentMode.caseComp.pattern.data.simple.changeAt[1].output.type = RGB;
+    manager.currentMode.caseComp.pattern.data.simple.changeAt[1].output.data.rgb.g = 255;
+
+    modeStateInitialize(&manager.modeState, &manager.currentMode, 0, NULL);
+    manager.shouldResetState = false;
+
+    TEST_ASSERT_TRUE(modeTask(&manager, 10, 50).caseValid);
+    TEST_ASSERT_EQUAL_UINT8(255, lastRgbR);
+
+    // a status covers the case LED, the last outputs stand and the pattern is left alone
+    mockCaseCovered = true;
+    TEST_ASSERT_TRUE(modeTask(&manager, 120, 50).caseValid);
+    TEST_ASSERT_EQUAL_UINT8(255, lastRgbR);
+    TEST_ASSERT_EQUAL_UINT32(10, manager.modeState.case_comp.syncedMs);
+
+    mockCaseCovered = false;
+    modeTask(&manager, 130, 50);
+    TEST_ASSERT_EQUAL_UINT8(0, lastRgbR);
+    TEST_ASSERT_EQUAL_UINT8(255, lastRgbG);
+}
+
 void test_ModeTask_NoFrontComponent_ClearsBulbAndFrontOutput(void) {
     ModeManager manager;
     modeManagerInit(
@@ -316,11 +403,12 @@ void test_ModeTask_NoFrontComponent_ClearsBulbAndFrontOutput(void) {
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
     manager.currentMode.hasFront = false;
     lastWrittenBulbState = 1;
 
-    ModeOutputs outputs = modeTask(&manager, 10, true, true, 50);
+    ModeOutputs outputs = modeTask(&manager, 10, 50);
 
     TEST_ASSERT_EQUAL_UINT8(0, lastWrittenBulbState);
     TEST_ASSERT_FALSE(outputs.frontValid);
@@ -336,6 +424,7 @@ void test_FrontPattern_ContinuesDuringTriggerOverride(void) {
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
     manager.currentMode.hasFront = true;
     manager.currentMode.front.pattern.type = PATTERN_TYPE_SIMPLE;
@@ -364,18 +453,18 @@ void test_FrontPattern_ContinuesDuringTriggerOverride(void) {
     manager.shouldResetState = false;
 
     mockAccelMagnitude = 0;
-    modeTask(&manager, 100, true, true, 50);
+    modeTask(&manager, 100, 50);
     TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
 
     mockAccelMagnitude = 20;
-    modeTask(&manager, 600, true, true, 50);
+    modeTask(&manager, 600, 50);
     TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
 
-    modeTask(&manager, 1200, true, true, 50);
+    modeTask(&manager, 1200, 50);
     TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
 
     mockAccelMagnitude = 0;
-    modeTask(&manager, 1300, true, true, 50);
+    modeTask(&manager, 1300, 50);
     TEST_ASSERT_EQUAL_UINT8(0, lastWrittenBulbState);
 }
 
@@ -389,6 +478,7 @@ void test_UpdateMode_CaseLed_FollowsSimplePattern(void) {
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
     // Setup a simple pattern for Case LED
     manager.currentMode.hasCaseComp = true;
@@ -405,7 +495,7 @@ void test_UpdateMode_CaseLed_FollowsSimplePattern(void) {
     manager.shouldResetState = false;
 
     // Test at 100ms
-    modeTask(&manager, 100, true, true, 50);
+    modeTask(&manager, 100, 50);
 
     TEST_ASSERT_EQUAL_UINT8(255, lastRgbR);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbG);
@@ -422,6 +512,7 @@ void test_UpdateMode_CaseLed_Off_WhenNoPattern(void) {
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
     manager.currentMode.hasCaseComp = false;
 
@@ -433,52 +524,13 @@ void test_UpdateMode_CaseLed_Off_WhenNoPattern(void) {
     modeStateInitialize(&manager.modeState, &manager.currentMode, 0, NULL);
     manager.shouldResetState = false;
 
-    modeTask(&manager, 100, true, true, 50);
+    modeTask(&manager, 100, 50);
 
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbR);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbG);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbB);
 }
 
-void test_UpdateMode_CaseLed_NotUpdated_WhenButtonEvaluating(void) {
-    ModeManager manager;
-    modeManagerInit(
-        &manager,
-        &mockAccel,
-        &mockCaseLed,
-        &mockFrontLed,
-        mock_readSavedMode,
-        mock_writeBulbLedPin,
-        mock_writeToSerial);
-
-    // Setup pattern
-    manager.currentMode.hasCaseComp = true;
-    manager.currentMode.caseComp.pattern.type = PATTERN_TYPE_SIMPLE;
-    manager.currentMode.caseComp.pattern.data.simple.duration = 1000;
-    manager.currentMode.caseComp.pattern.data.simple.changeAtCount = 1;
-    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].ms = 0;
-    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].output.type = RGB;
-    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].output.data.rgb.r = 255;
-    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].output.data.rgb.g = 255;
-    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].output.data.rgb.b = 255;
-
-    // Set last RGB to something else
-    lastRgbR = 50;
-    lastRgbG = 50;
-    lastRgbB = 50;
-
-    modeStateInitialize(&manager.modeState, &manager.currentMode, 0, NULL);
-    manager.shouldResetState = false;
-
-    // Pass false for canUpdateCaseLed
-    modeTask(&manager, 100, true, false, 50);
-
-    // Should NOT have updated to 255, 255, 255
-    TEST_ASSERT_EQUAL_UINT8(50, lastRgbR);
-    TEST_ASSERT_EQUAL_UINT8(50, lastRgbG);
-    TEST_ASSERT_EQUAL_UINT8(50, lastRgbB);
-}
-
 void test_UpdateMode_CaseLed_FollowsSimplePatternMultipleChanges(void) {
     ModeManager manager;
     modeManagerInit(
@@ -489,6 +541,7 @@ void test_UpdateMode_CaseLed_FollowsSimplePatternMultipleChanges(void) {
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
     // Setup a simple pattern for Case LED
     manager.currentMode.hasCaseComp = true;
@@ -521,25 +574,25 @@ void test_UpdateMode_CaseLed_FollowsSimplePatternMultipleChanges(void) {
     manager.shouldResetState = false;
 
     // Test at 100ms (Should be Red)
-    modeTask(&manager, 100, true, true, 50);
+    modeTask(&manager, 100, 50);
     TEST_ASSERT_EQUAL_UINT8(255, lastRgbR);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbG);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbB);
 
     // Test at 600ms (Should be Green)
-    modeTask(&manager, 600, true, true, 50);
+    modeTask(&manager, 600, 50);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbR);
     TEST_ASSERT_EQUAL_UINT8(255, lastRgbG);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbB);
 
     // Test at 1500ms (Should be Blue)
-    modeTask(&manager, 1500, true, true, 50);
+    modeTask(&manager, 1500, 50);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbR);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbG);
     TEST_ASSERT_EQUAL_UINT8(255, lastRgbB);
 
     // Test at 2100ms (Should be Red - loop back to 100ms)
-    modeTask(&manager, 2100, true, true, 50);
+    modeTask(&manager, 2100, 50);
     TEST_ASSERT_EQUAL_UINT8(255, lastRgbR);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbG);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbB);
@@ -555,6 +608,7 @@ void test_UpdateMode_AccelTrigger_OverridesPatterns_WhenThresholdMet(void) {
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
     // Setup Default Mode: Front OFF, Case OFF
     manager.currentMode.hasFront = true;
@@ -612,7 +666,7 @@ void test_UpdateMode_AccelTrigger_OverridesPatterns_WhenThresholdMet(void) {
     // Trigger the accel
     mockAccelMagnitude = 20;
 
-    modeTask(&manager, 100, true, true, 50);
+    modeTask(&manager, 100, 50);
 
     // Should be High and Red
     TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
@@ -633,6 +687,7 @@ void test_UpdateMode_AccelTrigger_DoesNotOverride_WhenThresholdNotMet(void) {
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
     // Setup Default Mode: Front OFF
     manager.currentMode.hasFront = true;
@@ -661,12 +716,62 @@ void test_UpdateMode_AccelTrigger_DoesNotOverride_WhenThresholdNotMet(void) {
     // Do NOT trigger the accel
     mockAccelMagnitude = 0;
 
-    modeTask(&manager, 100, true, true, 50);
+    modeTask(&manager, 100, 50);
 
     // Should be Low (Default)
     TEST_ASSERT_EQUAL_UINT8(0, lastWrittenBulbState);
 }
 
+void test_UpdateMode_AccelTrigger_HoldsForHoldMs(void) {
+    ModeManager manager;
+    modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
+
+    // Setup Default Mode: Front OFF
+    manager.currentMode.hasFront = true;
+    manager.currentMode.front.pattern.type = PATTERN_TYPE_SIMPLE;
+    manager.currentMode.front.pattern.data.simple.duration = 1000;
+    manager.currentMode.front.pattern.data.simple.changeAtCount = 1;
+    manager.currentMode.front.pattern.data.simple.changeAt[0].ms = 0;
+    manager.currentMode.front.pattern.data.simple.changeAt[0].output.type = BULB;
+    manager.currentMode.front.pattern.data.simple.changeAt[0].output.data.bulb = low;
+
+    // Setup Accel Trigger: Front ON, held for 300ms
+    manager.currentMode.hasAccel = true;
+    manager.currentMode.accel.triggersCount = 1;
+    manager.currentMode.accel.triggers[0].threshold = 10;
+    manager.currentMode.accel.triggers[0].hasHoldMs = true;
+    manager.currentMode.accel.triggers[0].holdMs = 300;
+    manager.currentMode.accel.triggers[0].hasFront = true;
+    manager.currentMode.accel.triggers[0].front = manager.currentMode.front;
+    manager.currentMode.accel.triggers[0].front.pattern.data.simple.changeAt[0].output.data.bulb =
+        high;
+
+    modeStateInitialize(&manager.modeState, &manager.currentMode, 0, NULL);
+    manager.shouldResetState = false;
+
+    mockAccelMagnitude = 20;
+    modeTask(&manager, 100, 50);
+    TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
+
+    // below the threshold again, latched until 400
+    mockAccelMagnitude = 0;
+    modeTask(&manager, 250, 50);
+    TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
+    TEST_ASSERT_EQUAL_UINT32(150, modeIdleBudgetMs(&manager));
+
+    modeTask(&manager, 400, 50);
+    TEST_ASSERT_EQUAL_UINT8(0, lastWrittenBulbState);
+    TEST_ASSERT_EQUAL_UINT8(0, manager.modeState.machine.state);
+}
+
 void test_UpdateMode_AccelTrigger_PartialOverride(void) {
     ModeManager manager;
     modeManagerInit(
@@ -677,6 +782,7 @@ void test_UpdateMode_AccelTrigger_PartialOverride(void) {
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
     // Setup Default Mode: Front OFF, Case BLUE
     manager.currentMode.hasFront = true;
@@ -718,7 +824,7 @@ void test_UpdateMode_AccelTrigger_PartialOverride(void) {
     // Trigger the accel
     mockAccelMagnitude = 20;
 
-    modeTask(&manager, 100, true, true, 50);
+    modeTask(&manager, 100, 50);
 
     // Should be High (Triggered) and Blue (Default)
     TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
@@ -736,6 +842,7 @@ void test_UpdateMode_AccelTrigger_UsesHighestMatchingTrigger_AssumingAscendingOr
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
     // Setup Default Mode: Case OFF
     manager.currentMode.hasCaseComp = true;
@@ -794,24 +901,140 @@ void test_UpdateMode_AccelTrigger_UsesHighestMatchingTrigger_AssumingAscendingOr
 
     // Case A: Accel = 5 (Below both) -> Default (OFF)
     mockAccelMagnitude = 5;
-    modeTask(&manager, 100, true, true, 50);
+    modeTask(&manager, 100, 50);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbR);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbB);
 
     // Case B: Accel = 15 (Above Trigger 0, Below Trigger 1) -> Trigger 0 (BLUE)
     mockAccelMagnitude = 15;
-    modeTask(&manager, 200, true, true, 50);
+    modeTask(&manager, 200, 50);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbR);
     TEST_ASSERT_EQUAL_UINT8(255, lastRgbB);
 
     // Case C: Accel = 25 (Above both) -> Trigger 1 (RED)
     mockAccelMagnitude = 25;
-    modeTask(&manager, 300, true, true, 50);
+    modeTask(&manager, 300, 50);
     TEST_ASSERT_EQUAL_UINT8(255, lastRgbR);
     TEST_ASSERT_EQUAL_UINT8(0, lastRgbB);
 }
 
-void test_ModeTask_CaseValid_False_WhenCanUpdateCaseLedFalse(void) {
+void test_ModeManager_Init_RejectsIdenticalCaseAndFrontLed(void) {
+    ModeManager manager;
+    RGBLed sharedLed;
+    memset(&sharedLed, 0, sizeof(RGBLed));
+
+    TEST_ASSERT_FALSE_MESSAGE(
+        modeManagerInit(
+            &manager,
+            &mockAccel,
+            &sharedLed,
+            &sharedLed,  // same pointer as caseLed
+            mock_readSavedMode,
+            mock_writeBulbLedPin,
+            mock_writeToSerial),
+        "modeManagerInit should reject caseLed == frontLed");
+}
+
+void test_ModeManager_LogsEquationCompileError(void) {
+    ModeManager manager;
+    TEST_ASSERT_TRUE(modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial));
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
+
+    manager.currentMode.hasFront = true;
+    manager.currentMode.front.pattern.type = PATTERN_TYPE_EQUATION;
+    EquationPattern *pattern = &manager.currentMode.front.pattern.data.equation;
+    pattern->red.sectionsCount = 1;
+    strcpy(pattern->red.sections[0].equation, "bad +");
+    pattern->red.sections[0].duration = 1000;
+
+    modeTask(&manager, 0, 50);
+
+    TEST_ASSERT_TRUE(writeToSerialCalled);
+    TEST_ASSERT_NOT_EQUAL_UINT32(0, lastSerialCount);
+    TEST_ASSERT_NOT_NULL(strstr(lastSerialBuffer, "front"));
+    TEST_ASSERT_NOT_NULL(strstr(lastSerialBuffer, "red"));
+}
+
+void test_ModeTask_LiveStream_OverridesModeOutputs(void) {
+    ModeManager manager;
+    TEST_ASSERT_TRUE(modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial));
+    loadMode(&manager, 3);
+
+    startLiveStream(&manager, 20, 1, 100);
+    const uint8_t frame[LIVE_STREAM_FRAME_SIZE] = {1, 2, 3, 4, 5, 6};
+    liveStreamPush(&manager.liveStream, frame, 100);
+    ModeOutputs outputs = modeTask(&manager, 100, 50);
+
+    TEST_ASSERT_TRUE(outputs.frontValid);
+    TEST_ASSERT_EQUAL_UINT8(RGB, outputs.frontType);
+    TEST_ASSERT_TRUE(outputs.caseValid);
+    TEST_ASSERT_EQUAL_UINT8(0, lastWrittenBulbState);
+    TEST_ASSERT_EQUAL_UINT8(1, lastFrontRgbR);
+    TEST_ASSERT_EQUAL_UINT8(3, lastFrontRgbB);
+    TEST_ASSERT_EQUAL_UINT8(4, lastRgbR);
+    TEST_ASSERT_EQUAL_UINT8(6, lastRgbB);
+}
+
+void test_ModeTask_LiveStream_TimeoutResumesMode(void) {
+    ModeManager manager;
+    TEST_ASSERT_TRUE(modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial));
+    loadMode(&manager, 3);
+    modeTask(&manager, 0, 50);
+
+    startLiveStream(&manager, 20, 1, 100);
+    modeTask(&manager, 100, 50);
+    ModeOutputs outputs = modeTask(&manager, 100 + LIVE_STREAM_TIMEOUT_MS, 50);
+
+    TEST_ASSERT_FALSE(manager.liveStream.active);
+    TEST_ASSERT_TRUE(outputs.frontValid);
+    TEST_ASSERT_EQUAL_UINT8(BULB, outputs.frontType);
+    TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
+}
+
+void test_ModeManager_StartLiveStream_LeavesFakeOff(void) {
+    ModeManager manager;
+    TEST_ASSERT_TRUE(modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial));
+    fakeOffMode(&manager);
+
+    startLiveStream(&manager, 20, 1, 0);
+
+    TEST_ASSERT_FALSE(isFakeOff(&manager));
+    TEST_ASSERT_TRUE(manager.liveStream.active);
+
+    stopLiveStream(&manager);
+    TEST_ASSERT_FALSE(manager.liveStream.active);
+    TEST_ASSERT_TRUE(manager.shouldResetState);
+}
+
+void test_ModeTask_BlackRgb_ReleasesFrontAndCaseOutputs(void) {
     ModeManager manager;
     modeManagerInit(
         &manager,
@@ -821,35 +1044,112 @@ void test_ModeTask_CaseValid_False_WhenCanUpdateCaseLedFalse(void) {
         mock_readSavedMode,
         mock_writeBulbLedPin,
         mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
-    // Setup active case pattern that would produce caseValid=true
+    manager.currentMode.hasFront = true;
+    manager.currentMode.front.pattern.type = PATTERN_TYPE_SIMPLE;
+    manager.currentMode.front.pattern.data.simple.duration = 1000;
+    manager.currentMode.front.pattern.data.simple.changeAtCount = 1;
+    manager.currentMode.front.pattern.data.simple.changeAt[0].output.type = RGB;
     manager.currentMode.hasCaseComp = true;
-    manager.currentMode.caseComp.pattern.type = PATTERN_TYPE_SIMPLE;
-    manager.currentMode.caseComp.pattern.data.simple.duration = 1000;
-    manager.currentMode.caseComp.pattern.data.simple.changeAtCount = 1;
-    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].ms = 0;
-    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].output.type = RGB;
-    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].output.data.rgb.r = 100;
-    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].output.data.rgb.g = 200;
-    manager.currentMode.caseComp.pattern.data.simple.changeAt[0].output.data.rgb.b = 50;
+    manager.currentMode.caseComp = manager.currentMode.front;
 
     modeStateInitialize(&manager.modeState, &manager.currentMode, 0, NULL);
     manager.shouldResetState = false;
 
-    // canUpdateCaseLed=false should suppress case output
-    ModeOutputs outputs = modeTask(&manager, 100, true, false, 50);
+    ModeOutputs outputs = modeTask(&manager, 10, 50);
 
-    TEST_ASSERT_FALSE_MESSAGE(
-        outputs.caseValid, "caseValid should be false when canUpdateCaseLed is false");
+    TEST_ASSERT_FALSE(outputs.frontValid);
+    TEST_ASSERT_FALSE(outputs.caseValid);
+}
+
+static Mode solidColorMode(RGBSimpleOutput front, bool hasCase, RGBSimpleOutput caseColor) {
+    Mode mode;
+    memset(&mode, 0, sizeof(mode));
+    mode.hasFront = true;
+    mode.front.pattern.type = PATTERN_TYPE_SIMPLE;
+    mode.front.pattern.data.simple.duration = 1000;
+    mode.front.pattern.data.simple.changeAtCount = 1;
+    mode.front.pattern.data.simple.changeAt[0].output.type = RGB;
+    mode.front.pattern.data.simple.changeAt[0].output.data.rgb = front;
+    mode.hasCaseComp = hasCase;
+    mode.caseComp = mode.front;
+    mode.caseComp.pattern.data.simple.changeAt[0].output.data.rgb = caseColor;
+    return mode;
+}
+
+void test_ModeTask_Crossfade_BlendsFromShownColorsToNewMode(void) {
+    ModeManager manager;
+    modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial);
+
+    Mode outgoing = solidColorMode((RGBSimpleOutput){.r = 200}, true, (RGBSimpleOutput){.b = 100});
+    setMode(&manager, &outgoing, 1);
+    modeTask(&manager, 0, 50);
+    TEST_ASSERT_EQUAL_UINT8(200, lastFrontRgbR);
+
+    manager.crossfadeMs = 200;
+
+    // the new mode has no case component, the case LED fades out
+    Mode incoming = solidColorMode((RGBSimpleOutput){.b = 200}, false, (RGBSimpleOutput){0});
+    setMode(&manager, &incoming, 2);
+
+    modeTask(&manager, 1000, 50);
+    TEST_ASSERT_EQUAL_UINT8(200, lastFrontRgbR);
+    TEST_ASSERT_EQUAL_UINT8(0, lastFrontRgbB);
+
+    ModeOutputs outputs = modeTask(&manager, 1100, 50);
+    TEST_ASSERT_EQUAL_UINT8(100, lastFrontRgbR);
+    TEST_ASSERT_EQUAL_UINT8(100, lastFrontRgbB);
+    TEST_ASSERT_EQUAL_UINT8(50, lastRgbB);
+    TEST_ASSERT_TRUE(outputs.caseValid);
+    TEST_ASSERT_EQUAL_UINT32(0, modeIdleBudgetMs(&manager));
+
+    outputs = modeTask(&manager, 1200, 50);
+    TEST_ASSERT_EQUAL_UINT8(0, lastFrontRgbR);
+    TEST_ASSERT_EQUAL_UINT8(200, lastFrontRgbB);
+    TEST_ASSERT_FALSE(outputs.caseValid);
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, modeIdleBudgetMs(&manager));
+}
+
+void test_ModeTask_Crossfade_LongerThanUint8(void) {
+    ModeManager manager;
+    modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial);
 
-    // Verify it IS true when canUpdateCaseLed=true (same state)
-    ModeOutputs outputsEnabled = modeTask(&manager, 200, true, true, 50);
+    Mode outgoing = solidColorMode((RGBSimpleOutput){.r = 200}, false, (RGBSimpleOutput){0});
+    setMode(&manager, &outgoing, 1);
+    modeTask(&manager, 0, 50);
 
-    TEST_ASSERT_TRUE_MESSAGE(
-        outputsEnabled.caseValid, "caseValid should be true when canUpdateCaseLed is true");
+    manager.crossfadeMs = 1000;
+    Mode incoming = solidColorMode((RGBSimpleOutput){.b = 200}, false, (RGBSimpleOutput){0});
+    setMode(&manager, &incoming, 2);
+    modeTask(&manager, 1000, 50);
+
+    modeTask(&manager, 1500, 50);
+    TEST_ASSERT_EQUAL_UINT8(100, lastFrontRgbR);
+    TEST_ASSERT_EQUAL_UINT8(100, lastFrontRgbB);
+    TEST_ASSERT_TRUE(manager.crossfade.active);
+
+    modeTask(&manager, 2000, 50);
+    TEST_ASSERT_EQUAL_UINT8(0, lastFrontRgbR);
+    TEST_ASSERT_EQUAL_UINT8(200, lastFrontRgbB);
+    TEST_ASSERT_FALSE(manager.crossfade.active);
 }
 
-void test_ModeTask_FrontValid_False_WhenCanUpdateFrontLedFalse(void) {
+void test_ModeTask_Crossfade_OffSwitchesAtOnce(void) {
     ModeManager manager;
     modeManagerInit(
         &manager,
@@ -860,64 +1160,157 @@ void test_ModeTask_FrontValid_False_WhenCanUpdateFrontLedFalse(void) {
         mock_writeBulbLedPin,
         mock_writeToSerial);
 
-    // Setup active front pattern that would produce frontValid=true and write the front LED
+    Mode outgoing = solidColorMode((RGBSimpleOutput){.r = 200}, false, (RGBSimpleOutput){0});
+    setMode(&manager, &outgoing, 1);
+    modeTask(&manager, 0, 50);
+
+    Mode incoming = solidColorMode((RGBSimpleOutput){.b = 200}, false, (RGBSimpleOutput){0});
+    setMode(&manager, &incoming, 2);
+    modeTask(&manager, 1000, 50);
+
+    TEST_ASSERT_FALSE(manager.crossfade.active);
+    TEST_ASSERT_EQUAL_UINT8(0, lastFrontRgbR);
+    TEST_ASSERT_EQUAL_UINT8(200, lastFrontRgbB);
+}
+
+void test_ModeIdleBudget_UsesSoonestComponentChange(void) {
+    ModeManager manager;
+    modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
+
     manager.currentMode.hasFront = true;
     manager.currentMode.front.pattern.type = PATTERN_TYPE_SIMPLE;
     manager.currentMode.front.pattern.data.simple.duration = 1000;
-    manager.currentMode.front.pattern.data.simple.changeAtCount = 1;
-    manager.currentMode.front.pattern.data.simple.changeAt[0].ms = 0;
-    manager.currentMode.front.pattern.data.simple.changeAt[0].output.type = RGB;
-    manager.currentMode.front.pattern.data.simple.changeAt[0].output.data.rgb.r = 10;
-    manager.currentMode.front.pattern.data.simple.changeAt[0].output.data.rgb.g = 20;
-    manager.currentMode.front.pattern.data.simple.changeAt[0].output.data.rgb.b = 30;
+    manager.currentMode.front.pattern.data.simple.changeAtCount = 2;
+    manager.currentMode.front.pattern.data.simple.changeAt[1].ms = 500;
+    manager.currentMode.hasCaseComp = true;
+    manager.currentMode.caseComp = manager.currentMode.front;
+    manager.currentMode.caseComp.pattern.data.simple.changeAt[1].ms = 200;
 
     modeStateInitialize(&manager.modeState, &manager.currentMode, 0, NULL);
     manager.shouldResetState = false;
 
-    // canUpdateFrontLed=false should suppress front output and not exercise write paths
-    ModeOutputs outputs = modeTask(&manager, 100, false, true, 50);
+    TEST_ASSERT_EQUAL_UINT32(200, modeIdleBudgetMs(&manager));
 
-    TEST_ASSERT_FALSE_MESSAGE(
-        outputs.frontValid, "frontValid should be false when canUpdateFrontLed is false");
-    // Front LED write paths must not run: sentinel/zero values from setUp stay untouched
-    TEST_ASSERT_EQUAL_UINT8_MESSAGE(
-        255, lastWrittenBulbState, "bulb pin must not be written when canUpdateFrontLed is false");
-    TEST_ASSERT_EQUAL_UINT8_MESSAGE(
-        0, lastFrontRgbR, "front RGB must not be written when canUpdateFrontLed is false");
-    TEST_ASSERT_EQUAL_UINT8_MESSAGE(
-        0, lastFrontRgbG, "front RGB must not be written when canUpdateFrontLed is false");
-    TEST_ASSERT_EQUAL_UINT8_MESSAGE(
-        0, lastFrontRgbB, "front RGB must not be written when canUpdateFrontLed is false");
-
-    // Verify it IS true and writes the front LED when canUpdateFrontLed=true (same state)
-    ModeOutputs outputsEnabled = modeTask(&manager, 200, true, true, 50);
-
-    TEST_ASSERT_TRUE_MESSAGE(
-        outputsEnabled.frontValid, "frontValid should be true when canUpdateFrontLed is true");
-    TEST_ASSERT_EQUAL_UINT8(RGB, outputsEnabled.frontType);
-    TEST_ASSERT_EQUAL_UINT8(10, lastFrontRgbR);
-    TEST_ASSERT_EQUAL_UINT8(20, lastFrontRgbG);
-    TEST_ASSERT_EQUAL_UINT8(30, lastFrontRgbB);
+    manager.currentMode.hasCaseComp = false;
+    modeStateInitialize(&manager.modeState, &manager.currentMode, 0, NULL);
+    TEST_ASSERT_EQUAL_UINT32(500, modeIdleBudgetMs(&manager));
+
+    // accel modes sleep until the next FIFO drain
+    manager.currentMode.hasAccel = true;
+    manager.currentMode.accel.triggersCount = 1;
+    modeStateInitialize(&manager.modeState, &manager.currentMode, 0, NULL);
+    mockMsUntilNextDrain = 80;
+    TEST_ASSERT_EQUAL_UINT32(80, modeIdleBudgetMs(&manager));
+    mockMsUntilNextDrain = 0;
+    TEST_ASSERT_EQUAL_UINT32(0, modeIdleBudgetMs(&manager));
+
+    manager.currentMode.hasAccel = false;
+    manager.shouldResetState = true;
+    TEST_ASSERT_EQUAL_UINT32(0, modeIdleBudgetMs(&manager));
 }
 
-void test_ModeManager_Init_RejectsIdenticalCaseAndFrontLed(void) {
+void test_ModeIdleBudget_UsesActiveAccelTriggerComponents(void) {
     ModeManager manager;
-    RGBLed sharedLed;
-    memset(&sharedLed, 0, sizeof(RGBLed));
+    modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
 
-    TEST_ASSERT_FALSE_MESSAGE(
-        modeManagerInit(
-            &manager,
-            &mockAccel,
-            &sharedLed,
-            &sharedLed,  // same pointer as caseLed
-            mock_readSavedMode,
-            mock_writeBulbLedPin,
-            mock_writeToSerial),
-        "modeManagerInit should reject caseLed == frontLed");
+    manager.currentMode.hasFront = true;
+    manager.currentMode.front.pattern.type = PATTERN_TYPE_SIMPLE;
+    manager.currentMode.front.pattern.data.simple.duration = 1000;
+    manager.currentMode.front.pattern.data.simple.changeAtCount = 2;
+    manager.currentMode.front.pattern.data.simple.changeAt[1].ms = 500;
+    manager.currentMode.hasAccel = true;
+    manager.currentMode.accel.triggersCount = 1;
+    manager.currentMode.accel.triggers[0].threshold = 10;
+    manager.currentMode.accel.triggers[0].hasFront = true;
+    manager.currentMode.accel.triggers[0].front.pattern.type = PATTERN_TYPE_EQUATION;
+
+    modeStateInitialize(&manager.modeState, &manager.currentMode, 0, NULL);
+    manager.shouldResetState = false;
+    mockMsUntilNextDrain = 80;
+
+    mockAccelMagnitude = 0;
+    TEST_ASSERT_EQUAL_UINT32(80, modeIdleBudgetMs(&manager));
+
+    // the budget is for the state the last modeTask left, only modeTask steps the machine
+    mockAccelMagnitude = 20;
+    TEST_ASSERT_EQUAL_UINT32(80, modeIdleBudgetMs(&manager));
+    TEST_ASSERT_EQUAL_UINT8(0, manager.modeState.machine.state);
+
+    // an equation trigger pattern keeps the MCU awake while it plays
+    modeTask(&manager, 0, 50);
+    TEST_ASSERT_EQUAL_UINT8(1, manager.modeState.machine.state);
+    TEST_ASSERT_EQUAL_UINT32(0, modeIdleBudgetMs(&manager));
 }
 
-void test_ModeManager_LogsEquationCompileError(void) {
+void test_ModeAwakePermille_MeasuredSinceModeStarted(void) {
+    ModeManager manager;
+    modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
+
+    modeTask(&manager, 1000, 50);
+    TEST_ASSERT_EQUAL_UINT16(1000, modeAwakePermille(&manager, 1000));
+
+    modeNoteStopModeSleep(&manager, 750);
+    TEST_ASSERT_EQUAL_UINT16(250, modeAwakePermille(&manager, 2000));
+
+    // restarting the mode starts a new measurement
+    setMode(&manager, &manager.currentMode, 1);
+    TEST_ASSERT_EQUAL_UINT16(1000, modeAwakePermille(&manager, 2500));
+    modeTask(&manager, 2500, 50);
+    TEST_ASSERT_EQUAL_UINT16(1000, modeAwakePermille(&manager, 3500));
+}
+
+void test_ModeNeedsFullSpeedClock_OnlyForEquations(void) {
+    ModeManager manager;
+    modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
+
+    manager.currentMode.hasFront = true;
+    manager.currentMode.front.pattern.type = PATTERN_TYPE_SIMPLE;
+    TEST_ASSERT_FALSE(modeNeedsFullSpeedClock(&manager));
+
+    manager.currentMode.hasAccel = true;
+    manager.currentMode.accel.triggersCount = 1;
+    manager.currentMode.accel.triggers[0].hasCaseComp = true;
+    manager.currentMode.accel.triggers[0].caseComp.pattern.type = PATTERN_TYPE_EQUATION;
+    TEST_ASSERT_TRUE(modeNeedsFullSpeedClock(&manager));
+
+    manager.currentMode.hasAccel = false;
+    manager.currentMode.front.pattern.type = PATTERN_TYPE_EQUATION;
+    TEST_ASSERT_TRUE(modeNeedsFullSpeedClock(&manager));
+}
+
+void test_ModeManager_LoadMode_ParsesKeyframePatternWithoutFullSpeedClock(void) {
     ModeManager manager;
     TEST_ASSERT_TRUE(modeManagerInit(
         &manager,
@@ -928,42 +1321,194 @@ void test_ModeManager_LogsEquationCompileError(void) {
         mock_writeBulbLedPin,
         mock_writeToSerial));
 
+    loadMode(&manager, 4);
+
+    const ModePattern *pattern = &manager.currentMode.front.pattern;
+    TEST_ASSERT_EQUAL(PATTERN_TYPE_KEYFRAME, pattern->type);
+    TEST_ASSERT_EQUAL(KEYFRAME_EASING_EASE, pattern->data.keyframe.easing);
+    TEST_ASSERT_EQUAL_UINT8(2, pattern->data.keyframe.changeAtCount);
+    TEST_ASSERT_EQUAL_UINT8(0x80, pattern->data.keyframe.changeAt[1].output.data.rgb.g);
+    TEST_ASSERT_FALSE(modeNeedsFullSpeedClock(&manager));
+}
+
+void test_ModeManager_LoadMode_ParsesScript(void) {
+    ModeManager manager;
+    TEST_ASSERT_TRUE(modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial));
+
+    loadMode(&manager, 5);
+
+    TEST_ASSERT_TRUE(manager.currentMode.hasScript);
+    const ModeScript *script = &manager.currentMode.script;
+    TEST_ASSERT_EQUAL_UINT8(2, script->transitionsCount);
+    TEST_ASSERT_EQUAL(MODE_TRANSITION_EVENT_ACCEL, script->transitions[0].on);
+    TEST_ASSERT_EQUAL_UINT8(40, script->transitions[0].threshold);
+    TEST_ASSERT_FALSE(script->transitions[0].hasMs);
+    TEST_ASSERT_EQUAL(MODE_TRANSITION_EVENT_TIMER, script->transitions[1].on);
+    TEST_ASSERT_EQUAL_UINT8(1, script->transitions[1].from);
+    TEST_ASSERT_EQUAL_UINT32(2000, script->transitions[1].ms);
+}
+
+void test_ModeManager_LoadMode_ParsesScriptStates(void) {
+    ModeManager manager;
+    TEST_ASSERT_TRUE(modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial));
+
+    loadMode(&manager, 6);
+
+    const ModeScript *script = &manager.currentMode.script;
+    TEST_ASSERT_TRUE(script->hasStates);
+    TEST_ASSERT_EQUAL_UINT8(2, script->statesCount);
+    TEST_ASSERT_TRUE(script->states[0].hasFront);
+    TEST_ASSERT_EQUAL_UINT8(0, script->states[0].front);
+    TEST_ASSERT_FALSE(script->states[1].hasFront);
+    TEST_ASSERT_FALSE(script->states[1].hasCaseComp);
+    TEST_ASSERT_EQUAL(MODE_TRANSITION_EVENT_BUTTON, script->transitions[0].on);
+    TEST_ASSERT_EQUAL(MODE_TRANSITION_EVENT_CHARGE, script->transitions[1].on);
+}
+
+void test_ModeTask_Script_ButtonAndChargeMoveStates(void) {
+    ModeManager manager;
+    modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial);
+    loadMode(&manager, 6);
+    modeTask(&manager, 0, 50);
+    TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
+
+    // the tap is only taken while a button transition leaves the state, and moves it once
+    TEST_ASSERT_TRUE(modeTakeButtonTap(&manager));
+    modeTask(&manager, 10, 50);
+    TEST_ASSERT_EQUAL_UINT8(1, manager.modeState.machine.state);
+    TEST_ASSERT_EQUAL_UINT8(0, lastWrittenBulbState);
+    TEST_ASSERT_FALSE(modeTakeButtonTap(&manager));
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, modeIdleBudgetMs(&manager));
+
+    modeNoteCharging(&manager, true);
+    modeTask(&manager, 20, 50);
+    TEST_ASSERT_EQUAL_UINT8(0, manager.modeState.machine.state);
+    TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
+
+    // entered while charging, so it is unplugging that leaves the state this time
+    TEST_ASSERT_TRUE(modeTakeButtonTap(&manager));
+    modeTask(&manager, 30, 50);
+    modeTask(&manager, 40, 50);
+    TEST_ASSERT_EQUAL_UINT8(1, manager.modeState.machine.state);
+    modeNoteCharging(&manager, false);
+    modeTask(&manager, 50, 50);
+    TEST_ASSERT_EQUAL_UINT8(0, manager.modeState.machine.state);
+}
+
+void test_ModeTask_Script_TimerReturnsToFirstState(void) {
+    ModeManager manager;
+    modeManagerInit(
+        &manager,
+        &mockAccel,
+        &mockCaseLed,
+        &mockFrontLed,
+        mock_readSavedMode,
+        mock_writeBulbLedPin,
+        mock_writeToSerial);
+    memset(&manager.currentMode, 0, sizeof(manager.currentMode));
+
     manager.currentMode.hasFront = true;
-    manager.currentMode.front.pattern.type = PATTERN_TYPE_EQUATION;
-    EquationPattern *pattern = &manager.currentMode.front.pattern.data.equation;
-    pattern->red.sectionsCount = 1;
-    strcpy(pattern->red.sections[0].equation, "bad +");
-    pattern->red.sections[0].duration = 1000;
+    manager.currentMode.front.pattern.type = PATTERN_TYPE_SIMPLE;
+    manager.currentMode.front.pattern.data.simple.duration = 1000;
+    manager.currentMode.front.pattern.data.simple.changeAtCount = 1;
+    manager.currentMode.front.pattern.data.simple.changeAt[0].ms = 0;
+    manager.currentMode.front.pattern.data.simple.changeAt[0].output.type = BULB;
+    manager.currentMode.front.pattern.data.simple.changeAt[0].output.data.bulb = low;
 
-    modeTask(&manager, 0, true, true, 50);
+    // the trigger only supplies the component, the script decides when it shows
+    manager.currentMode.hasAccel = true;
+    manager.currentMode.accel.triggersCount = 1;
+    manager.currentMode.accel.triggers[0].threshold = 200;
+    manager.currentMode.accel.triggers[0].hasFront = true;
+    manager.currentMode.accel.triggers[0].front = manager.currentMode.front;
+    manager.currentMode.accel.triggers[0].front.pattern.data.simple.changeAt[0].output.data.bulb =
+        high;
 
-    TEST_ASSERT_TRUE(writeToSerialCalled);
-    TEST_ASSERT_NOT_EQUAL_UINT32(0, lastSerialCount);
-    TEST_ASSERT_NOT_NULL(strstr(lastSerialBuffer, "front"));
-    TEST_ASSERT_NOT_NULL(strstr(lastSerialBuffer, "red"));
+    manager.currentMode.hasScript = true;
+    manager.currentMode.script.transitionsCount = 2;
+    manager.currentMode.script.transitions[0] = (ModeTransition){
+        .from = 0,
+        .to = 1,
+        .on = MODE_TRANSITION_EVENT_ACCEL,
+        .threshold = 10,
+        .hasThreshold = true};
+    manager.currentMode.script.transitions[1] = (ModeTransition){
+        .from = 1, .to = 0, .on = MODE_TRANSITION_EVENT_TIMER, .ms = 200, .hasMs = true};
+
+    modeStateInitialize(&manager.modeState, &manager.currentMode, 0, NULL);
+    manager.shouldResetState = false;
+
+    mockAccelMagnitude = 20;
+    modeTask(&manager, 100, 50);
+    TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
+
+    // the timer runs from entering the state, not from the last jerk
+    mockAccelMagnitude = 0;
+    modeTask(&manager, 200, 50);
+    TEST_ASSERT_EQUAL_UINT8(1, lastWrittenBulbState);
+    TEST_ASSERT_EQUAL_UINT32(100, modeIdleBudgetMs(&manager));
+
+    modeTask(&manager, 300, 50);
+    TEST_ASSERT_EQUAL_UINT8(0, lastWrittenBulbState);
 }
 
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_FrontPattern_ContinuesDuringTriggerOverride);
+    RUN_TEST(test_ModeAwakePermille_MeasuredSinceModeStarted);
+    RUN_TEST(test_ModeIdleBudget_UsesActiveAccelTriggerComponents);
+    RUN_TEST(test_ModeIdleBudget_UsesSoonestComponentChange);
     RUN_TEST(test_ModeManager_FakeOff_SetsCorrectIndex_WithoutFlashRead);
     RUN_TEST(test_ModeManager_Init_RejectsIdenticalCaseAndFrontLed);
     RUN_TEST(test_ModeManager_IsFakeOff_ReturnsTrueForFakeOffIndex);
     RUN_TEST(test_ModeManager_LoadMode_DisablesAccel_IfModeHasNoAccel);
     RUN_TEST(test_ModeManager_LoadMode_EnablesAccel_IfModeHasAccel);
+    RUN_TEST(test_ModeManager_LoadMode_ParsesKeyframePatternWithoutFullSpeedClock);
+    RUN_TEST(test_ModeManager_LoadMode_ParsesScript);
+    RUN_TEST(test_ModeManager_LoadMode_ParsesScriptStates);
     RUN_TEST(test_ModeManager_LoadMode_ReadsFromStorage);
     RUN_TEST(test_ModeManager_LogsEquationCompileError);
-    RUN_TEST(test_ModeTask_CaseValid_False_WhenCanUpdateCaseLedFalse);
-    RUN_TEST(test_ModeTask_FrontValid_False_WhenCanUpdateFrontLedFalse);
+    RUN_TEST(test_ModeManager_StartLiveStream_LeavesFakeOff);
+    RUN_TEST(test_ModeNeedsFullSpeedClock_OnlyForEquations);
+    RUN_TEST(test_ModeTask_BlackRgb_ReleasesFrontAndCaseOutputs);
+    RUN_TEST(test_ModeTask_CoveredCase_SkipsEvaluationUntilShown);
+    RUN_TEST(test_ModeTask_Crossfade_BlendsFromShownColorsToNewMode);
+    RUN_TEST(test_ModeTask_Crossfade_LongerThanUint8);
+    RUN_TEST(test_ModeTask_Crossfade_OffSwitchesAtOnce);
+    RUN_TEST(test_ModeTask_LiveStream_OverridesModeOutputs);
+    RUN_TEST(test_ModeTask_LiveStream_TimeoutResumesMode);
     RUN_TEST(test_ModeTask_NoFrontComponent_ClearsBulbAndFrontOutput);
     RUN_TEST(test_ModeTask_ReturnsCaseRgbActive);
+    RUN_TEST(test_ModeTask_Script_ButtonAndChargeMoveStates);
+    RUN_TEST(test_ModeTask_Script_TimerReturnsToFirstState);
     RUN_TEST(test_UpdateMode_AccelTrigger_DoesNotOverride_WhenThresholdNotMet);
+    RUN_TEST(test_UpdateMode_AccelTrigger_HoldsForHoldMs);
     RUN_TEST(test_UpdateMode_AccelTrigger_OverridesPatterns_WhenThresholdMet);
     RUN_TEST(test_UpdateMode_AccelTrigger_PartialOverride);
     RUN_TEST(test_UpdateMode_AccelTrigger_UsesHighestMatchingTrigger_AssumingAscendingOrder);
     RUN_TEST(test_UpdateMode_CaseLed_FollowsSimplePattern);
     RUN_TEST(test_UpdateMode_CaseLed_FollowsSimplePatternMultipleChanges);
-    RUN_TEST(test_UpdateMode_CaseLed_NotUpdated_WhenButtonEvaluating);
     RUN_TEST(test_UpdateMode_CaseLed_Off_WhenNoPattern);
     RUN_TEST(test_UpdateMode_FrontLed_FollowsSimplePattern);
     RUN_TEST(test_UpdateMode_FrontRgb_EnablesFrontTimerAndWritesRgb);
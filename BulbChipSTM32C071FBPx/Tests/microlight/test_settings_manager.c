@@ -18,6 +18,8 @@ static ModeManager mockModeManager;
 static Button mockButton;
 static BQ25180 mockCharger;
 static MC3479 mockAccel;
+static I2CQueue mockI2c;
+static Telemetry mockTelemetry;
 static RGBLed mockCaseLed;
 static RGBLed mockFrontLed;
 static ChipState state;
@@ -68,13 +70,18 @@ void mock_enableAutoOffTimer(bool enable) {
 void mock_enableUsbClock(bool enable) {
 }
 
-enum ChargeState getChargingState(BQ25180 *dev, uint32_t milliseconds) {
-    (void)milliseconds;
+void mock_enableLowPowerClock(bool enable) {
+}
+
+enum ChargeState getChargingState(const BQ25180 *dev) {
     return notConnected;
 }
+uint32_t bq25180MsUntilNextRead(const BQ25180 *dev, uint32_t milliseconds) {
+    return UINT32_MAX;
+}
 void loadMode(ModeManager *manager, uint8_t index) {
 }
-enum ButtonResult buttonInputTask(Button *button, uint32_t ms, bool interruptTriggered) {
+enum ButtonResult buttonInputTask(Button *button) {
     return ignore;
 }
 void rgbShowSuccess(RGBLed *led) {
@@ -89,24 +96,32 @@ void lock(BQ25180 *dev) {
 }
 void disableWatchdog(BQ25180 *dev) {
 }
-void rgbTransientTask(RGBLed *led, uint32_t ms) {
+void rgbCompose(RGBLed *led, uint32_t ms) {
+}
+void rgbClearLayer(RGBLed *led, RGBLayer layer) {
+}
+bool rgbLayerActive(const RGBLed *led, RGBLayer layer) {
+    return false;
 }
 void mc3479Task(MC3479 *dev, uint32_t ms) {
 }
 void mc3479Disable(MC3479 *dev) {
 }
+void i2cQueueFlush(I2CQueue *queue) {
+}
+uint8_t bq25180TakeFaults(BQ25180 *dev) {
+    return 0;
+}
+void telemetryRecord(
+    Telemetry *telemetry, uint8_t event, uint8_t arg, uint16_t value, uint32_t milliseconds) {
+}
+void telemetryFlush(Telemetry *telemetry) {
+}
 void chargerTask(BQ25180 *dev, uint32_t ms, ChargerTaskFlags flags) {
 }
-ModeOutputs modeTask(
-    ModeManager *manager,
-    uint32_t ms,
-    bool canUpdateFrontLed,
-    bool canUpdateCaseLed,
-    uint8_t equationEvalIntervalMs) {
+ModeOutputs modeTask(ModeManager *manager, uint32_t ms, uint8_t equationEvalIntervalMs) {
     (void)manager;
     (void)ms;
-    (void)canUpdateFrontLed;
-    (void)canUpdateCaseLed;
     (void)equationEvalIntervalMs;
     return (ModeOutputs){
         .frontValid = false,
@@ -117,9 +132,23 @@ ModeOutputs modeTask(
 bool isFakeOff(ModeManager *manager) {
     return false;
 }
+uint32_t modeIdleBudgetMs(ModeManager *manager) {
+    return 0;
+}
+bool modeNeedsFullSpeedClock(ModeManager *manager) {
+    return false;
+}
+bool modeTakeButtonTap(ModeManager *manager) {
+    return false;
+}
+void modeNoteCharging(ModeManager *manager, bool charging) {
+}
 bool isEvaluatingButtonPress(Button *button) {
     return false;
 }
+uint32_t buttonMsUntilNextResult(Button *button) {
+    return UINT32_MAX;
+}
 void fakeOffMode(ModeManager *manager) {
 }
 void enterStandbyMode(void) {
@@ -171,6 +200,8 @@ void test_UpdateSettings_UpdatesChipStateSettings(void) {
             .button = &mockButton,
             .chargerIC = &mockCharger,
             .accel = &mockAccel,
+            .i2c = &mockI2c,
+            .telemetry = &mockTelemetry,
             .caseLed = &mockCaseLed,
             .frontLed = &mockFrontLed,
             .enableChipTickTimer = mock_enableChipTickTimer,
@@ -178,6 +209,7 @@ void test_UpdateSettings_UpdatesChipStateSettings(void) {
             .enableFrontLedTimer = mock_enableFrontLedTimer,
             .enableAutoOffTimer = mock_enableAutoOffTimer,
             .enableUsbClock = mock_enableUsbClock,
+            .enableLowPowerClock = mock_enableLowPowerClock,
             .enterStandbyMode = enterStandbyMode,
             .waitForButtonWakeOrAutoLock = mock_waitForButtonWakeOrAutoLock,
             .systemReset = mock_systemReset,
@@ -315,6 +347,31 @@ void test_SettingsJson_KeysMatchMacroCount(void) {
     lwjson_free(&lwjson);
 }
 
+void test_SettingsCommandJson_IsWriteSettingsCommand(void) {
+    char buf[TEST_JSON_BUFFER_SIZE];
+    ChipSettings settings;
+    chipSettingsInitDefaults(&settings);
+    settings.modeCount = 6;
+    settings.enableChargerSerial = true;
+
+    int len = getSettingsCommandJson(&settings, buf, sizeof(buf));
+    TEST_ASSERT_EQUAL_INT((int)strlen(buf), len);
+
+    lwjson_token_t tokens[128];
+    lwjson_t lwjson;
+    lwjson_init(&lwjson, tokens, LWJSON_ARRAYSIZE(tokens));
+    TEST_ASSERT_EQUAL(lwjsonOK, lwjson_parse(&lwjson, buf));
+
+    const lwjson_token_t *command = lwjson_find(&lwjson, "command");
+    TEST_ASSERT_NOT_NULL(command);
+    TEST_ASSERT_EQUAL_STRING_LEN(
+        "writeSettings", command->u.str.token_value, command->u.str.token_value_len);
+    TEST_ASSERT_EQUAL_INT(6, lwjson_find(&lwjson, "modeCount")->u.num_int);
+    TEST_ASSERT_EQUAL(LWJSON_TYPE_TRUE, lwjson_find(&lwjson, "enableChargerSerial")->type);
+
+    lwjson_free(&lwjson);
+}
+
 void test_SettingsMetadataJson_ContainsShutdownPolicyOptions(void) {
     char buf[SETTINGS_METADATA_JSON_SIZE];
 
@@ -480,6 +537,7 @@ void test_SettingsMetadataJson_FitsInBufferSize(void) {
 
 int main(void) {
     UNITY_BEGIN();
+    RUN_TEST(test_SettingsCommandJson_IsWriteSettingsCommand);
     RUN_TEST(test_SettingsDefaultsJson_FitsInBufferSize);
     RUN_TEST(test_SettingsJson_KeysMatchMacroCount);
     RUN_TEST(test_SettingsManagerInit_DoesNotWriteFlash_WhenFlashMatches);
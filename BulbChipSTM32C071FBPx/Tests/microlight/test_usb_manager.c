@@ -1,4 +1,5 @@
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 #include "unity.h"
@@ -6,6 +7,8 @@
 #include "microlight/json/command_parser.h"
 #include "microlight/json/json_buf.h"
 #include "microlight/mode_manager.h"
+#include "microlight/model/power_estimate.h"
+#include "microlight/protocol/frame.h"
 #include "microlight/settings_manager.h"
 #include "microlight/usb_manager.h"
 // --- Mocks & Stubs ---
@@ -14,35 +17,76 @@
 USBManager usbManager;
 ModeManager modeManager;
 SettingsManager settingsManager;
+Telemetry telemetry;
 
 // Flash/Storage Mocks
+static uint8_t mock_telemetry_flash[TELEMETRY_PAGE_COUNT * TELEMETRY_PAGE_SIZE];
+void mock_eraseTelemetryPage(uint8_t page) {
+    memset(&mock_telemetry_flash[page * TELEMETRY_PAGE_SIZE], 0xFF, TELEMETRY_PAGE_SIZE);
+}
+void mock_writeTelemetry(uint32_t offset, const uint8_t *data, size_t length) {
+    memcpy(&mock_telemetry_flash[offset], data, length);
+}
+void mock_readTelemetry(uint32_t offset, uint8_t *buffer, size_t length) {
+    memcpy(buffer, &mock_telemetry_flash[offset], length);
+}
+
 #define TEST_JSON_BUFFER_SIZE 2048
 static char mock_flash_buffer[TEST_JSON_BUFFER_SIZE];
+static char mock_saved_buffer[TEST_JSON_BUFFER_SIZE];  // flash buffer doubles as the shared buffer
 static bool mock_flash_write_called = false;
 static bool mock_settings_update_called = false;
 static bool mock_mode_set_called = false;
 static bool mock_enter_dfu_called = false;
+static uint32_t mock_milliseconds = 0;
+static uint32_t mock_milliseconds_step = 0;  // clock advance per read, for the usbTask budget
 
 // Read/Write buffers for USB mocks
 static char mock_usb_read_buffer[TEST_JSON_BUFFER_SIZE];
 static bool mock_usb_read_has_data = false;
+static size_t mock_usb_read_length = 0;  // binary frames can contain '\0', 0 means strlen
+static size_t mock_usb_read_offset = 0;  // strlen mode hands out one '\n' terminated line per read
+static int mock_usb_read_calls = 0;
 static char mock_usb_write_buffer[TEST_JSON_BUFFER_SIZE];
 static int mock_usb_write_idx = 0;
+static size_t mock_usb_tx_free = SIZE_MAX;  // SIZE_MAX never runs out, otherwise writes use it up
 
 // Callbacks
 int32_t mock_usbReadTask(char usbBuffer[], size_t bufferLength) {
+    mock_usb_read_calls++;
     if (mock_usb_read_has_data) {
-        size_t len = strlen(mock_usb_read_buffer);
+        const char *start = &mock_usb_read_buffer[mock_usb_read_offset];
+        size_t len = mock_usb_read_length ? mock_usb_read_length : strlen(start);
+        const char *newline = mock_usb_read_length ? NULL : strchr(start, '\n');
+        if (newline && newline[1] != '\0') {
+            len = (size_t)(newline - start) + 1;
+            mock_usb_read_offset += len;
+        } else {
+            mock_usb_read_has_data = false;
+            mock_usb_read_offset = 0;
+        }
         if (len >= bufferLength) len = bufferLength - 1;
-        memcpy(usbBuffer, mock_usb_read_buffer, len);
+        memcpy(usbBuffer, start, len);
         usbBuffer[len] = '\0';
-        mock_usb_read_has_data = false;
         return (int32_t)len;
     }
     return 0;
 }
 
+uint32_t mock_currentMilliseconds(void) {
+    mock_milliseconds += mock_milliseconds_step;
+    return mock_milliseconds;
+}
+
+size_t mock_usbTxFree(void) {
+    return mock_usb_tx_free;
+}
+
 void mock_usbWrite(const char usbBuffer[], size_t bufferLength) {
+    if (mock_usb_tx_free != SIZE_MAX) {
+        TEST_ASSERT_TRUE_MESSAGE(bufferLength <= mock_usb_tx_free, "TX ring overflowed");
+        mock_usb_tx_free -= bufferLength;
+    }
     if (mock_usb_write_idx + bufferLength < TEST_JSON_BUFFER_SIZE) {
         memcpy(&mock_usb_write_buffer[mock_usb_write_idx], usbBuffer, bufferLength);
         mock_usb_write_idx += bufferLength;
@@ -54,22 +98,37 @@ void mock_usbWrite(const char usbBuffer[], size_t bufferLength) {
 // Storage / Logic Mocks
 void saveMode(uint8_t mode, const char str[], size_t length) {
     mock_flash_write_called = true;
+    memcpy(mock_saved_buffer, str, length);
     strncpy(mock_flash_buffer, str, length);
     mock_flash_buffer[length] = '\0';
 }
 void saveSettings(const char str[], size_t length) {
     mock_flash_write_called = true;
+    memcpy(mock_saved_buffer, str, length);
     strncpy(mock_flash_buffer, str, length);
     mock_flash_buffer[length] = '\0';
 }
+static const char *mock_stored_mode = NULL;  // NULL reads back the placeholder below
 void readBulbModeFromMock(uint8_t mode, char buffer[], size_t length) {
-    strcpy(buffer, "{\"mode\":\"test\"}");
+    // flash reads hand back `length` bytes, a mode filling them has no terminator
+    strncpy(buffer, mock_stored_mode ? mock_stored_mode : "{\"mode\":\"test\"}", length);
 }
 
 // Mocking ModeManager functions
 void setMode(ModeManager *manager, Mode *mode, uint8_t index) {
     mock_mode_set_called = true;
 }
+void startLiveStream(
+    ModeManager *manager, uint8_t frameIntervalMs, uint8_t prefillFrames, uint32_t milliseconds) {
+    liveStreamStart(&manager->liveStream, frameIntervalMs, prefillFrames, milliseconds);
+}
+void stopLiveStream(ModeManager *manager) {
+    liveStreamStop(&manager->liveStream);
+}
+static uint16_t mock_awake_permille = 1000;
+uint16_t modeAwakePermille(ModeManager *manager, uint32_t milliseconds) {
+    return mock_awake_permille;
+}
 
 // Mocking SettingsManager functions
 void updateSettings(SettingsManager *manager, ChipSettings *settings) {
@@ -79,6 +138,14 @@ int getSettingsResponse(SettingsManager *manager, char *buffer, size_t len) {
     sprintf(buffer, "{\"settings\":\"mock\"}");
     return strlen(buffer);
 }
+int getSettingsCommandJson(const ChipSettings *settings, char *buffer, size_t len) {
+    sprintf(
+        buffer,
+        "{\"command\":\"writeSettings\",\"modeCount\":%d,\"modeCrossfadeMs\":%d}",
+        settings->modeCount,
+        settings->modeCrossfadeMs);
+    return strlen(buffer);
+}
 
 void mock_enter_dfu() {
     mock_enter_dfu_called = true;
@@ -96,17 +163,28 @@ void setUp(void) {
     mock_flash_write_called = false;
     mock_settings_update_called = false;
     mock_mode_set_called = false;
+    mock_milliseconds = 0;
+    mock_milliseconds_step = 0;
+    mock_usb_read_offset = 0;
+    mock_usb_read_calls = 0;
+    mock_stored_mode = NULL;
+    mock_awake_permille = 1000;
 
     // Reset Buffers
     mock_usb_read_has_data = false;
+    mock_usb_read_length = 0;
     mock_usb_write_idx = 0;
+    mock_usb_tx_free = SIZE_MAX;
     memset(mock_usb_read_buffer, 0, sizeof(mock_usb_read_buffer));
     memset(mock_usb_write_buffer, 0, sizeof(mock_usb_write_buffer));
     memset(mock_flash_buffer, 0, sizeof(mock_flash_buffer));
+    memset(mock_saved_buffer, 0, sizeof(mock_saved_buffer));
     initSharedJsonIOBuffer(mock_flash_buffer, TEST_JSON_BUFFER_SIZE);
 
     // Setup Managers
     modeManager.readSavedMode = readBulbModeFromMock;
+    memset(mock_telemetry_flash, 0xFF, sizeof(mock_telemetry_flash));
+    telemetryInit(&telemetry, mock_eraseTelemetryPage, mock_writeTelemetry, mock_readTelemetry);
 }
 
 void tearDown(void) {
@@ -119,11 +197,14 @@ void test_usbInit_success(void) {
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite);
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds);
     TEST_ASSERT_TRUE(result);
     TEST_ASSERT_EQUAL_PTR(mock_usbReadTask, usbManager.usbReadTask);
     TEST_ASSERT_EQUAL_PTR(mock_usbWrite, usbManager.usbWrite);
@@ -134,73 +215,133 @@ void test_usbInit_failure_null_args(void) {
         NULL,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite));
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds));
     TEST_ASSERT_FALSE(usbInit(
         &usbManager,
         NULL,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite));
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds));
     TEST_ASSERT_FALSE(usbInit(
         &usbManager,
         &modeManager,
         NULL,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite));
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds));
     TEST_ASSERT_FALSE(usbInit(
         &usbManager,
         &modeManager,
         &settingsManager,
         NULL,
+        mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite));
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds));
     TEST_ASSERT_FALSE(usbInit(
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
+        NULL,
+        saveSettings,
+        saveMode,
+        mock_usbReadTask,
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds));
+    TEST_ASSERT_FALSE(usbInit(
+        &usbManager,
+        &modeManager,
+        &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         NULL,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite));
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds));
+    TEST_ASSERT_FALSE(usbInit(
+        &usbManager,
+        &modeManager,
+        &settingsManager,
+        &telemetry,
+        mock_enter_dfu,
+        saveSettings,
+        NULL,
+        mock_usbReadTask,
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds));
     TEST_ASSERT_FALSE(usbInit(
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
+        saveMode,
         NULL,
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds));
+    TEST_ASSERT_FALSE(usbInit(
+        &usbManager,
+        &modeManager,
+        &settingsManager,
+        &telemetry,
+        mock_enter_dfu,
+        saveSettings,
+        saveMode,
         mock_usbReadTask,
-        mock_usbWrite));
+        NULL,
+        mock_usbTxFree,
+        mock_currentMilliseconds));
     TEST_ASSERT_FALSE(usbInit(
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
+        mock_usbReadTask,
+        mock_usbWrite,
         NULL,
-        mock_usbWrite));
+        mock_currentMilliseconds));
     TEST_ASSERT_FALSE(usbInit(
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
+        mock_usbWrite,
+        mock_usbTxFree,
         NULL));
 }
 
@@ -218,11 +359,14 @@ void test_parse_write_mode_normal(void) {
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite);
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds);
 
     // Simulate incoming "writeMode" JSON
     const char *input =
@@ -244,11 +388,14 @@ void test_parse_write_mode_transient(void) {
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite);
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds);
 
     const char *input =
         "{\"command\":\"writeMode\",\"index\":1,\"mode\":{\"name\":\"transientTest\",\"front\":{"
@@ -269,11 +416,14 @@ void test_parse_read_mode(void) {
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite);
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds);
 
     const char *input = "{\"command\":\"readMode\",\"index\":1}\n";
     strcpy(mock_usb_read_buffer, input);
@@ -285,16 +435,93 @@ void test_parse_read_mode(void) {
     TEST_ASSERT_EQUAL_STRING_LEN("{\"mode\":\"test\"}\n", mock_usb_write_buffer, 16);
 }
 
+// front is red for a quarter of the loop
+static const char *storedRedQuarterMode =
+    "{\"command\":\"writeMode\",\"index\":1,\"mode\":{\"name\":\"red\",\"front\":{\"pattern\":"
+    "{\"type\":\"simple\",\"name\":\"red\",\"duration\":1000,\"changeAt\":[{\"ms\":0,"
+    "\"output\":\"#ff0000\"},{\"ms\":250,\"output\":\"#000000\"}]}}}}";
+
+static void initForPowerEstimate(void) {
+    usbInit(
+        &usbManager,
+        &modeManager,
+        &settingsManager,
+        &telemetry,
+        mock_enter_dfu,
+        saveSettings,
+        saveMode,
+        mock_usbReadTask,
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds);
+    chipSettingsInitDefaults(&settingsManager.currentSettings);
+    settingsManager.currentSettings.frontWhiteBalanceRed = 255;
+    settingsManager.currentSettings.frontRedCurrentMa = 20;
+    mock_stored_mode = storedRedQuarterMode;
+}
+
+void test_parse_read_mode_appends_power_estimate(void) {
+    initForPowerEstimate();
+    modeManager.currentModeIndex = 0;
+
+    strcpy(mock_usb_read_buffer, "{\"command\":\"readMode\",\"index\":1}\n");
+    mock_usb_read_has_data = true;
+    pumpUsbTask();
+
+    size_t storedLen = strlen(storedRedQuarterMode);
+    TEST_ASSERT_EQUAL_STRING_LEN(storedRedQuarterMode, mock_usb_write_buffer, storedLen - 1);
+    TEST_ASSERT_EQUAL_STRING(
+        ",\"powerEstimate\":{\"averageMicroamps\":6500,\"frontMicroamps\":5000,"
+        "\"caseMicroamps\":0,\"mcuMicroamps\":1500,\"awakePermille\":1000,"
+        "\"awakeMeasured\":false,\"exact\":true}}\n",
+        &mock_usb_write_buffer[storedLen - 1]);
+}
+
+void test_parse_estimate_power_uses_measured_awake_fraction(void) {
+    initForPowerEstimate();
+    modeManager.currentModeIndex = 1;
+    mock_awake_permille = 0;
+
+    strcpy(mock_usb_read_buffer, "{\"command\":\"estimatePower\",\"index\":1}\n");
+    mock_usb_read_has_data = true;
+    pumpUsbTask();
+
+    char expected[256];
+    snprintf(
+        expected,
+        sizeof(expected),
+        "{\"powerEstimate\":{\"averageMicroamps\":%u,\"frontMicroamps\":5000,"
+        "\"caseMicroamps\":0,\"mcuMicroamps\":%u,\"awakePermille\":0,"
+        "\"awakeMeasured\":true,\"exact\":true}}\n",
+        5000U + POWER_MCU_STOP_MICROAMPS,
+        POWER_MCU_STOP_MICROAMPS);
+    TEST_ASSERT_EQUAL_STRING(expected, mock_usb_write_buffer);
+}
+
+void test_parse_estimate_power_without_stored_mode_reports_error(void) {
+    initForPowerEstimate();
+    mock_stored_mode = NULL;
+
+    strcpy(mock_usb_read_buffer, "{\"command\":\"estimatePower\",\"index\":3}\n");
+    mock_usb_read_has_data = true;
+    pumpUsbTask();
+
+    TEST_ASSERT_EQUAL_STRING("{\"error\":\"no mode at index 3\"}\n", mock_usb_write_buffer);
+}
+
 void test_parse_write_settings(void) {
     usbInit(
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite);
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds);
 
     const char *input = "{\"command\":\"writeSettings\"}\n";
     strcpy(mock_usb_read_buffer, input);
@@ -311,11 +538,14 @@ void test_parse_read_settings(void) {
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite);
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds);
 
     const char *input = "{\"command\":\"readSettings\"}\n";
     strcpy(mock_usb_read_buffer, input);
@@ -331,11 +561,14 @@ void test_parse_dfu(void) {
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite);
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds);
 
     const char *input = "{\"command\":\"dfu\"}\n";
     strcpy(mock_usb_read_buffer, input);
@@ -351,11 +584,14 @@ void test_parse_multiple_commands(void) {
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite);
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds);
 
     // Command 1
     const char *input1 = "{\"command\":\"writeSettings\"}\n";
@@ -388,11 +624,14 @@ void test_malformed_json(void) {
         &usbManager,
         &modeManager,
         &settingsManager,
+        &telemetry,
         mock_enter_dfu,
         saveSettings,
         saveMode,
         mock_usbReadTask,
-        mock_usbWrite);
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds);
 
     const char *input = "{junk}\n";
     strcpy(mock_usb_read_buffer, input);
@@ -404,17 +643,421 @@ void test_malformed_json(void) {
     TEST_ASSERT_NOT_NULL(strstr(mock_usb_write_buffer, "error"));
 }
 
+static void initUsbManager(void) {
+    usbInit(
+        &usbManager,
+        &modeManager,
+        &settingsManager,
+        &telemetry,
+        mock_enter_dfu,
+        saveSettings,
+        saveMode,
+        mock_usbReadTask,
+        mock_usbWrite,
+        mock_usbTxFree,
+        mock_currentMilliseconds);
+}
+
+static void queueFrame(uint8_t opcode, uint8_t seq, const char *payload, size_t length) {
+    mock_usb_read_length = frameEncode(
+        opcode, seq, payload, length, mock_usb_read_buffer, sizeof(mock_usb_read_buffer));
+    mock_usb_read_has_data = true;
+}
+
+static Frame decodeResponse(void) {
+    Frame frame = {0};
+    TEST_ASSERT_EQUAL(
+        FRAME_OK, frameDecode(mock_usb_write_buffer, (size_t)mock_usb_write_idx, &frame));
+    return frame;
+}
+
+void test_frame_hello_reports_version_and_limits(void) {
+    initUsbManager();
+    const char version = FRAME_PROTOCOL_VERSION;
+    queueFrame(FRAME_OP_HELLO, 5, &version, 1);
+
+    pumpUsbTask();
+
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_HELLO | FRAME_RESPONSE_FLAG, response.opcode);
+    TEST_ASSERT_EQUAL_UINT8(5, response.seq);
+    TEST_ASSERT_EQUAL(4, response.payloadLength);
+    TEST_ASSERT_EQUAL_UINT8(FRAME_PROTOCOL_VERSION, response.payload[0]);
+    uint16_t maxPayload = (uint8_t)response.payload[1] | ((uint8_t)response.payload[2] << 8);
+    TEST_ASSERT_EQUAL(TEST_JSON_BUFFER_SIZE - FRAME_HEADROOM, maxPayload);
+    TEST_ASSERT_EQUAL_UINT8(CHIP_SETTINGS_PACKED_SIZE, response.payload[3]);
+}
+
+void test_frame_write_mode_saves_and_acks(void) {
+    initUsbManager();
+    const char *json =
+        "{\"command\":\"writeMode\",\"index\":1,\"mode\":{\"name\":\"test\",\"front\":{"
+        "\"pattern\":{\"type\":\"simple\",\"name\":\"test\",\"duration\":1000,\"changeAt\":[{"
+        "\"ms\":0,\"output\":\"low\"}]}}}}";
+    queueFrame(FRAME_OP_WRITE_MODE, 9, json, strlen(json));
+
+    pumpUsbTask();
+
+    TEST_ASSERT_TRUE(mock_flash_write_called);
+    TEST_ASSERT_TRUE(mock_mode_set_called);
+    TEST_ASSERT_EQUAL_STRING(json, mock_saved_buffer);
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_WRITE_MODE | FRAME_RESPONSE_FLAG, response.opcode);
+    TEST_ASSERT_EQUAL_UINT8(9, response.seq);
+    TEST_ASSERT_EQUAL(0, response.payloadLength);
+}
+
+void test_frame_write_mode_invalid_json_reports_error(void) {
+    initUsbManager();
+    const char *json = "{junk}";
+    queueFrame(FRAME_OP_WRITE_MODE, 2, json, strlen(json));
+
+    pumpUsbTask();
+
+    TEST_ASSERT_FALSE(mock_mode_set_called);
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_ERROR, response.opcode);
+    TEST_ASSERT_EQUAL_UINT8(2, response.seq);
+    TEST_ASSERT_EQUAL_UINT8(FRAME_ERR_INVALID_PAYLOAD, response.payload[0]);
+}
+
+void test_frame_read_mode_returns_stored_json(void) {
+    initUsbManager();
+    const char index = 1;
+    queueFrame(FRAME_OP_READ_MODE, 3, &index, 1);
+
+    pumpUsbTask();
+
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_READ_MODE | FRAME_RESPONSE_FLAG, response.opcode);
+    TEST_ASSERT_EQUAL(15, response.payloadLength);
+    TEST_ASSERT_EQUAL_STRING_LEN("{\"mode\":\"test\"}", response.payload, 15);
+}
+
+void test_frame_read_mode_too_large_reports_error(void) {
+    initUsbManager();
+    static char stored[TEST_JSON_BUFFER_SIZE];
+    memset(stored, 'x', TEST_JSON_BUFFER_SIZE - FRAME_HEADROOM);
+    stored[TEST_JSON_BUFFER_SIZE - FRAME_HEADROOM] = '\0';
+    mock_stored_mode = stored;
+    const char index = 1;
+    queueFrame(FRAME_OP_READ_MODE, 3, &index, 1);
+
+    pumpUsbTask();
+
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_ERROR, response.opcode);
+    TEST_ASSERT_EQUAL_UINT8(3, response.seq);
+    TEST_ASSERT_EQUAL_UINT8(FRAME_ERR_INVALID_PAYLOAD, response.payload[0]);
+}
+
+void test_frame_read_settings_packs_current_settings(void) {
+    initUsbManager();
+    chipSettingsInitDefaults(&settingsManager.currentSettings);
+    settingsManager.currentSettings.modeCount = 4;
+    settingsManager.currentSettings.enableChargerSerial = true;
+    settingsManager.currentSettings.modeCrossfadeMs = 1500;
+    queueFrame(FRAME_OP_READ_SETTINGS, 1, NULL, 0);
+
+    pumpUsbTask();
+
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL(CHIP_SETTINGS_PACKED_SIZE, response.payloadLength);
+    TEST_ASSERT_EQUAL_UINT8(4, response.payload[CHIP_SETTING_OFFSET(modeCount)]);
+    TEST_ASSERT_EQUAL_UINT8(1, response.payload[CHIP_SETTING_OFFSET(enableChargerSerial)]);
+    TEST_ASSERT_EQUAL_UINT8(
+        DEFAULT_CASE_WHITE_BALANCE_BLUE,
+        (uint8_t)response.payload[CHIP_SETTING_OFFSET(caseWhiteBalanceBlue)]);
+    const uint8_t *crossfade =
+        (const uint8_t *)&response.payload[CHIP_SETTING_OFFSET(modeCrossfadeMs)];
+    TEST_ASSERT_EQUAL_UINT16(1500, crossfade[0] | (crossfade[1] << 8));
+}
+
+void test_frame_write_settings_saves_json_command(void) {
+    initUsbManager();
+    ChipSettings settings;
+    chipSettingsInitDefaults(&settings);
+    settings.modeCount = 3;
+    settings.modeCrossfadeMs = 1500;
+    uint8_t packed[CHIP_SETTINGS_PACKED_SIZE];
+    chipSettingsPack(&settings, packed);
+    queueFrame(FRAME_OP_WRITE_SETTINGS, 4, (const char *)packed, sizeof(packed));
+
+    pumpUsbTask();
+
+    TEST_ASSERT_TRUE(mock_settings_update_called);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"command\":\"writeSettings\",\"modeCount\":3,\"modeCrossfadeMs\":1500}",
+        mock_saved_buffer);
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_WRITE_SETTINGS | FRAME_RESPONSE_FLAG, response.opcode);
+}
+
+void test_frame_write_settings_wrong_size_rejected(void) {
+    initUsbManager();
+    const char packed[2] = {1, 2};
+    queueFrame(FRAME_OP_WRITE_SETTINGS, 4, packed, sizeof(packed));
+
+    pumpUsbTask();
+
+    TEST_ASSERT_FALSE(mock_settings_update_called);
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_ERROR, response.opcode);
+    TEST_ASSERT_EQUAL_UINT8(FRAME_ERR_INVALID_PAYLOAD, response.payload[0]);
+}
+
+void test_frame_crc_error_reported(void) {
+    initUsbManager();
+    const char index = 1;
+    queueFrame(FRAME_OP_READ_MODE, 6, &index, 1);
+    mock_usb_read_buffer[mock_usb_read_length - 2] ^= 0x01;
+
+    pumpUsbTask();
+
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_ERROR, response.opcode);
+    TEST_ASSERT_EQUAL_UINT8(FRAME_ERR_CRC, response.payload[0]);
+}
+
+void test_frame_unknown_opcode_reported(void) {
+    initUsbManager();
+    queueFrame(0x55, 8, NULL, 0);
+
+    pumpUsbTask();
+
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_ERROR, response.opcode);
+    TEST_ASSERT_EQUAL_UINT8(8, response.seq);
+    TEST_ASSERT_EQUAL_UINT8(FRAME_ERR_UNKNOWN_OPCODE, response.payload[0]);
+}
+
+void test_frame_stream_start_acks_buffer_size(void) {
+    initUsbManager();
+    mock_milliseconds = 500;
+    const char payload[2] = {20, 3};
+    queueFrame(FRAME_OP_STREAM_START, 4, payload, sizeof(payload));
+
+    pumpUsbTask();
+
+    TEST_ASSERT_TRUE(modeManager.liveStream.active);
+    TEST_ASSERT_EQUAL_UINT8(20, modeManager.liveStream.frameIntervalMs);
+    TEST_ASSERT_EQUAL_UINT8(3, modeManager.liveStream.prefillFrames);
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_STREAM_START | FRAME_RESPONSE_FLAG, response.opcode);
+    TEST_ASSERT_EQUAL_UINT8(4, response.seq);
+    TEST_ASSERT_EQUAL(1, response.payloadLength);
+    TEST_ASSERT_EQUAL_UINT8(LIVE_STREAM_BUFFER_FRAMES, response.payload[0]);
+}
+
+void test_frame_stream_frames_queued_without_response(void) {
+    initUsbManager();
+    liveStreamStart(&modeManager.liveStream, 20, 2, 0);
+    const char frames[12] = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+    queueFrame(FRAME_OP_STREAM_FRAMES, 1, frames, sizeof(frames));
+
+    pumpUsbTask();
+
+    TEST_ASSERT_EQUAL(0, mock_usb_write_idx);
+    TEST_ASSERT_EQUAL_UINT8(2, modeManager.liveStream.count);
+    TEST_ASSERT_EQUAL_UINT32(2, modeManager.liveStream.stats.framesReceived);
+    TEST_ASSERT_EQUAL_UINT8(7, modeManager.liveStream.frames[1].frontRed);
+    TEST_ASSERT_EQUAL_UINT8(12, modeManager.liveStream.frames[1].caseBlue);
+}
+
+void test_frame_stream_frames_rejected_when_not_streaming(void) {
+    initUsbManager();
+    const char frame[LIVE_STREAM_FRAME_SIZE] = {0};
+    queueFrame(FRAME_OP_STREAM_FRAMES, 6, frame, sizeof(frame));
+
+    pumpUsbTask();
+
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_ERROR, response.opcode);
+    TEST_ASSERT_EQUAL_UINT8(FRAME_ERR_INVALID_PAYLOAD, response.payload[0]);
+}
+
+void test_frame_stream_stop_reports_stats(void) {
+    initUsbManager();
+    liveStreamStart(&modeManager.liveStream, 20, 2, 100);
+    const uint8_t frame[LIVE_STREAM_FRAME_SIZE] = {0};
+    liveStreamPush(&modeManager.liveStream, frame, 110);
+    mock_milliseconds = 400;
+    queueFrame(FRAME_OP_STREAM_STOP, 7, NULL, 0);
+
+    pumpUsbTask();
+
+    TEST_ASSERT_FALSE(modeManager.liveStream.active);
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_STREAM_STOP | FRAME_RESPONSE_FLAG, response.opcode);
+    TEST_ASSERT_EQUAL(LIVE_STREAM_STATS_SIZE, response.payloadLength);
+    TEST_ASSERT_EQUAL_UINT8(1, response.payload[0]);   // received
+    TEST_ASSERT_EQUAL_UINT8(44, response.payload[16]);  // 300 ms elapsed, low byte
+    TEST_ASSERT_EQUAL_UINT8(1, response.payload[17]);
+}
+
+static void recordTelemetryEvents(uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        telemetryRecord(&telemetry, TELEMETRY_EVENT_MODE_CHANGED, (uint8_t)i, 0, 1000 + i);
+        telemetryFlush(&telemetry);
+    }
+}
+
+void test_read_telemetry_json_flushes_and_pages_records(void) {
+    initUsbManager();
+    recordTelemetryEvents(USB_TELEMETRY_JSON_RECORDS + 2);
+    // still queued in RAM, the response has to include it
+    telemetryRecord(&telemetry, TELEMETRY_EVENT_AUTO_OFF, 0, 0, 0x0A0B0C0D);
+    strcpy(mock_usb_read_buffer, "{\"command\":\"readTelemetry\",\"first\":50}\n");
+    mock_usb_read_has_data = true;
+
+    pumpUsbTask();
+
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"telemetry\":{\"total\":51,\"first\":50,\"records\":\"050000000D0C0B0A\"}}\n",
+        mock_usb_write_buffer);
+}
+
+void test_frame_read_telemetry_returns_records_from_first(void) {
+    initUsbManager();
+    recordTelemetryEvents(3);
+    const char first[2] = {1, 0};
+    queueFrame(FRAME_OP_READ_TELEMETRY, 4, first, sizeof(first));
+
+    pumpUsbTask();
+
+    Frame response = decodeResponse();
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_READ_TELEMETRY | FRAME_RESPONSE_FLAG, response.opcode);
+    TEST_ASSERT_EQUAL(
+        TELEMETRY_FRAME_HEADER_SIZE + 2 * TELEMETRY_RECORD_SIZE, response.payloadLength);
+    TEST_ASSERT_EQUAL_UINT8(3, response.payload[0]);  // total
+    TEST_ASSERT_EQUAL_UINT8(1, response.payload[2]);  // first
+    TelemetryRecord record;
+    telemetryUnpack((const uint8_t *)&response.payload[TELEMETRY_FRAME_HEADER_SIZE], &record);
+    TEST_ASSERT_EQUAL_UINT8(TELEMETRY_EVENT_MODE_CHANGED, record.event);
+    TEST_ASSERT_EQUAL_UINT8(1, record.arg);
+    TEST_ASSERT_EQUAL_UINT32(1001, record.milliseconds);
+}
+
+void test_frame_read_telemetry_rejects_bad_payload(void) {
+    initUsbManager();
+    const char payload[1] = {0};
+    queueFrame(FRAME_OP_READ_TELEMETRY, 4, payload, sizeof(payload));
+
+    pumpUsbTask();
+
+    TEST_ASSERT_EQUAL_UINT8(FRAME_OP_ERROR, decodeResponse().opcode);
+}
+
+void test_usbTask_drains_all_buffered_lines(void) {
+    initUsbManager();
+    strcpy(
+        mock_usb_read_buffer,
+        "{\"command\":\"readSettings\"}\n{\"command\":\"writeSettings\"}\n"
+        "{\"command\":\"readSettings\"}\n");
+    mock_usb_read_has_data = true;
+
+    usbTask(&usbManager);
+
+    TEST_ASSERT_TRUE(mock_settings_update_called);
+    TEST_ASSERT_EQUAL_STRING(
+        "{\"settings\":\"mock\"}{\"settings\":\"mock\"}", mock_usb_write_buffer);
+    TEST_ASSERT_FALSE(mock_usb_read_has_data);
+}
+
+void test_usbTask_stops_at_max_lines(void) {
+    initUsbManager();
+    mock_usb_read_buffer[0] = '\0';
+    for (int i = 0; i < USB_TASK_MAX_LINES + 2; i++) {
+        strcat(mock_usb_read_buffer, "{\"command\":\"readSettings\"}\n");
+    }
+    mock_usb_read_has_data = true;
+
+    usbTask(&usbManager);
+    TEST_ASSERT_EQUAL(USB_TASK_MAX_LINES, mock_usb_read_calls);
+    TEST_ASSERT_TRUE(mock_usb_read_has_data);
+
+    usbTask(&usbManager);
+    TEST_ASSERT_FALSE(mock_usb_read_has_data);
+}
+
+void test_usbTask_stops_when_budget_spent(void) {
+    initUsbManager();
+    strcpy(
+        mock_usb_read_buffer,
+        "{\"command\":\"readSettings\"}\n{\"command\":\"readSettings\"}\n"
+        "{\"command\":\"readSettings\"}\n");
+    mock_usb_read_has_data = true;
+    mock_milliseconds_step = USB_TASK_BUDGET_MS / 2;
+
+    usbTask(&usbManager);
+
+    TEST_ASSERT_EQUAL(1, mock_usb_read_calls);
+    TEST_ASSERT_TRUE(mock_usb_read_has_data);
+}
+
+void test_usbTask_waits_for_tx_room_before_next_line(void) {
+    initUsbManager();
+    mock_usb_read_buffer[0] = '\0';
+    for (int i = 0; i < 6; i++) {
+        strcat(mock_usb_read_buffer, "{\"command\":\"readMode\",\"index\":1}\n");
+    }
+    mock_usb_read_has_data = true;
+    // an empty ring the size of the shared buffer, like the firmware's
+    mock_usb_tx_free = TEST_JSON_BUFFER_SIZE;
+
+    // after one response another full size one would not fit, the rest wait with the host
+    usbTask(&usbManager);
+    TEST_ASSERT_EQUAL(1, mock_usb_read_calls);
+    TEST_ASSERT_TRUE(mock_usb_read_has_data);
+
+    for (int i = 0; i < 5; i++) {
+        mock_usb_tx_free = TEST_JSON_BUFFER_SIZE;  // host caught up
+        usbTask(&usbManager);
+    }
+    TEST_ASSERT_FALSE(mock_usb_read_has_data);
+
+    int responses = 0;
+    for (const char *at = mock_usb_write_buffer; (at = strstr(at, "{\"mode\":\"test\"")); at++) {
+        responses++;
+    }
+    TEST_ASSERT_EQUAL(6, responses);
+}
+
 int main(void) {
     UNITY_BEGIN();
+    RUN_TEST(test_frame_crc_error_reported);
+    RUN_TEST(test_frame_hello_reports_version_and_limits);
+    RUN_TEST(test_frame_read_mode_returns_stored_json);
+    RUN_TEST(test_frame_read_mode_too_large_reports_error);
+    RUN_TEST(test_frame_read_settings_packs_current_settings);
+    RUN_TEST(test_frame_read_telemetry_rejects_bad_payload);
+    RUN_TEST(test_frame_read_telemetry_returns_records_from_first);
+    RUN_TEST(test_frame_stream_frames_queued_without_response);
+    RUN_TEST(test_frame_stream_frames_rejected_when_not_streaming);
+    RUN_TEST(test_frame_stream_start_acks_buffer_size);
+    RUN_TEST(test_frame_stream_stop_reports_stats);
+    RUN_TEST(test_frame_unknown_opcode_reported);
+    RUN_TEST(test_frame_write_mode_invalid_json_reports_error);
+    RUN_TEST(test_frame_write_mode_saves_and_acks);
+    RUN_TEST(test_frame_write_settings_saves_json_command);
+    RUN_TEST(test_frame_write_settings_wrong_size_rejected);
     RUN_TEST(test_malformed_json);
     RUN_TEST(test_parse_dfu);
+    RUN_TEST(test_parse_estimate_power_uses_measured_awake_fraction);
+    RUN_TEST(test_parse_estimate_power_without_stored_mode_reports_error);
     RUN_TEST(test_parse_multiple_commands);
     RUN_TEST(test_parse_read_mode);
+    RUN_TEST(test_parse_read_mode_appends_power_estimate);
     RUN_TEST(test_parse_read_settings);
     RUN_TEST(test_parse_write_mode_normal);
     RUN_TEST(test_parse_write_mode_transient);
     RUN_TEST(test_parse_write_settings);
+    RUN_TEST(test_read_telemetry_json_flushes_and_pages_records);
     RUN_TEST(test_usbInit_failure_null_args);
     RUN_TEST(test_usbInit_success);
+    RUN_TEST(test_usbTask_drains_all_buffered_lines);
+    RUN_TEST(test_usbTask_stops_at_max_lines);
+    RUN_TEST(test_usbTask_stops_when_budget_spent);
+    RUN_TEST(test_usbTask_waits_for_tx_room_before_next_line);
     return UNITY_END();
 }
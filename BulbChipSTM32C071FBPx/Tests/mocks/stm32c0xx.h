@@ -41,6 +41,8 @@ void __HAL_FLASH_CLEAR_FLAG(uint32_t flags);
 // Interrupt macros used in storage.c
 #define __disable_irq()
 #define __enable_irq()
+#define __get_PRIMASK() 0U
+#define __set_PRIMASK(priMask) ((void)(priMask))
 
 void NVIC_SystemReset(void);
 
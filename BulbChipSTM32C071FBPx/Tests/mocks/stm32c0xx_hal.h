@@ -11,6 +11,12 @@ typedef struct {
     I2C_InitTypeDef Init;
 } I2C_HandleTypeDef;
 
+typedef enum {
+    HAL_I2C_STATE_RESET = 0x00U,
+    HAL_I2C_STATE_READY = 0x20U,
+    HAL_I2C_STATE_BUSY = 0x24U
+} HAL_I2C_StateTypeDef;
+
 typedef struct {
   uint32_t HourFormat;
   uint32_t AsynchPrediv;
@@ -58,6 +64,19 @@ typedef struct {
 } TIM_Base_InitTypeDef;
 
 typedef struct {
+    volatile uint32_t CR1;
+    volatile uint32_t CCR1;
+    volatile uint32_t CCR2;
+    volatile uint32_t CCR3;
+    volatile uint32_t CCR4;
+    volatile uint32_t ARR;
+    volatile uint32_t CNT;
+    volatile uint32_t SR;
+    volatile uint32_t DIER;
+} TIM_TypeDef;
+
+typedef struct {
+  TIM_TypeDef *Instance;
   TIM_Base_InitTypeDef Init;
   // ...
 } TIM_HandleTypeDef;
@@ -85,14 +104,6 @@ typedef enum {
 #define GPIO_PIN_15                ((uint16_t)0x8000)  /* Pin 15 selected   */
 #define GPIO_PIN_All               ((uint16_t)0xFFFF)  /* All pins selected */
 
-typedef struct {
-    volatile uint32_t CR1;
-    volatile uint32_t CCR1;
-    volatile uint32_t CCR2;
-    volatile uint32_t CCR3;
-    volatile uint32_t CCR4;
-    volatile uint32_t ARR;
-} TIM_TypeDef;
 #define TIM_CR1_CEN  (0x1U)
 extern TIM_TypeDef mockTIM1;
 #define TIM1  (&mockTIM1)
@@ -141,6 +152,10 @@ extern GPIO_TypeDef mockGPIOA;
 // Prototypes
 HAL_StatusTypeDef HAL_I2C_Mem_Read(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
 HAL_StatusTypeDef HAL_I2C_Mem_Write(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size, uint32_t Timeout);
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size);
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(I2C_HandleTypeDef *hi2c, uint16_t DevAddress, uint16_t MemAddress, uint16_t MemAddSize, uint8_t *pData, uint16_t Size);
+HAL_I2C_StateTypeDef HAL_I2C_GetState(const I2C_HandleTypeDef *hi2c);
+uint32_t HAL_GetTick(void);
 void HAL_GPIO_Init(GPIO_TypeDef *GPIOx, GPIO_InitTypeDef *GPIO_Init);
 GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin);
 void HAL_GPIO_WritePin(GPIO_TypeDef* GPIOx, uint16_t GPIO_Pin, GPIO_PinState PinState);
@@ -169,7 +184,9 @@ uint32_t HAL_RCC_GetPCLK1Freq(void);
 #define RTC_DAYLIGHTSAVING_NONE 0U
 #define RTC_STOREOPERATION_RESET 0U
 #define RTC_ALARMMASK_NONE 0U
+#define RTC_ALARMMASK_DATEWEEKDAY 0x80000000U
 #define RTC_ALARMSUBSECONDMASK_ALL 0U
+#define RTC_ALARMSUBSECONDMASK_NONE 0x0F000000U
 #define RTC_ALARMDATEWEEKDAYSEL_DATE 0U
 #define RTC_ALARM_A 0U
 #define RTC_FLAG_ALRAF 0x00000001U
@@ -196,6 +213,8 @@ uint32_t HAL_RCC_GetPCLK1Freq(void);
 #define __HAL_GPIO_EXTI_CLEAR_FLAG(__EXTI_LINE__) (mockLastExtiClearedLine = (__EXTI_LINE__))
 
 #define __HAL_RTC_ALARM_CLEAR_FLAG(__HANDLE__, __FLAG__) ((void)(__HANDLE__), (void)(__FLAG__))
+#define __HAL_RTC_WRITEPROTECTION_DISABLE(__HANDLE__) ((void)(__HANDLE__))
+#define __HAL_RTC_WRITEPROTECTION_ENABLE(__HANDLE__) ((void)(__HANDLE__))
 
 // RCC/CRS mock for HSI48 gating (enableUsbClock)
 typedef struct {
@@ -231,10 +250,28 @@ extern CRS_TypeDef mockCRS;
 #define RCC_CR_HSIDIV    0x0000E000U
 #define RCC_HSI_DIV1     0x00000000U
 #define RCC_HSI_DIV4     0x00004000U
+#define RCC_HSI_DIV16    0x00008000U
 #ifndef MODIFY_REG
 #define MODIFY_REG(REG, CLEARMASK, SETMASK)  ((REG) = (((REG) & (~(CLEARMASK))) | (SETMASK)))
 #endif
 
+#define TIM_EVENTSOURCE_UPDATE 0x00000001U
+#define __HAL_TIM_GET_AUTORELOAD(__HANDLE__) ((__HANDLE__)->Instance->ARR)
+#define __HAL_TIM_GET_COUNTER(__HANDLE__) ((__HANDLE__)->Instance->CNT)
+#define __HAL_TIM_SET_COUNTER(__HANDLE__, __COUNTER__) ((__HANDLE__)->Instance->CNT = (__COUNTER__))
+#define __HAL_TIM_SET_AUTORELOAD(__HANDLE__, __AUTORELOAD__) \
+  ((__HANDLE__)->Instance->ARR = (__AUTORELOAD__), (__HANDLE__)->Init.Period = (__AUTORELOAD__))
+#define TIM_FLAG_UPDATE 0x00000001U
+#define TIM_IT_UPDATE 0x00000001U
+#define __HAL_TIM_CLEAR_FLAG(__HANDLE__, __FLAG__) ((__HANDLE__)->Instance->SR = ~(__FLAG__))
+#define __HAL_TIM_ENABLE_IT(__HANDLE__, __INTERRUPT__) \
+  ((__HANDLE__)->Instance->DIER |= (__INTERRUPT__))
+#define __HAL_TIM_DISABLE_IT(__HANDLE__, __INTERRUPT__) \
+  ((__HANDLE__)->Instance->DIER &= ~(__INTERRUPT__))
+HAL_StatusTypeDef HAL_TIM_GenerateEvent(TIM_HandleTypeDef *htim, uint32_t EventSource);
+
+#define LSI_VALUE 32000U
+
 // Timer prescaler macro — persists value so tests can assert the change
 #define __HAL_TIM_SET_PRESCALER(__HANDLE__, __PRESC__)  ((__HANDLE__)->Init.Prescaler = (__PRESC__))
 
@@ -245,12 +282,14 @@ static uint32_t uwTickPrio;
 
 // I2C init
 HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c);
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c);
 HAL_StatusTypeDef HAL_RTC_GetTime(RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *sTime, uint32_t Format);
 HAL_StatusTypeDef HAL_RTC_GetDate(
   const RTC_HandleTypeDef *hrtc, RTC_DateTypeDef *sDate, uint32_t Format);
 HAL_StatusTypeDef HAL_RTC_SetAlarm_IT(
   RTC_HandleTypeDef *hrtc, RTC_AlarmTypeDef *sAlarm, uint32_t Format);
 HAL_StatusTypeDef HAL_RTC_DeactivateAlarm(RTC_HandleTypeDef *hrtc, uint32_t Alarm);
+HAL_StatusTypeDef HAL_RTC_WaitForSynchro(RTC_HandleTypeDef *hrtc);
 void HAL_PWR_EnableWakeUpPin(uint32_t WakeUpPinPolarity);
 void HAL_PWR_DisableWakeUpPin(uint32_t WakeUpPinx);
 HAL_StatusTypeDef HAL_PWREx_EnableGPIOPullUp(uint32_t GPIO, uint32_t GPIONumber);
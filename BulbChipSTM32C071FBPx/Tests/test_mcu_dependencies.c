@@ -14,6 +14,8 @@ FLASH_TypeDef mockFlashPeripheral;
 FLASH_TypeDef *FLASH = &mockFlashPeripheral;
 TIM_TypeDef mockTIM1;
 TIM_TypeDef mockTIM3;
+TIM_TypeDef mockTIM2;
+TIM_TypeDef mockTIM17;
 RCC_TypeDef mockRCC = {.CR = RCC_CR_HSIUSB48RDY};
 CRS_TypeDef mockCRS;
 I2C_HandleTypeDef hi2c1;
@@ -33,6 +35,20 @@ static uint32_t i2cInitCallCount = 0;
 static RTC_TimeTypeDef mockRtcTime;
 static RTC_DateTypeDef mockRtcDate;
 static RTC_AlarmTypeDef lastRtcAlarm;
+// when set, the RTC reads this time once Stop mode is entered, as if it kept running while asleep
+static bool advanceRtcDuringStop = false;
+static RTC_TimeTypeDef mockRtcTimeAfterStop;
+// like the shadow registers, reads keep returning the time Stop began until the next resync
+static bool mockRtcShadowStale = false;
+static RTC_TimeTypeDef mockRtcShadowTime;
+static uint32_t rtcWaitForSynchroCallCount = 0;
+// reads the clock from inside Stop the way the button interrupt that wakes the chip does
+static bool readRtcOnStopWake = false;
+static uint32_t rtcMillisecondsOnStopWake = 0;
+static bool interruptRtcRead = false;
+static RTC_TimeTypeDef mockRtcTimeInInterrupt = {0};
+static uint32_t rtcMillisecondsInInterrupt = 0;
+uint32_t rtcMilliseconds(void);
 static uint32_t rtcSetAlarmCallCount = 0;
 static uint32_t rtcDeactivateAlarmCallCount = 0;
 static uint32_t wakeUpPinEnableCallCount = 0;
@@ -44,7 +60,10 @@ static uint32_t enterStandbyModeCallCount = 0;
 static uint32_t systemClockConfigCallCount = 0;
 static uint32_t autoOffTimerStartCallCount = 0;
 static uint32_t autoOffTimerStopCallCount = 0;
+static uint32_t autoOffTimerUpdateEventCount = 0;
 static uint32_t errorHandlerCallCount = 0;
+static uint32_t mockPclk1Freq = 1000000;
+static uint32_t hsiDividerDuringFlashWrite = 0;
 static GPIO_TypeDef *lastGpioReadPort = NULL;
 static uint16_t lastGpioReadPin = 0;
 static GPIO_PinState mockButtonPinState = GPIO_PIN_RESET;
@@ -72,24 +91,22 @@ static GpioWriteRecord gpioWrites[MAX_GPIO_WRITES];
 static uint32_t gpioWriteCount = 0;
 
 // HAL stubs
-HAL_StatusTypeDef HAL_I2C_Mem_Read(
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(
     I2C_HandleTypeDef *hi2c,
     uint16_t DevAddress,
     uint16_t MemAddress,
     uint16_t MemAddSize,
     uint8_t *pData,
-    uint16_t Size,
-    uint32_t Timeout) {
+    uint16_t Size) {
     return HAL_OK;
 }
-HAL_StatusTypeDef HAL_I2C_Mem_Write(
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(
     I2C_HandleTypeDef *hi2c,
     uint16_t DevAddress,
     uint16_t MemAddress,
     uint16_t MemAddSize,
     uint8_t *pData,
-    uint16_t Size,
-    uint32_t Timeout) {
+    uint16_t Size) {
     return HAL_OK;
 }
 GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
@@ -136,20 +153,36 @@ HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim) {
     }
     return HAL_OK;
 }
+HAL_StatusTypeDef HAL_TIM_GenerateEvent(TIM_HandleTypeDef *htim, uint32_t EventSource) {
+    if (htim == &htim17 && EventSource == TIM_EVENTSOURCE_UPDATE) {
+        autoOffTimerUpdateEventCount++;
+        htim->Instance->CNT = 0;
+    }
+    return HAL_OK;
+}
 void HAL_RCC_GetClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t *pFLatency) {
 }
 uint32_t HAL_RCC_GetPCLK1Freq(void) {
-    return 1000000;
+    return mockPclk1Freq;
 }
 HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c) {
     i2cInitCallCount++;
     return HAL_OK;
 }
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c) {
+    return HAL_OK;
+}
+HAL_I2C_StateTypeDef HAL_I2C_GetState(const I2C_HandleTypeDef *hi2c) {
+    return HAL_I2C_STATE_READY;
+}
+uint32_t HAL_GetTick(void) {
+    return 0;
+}
 HAL_StatusTypeDef HAL_RTC_GetTime(
     RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *sTime, uint32_t Format) {
     (void)hrtc;
     (void)Format;
-    *sTime = mockRtcTime;
+    *sTime = mockRtcShadowStale ? mockRtcShadowTime : mockRtcTime;
     return HAL_OK;
 }
 HAL_StatusTypeDef HAL_RTC_GetDate(
@@ -157,6 +190,12 @@ HAL_StatusTypeDef HAL_RTC_GetDate(
     (void)hrtc;
     (void)Format;
     *sDate = mockRtcDate;
+    if (interruptRtcRead) {
+        // the button EXTI lands after the main loop read the RTC, before it stored the read
+        interruptRtcRead = false;
+        mockRtcTime = mockRtcTimeInInterrupt;
+        rtcMillisecondsInInterrupt = rtcMilliseconds();
+    }
     return HAL_OK;
 }
 HAL_StatusTypeDef HAL_RTC_SetAlarm_IT(
@@ -167,6 +206,12 @@ HAL_StatusTypeDef HAL_RTC_SetAlarm_IT(
     lastRtcAlarm = *sAlarm;
     return HAL_OK;
 }
+HAL_StatusTypeDef HAL_RTC_WaitForSynchro(RTC_HandleTypeDef *hrtc) {
+    (void)hrtc;
+    rtcWaitForSynchroCallCount++;
+    mockRtcShadowStale = false;
+    return HAL_OK;
+}
 HAL_StatusTypeDef HAL_RTC_DeactivateAlarm(RTC_HandleTypeDef *hrtc, uint32_t Alarm) {
     (void)hrtc;
     (void)Alarm;
@@ -204,6 +249,14 @@ void HAL_PWR_EnterSTOPMode(uint32_t Regulator, uint8_t STOPEntry) {
     (void)Regulator;
     (void)STOPEntry;
     enterStopModeCallCount++;
+    if (advanceRtcDuringStop) {
+        mockRtcShadowTime = mockRtcTime;
+        mockRtcShadowStale = true;
+        mockRtcTime = mockRtcTimeAfterStop;
+        if (readRtcOnStopWake) {
+            rtcMillisecondsOnStopWake = rtcMilliseconds();
+        }
+    }
 }
 void HAL_PWR_EnterSTANDBYMode(void) {
     enterStandbyModeCallCount++;
@@ -211,6 +264,7 @@ void HAL_PWR_EnterSTANDBYMode(void) {
 
 void SystemClock_Config(void) {
     systemClockConfigCallCount++;
+    MODIFY_REG(mockRCC.CR, RCC_CR_HSIDIV, RCC_HSI_DIV4);
 }
 
 void Error_Handler(void) {
@@ -234,6 +288,7 @@ bool tud_connected(void) {
 
 // Flash stubs — not under test here, just satisfying linker
 HAL_StatusTypeDef HAL_FLASH_Unlock(void) {
+    hsiDividerDuringFlashWrite = mockRCC.CR & RCC_CR_HSIDIV;
     return HAL_OK;
 }
 HAL_StatusTypeDef FLASH_WaitForLastOperation(uint32_t Timeout) {
@@ -265,6 +320,16 @@ void setUp(void) {
     memset(&mockRtcTime, 0, sizeof(mockRtcTime));
     mockRtcDate = (RTC_DateTypeDef){.WeekDay = 1, .Month = 1, .Date = 1, .Year = 0};
     memset(&lastRtcAlarm, 0, sizeof(lastRtcAlarm));
+    advanceRtcDuringStop = false;
+    memset(&mockRtcTimeAfterStop, 0, sizeof(mockRtcTimeAfterStop));
+    mockRtcShadowStale = false;
+    rtcWaitForSynchroCallCount = 0;
+    readRtcOnStopWake = false;
+    rtcMillisecondsOnStopWake = 0;
+    interruptRtcRead = false;
+    rtcMillisecondsInInterrupt = 0;
+    hrtc.Init.AsynchPrediv = 127;
+    hrtc.Init.SynchPrediv = 255;
     rtcSetAlarmCallCount = 0;
     rtcDeactivateAlarmCallCount = 0;
     wakeUpPinEnableCallCount = 0;
@@ -277,7 +342,10 @@ void setUp(void) {
     systemClockConfigCallCount = 0;
     autoOffTimerStartCallCount = 0;
     autoOffTimerStopCallCount = 0;
+    autoOffTimerUpdateEventCount = 0;
     errorHandlerCallCount = 0;
+    mockPclk1Freq = 1000000;
+    hsiDividerDuringFlashWrite = 0;
     lastGpioReadPort = NULL;
     lastGpioReadPin = 0;
     mockButtonPinState = GPIO_PIN_RESET;
@@ -287,6 +355,24 @@ void setUp(void) {
     // Reset timer prescalers to a known sentinel so tests can detect changes
     htim1.Init.Prescaler = 0xFFFFFFFFU;
     htim3.Init.Prescaler = 0xFFFFFFFFU;
+    memset(&mockTIM2, 0, sizeof(mockTIM2));
+    htim2.Instance = &mockTIM2;
+    htim2.Init.Prescaler = CHIP_TICK_PRESCALER_12MHZ;
+    htim2.Init.Period = CHIP_TICK_PERIOD_12MHZ;
+    mockTIM2.ARR = CHIP_TICK_PERIOD_12MHZ;
+    memset(&mockTIM17, 0, sizeof(mockTIM17));
+    htim17.Instance = &mockTIM17;
+    htim17.Init.Prescaler = 1874;
+    mockTIM17.ARR = 63999;
+    clockLevel = CLOCK_LEVEL_NORMAL;
+    usbClockRequested = false;
+    lowPowerClockRequested = false;
+    fullSpeedClockHeld = false;
+    tickMultiplier = 0;
+    rebaseTicks = 0;
+    rebaseMilliseconds = 0;
+    lastTicks = 0;
+    lastMilliseconds = 0;
     // Set PA8 to GPIO output mode (MODER bits [17:16] = 0b01) — simulates
     // the pin state after CubeMX init, before any AF reconfiguration.
     mockGPIOA.MODER = (0x1U << (8U * 2U));
@@ -569,6 +655,233 @@ void test_EnterStopModeWithRtcAlarm_SchedulesAlarmAndRestoresClock(void) {
     TEST_ASSERT_EQUAL_UINT32(0, errorHandlerCallCount);
 }
 
+void test_EnterStopModeForMilliseconds_WakesOnSubSecondAlarm(void) {
+    mockRtcTime = (RTC_TimeTypeDef){.Hours = 1, .Minutes = 2, .Seconds = 3, .SubSeconds = 255};
+    advanceRtcDuringStop = true;
+    mockRtcTimeAfterStop =
+        (RTC_TimeTypeDef){.Hours = 1, .Minutes = 2, .Seconds = 3, .SubSeconds = 230};
+    mockRCC.CR |= RCC_CR_HSIUSB48ON;
+
+    // 100 ms is 25 RTC counts of 4 ms, read once the shadow registers caught up with the wake
+    uint32_t slept = enterStopModeForMilliseconds(100);
+
+    TEST_ASSERT_EQUAL_UINT32(100, slept);
+    TEST_ASSERT_EQUAL_UINT32(1, rtcWaitForSynchroCallCount);
+    TEST_ASSERT_EQUAL_UINT32(1, rtcSetAlarmCallCount);
+    TEST_ASSERT_EQUAL_UINT8(3, lastRtcAlarm.AlarmTime.Seconds);
+    TEST_ASSERT_EQUAL_UINT32(230, lastRtcAlarm.AlarmTime.SubSeconds);
+    TEST_ASSERT_EQUAL_UINT32(RTC_ALARMSUBSECONDMASK_NONE, lastRtcAlarm.AlarmSubSecondMask);
+    TEST_ASSERT_EQUAL_UINT32(1, enterStopModeCallCount);
+    TEST_ASSERT_EQUAL_UINT32(1, systemClockConfigCallCount);
+    TEST_ASSERT_EQUAL_UINT32(0, READ_BIT(mockRCC.CR, RCC_CR_HSIUSB48ON));
+    TEST_ASSERT_EQUAL_UINT32(0, errorHandlerCallCount);
+}
+
+void test_EnterStopModeForMilliseconds_AlarmCarriesIntoNextSecond(void) {
+    mockRtcTime = (RTC_TimeTypeDef){.Hours = 0, .Minutes = 0, .Seconds = 59, .SubSeconds = 10};
+
+    enterStopModeForMilliseconds(100);
+
+    TEST_ASSERT_EQUAL_UINT8(1, lastRtcAlarm.AlarmTime.Minutes);
+    TEST_ASSERT_EQUAL_UINT8(0, lastRtcAlarm.AlarmTime.Seconds);
+    TEST_ASSERT_EQUAL_UINT32(241, lastRtcAlarm.AlarmTime.SubSeconds);
+}
+
+void test_EnterStopModeForMilliseconds_SkipsSleepShorterThanOneCount(void) {
+    TEST_ASSERT_EQUAL_UINT32(0, enterStopModeForMilliseconds(3));
+    TEST_ASSERT_EQUAL_UINT32(0, enterStopModeCallCount);
+    TEST_ASSERT_EQUAL_UINT32(0, rtcSetAlarmCallCount);
+}
+
+void test_RtcMilliseconds_CountsFromFirstReadAcrossMidnight(void) {
+    rtcClockStarted = false;
+    rtcElapsedCounts = 0;
+    mockRtcTime = (RTC_TimeTypeDef){.Hours = 23, .Minutes = 59, .Seconds = 59, .SubSeconds = 255};
+    TEST_ASSERT_EQUAL_UINT32(0, rtcMilliseconds());
+
+    // 262 counts of 4 ms later the time of day has wrapped
+    mockRtcTime = (RTC_TimeTypeDef){.Hours = 0, .Minutes = 0, .Seconds = 0, .SubSeconds = 249};
+    TEST_ASSERT_EQUAL_UINT32(1048, rtcMilliseconds());
+    TEST_ASSERT_EQUAL_UINT32(1048, rtcMilliseconds());
+}
+
+void test_RtcMilliseconds_ReadInterruptedByButtonDoesNotStepBack(void) {
+    rtcClockStarted = false;
+    rtcElapsedCounts = 0;
+    mockRtcTime = (RTC_TimeTypeDef){.Seconds = 10, .SubSeconds = 255};
+    TEST_ASSERT_EQUAL_UINT32(0, rtcMilliseconds());
+
+    mockRtcTime = (RTC_TimeTypeDef){.Seconds = 10, .SubSeconds = 230};
+    interruptRtcRead = true;
+    mockRtcTimeInInterrupt = (RTC_TimeTypeDef){.Seconds = 10, .SubSeconds = 205};
+
+    TEST_ASSERT_EQUAL_UINT32(200, rtcMilliseconds());
+    TEST_ASSERT_EQUAL_UINT32(200, rtcMillisecondsInInterrupt);
+    TEST_ASSERT_EQUAL_UINT32(200, rtcMilliseconds());
+}
+
+void test_RtcMilliseconds_ClickThatWakesStopMeasuresOnlyTheHold(void) {
+    rtcClockStarted = false;
+    rtcElapsedCounts = 0;
+    mockRtcTime = (RTC_TimeTypeDef){.Seconds = 10, .SubSeconds = 255};
+    TEST_ASSERT_EQUAL_UINT32(0, rtcMilliseconds());
+
+    // the press edge is timestamped in the interrupt that ends a 30 s idle sleep, 7500 counts
+    advanceRtcDuringStop = true;
+    readRtcOnStopWake = true;
+    mockRtcTimeAfterStop = (RTC_TimeTypeDef){.Seconds = 39, .SubSeconds = 179};
+    TEST_ASSERT_EQUAL_UINT32(30000, enterStopModeForMilliseconds(30000));
+    TEST_ASSERT_EQUAL_UINT32(30000, rtcMillisecondsOnStopWake);
+
+    // released 100 ms later, a click and not a hold through the whole sleep
+    mockRtcTime = (RTC_TimeTypeDef){.Seconds = 39, .SubSeconds = 154};
+    TEST_ASSERT_EQUAL_UINT32(100, rtcMilliseconds() - rtcMillisecondsOnStopWake);
+}
+
+void test_EnterStopModeForMilliseconds_AdvancesRunningAutoOffTimer(void) {
+    mockRtcTime = (RTC_TimeTypeDef){.Seconds = 10, .SubSeconds = 255};
+    advanceRtcDuringStop = true;
+    mockRtcTimeAfterStop = (RTC_TimeTypeDef){.Seconds = 10, .SubSeconds = 5};
+    mockTIM17.CR1 = TIM_CR1_CEN;
+    mockTIM17.CNT = 100;
+
+    // TIM17 counts at 1 MHz / 1875, 533 counts a second
+    TEST_ASSERT_EQUAL_UINT32(1000, enterStopModeForMilliseconds(1000));
+    TEST_ASSERT_EQUAL_UINT32(633, mockTIM17.CNT);
+    TEST_ASSERT_EQUAL_UINT32(0, autoOffTimerUpdateEventCount);
+
+    mockRtcTime = (RTC_TimeTypeDef){.Seconds = 20, .SubSeconds = 255};
+    mockRtcTimeAfterStop = (RTC_TimeTypeDef){.Seconds = 20, .SubSeconds = 5};
+    mockTIM17.CNT = 63800;
+
+    enterStopModeForMilliseconds(1000);
+    TEST_ASSERT_EQUAL_UINT32(1, autoOffTimerUpdateEventCount);
+    TEST_ASSERT_EQUAL_UINT32(333, mockTIM17.CNT);
+}
+
+void test_EnterStopModeForMilliseconds_LeavesStoppedAutoOffTimer(void) {
+    mockRtcTime = (RTC_TimeTypeDef){.Seconds = 10, .SubSeconds = 255};
+    advanceRtcDuringStop = true;
+    mockRtcTimeAfterStop = (RTC_TimeTypeDef){.Seconds = 10, .SubSeconds = 5};
+    mockTIM17.CNT = 100;
+
+    enterStopModeForMilliseconds(1000);
+
+    TEST_ASSERT_EQUAL_UINT32(100, mockTIM17.CNT);
+    TEST_ASSERT_EQUAL_UINT32(0, autoOffTimerUpdateEventCount);
+}
+
+void test_EnableLowPowerClock_DropsTo3MhzAndKeepsTimerRates(void) {
+    mockTIM2.CNT = 7500;
+    mockTIM17.CNT = 32000;
+
+    enableLowPowerClock(true);
+
+    TEST_ASSERT_EQUAL_HEX32(RCC_HSI_DIV16, mockRCC.CR & RCC_CR_HSIDIV);
+    TEST_ASSERT_EQUAL_HEX32(I2C_TIMING_3MHZ, hi2c1.Init.Timing);
+    TEST_ASSERT_EQUAL_UINT32(1, i2cInitCallCount);
+    TEST_ASSERT_EQUAL_UINT32(PWM_PRESCALER_3MHZ, htim1.Init.Prescaler);
+    TEST_ASSERT_EQUAL_UINT32(CHIP_TICK_PERIOD_3MHZ, htim2.Init.Period);
+    TEST_ASSERT_EQUAL_UINT32(CHIP_TICK_PERIOD_3MHZ, mockTIM2.ARR);
+    TEST_ASSERT_EQUAL_UINT32(AUTO_OFF_PERIOD_3MHZ, mockTIM17.ARR);
+    // counts in flight keep their place in the period
+    TEST_ASSERT_EQUAL_UINT32(1874, mockTIM2.CNT);
+    TEST_ASSERT_EQUAL_UINT32(8000, mockTIM17.CNT);
+
+    enableLowPowerClock(false);
+
+    TEST_ASSERT_EQUAL_HEX32(RCC_HSI_DIV4, mockRCC.CR & RCC_CR_HSIDIV);
+    TEST_ASSERT_EQUAL_HEX32(I2C_TIMING_12MHZ, hi2c1.Init.Timing);
+    TEST_ASSERT_EQUAL_UINT32(PWM_PRESCALER_12MHZ, htim1.Init.Prescaler);
+    TEST_ASSERT_EQUAL_UINT32(CHIP_TICK_PERIOD_12MHZ, mockTIM2.ARR);
+    TEST_ASSERT_EQUAL_UINT32(AUTO_OFF_PERIOD_12MHZ, mockTIM17.ARR);
+}
+
+void test_EnableLowPowerClock_UsbTakesPrecedence(void) {
+    enableLowPowerClock(true);
+    enableUsbClock(true);
+
+    TEST_ASSERT_EQUAL_HEX32(RCC_HSI_DIV1, mockRCC.CR & RCC_CR_HSIDIV);
+    TEST_ASSERT_EQUAL_UINT32(PWM_PRESCALER_48MHZ, htim1.Init.Prescaler);
+    TEST_ASSERT_EQUAL_UINT32(CHIP_TICK_PRESCALER_48MHZ, htim2.Init.Prescaler);
+    TEST_ASSERT_EQUAL_UINT32(CHIP_TICK_PERIOD_12MHZ, mockTIM2.ARR);
+
+    i2cInitCallCount = 0;
+    enableLowPowerClock(true);
+    TEST_ASSERT_EQUAL_UINT32(0, i2cInitCallCount);
+
+    enableUsbClock(false);
+    TEST_ASSERT_EQUAL_HEX32(RCC_HSI_DIV16, mockRCC.CR & RCC_CR_HSIDIV);
+    TEST_ASSERT_EQUAL_UINT32(CHIP_TICK_PRESCALER_12MHZ, htim2.Init.Prescaler);
+}
+
+void test_ConvertTicksToMilliseconds_ContinuousAcrossTickRateChange(void) {
+    // 12 MHz with 1 ms ticks
+    mockPclk1Freq = 12000000;
+    htim2.Init.Prescaler = 0;
+    htim2.Init.Period = 11999;
+    TEST_ASSERT_EQUAL_UINT32(1000, convertTicksToMilliseconds(1000));
+
+    // ticks become twice as long, only ticks from here on count double
+    htim2.Init.Prescaler = 1;
+    tickMultiplier = 0;
+    TEST_ASSERT_EQUAL_UINT32(1000, convertTicksToMilliseconds(1000));
+    TEST_ASSERT_EQUAL_UINT32(1200, convertTicksToMilliseconds(1100));
+}
+
+void test_ConvertTicksToMilliseconds_SameTickRateAtEveryClockLevel(void) {
+    mockPclk1Freq = 12000000;
+    uint32_t ms = convertTicksToMilliseconds(800);
+
+    mockPclk1Freq = 3000000;
+    enableLowPowerClock(true);
+    TEST_ASSERT_EQUAL_UINT32(ms, convertTicksToMilliseconds(800));
+    TEST_ASSERT_UINT32_WITHIN(1, ms + 1000, convertTicksToMilliseconds(1600));
+
+    mockPclk1Freq = 48000000;
+    enableUsbClock(true);
+    TEST_ASSERT_UINT32_WITHIN(1, ms + 2000, convertTicksToMilliseconds(2400));
+}
+
+void test_EnableLedDither_TogglesUpdateInterrupt(void) {
+    memset(&mockTIM1, 0, sizeof(mockTIM1));
+    memset(&mockTIM3, 0, sizeof(mockTIM3));
+    htim1.Instance = &mockTIM1;
+    htim3.Instance = &mockTIM3;
+    mockTIM1.SR = TIM_FLAG_UPDATE;
+
+    enableCaseLedDither(true);
+    enableFrontLedDither(true);
+    // a stale update flag would fire the interrupt straight away
+    TEST_ASSERT_EQUAL_UINT32(0, mockTIM1.SR & TIM_FLAG_UPDATE);
+    TEST_ASSERT_EQUAL_UINT32(TIM_IT_UPDATE, mockTIM1.DIER);
+    TEST_ASSERT_EQUAL_UINT32(TIM_IT_UPDATE, mockTIM3.DIER);
+
+    enableCaseLedDither(false);
+    enableFrontLedDither(false);
+    TEST_ASSERT_EQUAL_UINT32(0, mockTIM1.DIER);
+    TEST_ASSERT_EQUAL_UINT32(0, mockTIM3.DIER);
+}
+
+void test_WriteSettingsToFlash_RaisesLowPowerClockForTheWrite(void) {
+    enableLowPowerClock(true);
+
+    writeSettingsToFlash("{}", 2);
+
+    TEST_ASSERT_EQUAL_HEX32(RCC_HSI_DIV4, hsiDividerDuringFlashWrite);
+    TEST_ASSERT_EQUAL_HEX32(RCC_HSI_DIV16, mockRCC.CR & RCC_CR_HSIDIV);
+}
+
+void test_EnterStopModeForMilliseconds_ReturnsToLowPowerClock(void) {
+    mockRtcTime = (RTC_TimeTypeDef){.Seconds = 10, .SubSeconds = 255};
+    enableLowPowerClock(true);
+
+    enterStopModeForMilliseconds(100);
+
+    TEST_ASSERT_EQUAL_UINT32(1, systemClockConfigCallCount);
+    TEST_ASSERT_EQUAL_HEX32(RCC_HSI_DIV16, mockRCC.CR & RCC_CR_HSIDIV);
+}
+
 void test_WaitForButtonWakeOrAutoLock_ReturnsFalse_AfterTimeout(void) {
 #ifdef MICROLIGHT_LEGACY_PCB_BUTTON_PA7
     mockButtonPinState = GPIO_PIN_SET;
@@ -618,18 +931,33 @@ void test_WasWakeFromButton_ReturnsTrueAndClearsFlag(void) {
 
 int main(void) {
     UNITY_BEGIN();
+    RUN_TEST(test_ConvertTicksToMilliseconds_ContinuousAcrossTickRateChange);
+    RUN_TEST(test_ConvertTicksToMilliseconds_SameTickRateAtEveryClockLevel);
     RUN_TEST(test_EnableAutoOffTimer_UsesTim17);
     RUN_TEST(test_EnableFrontLedTimer_GpioReconfigurationRoundTrip);
+    RUN_TEST(test_EnableLedDither_TogglesUpdateInterrupt);
+    RUN_TEST(test_EnableLowPowerClock_DropsTo3MhzAndKeepsTimerRates);
+    RUN_TEST(test_EnableLowPowerClock_UsbTakesPrecedence);
     RUN_TEST(test_EnableUsbClock_Disable_TearsDownClocksAndI2C);
     RUN_TEST(test_EnableUsbClock_Enable_SetsUpClocksAndI2C);
     RUN_TEST(test_EnableUsbClock_InvalidatesTickMultiplier);
     RUN_TEST(test_EnterStandbyMode_ConfiguresWakePinAndClearsFlags);
+    RUN_TEST(test_EnterStopModeForMilliseconds_AdvancesRunningAutoOffTimer);
+    RUN_TEST(test_EnterStopModeForMilliseconds_AlarmCarriesIntoNextSecond);
+    RUN_TEST(test_EnterStopModeForMilliseconds_LeavesStoppedAutoOffTimer);
+    RUN_TEST(test_EnterStopModeForMilliseconds_ReturnsToLowPowerClock);
+    RUN_TEST(test_EnterStopModeForMilliseconds_SkipsSleepShorterThanOneCount);
+    RUN_TEST(test_EnterStopModeForMilliseconds_WakesOnSubSecondAlarm);
     RUN_TEST(test_EnterStopModeWithRtcAlarm_SchedulesAlarmAndRestoresClock);
     RUN_TEST(test_FrontBluePin_ReconfiguresBetweenGpioAndPwm);
     RUN_TEST(test_ReadButtonPin_UsesConfiguredButtonPin);
+    RUN_TEST(test_RtcMilliseconds_ClickThatWakesStopMeasuresOnlyTheHold);
+    RUN_TEST(test_RtcMilliseconds_CountsFromFirstReadAcrossMidnight);
+    RUN_TEST(test_RtcMilliseconds_ReadInterruptedByButtonDoesNotStepBack);
     RUN_TEST(test_WaitForButtonWakeOrAutoLock_ReturnsFalse_AfterTimeout);
     RUN_TEST(test_WaitForButtonWakeOrAutoLock_ReturnsTrue_OnButtonWake);
     RUN_TEST(test_WasWakeFromButton_ReturnsTrueAndClearsFlag);
     RUN_TEST(test_WriteBulbLed_Legacy_DrivesBothBulbAndFBluePins);
+    RUN_TEST(test_WriteSettingsToFlash_RaisesLowPowerClockForTheWrite);
     return UNITY_END();
 }
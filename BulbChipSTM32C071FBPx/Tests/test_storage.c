@@ -30,24 +30,22 @@ TIM_HandleTypeDef htim17;
 PWR_TypeDef mockPWR;
 uint16_t mockLastExtiClearedLine;
 
-HAL_StatusTypeDef HAL_I2C_Mem_Read(
+HAL_StatusTypeDef HAL_I2C_Mem_Read_IT(
     I2C_HandleTypeDef *hi2c,
     uint16_t DevAddress,
     uint16_t MemAddress,
     uint16_t MemAddSize,
     uint8_t *pData,
-    uint16_t Size,
-    uint32_t Timeout) {
+    uint16_t Size) {
     return HAL_OK;
 }
-HAL_StatusTypeDef HAL_I2C_Mem_Write(
+HAL_StatusTypeDef HAL_I2C_Mem_Write_IT(
     I2C_HandleTypeDef *hi2c,
     uint16_t DevAddress,
     uint16_t MemAddress,
     uint16_t MemAddSize,
     uint8_t *pData,
-    uint16_t Size,
-    uint32_t Timeout) {
+    uint16_t Size) {
     return HAL_OK;
 }
 GPIO_PinState HAL_GPIO_ReadPin(GPIO_TypeDef *GPIOx, uint16_t GPIO_Pin) {
@@ -70,6 +68,9 @@ HAL_StatusTypeDef HAL_TIM_Base_Start_IT(TIM_HandleTypeDef *htim) {
 HAL_StatusTypeDef HAL_TIM_Base_Stop_IT(TIM_HandleTypeDef *htim) {
     return HAL_OK;
 }
+HAL_StatusTypeDef HAL_TIM_GenerateEvent(TIM_HandleTypeDef *htim, uint32_t EventSource) {
+    return HAL_OK;
+}
 void HAL_RCC_GetClockConfig(RCC_ClkInitTypeDef *RCC_ClkInitStruct, uint32_t *pFLatency) {
 }
 uint32_t HAL_RCC_GetPCLK1Freq(void) {
@@ -78,6 +79,15 @@ uint32_t HAL_RCC_GetPCLK1Freq(void) {
 HAL_StatusTypeDef HAL_I2C_Init(I2C_HandleTypeDef *hi2c) {
     return HAL_OK;
 }
+HAL_StatusTypeDef HAL_I2C_DeInit(I2C_HandleTypeDef *hi2c) {
+    return HAL_OK;
+}
+HAL_I2C_StateTypeDef HAL_I2C_GetState(const I2C_HandleTypeDef *hi2c) {
+    return HAL_I2C_STATE_READY;
+}
+uint32_t HAL_GetTick(void) {
+    return 0;
+}
 HAL_StatusTypeDef HAL_RTC_GetTime(
     RTC_HandleTypeDef *hrtc, RTC_TimeTypeDef *sTime, uint32_t Format) {
     (void)hrtc;
@@ -102,6 +112,10 @@ HAL_StatusTypeDef HAL_RTC_SetAlarm_IT(
     (void)Format;
     return HAL_OK;
 }
+HAL_StatusTypeDef HAL_RTC_WaitForSynchro(RTC_HandleTypeDef *hrtc) {
+    (void)hrtc;
+    return HAL_OK;
+}
 HAL_StatusTypeDef HAL_RTC_DeactivateAlarm(RTC_HandleTypeDef *hrtc, uint32_t Alarm) {
     (void)hrtc;
     (void)Alarm;
@@ -281,9 +295,29 @@ void test_readSettingsFromFlash_ReturnsEmptyString_WhenFlashIsErased(void) {
     TEST_ASSERT_EQUAL_STRING("", readBuf);
 }
 
+void test_telemetryFlash_AppendsDoubleWordsAfterErase(void) {
+    const uint8_t first[8] = {1, 2, 3, 4, 5, 6, 7, 8};
+    const uint8_t second[8] = {9, 10, 11, 12, 13, 14, 15, 16};
+    memset((void *)(uintptr_t)(FLASH_INIT + TELEMETRY_PAGE_0 * PAGE_SECTOR), 0, PAGE_SECTOR);
+
+    eraseTelemetryPage(0);
+    writeTelemetryToFlash(0, first, sizeof(first));
+    writeTelemetryToFlash(8, second, sizeof(second));
+
+    uint8_t readBuf[24];
+    readTelemetryFromFlash(0, readBuf, sizeof(readBuf));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(first, readBuf, 8);
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(second, &readBuf[8], 8);
+    TEST_ASSERT_EQUAL_HEX8(0xFF, readBuf[16]);
+
+    // the ring sits right below the settings page
+    TEST_ASSERT_EQUAL_UINT32(SETTINGS_PAGE, TELEMETRY_PAGE_0 + 2);
+}
+
 int main(void) {
     UNITY_BEGIN();
     RUN_TEST(test_readSettingsFromFlash_ReturnsEmptyString_WhenFlashIsErased);
+    RUN_TEST(test_telemetryFlash_AppendsDoubleWordsAfterErase);
     RUN_TEST(test_writeBulbModeToFlash_WritesDataCorrectly);
     RUN_TEST(test_writeSettingsToFlash_TruncatesIfTooLong);
     RUN_TEST(test_writeSettingsToFlash_WritesDataCorrectly);
@@ -5,23 +5,22 @@
 #include "unity.h"
 #include "usb_dependencies.h"
 
+// TinyUSB callback implemented by usb_dependencies.c
+void tud_vendor_tx_cb(uint8_t itf, uint32_t sent_bytes);
+
 // --- Mocks ---
 
 // TinyUSB Mocks
 static uint32_t mock_tud_write_available = 64;
-static char mock_tud_write_buffer[1024];
+static char mock_tud_write_buffer[2048];
 static int mock_tud_write_idx = 0;
 static int mock_tud_write_calls = 0;
-static char mock_tud_read_buffer[1024];
+static char mock_tud_read_buffer[4096];
 static int mock_tud_read_len = 0;
 static int mock_tud_read_idx = 0;
 static int mock_tud_task_calls = 0;
 static int mock_tud_flush_calls = 0;
 static bool mock_tud_mounted = true;
-static uint32_t mock_board_time_ms = 0;
-static uint32_t mock_board_time_increment_per_task = 0;
-static int mock_write_stall_after_first_write_remaining_tasks = -1;
-static uint32_t mock_write_recovery_available = 0;
 
 // Mock implementations
 bool tud_vendor_n_mounted(uint8_t itf) {
@@ -40,7 +39,9 @@ uint32_t tud_vendor_n_write(uint8_t itf, void const *buffer, uint32_t bufsize) {
     mock_tud_write_idx += bufsize;
     mock_tud_write_calls++;
 
-    if (mock_tud_write_calls == 1 && mock_write_stall_after_first_write_remaining_tasks >= 0) {
+    if (mock_tud_write_available >= bufsize) {
+        mock_tud_write_available -= bufsize;
+    } else {
         mock_tud_write_available = 0;
     }
 
@@ -51,14 +52,6 @@ void tud_task_ext(uint32_t timeout_ms, bool in_isr) {
     (void)timeout_ms;
     (void)in_isr;
     mock_tud_task_calls++;
-    mock_board_time_ms += mock_board_time_increment_per_task;
-
-    if (mock_write_stall_after_first_write_remaining_tasks > 0) {
-        mock_write_stall_after_first_write_remaining_tasks--;
-        if (mock_write_stall_after_first_write_remaining_tasks == 0) {
-            mock_tud_write_available = mock_write_recovery_available;
-        }
-    }
 }
 
 void tud_task(void) {
@@ -71,10 +64,6 @@ uint32_t tud_vendor_n_write_flush(uint8_t itf) {
     return 0;
 }
 
-uint32_t board_millis(void) {
-    return mock_board_time_ms;
-}
-
 uint32_t tud_vendor_n_available(uint8_t itf) {
     if (mock_tud_read_idx >= mock_tud_read_len) return 0;
     return mock_tud_read_len - mock_tud_read_idx;
@@ -99,12 +88,9 @@ void setUp(void) {
     mock_tud_task_calls = 0;
     mock_tud_flush_calls = 0;
     mock_tud_mounted = true;
-    mock_board_time_ms = 0;
-    mock_board_time_increment_per_task = 0;
-    mock_write_stall_after_first_write_remaining_tasks = -1;
-    mock_write_recovery_available = 0;
     memset(mock_tud_write_buffer, 0, sizeof(mock_tud_write_buffer));
     memset(mock_tud_read_buffer, 0, sizeof(mock_tud_read_buffer));
+    usbWriteReset();
     usbReadTaskReset();
 }
 
@@ -118,8 +104,20 @@ void test_usbWrite_simple(void) {
     usbWrite(data, strlen(data));
 
     TEST_ASSERT_EQUAL_STRING_LEN("Hello World", mock_tud_write_buffer, 11);
-    TEST_ASSERT_GREATER_THAN(0, mock_tud_task_calls);
     TEST_ASSERT_EQUAL(1, mock_tud_flush_calls);
+    TEST_ASSERT_EQUAL(USB_TX_RING_SIZE, usbTxFree());
+}
+
+void test_usbWrite_never_runs_usb_task(void) {
+    const char *data = "1234567890";
+    mock_tud_write_available = 0;
+
+    usbWrite(data, 10);
+
+    // Returns right away, the pattern engine is not held up waiting for the host
+    TEST_ASSERT_EQUAL(0, mock_tud_task_calls);
+    TEST_ASSERT_EQUAL(0, mock_tud_write_idx);
+    TEST_ASSERT_EQUAL(USB_TX_RING_SIZE - 10, usbTxFree());
 }
 
 void test_usbWrite_chunked(void) {
@@ -128,53 +126,110 @@ void test_usbWrite_chunked(void) {
     mock_tud_write_available = 5;     // Report only 5 bytes available
     usbWrite(data, 10);
 
-    TEST_ASSERT_EQUAL_STRING_LEN("1234567890", mock_tud_write_buffer, 10);
-    // Should have called task multiple times
-    TEST_ASSERT_GREATER_THAN(1, mock_tud_task_calls);
-}
-
-void test_usbWrite_waits_through_long_backpressure_until_space_returns(void) {
-    const char *data = "1234567890";
+    // The FIFO accepts the first 5 bytes, the rest stays queued
+    TEST_ASSERT_EQUAL(5, mock_tud_write_idx);
 
     mock_tud_write_available = 5;
-    mock_write_stall_after_first_write_remaining_tasks = 1500;
-    mock_write_recovery_available = 5;
-    mock_board_time_increment_per_task = 0;
-
-    usbWrite(data, 10);
+    usbWriteTask();
 
+    TEST_ASSERT_EQUAL(10, mock_tud_write_idx);
     TEST_ASSERT_EQUAL_STRING_LEN("1234567890", mock_tud_write_buffer, 10);
-    TEST_ASSERT_GREATER_THAN(1000, mock_tud_task_calls);
 }
 
-void test_usbWrite_large_payload_waits_for_second_fifo_window(void) {
+void test_usbWrite_drained_by_tx_complete_callback(void) {
     char data[873];
     memset(data, 'A', sizeof(data) - 1);
     data[sizeof(data) - 1] = '\0';
 
     mock_tud_write_available = 512;
-    mock_write_stall_after_first_write_remaining_tasks = 400;
-    mock_write_recovery_available = 512;
-    mock_board_time_increment_per_task = 1;
 
     usbWrite(data, strlen(data));
+    TEST_ASSERT_EQUAL(512, mock_tud_write_idx);
+
+    // Host drained the FIFO
+    mock_tud_write_available = 512;
+    tud_vendor_tx_cb(0, 512);
 
     TEST_ASSERT_EQUAL((int)strlen(data), mock_tud_write_idx);
     TEST_ASSERT_EQUAL_STRING_LEN(data, mock_tud_write_buffer, (int)strlen(data));
-    TEST_ASSERT_GREATER_THAN(400, mock_tud_task_calls);
 }
 
-void test_usbWrite_stops_after_real_timeout_when_host_never_drains(void) {
-    const char *data = "1234567890";
+void test_usbWrite_preserves_order_across_ring_wrap(void) {
+    char first[1500];
+    char second[1000];
+    memset(first, '1', sizeof(first));
+    memset(second, '2', sizeof(second));
+    mock_tud_write_available = 0;
+
+    usbWrite(first, sizeof(first));
+    mock_tud_write_available = sizeof(first);
+    usbWriteTask();
+    TEST_ASSERT_EQUAL((int)sizeof(first), mock_tud_write_idx);
 
+    // Second message straddles the end of the ring
+    mock_tud_write_idx = 0;
     mock_tud_write_available = 0;
-    mock_board_time_increment_per_task = 1;
+    usbWrite(second, sizeof(second));
+    mock_tud_write_available = sizeof(second);
+    usbWriteTask();
+
+    TEST_ASSERT_EQUAL((int)sizeof(second), mock_tud_write_idx);
+    TEST_ASSERT_EQUAL_CHAR('2', mock_tud_write_buffer[0]);
+    TEST_ASSERT_EQUAL_CHAR('2', mock_tud_write_buffer[sizeof(second) - 1]);
+}
+
+void test_usbWrite_drops_whole_message_when_ring_full(void) {
+    char data[1500];
+    memset(data, 'A', sizeof(data));
+    mock_tud_write_available = 0;
+
+    usbWrite(data, sizeof(data));
+    usbWrite(data, sizeof(data));
+
+    TEST_ASSERT_EQUAL(USB_TX_RING_SIZE - sizeof(data), usbTxFree());
+
+    // Only the first message goes out once the host catches up
+    mock_tud_write_available = sizeof(mock_tud_write_buffer);
+    usbWriteTask();
+    TEST_ASSERT_EQUAL(1500, mock_tud_write_idx);
+}
 
+void test_usbWrite_discards_queue_when_unmounted(void) {
+    const char *data = "1234567890";
+    mock_tud_write_available = 0;
     usbWrite(data, 10);
 
+    mock_tud_mounted = false;
+    usbWriteTask();
+
+    mock_tud_mounted = true;
+    mock_tud_write_available = 64;
+    usbWriteTask();
+
     TEST_ASSERT_EQUAL(0, mock_tud_write_idx);
-    TEST_ASSERT_GREATER_THAN(0, mock_tud_task_calls);
-    TEST_ASSERT_LESS_THAN(1100, mock_tud_task_calls);
+}
+
+void test_usbReadTask_holds_line_until_tx_ring_has_room(void) {
+    char response[1500];
+    memset(response, 'R', sizeof(response));
+    mock_tud_write_available = 0;
+    usbWrite(response, sizeof(response));
+    TEST_ASSERT_EQUAL(USB_TX_RING_SIZE - sizeof(response), usbTxFree());
+
+    const char *input = "readMode\n";
+    strcpy(mock_tud_read_buffer, input);
+    mock_tud_read_len = strlen(input);
+
+    // the next response might not fit, the line stays with TinyUSB but IN transfers still complete
+    char buf[1024];
+    TEST_ASSERT_EQUAL(0, usbReadTask(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(0, mock_tud_read_idx);
+    TEST_ASSERT_EQUAL(1, mock_tud_task_calls);
+
+    mock_tud_write_available = sizeof(mock_tud_write_buffer);
+    usbWriteTask();
+    TEST_ASSERT_EQUAL(9, usbReadTask(buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL((int)sizeof(response), mock_tud_write_idx);
 }
 
 void test_usbReadTask_no_data(void) {
@@ -288,18 +343,97 @@ void test_usbReadTask_leftover_overflow(void) {
     TEST_ASSERT_NOT_NULL(strstr(mock_tud_write_buffer, "payload too long"));
 }
 
+void test_usbReadTask_large_payload_lands_in_caller_buffer(void) {
+    // writeMode payloads are close to the full shared JSON buffer
+    static char buf[2048];
+    const int lineLength = 2000;
+    memset(mock_tud_read_buffer, 'x', (size_t)lineLength - 1);
+    mock_tud_read_buffer[lineLength - 1] = '\n';
+    mock_tud_read_len = lineLength;
+
+    int len = usbReadTask(buf, sizeof(buf));
+
+    TEST_ASSERT_EQUAL(lineLength, len);
+    TEST_ASSERT_EQUAL_CHAR('x', buf[0]);
+    TEST_ASSERT_EQUAL_CHAR('x', buf[lineLength - 2]);
+    TEST_ASSERT_EQUAL_CHAR('\n', buf[lineLength - 1]);
+}
+
+void test_usbReadTask_finds_newline_at_every_word_offset(void) {
+    char buf[100];
+    for (int lineLength = 1; lineLength <= 12; lineLength++) {
+        usbReadTaskReset();
+        mock_tud_read_idx = 0;
+        memset(mock_tud_read_buffer, 'a', sizeof(mock_tud_read_buffer));
+        mock_tud_read_buffer[lineLength - 1] = '\n';
+        mock_tud_read_len = lineLength;
+
+        int len = usbReadTask(buf, sizeof(buf));
+
+        TEST_ASSERT_EQUAL(lineLength, len);
+        TEST_ASSERT_EQUAL_CHAR('\n', buf[lineLength - 1]);
+    }
+}
+
+void test_usbReadTask_line_split_across_packets_after_leftover(void) {
+    // The second command starts in the same packet as the first and finishes in a later one
+    const char *input = "cmd1\ncmd";
+    strcpy(mock_tud_read_buffer, input);
+    mock_tud_read_len = (int)strlen(input);
+
+    char buf[100];
+    int len = usbReadTask(buf, 100);
+    TEST_ASSERT_EQUAL(5, len);
+
+    len = usbReadTask(buf, 100);
+    TEST_ASSERT_EQUAL(0, len);
+
+    mock_tud_read_idx = 0;
+    strcpy(mock_tud_read_buffer, "2\n");
+    mock_tud_read_len = 2;
+
+    len = usbReadTask(buf, 100);
+    TEST_ASSERT_EQUAL(5, len);
+    buf[len] = '\0';
+    TEST_ASSERT_EQUAL_STRING("cmd2\n", buf);
+}
+
+void test_usbReadTask_overflow_discards_rest_of_line(void) {
+    char buf[10];
+    const char *input = "12345678901234\nok\n";
+    strcpy(mock_tud_read_buffer, input);
+    mock_tud_read_len = (int)strlen(input);
+
+    int len = usbReadTask(buf, 10);
+    TEST_ASSERT_EQUAL(0, len);
+    TEST_ASSERT_NOT_NULL(strstr(mock_tud_write_buffer, "payload too long"));
+
+    // The tail of the oversized line is dropped instead of being parsed as a new command
+    len = usbReadTask(buf, 10);
+    TEST_ASSERT_EQUAL(3, len);
+    buf[len] = '\0';
+    TEST_ASSERT_EQUAL_STRING("ok\n", buf);
+}
+
 int main(void) {
     UNITY_BEGIN();
+    RUN_TEST(test_usbReadTask_finds_newline_at_every_word_offset);
     RUN_TEST(test_usbReadTask_full_line);
+    RUN_TEST(test_usbReadTask_holds_line_until_tx_ring_has_room);
+    RUN_TEST(test_usbReadTask_large_payload_lands_in_caller_buffer);
     RUN_TEST(test_usbReadTask_leftover_overflow);
+    RUN_TEST(test_usbReadTask_line_split_across_packets_after_leftover);
     RUN_TEST(test_usbReadTask_multiple_commands_in_one_read);
     RUN_TEST(test_usbReadTask_no_data);
     RUN_TEST(test_usbReadTask_overflow);
+    RUN_TEST(test_usbReadTask_overflow_discards_rest_of_line);
     RUN_TEST(test_usbReadTask_split_line);
     RUN_TEST(test_usbWrite_chunked);
-    RUN_TEST(test_usbWrite_large_payload_waits_for_second_fifo_window);
+    RUN_TEST(test_usbWrite_discards_queue_when_unmounted);
+    RUN_TEST(test_usbWrite_drained_by_tx_complete_callback);
+    RUN_TEST(test_usbWrite_drops_whole_message_when_ring_full);
+    RUN_TEST(test_usbWrite_never_runs_usb_task);
+    RUN_TEST(test_usbWrite_preserves_order_across_ring_wrap);
     RUN_TEST(test_usbWrite_simple);
-    RUN_TEST(test_usbWrite_stops_after_real_timeout_when_host_never_drains);
-    RUN_TEST(test_usbWrite_waits_through_long_backpressure_until_space_returns);
     return UNITY_END();
 }
@@ -96,6 +96,26 @@ if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_mode_state...";
 gcc $CFLAGS Tests/microlight/model/test_mode_state.c $UNITY_SRC Core/Src/microlight/model/mode_state.c $TINYEXPR_SRC -lm -o Tests/build/test_mode_state
 run_test ./Tests/build/test_mode_state
 
+if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_live_stream..."; fi
+gcc $CFLAGS Tests/microlight/model/test_live_stream.c $UNITY_SRC Core/Src/microlight/model/live_stream.c -o Tests/build/test_live_stream
+run_test ./Tests/build/test_live_stream
+
+if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_telemetry..."; fi
+gcc $CFLAGS Tests/microlight/model/test_telemetry.c $UNITY_SRC Core/Src/microlight/model/telemetry.c -o Tests/build/test_telemetry
+run_test ./Tests/build/test_telemetry
+
+if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_monotonic_clock..."; fi
+gcc $CFLAGS Tests/microlight/model/test_monotonic_clock.c $UNITY_SRC Core/Src/microlight/model/monotonic_clock.c -o Tests/build/test_monotonic_clock
+run_test ./Tests/build/test_monotonic_clock
+
+if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_jerk_filter..."; fi
+gcc $CFLAGS Tests/microlight/model/test_jerk_filter.c $UNITY_SRC Core/Src/microlight/model/jerk_filter.c -o Tests/build/test_jerk_filter
+run_test ./Tests/build/test_jerk_filter
+
+if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_power_estimate..."; fi
+gcc $CFLAGS Tests/microlight/model/test_power_estimate.c $UNITY_SRC Core/Src/microlight/model/power_estimate.c Core/Src/microlight/device/rgb_led.c -o Tests/build/test_power_estimate
+run_test ./Tests/build/test_power_estimate
+
 if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_button..."; fi
 gcc $CFLAGS Tests/microlight/device/test_button.c $UNITY_SRC -o Tests/build/test_button
 run_test ./Tests/build/test_button
@@ -105,12 +125,24 @@ if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_command_parser..
 gcc $CFLAGS Tests/microlight/json/test_command_parser.c $UNITY_SRC $LWJSON_SRC Core/Src/microlight/model/cli_model.c Core/Src/microlight/json/json_buf.c -o Tests/build/test_command_parser
 run_test ./Tests/build/test_command_parser
 
+if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_frame..."; fi
+gcc $CFLAGS Tests/microlight/protocol/test_frame.c Core/Src/microlight/protocol/frame.c $UNITY_SRC -o Tests/build/test_frame
+run_test ./Tests/build/test_frame
+
 if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_rgb_led..."; fi
 gcc $CFLAGS Tests/microlight/device/test_rgb_led.c $UNITY_SRC -o Tests/build/test_rgb_led
 run_test ./Tests/build/test_rgb_led
 
+if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_i2c_queue..."; fi
+gcc $CFLAGS Tests/microlight/device/test_i2c_queue.c $UNITY_SRC Core/Src/microlight/device/i2c_queue.c -o Tests/build/test_i2c_queue
+run_test ./Tests/build/test_i2c_queue
+
+if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_mc3479..."; fi
+gcc $CFLAGS Tests/microlight/device/test_mc3479.c $UNITY_SRC Core/Src/microlight/device/i2c_queue.c Core/Src/microlight/model/jerk_filter.c -o Tests/build/test_mc3479
+run_test ./Tests/build/test_mc3479
+
 if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_bq25180..."; fi
-gcc $CFLAGS Tests/microlight/device/test_bq25180.c $UNITY_SRC $LWJSON_SRC -o Tests/build/test_bq25180
+gcc $CFLAGS Tests/microlight/device/test_bq25180.c $UNITY_SRC $LWJSON_SRC Core/Src/microlight/device/i2c_queue.c -o Tests/build/test_bq25180
 run_test ./Tests/build/test_bq25180
 
 if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_storage..."; fi
@@ -126,7 +158,7 @@ gcc $CFLAGS -DMICROLIGHT_LEGACY_PCB_BUTTON_PA7 Tests/test_mcu_dependencies.c $UN
 run_test ./Tests/build/test_mcu_dependencies_legacy_button
 
 if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_usb_manager..."; fi
-gcc $CFLAGS Tests/microlight/test_usb_manager.c $UNITY_SRC $LWJSON_SRC Core/Src/microlight/json/command_parser.c Core/Src/microlight/json/mode_parser.c Core/Src/microlight/json/parser.c Core/Src/microlight/model/cli_model.c Core/Src/microlight/json/json_buf.c Core/Src/microlight/usb_manager.c -lm -o Tests/build/test_usb_manager
+gcc $CFLAGS Tests/microlight/test_usb_manager.c $UNITY_SRC $LWJSON_SRC Core/Src/microlight/json/command_parser.c Core/Src/microlight/json/mode_parser.c Core/Src/microlight/json/parser.c Core/Src/microlight/model/cli_model.c Core/Src/microlight/json/json_buf.c Core/Src/microlight/protocol/frame.c Core/Src/microlight/model/live_stream.c Core/Src/microlight/model/power_estimate.c Core/Src/microlight/model/telemetry.c Core/Src/microlight/device/rgb_led.c Core/Src/microlight/usb_manager.c -lm -o Tests/build/test_usb_manager
 run_test ./Tests/build/test_usb_manager
 
 if [ "$SHOW_ALL" -eq 1 ]; then echo "Compiling and running test_i2c_log_decorate..."; fi